@@ -0,0 +1,105 @@
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <libslic3r/Arrange.hpp>
+#include <libslic3r/BoundingBox.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Time spent by arrangement::arrange() on plates made of many copies of the same few parts, for an increasing number
+// of copies. Each plate is arranged --repeat times. The no-fit polygon cache is shared by all the arrange calls of the
+// program: only the very first call starts with an empty cache, the next ones reuse the no-fit polygons cached by the
+// previous calls. The number of beds used and a checksum of the resulting positions are printed to check that the
+// builds being compared produce the same arrangement.
+
+const std::string USAGE_STR = {
+    "Usage: arrange [--copies 10,20,40,80,120] [--parts 3] [--rotations] [--repeat 3]"
+};
+
+using namespace Slic3r;
+
+static Polygon ellipse(double rx, double ry, size_t segments)
+{
+    Polygon out;
+    for (size_t i = 0; i < segments; ++ i) {
+        double angle = 2. * PI * double(i) / double(segments);
+        out.points.emplace_back(scale_(rx * cos(angle)), scale_(ry * sin(angle)));
+    }
+    return out;
+}
+
+// Convex silhouettes of the parts, as arrange() receives them from the model.
+static Polygon part(size_t idx)
+{
+    switch (idx % 3) {
+    case 0:
+        // 20x30 mm box with chamfered corners.
+        return Polygon{ { scale_(-8.), scale_(-15.) }, { scale_(8.), scale_(-15.) }, { scale_(10.), scale_(-13.) }, { scale_(10.), scale_(13.) },
+                        { scale_(8.), scale_(15.) }, { scale_(-8.), scale_(15.) }, { scale_(-10.), scale_(13.) }, { scale_(-10.), scale_(-13.) } };
+    case 1:
+        // 25 mm cylinder.
+        return ellipse(12.5, 12.5, 64);
+    default:
+        // Elongated bracket.
+        return ellipse(22., 8., 40);
+    }
+}
+
+int main(const int argc, const char *argv[])
+{
+    std::vector<size_t> copies    = { 10, 20, 40, 80, 120 };
+    size_t              num_parts = 3;
+    bool                rotations = false;
+    size_t              repeat    = 3;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--copies" && i + 1 < argc) {
+            copies.clear();
+            std::stringstream ss(argv[++ i]);
+            for (std::string n; std::getline(ss, n, ',');)
+                copies.emplace_back(std::max<size_t>(1, std::stoul(n)));
+        } else if (arg == "--parts" && i + 1 < argc)
+            num_parts = std::max<size_t>(1, std::min<size_t>(3, std::stoul(argv[++ i])));
+        else if (arg == "--rotations")
+            rotations = true;
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    BoundingBox                bed(Point(0, 0), Point(scale_(250.), scale_(210.)));
+    arrangement::ArrangeParams params(scale_(6.));
+    params.allow_rotations = rotations;
+
+    for (size_t num_copies : copies) {
+        arrangement::ArrangePolygons items;
+        double                       first = 0.;
+        double                       next  = 0.;
+        for (size_t r = 0; r < repeat; ++ r) {
+            items.assign(num_copies, {});
+            for (size_t i = 0; i < num_copies; ++ i)
+                items[i].poly.contour = part(i % num_parts);
+            Benchmark bench;
+            bench.start();
+            arrangement::arrange(items, bed, params);
+            bench.stop();
+            (r == 0 ? first : next) += bench.getElapsedSec();
+        }
+        int    beds     = 0;
+        double checksum = 0.;
+        for (const arrangement::ArrangePolygon &item : items) {
+            beds = std::max(beds, item.bed_idx + 1);
+            checksum += unscaled(item.translation.x()) + 3. * unscaled(item.translation.y()) + 7. * item.rotation + 11. * item.bed_idx;
+        }
+        std::cout << num_copies << " copies of " << num_parts << " parts: first " << first << " s";
+        if (repeat > 1)
+            std::cout << ", next " << next / double(repeat - 1) << " s";
+        std::cout << ", " << beds << " beds, checksum " << checksum << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
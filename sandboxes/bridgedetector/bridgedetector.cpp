@@ -0,0 +1,103 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/BridgeDetector.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Time spent by BridgeDetector::detect_angle() over the bridges of a sliced mesh, that is the parts of each layer
+// not supported by the layer below. The anchors are looked up through the spatial index with the candidate directions
+// evaluated in parallel, then by searching all the anchor regions serially. Both must pick the very same angles.
+
+const std::string USAGE_STR = {
+    "Usage: bridgedetector [--layer-height 0.2] [--spacing 0.45] [--repeat 3] mesh.stl"
+};
+
+using namespace Slic3r;
+
+struct Bridge {
+    ExPolygon         expolygon;
+    const ExPolygons *lower_slices;
+};
+
+int main(const int argc, const char *argv[])
+{
+    float       layer_height = 0.2f;
+    float       spacing      = 0.45f;
+    size_t      repeat       = 3;
+    std::string path;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--layer-height" && i + 1 < argc)
+            layer_height = std::stof(argv[++ i]);
+        else if (arg == "--spacing" && i + 1 < argc)
+            spacing = std::stof(argv[++ i]);
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else
+            path = arg;
+    }
+    if (path.empty()) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    TriangleMesh mesh;
+    if (! mesh.ReadSTLFile(path.c_str())) {
+        std::cerr << "Failed to load " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    mesh.repair();
+    mesh.require_shared_vertices();
+
+    BoundingBoxf3 bbox = mesh.bounding_box();
+    std::vector<float> z;
+    for (double slice_z = bbox.min.z() + 0.5 * layer_height; slice_z < bbox.max.z(); slice_z += layer_height)
+        z.emplace_back(float(slice_z));
+    std::vector<ExPolygons> layers;
+    TriangleMeshSlicer(&mesh).slice(z, SlicingMode::Regular, &layers, []() {});
+
+    // Bridges are the parts of a layer hanging over the layer below, ignoring the slivers narrower than the extrusion.
+    const coord_t scaled_spacing = scale_(spacing);
+    std::vector<Bridge> bridges;
+    for (size_t i = 1; i < layers.size(); ++ i)
+        for (ExPolygon &expoly : offset2_ex(diff_ex(layers[i], layers[i - 1]), - float(scaled_spacing), float(scaled_spacing)))
+            bridges.push_back({ std::move(expoly), &layers[i - 1] });
+    if (bridges.empty()) {
+        std::cerr << "No bridge found in " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << path << ": " << layers.size() << " layers, " << bridges.size() << " bridges" << std::endl;
+
+    auto run = [&bridges, scaled_spacing, repeat](const char *name, bool use_anchor_index) {
+        std::vector<double> angles(bridges.size(), -1.);
+        Benchmark bench;
+        bench.start();
+        for (size_t r = 0; r < repeat; ++ r)
+            for (size_t i = 0; i < bridges.size(); ++ i) {
+                BridgeDetector bd(bridges[i].expolygon, *bridges[i].lower_slices, scaled_spacing);
+                bd.use_anchor_index = use_anchor_index;
+                angles[i] = bd.detect_angle() ? bd.angle : -1.;
+            }
+        bench.stop();
+        std::cout << "  " << name << ": " << bench.getElapsedSec() << " s" << std::endl;
+        return angles;
+    };
+
+    std::vector<double> angles_index  = run("anchor index, parallel", true);
+    std::vector<double> angles_linear = run("linear search, serial  ", false);
+
+    size_t num_different = 0;
+    for (size_t i = 0; i < bridges.size(); ++ i)
+        if (angles_index[i] != angles_linear[i]) {
+            std::cerr << "Bridge " << i << ": angle " << angles_index[i] << " instead of " << angles_linear[i] << std::endl;
+            ++ num_different;
+        }
+    std::cout << "  " << (bridges.size() - num_different) << " of " << bridges.size() << " bridge angles unchanged" << std::endl;
+
+    return num_different == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
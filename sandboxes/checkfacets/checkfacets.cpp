@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libslic3r/TriangleMesh.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Time spent by stl_check_facets_exact(), which connects the facets by inserting their edges into a hash table one by one,
+// and by stl_check_facets_exact_parallel(), which sorts the edges in parallel. Both must produce the very same neighbors.
+// Without a mesh, spheres of the requested numbers of triangles are connected. The facets of a sphere are ordered ring by ring,
+// which keeps the hash table small, while the facets of STL files exported by CAD tools often have no such locality:
+// --shuffle randomizes the order of the facets.
+
+const std::string USAGE_STR = {
+    "Usage: checkfacets [--triangles 1000000] [--triangles 10000000] [--shuffle] [--repeat 3] [mesh.stl ...]"
+};
+
+using namespace Slic3r;
+
+static bool check_facets(const std::string &name, const stl_file &stl, size_t repeat)
+{
+    auto run = [&stl, repeat](const char *name, void (*check_facets_exact)(stl_file*)) {
+        stl_file out;
+        double   elapsed = 0.;
+        for (size_t r = 0; r < repeat; ++ r) {
+            out = stl;
+            Benchmark bench;
+            bench.start();
+            check_facets_exact(&out);
+            bench.stop();
+            elapsed += bench.getElapsedSec();
+        }
+        std::cout << "  " << name << ": " << elapsed / double(repeat) << " s" << std::endl;
+        return out;
+    };
+
+    std::cout << name << ": " << stl.stats.number_of_facets << " triangles" << std::endl;
+    stl_file hashed = run("hash table     ", stl_check_facets_exact);
+    stl_file sorted = run("parallel sort  ", stl_check_facets_exact_parallel);
+
+    bool same = hashed.neighbors_start.size() == sorted.neighbors_start.size() &&
+        std::memcmp(hashed.neighbors_start.data(), sorted.neighbors_start.data(), sizeof(stl_neighbors) * hashed.neighbors_start.size()) == 0 &&
+        hashed.stats.connected_edges         == sorted.stats.connected_edges &&
+        hashed.stats.connected_facets_1_edge == sorted.stats.connected_facets_1_edge &&
+        hashed.stats.connected_facets_2_edge == sorted.stats.connected_facets_2_edge &&
+        hashed.stats.connected_facets_3_edge == sorted.stats.connected_facets_3_edge &&
+        hashed.stats.shortest_edge           == sorted.stats.shortest_edge;
+    if (! same)
+        std::cerr << "  The neighbors differ" << std::endl;
+    return same;
+}
+
+int main(const int argc, const char *argv[])
+{
+    std::vector<size_t>      triangles;
+    size_t                   repeat  = 3;
+    bool                     shuffle = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--triangles" && i + 1 < argc)
+            triangles.emplace_back(std::max<size_t>(8, std::stoul(argv[++ i])));
+        else if (arg == "--shuffle")
+            shuffle = true;
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else if (arg == "--help" || arg == "-h") {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_SUCCESS;
+        } else
+            paths.emplace_back(arg);
+    }
+    if (triangles.empty() && paths.empty())
+        triangles = { 1000000, 4000000, 10000000 };
+
+    bool ok = true;
+    for (size_t num_triangles : triangles) {
+        // A sphere of n rings of 2n segments has about 4n^2 triangles.
+        TriangleMesh sphere = make_sphere(50., PI / std::sqrt(0.25 * double(num_triangles)));
+        stl_file stl;
+        stl.stats = sphere.stl.stats;
+        stl_facets_from_its(&stl, sphere.its);
+        if (shuffle)
+            std::shuffle(stl.facet_start.begin(), stl.facet_start.end(), std::mt19937(0));
+        ok &= check_facets("sphere", stl, repeat);
+    }
+    for (const std::string &path : paths) {
+        stl_file stl;
+        if (! stl_open(&stl, path.c_str())) {
+            std::cerr << "Failed to load " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (shuffle)
+            std::shuffle(stl.facet_start.begin(), stl.facet_start.end(), std::mt19937(0));
+        ok &= check_facets(path, stl, repeat);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Time spent in the most frequently called ClipperUtils functions over the layers of a sliced mesh.
+// Each layer is clipped against the layer above, as when detecting top / bottom surfaces and overhangs.
+// For diff() the former path through ClipperLib::Paths copies of the input and output is timed as well.
+
+const std::string USAGE_STR = {
+    "Usage: clipperutils [--layer-height 0.2] [--repeat 3] mesh.stl"
+};
+
+using namespace Slic3r;
+
+// The former implementation of _clipper(): input and output copied through ClipperLib::Paths.
+static Polygons diff_through_paths(const Polygons &subject, const Polygons &clip)
+{
+    ClipperLib::Clipper clipper;
+    clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(subject), ClipperLib::ptSubject, true);
+    clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(clip), ClipperLib::ptClip, true);
+    ClipperLib::Paths out;
+    clipper.Execute(ClipperLib::ctDifference, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return ClipperPaths_to_Slic3rPolygons(out);
+}
+
+int main(const int argc, const char *argv[])
+{
+    float       layer_height = 0.2f;
+    size_t      repeat       = 3;
+    std::string path;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--layer-height" && i + 1 < argc)
+            layer_height = std::stof(argv[++ i]);
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else
+            path = arg;
+    }
+    if (path.empty()) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    TriangleMesh mesh;
+    if (! mesh.ReadSTLFile(path.c_str())) {
+        std::cerr << "Failed to load " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    mesh.repair();
+    mesh.require_shared_vertices();
+
+    BoundingBoxf3 bbox = mesh.bounding_box();
+    std::vector<float> z;
+    for (double slice_z = bbox.min.z() + 0.5 * layer_height; slice_z < bbox.max.z(); slice_z += layer_height)
+        z.emplace_back(float(slice_z));
+    std::vector<ExPolygons> layers;
+    TriangleMeshSlicer(&mesh).slice(z, SlicingMode::Regular, &layers, []() {});
+    if (layers.size() < 2) {
+        std::cerr << "Not enough layers" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<Polygons> layers_polygons;
+    layers_polygons.reserve(layers.size());
+    size_t num_points = 0;
+    for (const ExPolygons &layer : layers) {
+        layers_polygons.emplace_back(to_polygons(layer));
+        for (const Polygon &polygon : layers_polygons.back())
+            num_points += polygon.points.size();
+    }
+    // Infill lines crossing each layer, 1mm apart.
+    Polylines infill;
+    for (coord_t y = scale_(bbox.min.y()); y < scale_(bbox.max.y()); y += scale_(1.))
+        infill.emplace_back(Point(scale_(bbox.min.x()) - scale_(1.), y), Point(scale_(bbox.max.x()) + scale_(1.), y));
+
+    const float width = float(scale_(0.45));
+    std::cout << path << ": " << layers.size() << " layers, " << num_points << " points" << std::endl;
+
+    // Runs fn over all pairs of neighbor layers, returns the number of output elements to keep the work alive.
+    auto run = [&layers, repeat](const char *name, const std::function<size_t(size_t, size_t)> &fn) {
+        size_t   out = 0;
+        Benchmark bench;
+        bench.start();
+        for (size_t r = 0; r < repeat; ++ r)
+            for (size_t i = 0; i + 1 < layers.size(); ++ i)
+                out += fn(i, i + 1);
+        bench.stop();
+        std::cout << "  " << std::left << std::setw(30) << name << bench.getElapsedSec() << " s (" << out << ")" << std::endl;
+    };
+
+    run("offset(Polygons)", [&](size_t i, size_t) { return offset(layers_polygons[i], - width).size(); });
+    run("offset_ex(ExPolygons)", [&](size_t i, size_t) { return offset_ex(layers[i], - width).size(); });
+    run("offset2_ex(ExPolygons)", [&](size_t i, size_t) { return offset2_ex(layers[i], - width, 0.5f * width).size(); });
+    run("union_(Polygons)", [&](size_t i, size_t j) { return union_(layers_polygons[i], layers_polygons[j]).size(); });
+    run("union_ex(ExPolygons)", [&](size_t i, size_t) { return union_ex(layers[i]).size(); });
+    run("diff(Polygons)", [&](size_t i, size_t j) { return diff(layers_polygons[i], layers_polygons[j]).size(); });
+    run("diff(Polygons) via Paths", [&](size_t i, size_t j) { return diff_through_paths(layers_polygons[i], layers_polygons[j]).size(); });
+    run("diff_ex(ExPolygons)", [&](size_t i, size_t j) { return diff_ex(layers[i], layers[j]).size(); });
+    run("intersection(ExPolygons)", [&](size_t i, size_t j) { return intersection(layers[i], layers[j]).size(); });
+    run("intersection_ex(Polygons)", [&](size_t i, size_t j) { return intersection_ex(layers_polygons[i], layers_polygons[j]).size(); });
+    run("intersection_pl(Polylines)", [&](size_t i, size_t) { return intersection_pl(infill, layers_polygons[i]).size(); });
+    run("simplify_polygons", [&](size_t i, size_t) { return simplify_polygons(layers_polygons[i]).size(); });
+
+    return EXIT_SUCCESS;
+}
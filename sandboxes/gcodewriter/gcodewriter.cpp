@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/GCodeWriter.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// G-code lines per second written by GCodeWriter::extrude_to_xy() and GCodeWriter::travel_to_xy().
+// Compares the std::ostringstream formatting the writer used before, the std::string returning API
+// and the API appending to a reused layer buffer.
+
+const std::string USAGE_STR = {
+    "Usage: gcodewriter [--lines 1000000] [--layers 10]"
+};
+
+using namespace Slic3r;
+
+// The former formatting of an extrusion line, through a stream and temporary strings.
+static std::string legacy_extrude_to_xy(const Vec2d &point, double E, int precision_xyz, int precision_e)
+{
+    auto nozero = [](double value, int max_precision) {
+        std::stringstream ss;
+        double intpart;
+        if (modf(value, &intpart) == 0.0) {
+            ss << std::setprecision(17) << intpart;
+            return ss.str();
+        }
+        int long10 = intpart > 9 ? int(std::floor(std::log10(std::abs(intpart)))) : 0;
+        ss << std::fixed << std::setprecision(std::min(15 - long10, max_precision)) << value;
+        std::string ret = ss.str();
+        if (ret.find('.') != std::string::npos) {
+            ret.erase(ret.find_last_not_of('0') + 1);
+            if (ret.back() == '.')
+                ret.pop_back();
+        }
+        return ret;
+    };
+    std::ostringstream gcode;
+    gcode << "G1 X" << nozero(point.x(), precision_xyz) << " Y" << nozero(point.y(), precision_xyz)
+          << " E" << nozero(E, precision_e) << "\n";
+    return gcode.str();
+}
+
+static void report(const char *name, Benchmark &bench, size_t lines, size_t bytes)
+{
+    std::cout << "  " << std::left << std::setw(26) << name << bench.getElapsedSec() << " s, "
+              << double(lines) / bench.getElapsedSec() << " lines/s (" << bytes << " bytes)" << std::endl;
+}
+
+int main(const int argc, const char *argv[])
+{
+    size_t num_lines  = 1000000;
+    size_t num_layers = 10;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--lines" && i + 1 < argc)
+            num_lines = std::stoul(argv[++ i]);
+        else if (arg == "--layers" && i + 1 < argc)
+            num_layers = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Random walk over a 250x210 bed, with short segments as in perimeters & infill.
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> step(-5., 5.);
+    std::vector<Vec2d> points;
+    points.reserve(num_lines);
+    Vec2d pt(125., 105.);
+    for (size_t i = 0; i < num_lines; ++ i) {
+        pt = Vec2d(std::clamp(pt.x() + step(rng), 0., 250.), std::clamp(pt.y() + step(rng), 0., 210.));
+        points.emplace_back(pt);
+    }
+    const size_t lines_per_layer = (num_lines + num_layers - 1) / num_layers;
+
+    // Not copied: the current tool of a GCodeWriter points into its extruders.
+    auto init_writer = [](GCodeWriter &writer) {
+        writer.set_extruders({ 0 });
+        writer.set_tool(0);
+    };
+
+    std::cout << num_lines << " lines in " << num_layers << " layers" << std::endl;
+    {
+        GCodeWriter writer;
+        init_writer(writer);
+        const int precision_xyz = writer.config.gcode_precision_xyz.value;
+        const int precision_e   = writer.config.gcode_precision_e.value;
+        size_t bytes = 0;
+        double E = 0.;
+        Benchmark bench;
+        bench.start();
+        for (size_t i = 0; i < num_lines; i += lines_per_layer) {
+            std::string gcode;
+            for (size_t j = i; j < std::min(num_lines, i + lines_per_layer); ++ j)
+                gcode += legacy_extrude_to_xy(points[j], E += 0.05, precision_xyz, precision_e);
+            bytes += gcode.size();
+        }
+        bench.stop();
+        report("ostringstream (before)", bench, num_lines, bytes);
+    }
+    for (bool travel : { false, true }) {
+        GCodeWriter writer;
+        init_writer(writer);
+        size_t bytes = 0;
+        Benchmark bench;
+        bench.start();
+        for (size_t i = 0; i < num_lines; i += lines_per_layer) {
+            std::string gcode;
+            for (size_t j = i; j < std::min(num_lines, i + lines_per_layer); ++ j)
+                gcode += travel ? writer.travel_to_xy(points[j]) : writer.extrude_to_xy(points[j], 0.05);
+            bytes += gcode.size();
+        }
+        bench.stop();
+        report(travel ? "travel_to_xy (returned)" : "extrude_to_xy (returned)", bench, num_lines, bytes);
+    }
+    for (bool travel : { false, true }) {
+        GCodeWriter writer;
+        init_writer(writer);
+        size_t bytes = 0;
+        // The layer buffer is reused, as GCode does with the G-code of a layer.
+        std::string gcode;
+        Benchmark bench;
+        bench.start();
+        for (size_t i = 0; i < num_lines; i += lines_per_layer) {
+            gcode.clear();
+            for (size_t j = i; j < std::min(num_lines, i + lines_per_layer); ++ j)
+                if (travel)
+                    writer.travel_to_xy(gcode, points[j]);
+                else
+                    writer.extrude_to_xy(gcode, points[j], 0.05);
+            bytes += gcode.size();
+        }
+        bench.stop();
+        report(travel ? "travel_to_xy (appended)" : "extrude_to_xy (appended)", bench, num_lines, bytes);
+    }
+
+    return EXIT_SUCCESS;
+}
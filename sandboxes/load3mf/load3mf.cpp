@@ -0,0 +1,100 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <libslic3r/Model.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/Utils.hpp>
+#include <libslic3r/Format/3mf.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Load time and peak memory of load_3mf() on a large project file.
+// The project file is written first by the --write mode, either from a mesh or from a sphere of the requested number
+// of triangles, then loaded by a separate run so that the peak memory reported is the one of the loading only.
+// Run the loading with the libslic3r builds to be compared.
+
+const std::string USAGE_STR = {
+    "Usage: load3mf --write [--triangles 4000000] [mesh.stl] project.3mf\n"
+    "       load3mf [--repeat 1] project.3mf"
+};
+
+using namespace Slic3r;
+
+static int write_project(const std::string &path, const std::string &mesh_path, size_t num_triangles)
+{
+    Model model;
+    if (mesh_path.empty()) {
+        // A sphere of n rings of 2n segments has about 4n^2 triangles.
+        double fa = PI / std::sqrt(0.25 * double(num_triangles));
+        model.add_object("sphere", "", make_sphere(50., fa));
+    } else
+        model = Model::read_from_file(mesh_path);
+    model.add_default_instances();
+
+    Benchmark bench;
+    bench.start();
+    bool ok = store_3mf(path.c_str(), &model, nullptr, false);
+    bench.stop();
+    if (! ok) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << path << ": " << model.mesh().facets_count() << " triangles written in " << bench.getElapsedSec() << " s" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+static int load_project(const std::string &path, size_t repeat)
+{
+    size_t  num_triangles = 0;
+    Benchmark bench;
+    bench.start();
+    for (size_t r = 0; r < repeat; ++ r) {
+        Model                     model;
+        DynamicPrintConfig        config;
+        ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+        if (! load_3mf(path.c_str(), config, ctxt, &model, false)) {
+            std::cerr << "Failed to load " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        num_triangles = 0;
+        for (const ModelObject *object : model.objects)
+            for (const ModelVolume *volume : object->volumes)
+                num_triangles += volume->mesh().facets_count();
+    }
+    bench.stop();
+    std::cout << path << ": " << num_triangles << " triangles loaded in " << bench.getElapsedSec() / double(repeat) << " s" << std::endl;
+    std::cout << " " << log_memory_info(true) << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(const int argc, const char *argv[])
+{
+    bool        write         = false;
+    size_t      num_triangles = 4000000;
+    size_t      repeat        = 1;
+    std::string mesh_path;
+    std::string path;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--write")
+            write = true;
+        else if (arg == "--triangles" && i + 1 < argc)
+            num_triangles = std::max<size_t>(8, std::stoul(argv[++ i]));
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else if (path.empty())
+            path = arg;
+        else {
+            mesh_path = path;
+            path      = arg;
+        }
+    }
+    if (path.empty() || (! write && ! mesh_path.empty())) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return write ? write_project(path, mesh_path, num_triangles) : load_project(path, repeat);
+}
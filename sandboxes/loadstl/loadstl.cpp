@@ -0,0 +1,85 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <libslic3r/TriangleMesh.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Load throughput of stl_open() on binary and ASCII STL files.
+// The --write mode writes a sphere of the requested number of triangles, or converts a mesh, to a binary and an ASCII STL.
+
+const std::string USAGE_STR = {
+    "Usage: loadstl --write [--triangles 4000000] [mesh.stl] output_prefix\n"
+    "       loadstl [--repeat 3] mesh.stl [mesh2.stl ...]"
+};
+
+using namespace Slic3r;
+
+static int write_meshes(const std::string &prefix, const std::string &mesh_path, size_t num_triangles)
+{
+    TriangleMesh mesh;
+    if (mesh_path.empty())
+        // A sphere of n rings of 2n segments has about 4n^2 triangles.
+        mesh = make_sphere(50., PI / std::sqrt(0.25 * double(num_triangles)));
+    else if (! mesh.ReadSTLFile(mesh_path.c_str())) {
+        std::cerr << "Failed to load " << mesh_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string binary = prefix + "_binary.stl";
+    std::string ascii  = prefix + "_ascii.stl";
+    if (! mesh.write_binary(binary.c_str()) || ! mesh.write_ascii(ascii.c_str())) {
+        std::cerr << "Failed to write " << binary << " or " << ascii << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << mesh.facets_count() << " triangles written to " << binary << " and " << ascii << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(const int argc, const char *argv[])
+{
+    bool                     write         = false;
+    size_t                   num_triangles = 4000000;
+    size_t                   repeat        = 3;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--write")
+            write = true;
+        else if (arg == "--triangles" && i + 1 < argc)
+            num_triangles = std::max<size_t>(8, std::stoul(argv[++ i]));
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else
+            paths.emplace_back(arg);
+    }
+    if (paths.empty() || (write && paths.size() > 2)) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (write)
+        return write_meshes(paths.back(), paths.size() == 2 ? paths.front() : std::string(), num_triangles);
+
+    for (const std::string &path : paths) {
+        size_t    num_facets = 0;
+        Benchmark bench;
+        bench.start();
+        for (size_t r = 0; r < repeat; ++ r) {
+            stl_file stl;
+            if (! stl_open(&stl, path.c_str())) {
+                std::cerr << "Failed to load " << path << std::endl;
+                return EXIT_FAILURE;
+            }
+            num_facets = stl.stats.number_of_facets;
+        }
+        bench.stop();
+        double seconds = bench.getElapsedSec() / double(repeat);
+        double mbytes  = double(boost::filesystem::file_size(path)) / (1024. * 1024.);
+        std::cout << path << ": " << num_facets << " facets, " << mbytes << " MB loaded in " << seconds << " s, "
+                  << mbytes / seconds << " MB/s, " << double(num_facets) / seconds << " facets/s" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
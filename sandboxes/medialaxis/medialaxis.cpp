@@ -0,0 +1,110 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/MedialAxis.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Time spent by MedialAxis::build() on thin walls and gap fill regions: thin rings and zig-zag walls of variable width
+// and thin wedges, built with the parameters of the gap fill. The number of points and the sum of the widths of
+// the extrusions produced are printed to check that the builds being compared produce the same extrusions.
+
+const std::string USAGE_STR = {
+    "Usage: medialaxis [--shapes 2000] [--width 0.45] [--repeat 3]"
+};
+
+using namespace Slic3r;
+
+static Polygon circle(const Point &center, double radius, size_t segments)
+{
+    Polygon out;
+    for (size_t i = 0; i < segments; ++ i) {
+        double angle = 2. * PI * double(i) / double(segments);
+        out.points.emplace_back(center + Point(coord_t(radius * cos(angle)), coord_t(radius * sin(angle))));
+    }
+    return out;
+}
+
+static ExPolygons thin_shapes(size_t num_shapes, double width)
+{
+    ExPolygons out;
+    for (size_t i = 0; i < num_shapes; ++ i) {
+        // Keep the coordinates well inside the range of the Voronoi builder.
+        Point  center(scale_(double(i % 4) * 50. - 100.), scale_(double(i / 4 % 4) * 50. - 100.));
+        // From a bit less than the width to a bit less than twice the width.
+        double w = scale_(width * (0.8 + 0.9 * double(i % 7) / 6.));
+        switch (i % 3) {
+        case 0:
+        {
+            // Thin ring.
+            double    radius = scale_(5. + double(i % 11) * 2.);
+            ExPolygon ring(circle(center, radius, 64 + i % 64));
+            Polygon   hole = circle(center, radius - w, 64 + i % 64);
+            hole.reverse();
+            ring.holes.emplace_back(std::move(hole));
+            out.emplace_back(std::move(ring));
+            break;
+        }
+        case 1:
+        {
+            // Zig-zag wall.
+            Polyline zigzag;
+            for (size_t j = 0; j < 10; ++ j)
+                zigzag.points.emplace_back(center + Point(scale_(double(j) * 4.), scale_((j & 1) ? 3. : 0.)));
+            append(out, union_ex(offset(zigzag, float(0.5 * w))));
+            break;
+        }
+        default:
+            // Thin wedge.
+            out.emplace_back(Polygon{ center, center + Point(scale_(40.), coord_t(0.5 * w)), center + Point(coord_t(0), coord_t(2. * w)) });
+        }
+    }
+    return out;
+}
+
+int main(const int argc, const char *argv[])
+{
+    size_t num_shapes = 2000;
+    double width      = 0.45;
+    size_t repeat     = 3;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--shapes" && i + 1 < argc)
+            num_shapes = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else if (arg == "--width" && i + 1 < argc)
+            width = std::stod(argv[++ i]);
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    ExPolygons shapes  = thin_shapes(num_shapes, width);
+    coord_t    scaled_width = scale_t(width);
+    size_t     num_points = 0;
+    double     sum_width  = 0.;
+    Benchmark  bench;
+    bench.start();
+    for (size_t r = 0; r < repeat; ++ r) {
+        num_points = 0;
+        sum_width  = 0.;
+        for (const ExPolygon &expoly : shapes) {
+            ThickPolylines polylines;
+            MedialAxis{ expoly, scaled_width * 2, scaled_width / 5, scale_t(0.2) }.build(polylines);
+            for (const ThickPolyline &polyline : polylines) {
+                num_points += polyline.points.size();
+                for (coordf_t w : polyline.width)
+                    sum_width += unscaled(w);
+            }
+        }
+    }
+    bench.stop();
+    std::cout << shapes.size() << " shapes: " << bench.getElapsedSec() / double(repeat) << " s, " <<
+        num_points << " points, sum of widths " << sum_width << std::endl;
+    return EXIT_SUCCESS;
+}
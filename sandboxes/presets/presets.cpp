@@ -0,0 +1,143 @@
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <libslic3r/AppConfig.hpp>
+#include <libslic3r/Preset.hpp>
+#include <libslic3r/PresetBundle.hpp>
+#include <libslic3r/Utils.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Load time and memory of PresetBundle::load_presets(), as called at the application start, on a data directory
+// with vendor config bundles installed, followed by the selection of every loaded preset, which copies its config into
+// the edited preset. The --write mode writes a synthetic vendor config bundle into data_dir/vendor, made of presets
+// inheriting from common parents as the vendor bundles are. The checksum of the serialized preset configs is printed
+// to check that the builds being compared load the same presets.
+
+const std::string USAGE_STR = {
+    "Usage: presets --write [--printers 100] [--prints 600] [--filaments 1500] data_dir\n"
+    "       presets data_dir"
+};
+
+using namespace Slic3r;
+
+static int write_bundle(const std::string &dir, size_t num_printers, size_t num_prints, size_t num_filaments)
+{
+    boost::filesystem::path path = boost::filesystem::path(dir) / "vendor";
+    boost::filesystem::create_directories(path);
+    path /= "Synthetic.ini";
+    boost::nowide::ofstream out(path.string());
+    out << "[vendor]\nname = Synthetic\nconfig_version = 1.0.0\n\n"
+           "[printer_model:SYNTH]\nname = Synthetic printer\nvariants = 0.4\ntechnology = FFF\ndefault_materials = Filament 0\n\n";
+
+    // The common parents hold all the values of the default presets, the presets themselves override a few of them.
+    PresetBundle defaults;
+    auto write_common = [&out](const char *section, const DynamicPrintConfig &config) {
+        out << "[" << section << ":*common*]\n";
+        for (const std::string &key : config.keys())
+            if (key != "inherits" && key != "printer_model" && key != "printer_variant")
+                out << key << " = " << config.opt_serialize(key) << "\n";
+    };
+    write_common("printer", defaults.printers.default_preset().config);
+    out << "printer_model = SYNTH\nprinter_variant = 0.4\n\n";
+    for (size_t i = 0; i < num_printers; ++ i)
+        out << "[printer:Printer " << i << "]\ninherits = *common*\n"
+            << "max_print_height = " << 150 + i % 100 << "\n"
+            << "retract_length = " << 0.5 + 0.1 * double(i % 30) << "\n\n";
+    write_common("print", defaults.fff_prints.default_preset().config);
+    out << "\n";
+    for (size_t i = 0; i < num_prints; ++ i)
+        out << "[print:Print " << i << "]\ninherits = *common*\n"
+            << "layer_height = " << 0.05 * double(1 + i % 6) << "\n"
+            << "perimeters = " << 2 + i % 3 << "\n"
+            << "fill_density = " << 5 * (2 + i % 8) << "%\n"
+            << "compatible_printers_condition = printer_model==\"SYNTH\"\n\n";
+    write_common("filament", defaults.filaments.default_preset().config);
+    out << "\n";
+    for (size_t i = 0; i < num_filaments; ++ i)
+        out << "[filament:Filament " << i << "]\ninherits = *common*\n"
+            << "temperature = " << 190 + i % 60 << "\n"
+            << "first_layer_temperature = " << 195 + i % 60 << "\n"
+            << "filament_cost = " << 20 + i % 40 << "\n"
+            << "filament_colour = #" << std::hex << (i * 2654435761u) % 0xffffff << std::dec << "\n\n";
+    out.close();
+    std::cout << path.string() << ": " << num_printers << " printers, " << num_prints << " prints, " << num_filaments << " filaments written" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+static int load_presets(const std::string &dir)
+{
+    set_data_dir(dir);
+    std::cout << "Before loading:" << log_memory_info(true) << std::endl;
+
+    Benchmark    bench;
+    AppConfig    app_config(AppConfig::EAppMode::Editor);
+    PresetBundle bundle;
+    bundle.setup_directories();
+    bench.start();
+    try {
+        bundle.load_presets(app_config, ForwardCompatibilitySubstitutionRule::EnableSystemSilent);
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+    }
+    bench.stop();
+    PresetCollection *collections[] = { &bundle.fff_prints, &bundle.filaments, &bundle.printers };
+    size_t num_presets = 0;
+    for (const PresetCollection *presets : collections)
+        num_presets += presets->size();
+    std::cout << num_presets << " presets loaded in " << bench.getElapsedSec() << " s" << std::endl;
+    std::cout << "After loading:" << log_memory_info(true) << std::endl;
+
+    // Select each preset, as the user does when browsing the presets.
+    bench.start();
+    for (PresetCollection *presets : collections)
+        for (size_t i = 0; i < presets->size(); ++ i)
+            presets->select_preset(i);
+    bench.stop();
+    std::cout << "All presets selected in " << bench.getElapsedSec() << " s" << std::endl;
+
+    size_t checksum = 0;
+    for (const PresetCollection *presets : collections)
+        for (size_t i = 0; i < presets->size(); ++ i) {
+            const DynamicPrintConfig &config = presets->preset(i).config;
+            for (const std::string &key : config.keys())
+                checksum = checksum * 31 + std::hash<std::string>()(key + "=" + config.opt_serialize(key));
+        }
+    std::cout << "Checksum: " << checksum << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(const int argc, const char *argv[])
+{
+    bool        write         = false;
+    size_t      num_printers  = 100;
+    size_t      num_prints    = 600;
+    size_t      num_filaments = 1500;
+    std::string dir;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--write")
+            write = true;
+        else if (arg == "--printers" && i + 1 < argc)
+            num_printers = std::max<size_t>(1, std::stoul(argv[++ i]));
+        else if (arg == "--prints" && i + 1 < argc)
+            num_prints = std::stoul(argv[++ i]);
+        else if (arg == "--filaments" && i + 1 < argc)
+            num_filaments = std::stoul(argv[++ i]);
+        else if (dir.empty())
+            dir = arg;
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (dir.empty()) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return write ? write_bundle(dir, num_printers, num_prints, num_filaments) : load_presets(dir);
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/ModelArrange.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/Utils.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Compares the wall time of Print::process() with the PrintObjects processed one after the other
+// and with the PrintObjects processed concurrently, on a plate of different parts.
+// The parts are either loaded from the STL files passed on the command line,
+// or generated (cubes, cylinders and spheres of various sizes).
+
+using namespace Slic3r;
+
+static constexpr size_t NUM_OBJECTS = 20;
+
+static std::vector<TriangleMesh> plate_meshes(const int argc, const char *argv[])
+{
+    std::vector<TriangleMesh> meshes;
+    if (argc > 1) {
+        for (size_t i = 0; i < NUM_OBJECTS; ++ i) {
+            TriangleMesh mesh;
+            mesh.ReadSTLFile(argv[1 + i % (argc - 1)]);
+            meshes.emplace_back(std::move(mesh));
+        }
+    } else {
+        for (size_t i = 0; i < NUM_OBJECTS; ++ i) {
+            double size = 10. + 2. * double(i);
+            switch (i % 3) {
+            case 0:  meshes.emplace_back(make_cube(size, size * 0.7, size * 1.5)); break;
+            case 1:  meshes.emplace_back(make_cylinder(size * 0.5, size * 2.)); break;
+            default: meshes.emplace_back(make_sphere(size * 0.5, 2. * PI / 120.)); break;
+            }
+        }
+    }
+    for (TriangleMesh &mesh : meshes)
+        mesh.repair();
+    return meshes;
+}
+
+static double process_plate(const std::vector<TriangleMesh> &meshes, bool serial)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "fill_density",     "20%" },
+        { "support_material", "1" },
+        { "ironing",          "1" },
+    });
+
+    Model model;
+    for (const TriangleMesh &mesh : meshes) {
+        ModelObject *object = model.add_object();
+        object->add_volume(mesh);
+        object->add_instance();
+        object->ensure_on_bed();
+    }
+
+    Print print;
+    print.apply(model, config);
+    arrange_objects(model, InfiniteBed{}, ArrangeParams{ scaled(print.config().min_object_distance()) });
+    print.apply(model, config);
+    print.validate();
+    print.set_status_silent();
+    print.set_serial_object_processing(serial);
+
+    Benchmark bench;
+    bench.start();
+    print.process();
+    bench.stop();
+    return bench.getElapsedSec();
+}
+
+int main(const int argc, const char *argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "--help") {
+        std::cout << "Usage: printobjects [part1.stl part2.stl ...]" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    // Log warnings and errors only.
+    set_logging_level(2);
+
+    std::vector<TriangleMesh> meshes = plate_meshes(argc, argv);
+
+    double serial     = process_plate(meshes, true);
+    double concurrent = process_plate(meshes, false);
+
+    std::cout << "Objects: " << meshes.size() << std::endl;
+    std::cout << "Serial object processing:     " << serial << " s" << std::endl;
+    std::cout << "Concurrent object processing: " << concurrent << " s" << std::endl;
+    std::cout << "Speedup: " << serial / concurrent << std::endl;
+
+    return EXIT_SUCCESS;
+}
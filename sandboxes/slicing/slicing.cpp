@@ -0,0 +1,77 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libslic3r/TriangleMesh.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+#include <tbb/task_arena.h>
+
+// Slicing throughput of TriangleMeshSlicer::slice() over the number of threads.
+// Slices each of the meshes passed on the command line with the given layer height
+// and reports facets per second for 1, 2, 4, ... threads up to the hardware concurrency.
+
+const std::string USAGE_STR = {
+    "Usage: slicing [--layer-height 0.05] mesh1.stl [mesh2.stl ...]"
+};
+
+using namespace Slic3r;
+
+static void benchmark_mesh(const std::string &path, float layer_height)
+{
+    TriangleMesh mesh;
+    if (! mesh.ReadSTLFile(path.c_str())) {
+        std::cerr << "Failed to load " << path << std::endl;
+        return;
+    }
+    mesh.repair();
+    mesh.require_shared_vertices();
+
+    BoundingBoxf3 bbox = mesh.bounding_box();
+    std::vector<float> z;
+    for (double slice_z = bbox.min.z() + 0.5 * layer_height; slice_z < bbox.max.z(); slice_z += layer_height)
+        z.emplace_back(float(slice_z));
+
+    TriangleMeshSlicer slicer(&mesh);
+
+    std::cout << path << ": " << mesh.facets_count() << " facets, " << z.size() << " layers" << std::endl;
+    size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    for (size_t num_threads = 1;; num_threads = std::min(num_threads * 2, max_threads)) {
+        std::vector<Polygons> layers;
+        Benchmark bench;
+        tbb::task_arena arena(static_cast<int>(num_threads));
+        arena.execute([&slicer, &z, &layers, &bench]() {
+            bench.start();
+            slicer.slice(z, SlicingMode::Regular, &layers, []() {});
+            bench.stop();
+        });
+        std::cout << "  threads: " << num_threads << ", time: " << bench.getElapsedSec() << " s, "
+                  << double(mesh.facets_count()) / bench.getElapsedSec() << " facets/s" << std::endl;
+        if (num_threads == max_threads)
+            break;
+    }
+}
+
+int main(const int argc, const char *argv[])
+{
+    float layer_height = 0.05f;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--layer-height" && i + 1 < argc)
+            layer_height = std::stof(argv[++ i]);
+        else
+            paths.emplace_back(arg);
+    }
+    if (paths.empty()) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (const std::string &path : paths)
+        benchmark_mesh(path, layer_height);
+
+    return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 #include <math.h>
 
 #include <algorithm>
+#include <atomic>
 #include <vector>
 
 #include <boost/predef/other/endian.h>
@@ -34,6 +35,9 @@
 #define BOOST_POOL_NO_MT
 #include <boost/pool/object_pool.hpp>
 
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
 #include "stl.h"
 
 struct HashEdge {
@@ -53,11 +57,14 @@ struct HashEdge {
 
 	void load_exact(stl_file *stl, const stl_vertex *a, const stl_vertex *b)
 	{
-		{
-	    	stl_vertex diff = (*a - *b).cwiseAbs();
-	    	float max_diff = std::max(diff(0), std::max(diff(1), diff(2)));
-	    	stl->stats.shortest_edge = std::min(max_diff, stl->stats.shortest_edge);
-	  	}
+		stl->stats.shortest_edge = std::min(this->load_exact(a, b), stl->stats.shortest_edge);
+	}
+
+	// Returns the maximum absolute coordinate difference of the two vertices, used to update stl->stats.shortest_edge.
+	float load_exact(const stl_vertex *a, const stl_vertex *b)
+	{
+		stl_vertex diff = (*a - *b).cwiseAbs();
+		float max_diff = std::max(diff(0), std::max(diff(1), diff(2)));
 
 	  	// Ensure identical vertex ordering of equal edges.
 	  	// This method is numerically robust.
@@ -82,6 +89,7 @@ struct HashEdge {
 	      		p[0] = 0;
 	#endif /* BOOST_ENDIAN_LITTLE_BYTE */
 	  	}
+	  	return max_diff;
 	}
 
 	bool load_nearby(const stl_file *stl, const stl_vertex &a, const stl_vertex &b, float tolerance)
@@ -120,6 +128,50 @@ private:
 	}
 };
 
+// Edge of a facet as sorted by stl_check_facets_exact_parallel(), a HashEdge without the chaining.
+struct SortedEdge {
+	uint32_t       key[6];
+	int            facet_number;
+	int            which_edge;
+
+	// Edges with equal keys are sorted in the order, in which stl_check_facets_exact() inserts them into its hash table.
+	bool operator<(const SortedEdge &rhs) const {
+		for (int i = 0; i < 6; ++ i)
+			if (key[i] != rhs.key[i])
+				return key[i] < rhs.key[i];
+		return facet_number < rhs.facet_number || (facet_number == rhs.facet_number && which_edge % 3 < rhs.which_edge % 3);
+	}
+	bool key_equal(const SortedEdge &rhs) const { return memcmp(key, rhs.key, sizeof(key)) == 0; }
+
+	uint64_t hash() const {
+		uint64_t h = 0;
+		for (int i = 0; i < 6; ++ i) {
+			h = (h ^ key[i]) * 0x9E3779B97F4A7C15ull;
+			h ^= h >> 29;
+		}
+		return h;
+	}
+};
+
+// Record that the facets owning edge_a and edge_b are neighbors over these edges. Edge is either HashEdge or SortedEdge.
+template<typename Edge>
+static inline void link_neighbors(stl_file *stl, const Edge &edge_a, const Edge &edge_b)
+{
+	// Facet a's neighbor is facet b
+	stl->neighbors_start[edge_a.facet_number].neighbor[edge_a.which_edge % 3] = edge_b.facet_number;	/* sets the .neighbor part */
+	stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] = (edge_b.which_edge + 2) % 3; /* sets the .which_vertex_not part */
+
+	// Facet b's neighbor is facet a
+	stl->neighbors_start[edge_b.facet_number].neighbor[edge_b.which_edge % 3] = edge_a.facet_number;	/* sets the .neighbor part */
+	stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] = (edge_a.which_edge + 2) % 3; /* sets the .which_vertex_not part */
+
+	if (((edge_a.which_edge < 3) && (edge_b.which_edge < 3)) || ((edge_a.which_edge > 2) && (edge_b.which_edge > 2))) {
+		// These facets are oriented in opposite directions, their normals are probably messed up.
+		stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] += 3;
+		stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] += 3;
+	}
+}
+
 struct HashTableEdges {
 	HashTableEdges(size_t number_of_faces) {
 		this->M = (int)hash_size_from_nr_faces(number_of_faces);
@@ -241,19 +293,7 @@ private:
 
 	static void record_neighbors(stl_file *stl, const HashEdge &edge_a, const HashEdge &edge_b)
 	{
-		// Facet a's neighbor is facet b
-		stl->neighbors_start[edge_a.facet_number].neighbor[edge_a.which_edge % 3] = edge_b.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] = (edge_b.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		// Facet b's neighbor is facet a
-		stl->neighbors_start[edge_b.facet_number].neighbor[edge_b.which_edge % 3] = edge_a.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] = (edge_a.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		if (((edge_a.which_edge < 3) && (edge_b.which_edge < 3)) || ((edge_a.which_edge > 2) && (edge_b.which_edge > 2))) {
-			// These facets are oriented in opposite directions, their normals are probably messed up.
-			stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] += 3;
-			stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] += 3;
-		}
+		link_neighbors(stl, edge_a, edge_b);
 
 		// Count successful connects:
 		// Total connects:
@@ -428,7 +468,8 @@ private:
 // This function builds the neighbors list.  No modifications are made
 // to any of the facets.  The edges are said to match only if all six
 // floats of the first edge matches all six floats of the second edge.
-void stl_check_facets_exact(stl_file *stl)
+// Reset the connectivity statistics and the neighbors, remove the degenerate facets.
+static void stl_check_facets_exact_prepare(stl_file *stl)
 {
 	assert(stl->facet_start.size() == stl->neighbors_start.size());
 
@@ -453,10 +494,16 @@ void stl_check_facets_exact(stl_file *stl)
 		  	++ i;
   	}
 
-  	// Initialize hash table.
-  	HashTableEdges hash_table(stl->stats.number_of_facets);
 	for (auto &neighbor : stl->neighbors_start)
 		neighbor.reset();
+}
+
+void stl_check_facets_exact(stl_file *stl)
+{
+	stl_check_facets_exact_prepare(stl);
+
+  	// Initialize hash table.
+  	HashTableEdges hash_table(stl->stats.number_of_facets);
 
   	// Connect neighbor edges.
 	for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i) {
@@ -477,6 +524,120 @@ void stl_check_facets_exact(stl_file *stl)
 #endif
 }
 
+// Same result as stl_check_facets_exact(), but the edges are matched by sorting them in parallel instead of by inserting them
+// into a hash table one by one. Equal edges are paired in the order of insertion into the hash table by stl_check_facets_exact():
+// An edge is paired with the first unpaired edge of another facet sorted before it.
+void stl_check_facets_exact_parallel(stl_file *stl)
+{
+	stl_check_facets_exact_prepare(stl);
+
+	const size_t num_edges = size_t(stl->stats.number_of_facets) * 3;
+	std::vector<SortedEdge> edges(num_edges);
+	stl->stats.shortest_edge = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, stl->stats.number_of_facets), stl->stats.shortest_edge,
+		[stl, &edges](const tbb::blocked_range<size_t> &range, float shortest_edge) {
+			for (size_t i = range.begin(); i < range.end(); ++ i) {
+				const stl_facet &facet = stl->facet_start[i];
+				for (int j = 0; j < 3; ++ j) {
+					HashEdge edge;
+					edge.facet_number = int(i);
+					edge.which_edge = j;
+					shortest_edge = std::min(shortest_edge, edge.load_exact(&facet.vertex[j], &facet.vertex[(j + 1) % 3]));
+					SortedEdge &sorted = edges[i * 3 + j];
+					memcpy(sorted.key, edge.key, sizeof(edge.key));
+					sorted.facet_number = edge.facet_number;
+					sorted.which_edge   = edge.which_edge;
+				}
+			}
+			return shortest_edge;
+		},
+		[](float a, float b) { return std::min(a, b); });
+
+	// Partition the edges into buckets by the leading bits of the hashes of their keys, so that equal edges land into the same bucket
+	// and a bucket of about a thousand edges is sorted inside the cache. The chunks of edges count their edges per bucket first,
+	// then each chunk scatters its edges into its own slots of the buckets.
+	int bucket_bits = 1;
+	while (bucket_bits < 20 && (num_edges >> bucket_bits) > 1024)
+		++ bucket_bits;
+	const size_t num_buckets = size_t(1) << bucket_bits;
+	const size_t num_chunks  = std::max<size_t>(1, std::min<size_t>(64, num_edges / 65536));
+	const size_t chunk_size  = (num_edges + num_chunks - 1) / num_chunks;
+	auto         bucket_of   = [bucket_bits](const SortedEdge &edge) { return size_t(edge.hash() >> (64 - bucket_bits)); };
+	std::vector<size_t> offsets(num_chunks * num_buckets + 1, 0);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1), [&](const tbb::blocked_range<size_t> &range) {
+		for (size_t chunk = range.begin(); chunk < range.end(); ++ chunk)
+			for (size_t i = chunk * chunk_size; i < std::min(num_edges, (chunk + 1) * chunk_size); ++ i)
+				++ offsets[bucket_of(edges[i]) * num_chunks + chunk + 1];
+	});
+	for (size_t i = 1; i < offsets.size(); ++ i)
+		offsets[i] += offsets[i - 1];
+	std::vector<SortedEdge> bucketed(num_edges);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1), [&](const tbb::blocked_range<size_t> &range) {
+		for (size_t chunk = range.begin(); chunk < range.end(); ++ chunk)
+			for (size_t i = chunk * chunk_size; i < std::min(num_edges, (chunk + 1) * chunk_size); ++ i)
+				bucketed[offsets[bucket_of(edges[i]) * num_chunks + chunk] ++] = edges[i];
+	});
+	std::vector<SortedEdge>().swap(edges);
+
+	// Sort each bucket and pair its runs of equal keys. After the scatter, offsets[bucket * num_chunks - 1] points to the start of a bucket.
+	// The neighbors of a facet over different edges may be written by different threads, but each edge of a facet is written at most once.
+	std::atomic<int> connected_edges(0);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_buckets), [stl, &bucketed, &offsets, num_chunks, &connected_edges](const tbb::blocked_range<size_t> &range) {
+		// Edges of the current run not paired yet, sorted by the order of their insertion into the hash table.
+		std::vector<const SortedEdge*> unpaired;
+		int 						   num_connected = 0;
+		for (size_t bucket = range.begin(); bucket < range.end(); ++ bucket) {
+			auto begin = bucketed.begin() + (bucket == 0 ? 0 : offsets[bucket * num_chunks - 1]);
+			auto end   = bucketed.begin() + offsets[(bucket + 1) * num_chunks - 1];
+			std::sort(begin, end);
+			for (auto i = begin; i != end;) {
+				auto j = i + 1;
+				while (j != end && j->key_equal(*i))
+					++ j;
+				if (j - i == 2) {
+					// Most common case: A manifold edge shared by two facets.
+					if (i->facet_number != (i + 1)->facet_number) {
+						link_neighbors(stl, *(i + 1), *i);
+						num_connected += 2;
+					}
+				} else if (j - i > 2) {
+					unpaired.clear();
+					for (auto k = i; k != j; ++ k) {
+						auto it = std::find_if(unpaired.begin(), unpaired.end(), [&edge = *k](const SortedEdge *e) { return e->facet_number != edge.facet_number; });
+						if (it == unpaired.end())
+							unpaired.emplace_back(&*k);
+						else {
+							link_neighbors(stl, *k, **it);
+							num_connected += 2;
+							unpaired.erase(it);
+						}
+					}
+				}
+				i = j;
+			}
+		}
+		connected_edges += num_connected;
+	});
+	stl->stats.connected_edges = connected_edges;
+
+	// stl_check_facets_exact() counts a facet as connected over 1, 2 and 3 edges once it gains its first, second and third neighbor.
+	struct ConnectedFacets { int edges[3] { 0, 0, 0 }; };
+	ConnectedFacets connected = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, stl->stats.number_of_facets), ConnectedFacets(),
+		[stl](const tbb::blocked_range<size_t> &range, ConnectedFacets connected) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				for (int j = 0; j < stl->neighbors_start[i].num_neighbors(); ++ j)
+					++ connected.edges[j];
+			return connected;
+		},
+		[](ConnectedFacets a, const ConnectedFacets &b) {
+			for (int j = 0; j < 3; ++ j)
+				a.edges[j] += b.edges[j];
+			return a;
+		});
+	stl->stats.connected_facets_1_edge = connected.edges[0];
+	stl->stats.connected_facets_2_edge = connected.edges[1];
+	stl->stats.connected_facets_3_edge = connected.edges[2];
+}
+
 void stl_check_facets_nearby(stl_file *stl, float tolerance)
 {
   	if (  (stl->stats.connected_facets_1_edge == stl->stats.number_of_facets)
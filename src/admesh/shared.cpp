@@ -125,6 +125,23 @@ void stl_generate_shared_vertices(stl_file *stl, indexed_triangle_set &its)
 	}
 }
 
+// Inverse of stl_generate_shared_vertices(): Expand the indexed triangle set into the facets of stl, so that the admesh
+// repair functions may run over it. The normals are calculated from the vertices, the neighbors are allocated only.
+void stl_facets_from_its(stl_file *stl, const indexed_triangle_set &its)
+{
+	stl->stats.number_of_facets = uint32_t(its.indices.size());
+	stl_allocate(stl);
+	for (uint32_t facet_idx = 0; facet_idx < stl->stats.number_of_facets; ++ facet_idx) {
+		stl_facet &facet = stl->facet_start[facet_idx];
+		for (int j = 0; j < 3; ++ j)
+			facet.vertex[j] = its.vertices[its.indices[facet_idx][j]];
+		facet.extra[0] = 0;
+		facet.extra[1] = 0;
+		stl_calculate_normal(facet.normal, &facet);
+		stl_normalize_vector(facet.normal);
+	}
+}
+
 bool its_write_off(const indexed_triangle_set &its, const char *file)
 {
 	/* Open the file */
@@ -150,8 +150,7 @@ struct indexed_triangle_set
 
 	std::vector<stl_triangle_vertex_indices> 	indices;
 	std::vector<stl_vertex>       				vertices;
-	//FIXME add normals once we get rid of the stl_file from TriangleMesh completely.
-	//std::vector<stl_normal> 					normals
+	// The normals are not stored, they are calculated on demand by its_face_normal().
 };
 
 extern bool stl_open(stl_file *stl, const char *file);
@@ -160,6 +159,7 @@ extern bool stl_print_neighbors(stl_file *stl, char *file);
 extern bool stl_write_ascii(stl_file *stl, const char *file, const char *label);
 extern bool stl_write_binary(stl_file *stl, const char *file, const char *label);
 extern void stl_check_facets_exact(stl_file *stl);
+extern void stl_check_facets_exact_parallel(stl_file *stl);
 extern void stl_check_facets_nearby(stl_file *stl, float tolerance);
 extern void stl_remove_unconnected_facets(stl_file *stl);
 extern void stl_write_vertex(stl_file *stl, int facet, int vertex);
@@ -183,6 +183,7 @@ extern void stl_mirror_yz(stl_file *stl);
 extern void stl_mirror_xz(stl_file *stl);
 
 extern void stl_get_size(stl_file *stl);
+extern void stl_get_size(stl_file *stl, const indexed_triangle_set &its);
 
 // the following function is not used
 /*
@@ -280,6 +281,7 @@ extern void its_rotate_y(indexed_triangle_set &its, float angle);
 extern void its_rotate_z(indexed_triangle_set &its, float angle);
 
 extern void stl_generate_shared_vertices(stl_file *stl, indexed_triangle_set &its);
+extern void stl_facets_from_its(stl_file *stl, const indexed_triangle_set &its);
 extern bool its_write_obj(const indexed_triangle_set &its, const char *file);
 extern bool its_write_off(const indexed_triangle_set &its, const char *file);
 extern bool its_write_vrml(const indexed_triangle_set &its, const char *file);
@@ -295,12 +297,18 @@ inline void stl_normalize_vector(stl_normal &normal) {
   else
     normal *= float(1.0 / length);
 }
+// Unit normal of a face of an indexed triangle set, calculated from its vertices the same way as stl_fix_normal_values() does.
+inline stl_normal its_face_normal(const indexed_triangle_set &its, size_t face_idx) {
+  const stl_triangle_vertex_indices &face = its.indices[face_idx];
+  stl_normal normal = (its.vertices[face(1)] - its.vertices[face(0)]).cross(its.vertices[face(2)] - its.vertices[face(0)]);
+  stl_normalize_vector(normal);
+  return normal;
+}
 extern void stl_calculate_volume(stl_file *stl);
 
 extern void stl_repair(stl_file *stl, bool fixall_flag, bool exact_flag, bool tolerance_flag, float tolerance, bool increment_flag, float increment, bool nearby_flag, int iterations, bool remove_unconnected_flag, bool fill_holes_flag, bool normal_directions_flag, bool normal_values_flag, bool reverse_all_flag, bool verbose_flag);
 
 extern void stl_allocate(stl_file *stl);
-extern void stl_read(stl_file *stl, int first_facet, bool first);
 extern void stl_facet_stats(stl_file *stl, stl_facet facet, bool &first);
 extern void stl_reallocate(stl_file *stl);
 extern void stl_add_facet(stl_file *stl, const stl_facet *new_facet);
@@ -26,10 +26,21 @@
 #include <math.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <atomic>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/predef/other/endian.h>
 
+#include <tbb/parallel_for.h>
+
+#if __has_include(<charconv>)
+	#include <charconv>
+#endif
+
 #include "stl.h"
 
 #ifndef SEEK_SET
@@ -40,206 +51,337 @@
 extern void stl_internal_reverse_quads(char *buf, size_t cnt);
 #endif /* BOOST_ENDIAN_BIG_BYTE */
 
-static FILE* stl_open_count_facets(stl_file *stl, const char *file) 
+// Content of a STL file, memory mapped. If the file could not be mapped (for example a path not representable
+// in the ANSI code page on Windows), the file is read at once.
+class StlFileContent
 {
-  	// Open the file in binary mode first.
-  	FILE *fp = boost::nowide::fopen(file, "rb");
-  	if (fp == nullptr) {
-		BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: Couldn't open " << file << " for reading";
-    	return nullptr;
-  	}
-  	// Find size of file.
-  	fseek(fp, 0, SEEK_END);
-  	long file_size = ftell(fp);
-
-  	// Check for binary or ASCII file.
-  	fseek(fp, HEADER_SIZE, SEEK_SET);
-	unsigned char chtest[128];
-  	if (! fread(chtest, sizeof(chtest), 1, fp)) {
-		BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: The input is an empty file: " << file;
-    	fclose(fp);
-    	return nullptr;
-  	}
-  	stl->stats.type = ascii;
-  	for (size_t s = 0; s < sizeof(chtest); s++) {
-    	if (chtest[s] > 127) {
-      		stl->stats.type = binary;
-      		break;
-    	}
-  	}
-  	rewind(fp);
-
-  	uint32_t num_facets = 0;
-
-  	// Get the header and the number of facets in the .STL file.
-  	// If the .STL file is binary, then do the following:
-  	if (stl->stats.type == binary) {
-    	// Test if the STL file has the right size.
-    	if (((file_size - HEADER_SIZE) % SIZEOF_STL_FACET != 0) || (file_size < STL_MIN_FILE_SIZE)) {
-			BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: The file " << file << " has the wrong size.";
-      		fclose(fp);
-      		return nullptr;
-    	}
-    	num_facets = (file_size - HEADER_SIZE) / SIZEOF_STL_FACET;
-
-    	// Read the header.
-    	if (fread(stl->stats.header, LABEL_SIZE, 1, fp) > 79)
-      		stl->stats.header[80] = '\0';
-
-    	// Read the int following the header.  This should contain # of facets.
-	  	uint32_t header_num_facets;
-    	bool header_num_faces_read = fread(&header_num_facets, sizeof(uint32_t), 1, fp) != 0;
-#if BOOST_ENDIAN_BIG_BYTE
-    	// Convert from little endian to big endian.
-    	stl_internal_reverse_quads((char*)&header_num_facets, 4);
-#endif /* BOOST_ENDIAN_BIG_BYTE */
-    	if (! header_num_faces_read || num_facets != header_num_facets)
-			BOOST_LOG_TRIVIAL(info) << "stl_open_count_facets: Warning: File size doesn't match number of facets in the header: " << file;
-  	}
-  	// Otherwise, if the .STL file is ASCII, then do the following:
-  	else
-  	{
-    	// Reopen the file in text mode (for getting correct newlines on Windows)
-    	// fix to silence a warning about unused return value.
-    	// obviously if it fails we have problems....
-    	fp = boost::nowide::freopen(file, "r", fp);
-
-		// do another null check to be safe
-    	if (fp == nullptr) {
-			BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: Couldn't open " << file << " for reading";
-      		fclose(fp);
-      		return nullptr;
-    	}
-    
-    	// Find the number of facets.
-		char linebuf[100];
-		int num_lines = 1;
-		while (fgets(linebuf, 100, fp) != nullptr) {
-		    // Don't count short lines.
-		    if (strlen(linebuf) <= 4)
-		    	continue;
-		    // Skip solid/endsolid lines as broken STL file generators may put several of them.
-		    if (strncmp(linebuf, "solid", 5) == 0 || strncmp(linebuf, "endsolid", 8) == 0)
-		    	continue;
-		    ++ num_lines;
+public:
+	bool open(const char *file)
+	{
+		try {
+			m_mapping = boost::interprocess::file_mapping(file, boost::interprocess::read_only);
+			m_region  = boost::interprocess::mapped_region(m_mapping, boost::interprocess::read_only);
+			m_data    = static_cast<const char*>(m_region.get_address());
+			m_size    = m_region.get_size();
+			return true;
+		} catch (const std::exception &) {
+			// An empty file can not be mapped either.
 		}
+		FILE *fp = boost::nowide::fopen(file, "rb");
+		if (fp == nullptr)
+			return false;
+		fseek(fp, 0, SEEK_END);
+		long file_size = ftell(fp);
+		rewind(fp);
+		m_buffer.assign(std::max<long>(file_size, 0), 0);
+		bool ok = file_size >= 0 && fread(m_buffer.data(), 1, m_buffer.size(), fp) == m_buffer.size();
+		fclose(fp);
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+		return ok;
+	}
 
-    	rewind(fp);
-    
-    	// Get the header.
-		int i = 0;
-    	for (; i < 80 && (stl->stats.header[i] = getc(fp)) != '\n'; ++ i) ;
-    	stl->stats.header[i] = '\0'; // Lose the '\n'
-    	stl->stats.header[80] = '\0';
+	const char* data() const { return m_data; }
+	size_t      size() const { return m_size; }
 
-    	num_facets = num_lines / ASCII_LINES_PER_FACET;
-  	}
+private:
+	boost::interprocess::file_mapping  m_mapping;
+	boost::interprocess::mapped_region m_region;
+	std::vector<char>                  m_buffer;
+	const char                        *m_data { nullptr };
+	size_t                             m_size { 0 };
+};
 
-  	stl->stats.number_of_facets += num_facets;
-  	stl->stats.original_num_facets = stl->stats.number_of_facets;
-  	return fp;
+// Updates the bounding box of the facets read.
+static void stl_read_stats(stl_file *stl)
+{
+	bool first = true;
+	for (const stl_facet &facet : stl->facet_start)
+		stl_facet_stats(stl, facet, first);
+	stl->stats.size = stl->stats.max - stl->stats.min;
+	stl->stats.bounding_diameter = stl->stats.size.norm();
 }
 
-/* Reads the contents of the file pointed to by fp into the stl structure,
-   starting at facet first_facet.  The second argument says if it's our first
-   time running this for the stl and therefore we should reset our max and min stats. */
-static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first)
+// Converts the facets of a binary STL file, all of them at once.
+static bool stl_read_binary(stl_file *stl, const char *file, const char *data, size_t size)
 {
-	if (stl->stats.type == binary)
-    	fseek(fp, HEADER_SIZE, SEEK_SET);
-  	else
-    	rewind(fp);
-
-  	char normal_buf[3][32];
-  	for (uint32_t i = first_facet; i < stl->stats.number_of_facets; ++ i) {
-  	  	stl_facet facet;
-
-    	if (stl->stats.type == binary) {
-      		// Read a single facet from a binary .STL file. We assume little-endian architecture!
-      		if (fread(&facet, 1, SIZEOF_STL_FACET, fp) != SIZEOF_STL_FACET)
-      			return false;
+	// Test if the STL file has the right size.
+	if (((size - HEADER_SIZE) % SIZEOF_STL_FACET != 0) || (size < STL_MIN_FILE_SIZE)) {
+		BOOST_LOG_TRIVIAL(error) << "stl_open: The file " << file << " has the wrong size.";
+		return false;
+	}
+	uint32_t num_facets = uint32_t((size - HEADER_SIZE) / SIZEOF_STL_FACET);
+
+	// Read the header and the int following the header. This should contain # of facets.
+	memcpy(stl->stats.header, data, LABEL_SIZE);
+	uint32_t header_num_facets;
+	memcpy(&header_num_facets, data + LABEL_SIZE, sizeof(uint32_t));
+#if BOOST_ENDIAN_BIG_BYTE
+	// Convert from little endian to big endian.
+	stl_internal_reverse_quads((char*)&header_num_facets, 4);
+#endif /* BOOST_ENDIAN_BIG_BYTE */
+	if (num_facets != header_num_facets)
+		BOOST_LOG_TRIVIAL(info) << "stl_open: Warning: File size doesn't match number of facets in the header: " << file;
+
+	stl->stats.number_of_facets = num_facets;
+	stl->stats.original_num_facets = num_facets;
+	stl_allocate(stl);
+	const char *facets = data + HEADER_SIZE;
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets, 65536), [stl, facets](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i) {
+			// The in memory facet is padded to 4 bytes. We assume little-endian architecture!
+			stl_facet &facet = stl->facet_start[i];
+			memcpy(&facet, facets + i * SIZEOF_STL_FACET, SIZEOF_STL_FACET);
 #if BOOST_ENDIAN_BIG_BYTE
-      		// Convert the loaded little endian data to big endian.
-      		stl_internal_reverse_quads((char*)&facet, 48);
+			// Convert the loaded little endian data to big endian.
+			stl_internal_reverse_quads((char*)&facet, 48);
 #endif /* BOOST_ENDIAN_BIG_BYTE */
-    	} else {
-			// Read a single facet from an ASCII .STL file
+		}
+	});
+	stl_read_stats(stl);
+	return true;
+}
+
+static inline bool stl_is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Parser of the facets of an ASCII STL file, accepting the same input as the former sequence of fscanf() calls.
+class StlAsciiParser
+{
+public:
+	StlAsciiParser(const char *begin, const char *end) : m_ptr(begin), m_end(end) {}
+
+	// Parses all the facets up to the end of the input, appending them to facets.
+	bool parse(std::vector<stl_facet> &facets)
+	{
+		for (;;) {
 			// skip solid/endsolid
 			// (in this order, otherwise it won't work when they are paired in the middle of a file)
-			fscanf(fp, " endsolid%*[^\n]\n");
-			fscanf(fp, " solid%*[^\n]\n");  // name might contain spaces so %*s doesn't work and it also can be empty (just "solid")
-			// Leading space in the fscanf format skips all leading white spaces including numerous new lines and tabs.
-			int res_normal     = fscanf(fp, " facet normal %31s %31s %31s", normal_buf[0], normal_buf[1], normal_buf[2]);
-			assert(res_normal == 3);
-			int res_outer_loop = fscanf(fp, " outer loop");
-			assert(res_outer_loop == 0);
-			int res_vertex1    = fscanf(fp, " vertex %f %f %f", &facet.vertex[0](0), &facet.vertex[0](1), &facet.vertex[0](2));
-			assert(res_vertex1 == 3);
-			int res_vertex2    = fscanf(fp, " vertex %f %f %f", &facet.vertex[1](0), &facet.vertex[1](1), &facet.vertex[1](2));
-			assert(res_vertex2 == 3);
-			// Trailing whitespace is there to eat all whitespaces and empty lines up to the next non-whitespace.
-			int res_vertex3    = fscanf(fp, " vertex %f %f %f ", &facet.vertex[2](0), &facet.vertex[2](1), &facet.vertex[2](2));
-			assert(res_vertex3 == 3);
-			// Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
-			char buf[2048];
-			fgets(buf, 2047, fp);
-			bool endloop_ok = strncmp(buf, "endloop", 7) == 0 && (buf[7] == '\r' || buf[7] == '\n' || buf[7] == ' ' || buf[7] == '\t');
-			assert(endloop_ok);
-			// Skip the trailing whitespaces and empty lines.
-			fscanf(fp, " ");
-			fgets(buf, 2047, fp);
-			bool endfacet_ok = strncmp(buf, "endfacet", 8) == 0 && (buf[8] == '\r' || buf[8] == '\n' || buf[8] == ' ' || buf[8] == '\t');
-			assert(endfacet_ok);
-			if (res_normal != 3 || res_outer_loop != 0 || res_vertex1 != 3 || res_vertex2 != 3 || res_vertex3 != 3 || ! endloop_ok || ! endfacet_ok) {
-				BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
+			bool end_solid = this->skip_line_starting_with("endsolid");
+			this->skip_line_starting_with("solid");
+			this->skip_spaces();
+			if (m_ptr == m_end)
+				return true;
+			if (! this->match("facet"))
+				// Some text after the end of the solid, ignored as before.
+				return end_solid;
+			stl_facet facet;
+			if (! this->parse_facet(facet))
 				return false;
-			}
-
-			// The facet normal has been parsed as a single string as to workaround for not a numbers in the normal definition.
-			if (sscanf(normal_buf[0], "%f", &facet.normal(0)) != 1 ||
-			    sscanf(normal_buf[1], "%f", &facet.normal(1)) != 1 ||
-			    sscanf(normal_buf[2], "%f", &facet.normal(2)) != 1) {
-			    // Normal was mangled. Maybe denormals or "not a number" were stored?
-			  	// Just reset the normal and silently ignore it.
-			  	memset(&facet.normal, 0, sizeof(facet.normal));
-			}
+			facets.emplace_back(facet);
 		}
+	}
+
+	// Returns the start of the first facet starting a line at or after ptr.
+	static const char* next_facet(const char *ptr, const char *end)
+	{
+		for (; ptr < end; ++ ptr) {
+			ptr = static_cast<const char*>(memchr(ptr, '\n', end - ptr));
+			if (ptr == nullptr)
+				return end;
+			const char *line = ptr + 1;
+			while (line < end && (*line == ' ' || *line == '\t'))
+				++ line;
+			if (end - line > 5 && strncmp(line, "facet", 5) == 0 && stl_is_space(line[5]))
+				return line;
+		}
+		return end;
+	}
 
-#if 0
-		// Report close to zero vertex coordinates. Due to the nature of the floating point numbers,
-		// close to zero values may be represented with singificantly higher precision than the rest of the vertices.
-		// It may be worth to round these numbers to zero during loading to reduce the number of errors reported
-		// during the STL import.
-		for (size_t j = 0; j < 3; ++ j) {
-		if (facet.vertex[j](0) > -1e-12f && facet.vertex[j](0) < 1e-12f)
-		    printf("stl_read: facet %d(0) = %e\r\n", j, facet.vertex[j](0));
-		if (facet.vertex[j](1) > -1e-12f && facet.vertex[j](1) < 1e-12f)
-		    printf("stl_read: facet %d(1) = %e\r\n", j, facet.vertex[j](1));
-		if (facet.vertex[j](2) > -1e-12f && facet.vertex[j](2) < 1e-12f)
-		    printf("stl_read: facet %d(2) = %e\r\n", j, facet.vertex[j](2));
+private:
+	bool parse_facet(stl_facet &facet)
+	{
+		// The facet normal is parsed as separate words to work around not a numbers in the normal definition.
+		if (! this->match("normal"))
+			return this->syntax_error();
+		bool normal_ok = true;
+		for (size_t i = 0; i < 3; ++ i) {
+			// Same as %31s
+			this->skip_spaces();
+			const char *word = m_ptr;
+			while (m_ptr < m_end && m_ptr < word + 31 && ! stl_is_space(*m_ptr))
+				++ m_ptr;
+			if (m_ptr == word)
+				return this->syntax_error();
+			const char *p = word;
+			normal_ok &= parse_float(p, m_ptr, facet.normal(i));
+		}
+		if (! normal_ok)
+			// Normal was mangled. Maybe denormals or "not a number" were stored?
+			// Just reset the normal and silently ignore it.
+			memset(&facet.normal, 0, sizeof(facet.normal));
+		if (! this->match("outer") || ! this->match("loop"))
+			return this->syntax_error();
+		for (size_t i = 0; i < 3; ++ i)
+			if (! this->match("vertex") ||
+				! parse_float(m_ptr, m_end, facet.vertex[i](0)) ||
+				! parse_float(m_ptr, m_end, facet.vertex[i](1)) ||
+				! parse_float(m_ptr, m_end, facet.vertex[i](2)))
+				return this->syntax_error();
+		// Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
+		if (! this->match_line("endloop") || ! this->match_line("endfacet"))
+			return this->syntax_error();
+		memset(facet.extra, 0, sizeof(facet.extra));
+		return true;
+	}
+
+	// Parses a float the way scanf("%f") does, though independently of the locale.
+	static bool parse_float(const char *&ptr, const char *end, float &value)
+	{
+		while (ptr < end && stl_is_space(*ptr))
+			++ ptr;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+		const char *begin = (ptr + 1 < end && *ptr == '+' && (ptr[1] == '.' || (ptr[1] >= '0' && ptr[1] <= '9'))) ? ptr + 1 : ptr;
+		auto [p, ec] = std::from_chars(begin, end, value);
+		if (ec == std::errc() && (p == end || stl_is_space(*p))) {
+			ptr = p;
+			return true;
 		}
 #endif
+		// Hexadecimal notation, out of range values, garbage following the number...
+		char buf[64];
+		size_t len = 0;
+		for (; ptr + len < end && len + 1 < sizeof(buf) && ! stl_is_space(ptr[len]); ++ len)
+			buf[len] = ptr[len];
+		buf[len] = 0;
+		char *buf_end = nullptr;
+		value = strtof(buf, &buf_end);
+		if (buf_end == buf)
+			return false;
+		ptr += buf_end - buf;
+		return true;
+	}
 
-		// Write the facet into memory.
-		stl->facet_start[i] = facet;
-		stl_facet_stats(stl, facet, first);
-  	}
-  
-  	stl->stats.size = stl->stats.max - stl->stats.min;
-  	stl->stats.bounding_diameter = stl->stats.size.norm();
-  	return true;
+	void skip_spaces()
+	{
+		while (m_ptr < m_end && stl_is_space(*m_ptr))
+			++ m_ptr;
+	}
+
+	// Skips up to the end of line, which may be a single carriage return as saved by the old Macs.
+	void skip_line()
+	{
+		while (m_ptr < m_end && *m_ptr != '\n' && *m_ptr != '\r')
+			++ m_ptr;
+	}
+
+	// Skips the leading spaces, then matches the keyword.
+	bool match(const char *keyword)
+	{
+		this->skip_spaces();
+		size_t len = strlen(keyword);
+		if (size_t(m_end - m_ptr) < len || strncmp(m_ptr, keyword, len) != 0)
+			return false;
+		m_ptr += len;
+		return true;
+	}
+
+	// Matches a line starting with the keyword followed by a space, and skips the rest of the line.
+	bool match_line(const char *keyword)
+	{
+		if (! this->match(keyword) || (m_ptr < m_end && *m_ptr != '\r' && *m_ptr != '\n' && *m_ptr != ' ' && *m_ptr != '\t'))
+			return false;
+		this->skip_line();
+		return true;
+	}
+
+	bool skip_line_starting_with(const char *keyword)
+	{
+		const char *ptr = m_ptr;
+		if (this->match(keyword)) {
+			this->skip_line();
+			return true;
+		}
+		m_ptr = ptr;
+		return false;
+	}
+
+	bool syntax_error()
+	{
+		BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
+		return false;
+	}
+
+	const char *m_ptr;
+	const char *m_end;
+};
+
+// Parses the facets of an ASCII STL file. Large files are split at the facets into chunks parsed in parallel.
+static bool stl_read_ascii(stl_file *stl, const char *file, const char *data, size_t size)
+{
+	// Get the header, the first line.
+	size_t i = 0;
+	for (; i < LABEL_SIZE && i < size && data[i] != '\n' && data[i] != '\r'; ++ i)
+		stl->stats.header[i] = data[i];
+	stl->stats.header[i] = '\0';
+	stl->stats.header[80] = '\0';
+
+	static constexpr size_t CHUNK_SIZE = 4 * 1024 * 1024;
+	std::vector<const char*> chunks { data };
+	for (const char *ptr = data + CHUNK_SIZE; ptr < data + size; ptr = chunks.back() + CHUNK_SIZE) {
+		const char *next = StlAsciiParser::next_facet(ptr, data + size);
+		if (next == data + size)
+			break;
+		chunks.emplace_back(next);
+	}
+	chunks.emplace_back(data + size);
+
+	std::vector<std::vector<stl_facet>> facets(chunks.size() - 1);
+	std::atomic<bool>                   failed { false };
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, facets.size(), 1), [&chunks, &facets, &failed](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i)
+			if (! StlAsciiParser(chunks[i], chunks[i + 1]).parse(facets[i]))
+				failed = true;
+	});
+	if (failed)
+		return false;
+
+	size_t num_facets = 0;
+	for (const std::vector<stl_facet> &chunk : facets)
+		num_facets += chunk.size();
+	stl->stats.number_of_facets = uint32_t(num_facets);
+	stl->stats.original_num_facets = stl->stats.number_of_facets;
+	if (facets.size() == 1) {
+		stl->facet_start = std::move(facets.front());
+		stl->neighbors_start.assign(num_facets, stl_neighbors());
+	} else {
+		stl_allocate(stl);
+		auto it = stl->facet_start.begin();
+		for (std::vector<stl_facet> &chunk : facets) {
+			it = std::copy(chunk.begin(), chunk.end(), it);
+			chunk = std::vector<stl_facet>();
+		}
+	}
+	stl_read_stats(stl);
+	return true;
 }
 
 bool stl_open(stl_file *stl, const char *file)
 {
 	stl->clear();
-	FILE *fp = stl_open_count_facets(stl, file);
-	if (fp == nullptr)
+	StlFileContent content;
+	if (! content.open(file)) {
+		BOOST_LOG_TRIVIAL(error) << "stl_open: Couldn't open " << file << " for reading";
 		return false;
-	stl_allocate(stl);
-	bool result = stl_read(stl, fp, 0, true);
-  	fclose(fp);
-  	return result;
+	}
+	const char *data = content.data();
+	size_t      size = content.size();
+
+	// Check for binary or ASCII file.
+	if (size < HEADER_SIZE + 128) {
+		BOOST_LOG_TRIVIAL(error) << "stl_open: The input is an empty file: " << file;
+		return false;
+	}
+	stl->stats.type = ascii;
+	for (size_t s = HEADER_SIZE; s < HEADER_SIZE + 128; ++ s)
+		if ((unsigned char)data[s] > 127) {
+			stl->stats.type = binary;
+			break;
+		}
+
+	return stl->stats.type == binary ? stl_read_binary(stl, file, data, size) : stl_read_ascii(stl, file, data, size);
 }
 
 void stl_allocate(stl_file *stl) 
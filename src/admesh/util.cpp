@@ -203,6 +203,23 @@ void stl_get_size(stl_file *stl)
   	stl->stats.bounding_diameter = stl->stats.size.norm();
 }
 
+// Same as above for a mesh stored as an indexed triangle set, only the vertices referenced by the faces are accounted for.
+void stl_get_size(stl_file *stl, const indexed_triangle_set &its)
+{
+  	if (its.indices.empty())
+  		return;
+  	stl->stats.min = its.vertices[its.indices.front()(0)];
+  	stl->stats.max = stl->stats.min;
+  	for (const stl_triangle_vertex_indices &face : its.indices)
+    	for (int j = 0; j < 3; ++ j) {
+    		const stl_vertex &v = its.vertices[face(j)];
+      		stl->stats.min = stl->stats.min.cwiseMin(v);
+      		stl->stats.max = stl->stats.max.cwiseMax(v);
+    	}
+  	stl->stats.size = stl->stats.max - stl->stats.min;
+  	stl->stats.bounding_diameter = stl->stats.size.norm();
+}
+
 void stl_mirror_xy(stl_file *stl)
 {
   	for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i)
@@ -741,73 +741,7 @@ TEdge* ClipperBase::ProcessBound(TEdge* E, bool NextIsForward)
 }
 //------------------------------------------------------------------------------
 
-bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
-{
-  CLIPPERLIB_PROFILE_FUNC();
-  // Remove duplicate end point from a closed input path.
-  // Remove duplicate points from the end of the input path.
-  int highI = (int)pg.size() -1;
-  if (Closed) 
-    while (highI > 0 && (pg[highI] == pg[0])) 
-      --highI;
-  while (highI > 0 && (pg[highI] == pg[highI -1])) 
-    --highI;
-  if ((Closed && highI < 2) || (!Closed && highI < 1))
-    return false;
-
-  // Allocate a new edge array.
-  std::vector<TEdge> edges(highI + 1);
-  // Fill in the edge array.
-  bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
-  if (result)
-    // Success, remember the edge array.
-    m_edges.emplace_back(std::move(edges));
-  return result;
-}
-
-bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
-{
-  CLIPPERLIB_PROFILE_FUNC();
-  std::vector<int> num_edges(ppg.size(), 0);
-  int num_edges_total = 0;
-  for (size_t i = 0; i < ppg.size(); ++ i) {
-    const Path &pg = ppg[i];
-    // Remove duplicate end point from a closed input path.
-    // Remove duplicate points from the end of the input path.
-    int highI = (int)pg.size() -1;
-    if (Closed) 
-      while (highI > 0 && (pg[highI] == pg[0])) 
-        --highI;
-    while (highI > 0 && (pg[highI] == pg[highI -1])) 
-      --highI;
-    if ((Closed && highI < 2) || (!Closed && highI < 1))
-      highI = -1;
-    num_edges[i] = highI + 1;
-    num_edges_total += highI + 1;
-  }
-  if (num_edges_total == 0)
-    return false;
-
-  // Allocate a new edge array.
-  std::vector<TEdge> edges(num_edges_total);
-  // Fill in the edge array.
-  bool result = false;
-  TEdge *p_edge = edges.data();
-  for (Paths::size_type i = 0; i < ppg.size(); ++i)
-    if (num_edges[i]) {
-      bool res = AddPathInternal(ppg[i], num_edges[i] - 1, PolyTyp, Closed, p_edge);
-      if (res) {
-        p_edge += num_edges[i];
-        result = true;
-      }
-    }
-  if (result)
-    // At least some edges were generated. Remember the edge array.
-    m_edges.emplace_back(std::move(edges));
-  return result;
-}
-
-bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
+bool ClipperBase::AddPathInternal(int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
 {
   CLIPPERLIB_PROFILE_FUNC();
 #ifdef use_lines
@@ -818,25 +752,16 @@ bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, b
     throw clipperException("AddPath: Open paths have been disabled.");
 #endif
 
-  assert(highI >= 0 && highI < pg.size());
+  assert(highI >= 1);
 
   //1. Basic (first) edge initialization ...
-  try
-  {
-    edges[1].Curr = pg[1];
-    RangeTest(pg[0], m_UseFullRange);
-    RangeTest(pg[highI], m_UseFullRange);
-    InitEdge(&edges[0], &edges[1], &edges[highI], pg[0]);
-    InitEdge(&edges[highI], &edges[0], &edges[highI-1], pg[highI]);
-    for (int i = highI - 1; i >= 1; --i)
-    {
-      RangeTest(pg[i], m_UseFullRange);
-      InitEdge(&edges[i], &edges[i+1], &edges[i-1], pg[i]);
-    }
-  }
-  catch(...)
+  // The input points were already stored into edges[i].Curr by AddPath() / AddPaths().
+  // InitEdge() clears the edge, thus the point is copied first.
+  for (int i = 0; i <= highI; ++ i)
   {
-    throw; //range test fails
+    IntPoint pt = edges[i].Curr;
+    RangeTest(pt, m_UseFullRange);
+    InitEdge(&edges[i], &edges[i == highI ? 0 : i + 1], &edges[i == 0 ? highI : i - 1], pt);
   }
   TEdge *eStart = &edges[0];
 
@@ -1097,18 +1022,26 @@ void Clipper::Reset()
 
 //------------------------------------------------------------------------------
 
-bool Clipper::Execute(ClipType clipType, Paths &solution,
-    PolyFillType subjFillType, PolyFillType clipFillType)
+bool Clipper::ExecuteNoResult(ClipType clipType,
+    PolyFillType subjFillType, PolyFillType clipFillType, bool usingPolyTree)
 {
   CLIPPERLIB_PROFILE_FUNC();
-  if (m_HasOpenPaths)
+  if (m_HasOpenPaths && ! usingPolyTree)
     throw clipperException("Error: PolyTree struct is needed for open path clipping.");
-  solution.resize(0);
   m_SubjFillType = subjFillType;
   m_ClipFillType = clipFillType;
   m_ClipType = clipType;
-  m_UsingPolyTree = false;
-  bool succeeded = ExecuteInternal();
+  m_UsingPolyTree = usingPolyTree;
+  return ExecuteInternal();
+}
+//------------------------------------------------------------------------------
+
+bool Clipper::Execute(ClipType clipType, Paths &solution,
+    PolyFillType subjFillType, PolyFillType clipFillType)
+{
+  CLIPPERLIB_PROFILE_FUNC();
+  solution.resize(0);
+  bool succeeded = ExecuteNoResult(clipType, subjFillType, clipFillType, false);
   if (succeeded) BuildResult(solution);
   DisposeAllOutRecs();
   return succeeded;
@@ -1119,11 +1052,7 @@ bool Clipper::Execute(ClipType clipType, PolyTree& polytree,
     PolyFillType subjFillType, PolyFillType clipFillType)
 {
   CLIPPERLIB_PROFILE_FUNC();
-  m_SubjFillType = subjFillType;
-  m_ClipFillType = clipFillType;
-  m_ClipType = clipType;
-  m_UsingPolyTree = true;
-  bool succeeded = ExecuteInternal();
+  bool succeeded = ExecuteNoResult(clipType, subjFillType, clipFillType, true);
   if (succeeded) BuildResult2(polytree);
   DisposeAllOutRecs();
   return succeeded;
@@ -2796,17 +2725,26 @@ int PointCount(OutPt *Pts)
 }
 //------------------------------------------------------------------------------
 
+const OutPt* Clipper::ResultPath(size_t idx, int &cnt) const
+{
+  const OutRec *outRec = m_PolyOuts[idx];
+  assert(! outRec->IsOpen);
+  if (!outRec->Pts) return nullptr;
+  OutPt* p = outRec->Pts->Prev;
+  cnt = PointCount(p);
+  return cnt < 2 ? nullptr : p;
+}
+//------------------------------------------------------------------------------
+
 void Clipper::BuildResult(Paths &polys)
 {
   polys.reserve(m_PolyOuts.size());
-  for (OutRec* outRec : m_PolyOuts)
+  for (size_t i = 0; i < m_PolyOuts.size(); ++ i)
   {
-    assert(! outRec->IsOpen);
-    if (!outRec->Pts) continue;
+    int cnt;
+    const OutPt* p = ResultPath(i, cnt);
+    if (!p) continue;
     Path pg;
-    OutPt* p = outRec->Pts->Prev;
-    int cnt = PointCount(p);
-    if (cnt < 2) continue;
     pg.reserve(cnt);
     for (int i = 0; i < cnt; ++i)
     {
@@ -105,6 +105,13 @@ typedef std::vector< Path > Paths;
 inline Path& operator <<(Path& poly, const IntPoint& p) {poly.push_back(p); return poly;}
 inline Paths& operator <<(Paths& polys, const Path& p) {polys.push_back(p); return polys;}
 
+// Conversion of an input point of ClipperBase::AddPath() / AddPaths() to IntPoint.
+// Any point type with x() and y() accessors (for example Slic3r::Point) is read in place,
+// so that the input paths do not need to be copied to Paths first.
+inline const IntPoint& ToIntPoint(const IntPoint &pt) { return pt; }
+template<typename PointType>
+inline IntPoint ToIntPoint(const PointType &pt) { return IntPoint(pt.x(), pt.y()); }
+
 std::ostream& operator <<(std::ostream &s, const IntPoint &p);
 std::ostream& operator <<(std::ostream &s, const Path &p);
 std::ostream& operator <<(std::ostream &s, const Paths &p);
@@ -292,8 +299,14 @@ class ClipperBase
 public:
   ClipperBase() : m_UseFullRange(false), m_HasOpenPaths(false) {}
   ~ClipperBase() { Clear(); }
-  bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed);
-  bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed);
+  // PathInput is any random access container of points convertible by ToIntPoint(), for example Path or Slic3r::Points.
+  template<typename PathInput>
+  bool AddPath(const PathInput &pg, PolyType PolyTyp, bool Closed);
+  // PathsInput is any range of PathInput, for example Paths or a range of Slic3r::Points.
+  template<typename PathsInput>
+  bool AddPaths(const PathsInput &ppg, PolyType PolyTyp, bool Closed);
+  bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed) { return this->AddPath<Path>(pg, PolyTyp, Closed); }
+  bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed) { return this->AddPaths<Paths>(ppg, PolyTyp, Closed); }
   void Clear();
   IntRect GetBounds();
   // By default, when three or more vertices are collinear in input polygons (subject or clip), the Clipper object removes the 'inner' vertices before clipping.
@@ -301,7 +314,11 @@ public:
   bool PreserveCollinear() const {return m_PreserveCollinear;};
   void PreserveCollinear(bool value) {m_PreserveCollinear = value;};
 protected:
-  bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
+  // Index of the last point of pg to be added, after removing the duplicate end points. -1 if pg is degenerate.
+  template<typename PathInput>
+  static int PathHighIndex(const PathInput &pg, bool Closed);
+  // Edges [0, highI] with their Curr points filled in from the input path.
+  bool AddPathInternal(int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
@@ -345,6 +362,13 @@ public:
       PolyTree &polytree,
       PolyFillType subjFillType,
       PolyFillType clipFillType);
+  // Same as Execute() into Paths, but the resulting closed paths are passed to output without being copied
+  // into Paths first: output.begin_path(num_points) starts a new path, output.add_point(pt) appends a point to it.
+  template<typename PathsOutput>
+  bool Execute(ClipType clipType,
+      PathsOutput &&output,
+      PolyFillType subjFillType,
+      PolyFillType clipFillType);
   bool ReverseSolution() const { return m_ReverseOutput; };
   void ReverseSolution(bool value) {m_ReverseOutput = value;};
   bool StrictlySimple() const {return m_StrictSimple;};
@@ -356,6 +380,11 @@ public:
 protected:
   void Reset();
   virtual bool ExecuteInternal();
+  // Execute() up to building the result, which is left in m_PolyOuts.
+  bool ExecuteNoResult(ClipType clipType, PolyFillType subjFillType, PolyFillType clipFillType, bool usingPolyTree);
+  // Last point of the idx-th output closed path, to be traversed in the Prev direction for cnt points.
+  // nullptr if the output path is empty or degenerate.
+  const OutPt* ResultPath(size_t idx, int &cnt) const;
 private:
   
   // Output polygons.
@@ -486,6 +515,96 @@ class clipperException : public std::exception
 };
 //------------------------------------------------------------------------------
 
+template<typename PathInput>
+inline int ClipperBase::PathHighIndex(const PathInput &pg, bool Closed)
+{
+  // Remove duplicate end point from a closed input path.
+  // Remove duplicate points from the end of the input path.
+  int highI = (int)pg.size() -1;
+  if (Closed) 
+    while (highI > 0 && (ToIntPoint(pg[highI]) == ToIntPoint(pg[0]))) 
+      --highI;
+  while (highI > 0 && (ToIntPoint(pg[highI]) == ToIntPoint(pg[highI -1]))) 
+    --highI;
+  return ((Closed && highI < 2) || (!Closed && highI < 1)) ? -1 : highI;
+}
+
+template<typename PathInput>
+bool ClipperBase::AddPath(const PathInput &pg, PolyType PolyTyp, bool Closed)
+{
+  int highI = PathHighIndex(pg, Closed);
+  if (highI < 0)
+    return false;
+
+  // Allocate a new edge array.
+  std::vector<TEdge> edges(highI + 1);
+  for (int i = 0; i <= highI; ++ i)
+    edges[i].Curr = ToIntPoint(pg[i]);
+  // Fill in the edge array.
+  bool result = AddPathInternal(highI, PolyTyp, Closed, edges.data());
+  if (result)
+    // Success, remember the edge array.
+    m_edges.emplace_back(std::move(edges));
+  return result;
+}
+
+template<typename PathsInput>
+bool ClipperBase::AddPaths(const PathsInput &ppg, PolyType PolyTyp, bool Closed)
+{
+  std::vector<int> num_edges;
+  int num_edges_total = 0;
+  for (const auto &pg : ppg) {
+    int highI = PathHighIndex(pg, Closed);
+    num_edges.emplace_back(highI + 1);
+    num_edges_total += highI + 1;
+  }
+  if (num_edges_total == 0)
+    return false;
+
+  // Allocate a new edge array.
+  std::vector<TEdge> edges(num_edges_total);
+  // Fill in the edge array.
+  bool result = false;
+  TEdge *p_edge = edges.data();
+  auto it_num_edges = num_edges.begin();
+  for (const auto &pg : ppg) {
+    int n = *it_num_edges ++;
+    if (n) {
+      for (int i = 0; i < n; ++ i)
+        p_edge[i].Curr = ToIntPoint(pg[i]);
+      if (AddPathInternal(n - 1, PolyTyp, Closed, p_edge)) {
+        p_edge += n;
+        result = true;
+      }
+    }
+  }
+  if (result)
+    // At least some edges were generated. Remember the edge array.
+    m_edges.emplace_back(std::move(edges));
+  return result;
+}
+
+template<typename PathsOutput>
+bool Clipper::Execute(ClipType clipType, PathsOutput &&output, PolyFillType subjFillType, PolyFillType clipFillType)
+{
+  bool succeeded = ExecuteNoResult(clipType, subjFillType, clipFillType, false);
+  if (succeeded)
+    for (size_t i = 0; i < m_PolyOuts.size(); ++ i) {
+      int cnt;
+      const OutPt *p = ResultPath(i, cnt);
+      if (p) {
+        output.begin_path(cnt);
+        for (int j = 0; j < cnt; ++ j) {
+          output.add_point(p->Pt);
+          p = p->Prev;
+        }
+      }
+    }
+  DisposeAllOutRecs();
+  return succeeded;
+}
+//------------------------------------------------------------------------------
+
 } //ClipperLib namespace
 
 #endif //clipper_hpp
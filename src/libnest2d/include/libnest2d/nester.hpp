@@ -52,6 +52,8 @@ class _Item {
     mutable bool area_cache_valid_ = false;
     mutable RawShape inflate_cache_;
     mutable bool inflate_cache_valid_ = false;
+    mutable std::size_t shape_hash_ = 0;
+    mutable bool shape_hash_valid_ = false;
 
     enum class Convexity: char {
         UNCHECKED,
@@ -202,6 +204,7 @@ public:
     inline void setVertex(unsigned long idx, const Vertex& v )
     {
         invalidateCache();
+        shape_hash_valid_ = false;
         sl::vertex(sh_, idx) = v;
     }
 
@@ -256,6 +259,28 @@ public:
         return sl::holeCount(sh_);
     }
 
+    /**
+     * @brief Hash of the outer vertices of the original shape.
+     *
+     * Items carrying the same geometry have the same hash regardless of their
+     * transformation. The result is cached.
+     */
+    inline std::size_t shapeHash() const
+    {
+        if(!shape_hash_valid_) {
+            std::size_t h = sl::contourVertexCount(sh_);
+            auto combine = [&h](Coord c) {
+                h ^= std::hash<Coord>()(c) + 0x9e3779b97f4a7c15ull +
+                     (h << 6) + (h >> 2);
+            };
+            for(auto it = sl::cbegin(sh_); it != sl::cend(sh_); ++it) {
+                combine(getX(*it)); combine(getY(*it));
+            }
+            shape_hash_ = h; shape_hash_valid_ = true;
+        }
+        return shape_hash_;
+    }
+
     /**
      * @brief isPointInside
      * @param p
@@ -7,7 +7,11 @@
 #include <functional>
 #include <iterator>
 #include <future>
+#include <algorithm>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -75,6 +79,141 @@ inline void enumerate(
 
 namespace placers {
 
+/**
+ * A cache of the no-fit polygons of pairs of items.
+ *
+ * Plates are often made of many copies of the same few parts, whose no-fit
+ * polygons are the same up to the transformation of the stationary item. The
+ * no-fit polygons are stored in the frame of the stationary item, keyed by the
+ * shapes of the two items, their inflations and their relative rotation. The
+ * shapes are hashed for the lookup, but the cache keeps a copy of them and
+ * compares their vertices on a hit, so that items of a different geometry
+ * never share a no-fit polygon. The cache can be shared by several placers
+ * through their configuration and kept between packings. It is emptied once
+ * it holds max_entries polygons.
+ */
+template<class RawShape>
+class NfpCache {
+public:
+    using Coord = TCoord<TPoint<RawShape>>;
+
+    struct Key {
+        std::size_t fixed_shape, orbiter_shape; // Hashes of the shapes
+        Coord fixed_inflation, orbiter_inflation;
+        long long rotation; // Relative rotation of the orbiter in nanoradians
+        // The shapes themselves, owned either by the items or by the cache.
+        const RawShape *fixed_contour, *orbiter_contour;
+
+        bool operator==(const Key& k) const {
+            return fixed_shape == k.fixed_shape &&
+                   orbiter_shape == k.orbiter_shape &&
+                   fixed_inflation == k.fixed_inflation &&
+                   orbiter_inflation == k.orbiter_inflation &&
+                   rotation == k.rotation &&
+                   sameContour(*fixed_contour, *k.fixed_contour) &&
+                   sameContour(*orbiter_contour, *k.orbiter_contour);
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& k) const {
+            std::size_t h = k.fixed_shape;
+            for(std::size_t v : {k.orbiter_shape,
+                                 std::hash<Coord>()(k.fixed_inflation),
+                                 std::hash<Coord>()(k.orbiter_inflation),
+                                 std::hash<long long>()(k.rotation)})
+                h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    explicit NfpCache(std::size_t max_entries = 4096):
+        max_entries_(max_entries) {}
+
+    /// The key refers to the raw shapes of the items, which have to outlive it.
+    static Key key(const _Item<RawShape>& fixed, const _Item<RawShape>& orbiter)
+    {
+        static const long long full_turn = std::llround(2 * Pi * 1e9);
+
+        double rot = std::fmod(double(orbiter.rotation()) -
+                               double(fixed.rotation()), 2 * Pi);
+        long long qrot = std::llround((rot < 0 ? rot + 2 * Pi : rot) * 1e9);
+
+        return { fixed.shapeHash(), orbiter.shapeHash(), fixed.inflation(),
+                 orbiter.inflation(), qrot >= full_turn ? 0 : qrot,
+                 &fixed.rawShape(), &orbiter.rawShape() };
+    }
+
+    /// Copy the cached no-fit polygons of the keys into nfps. The returned
+    /// flags tell which ones were found.
+    std::vector<bool> find(const std::vector<Key>& keys,
+                           std::vector<RawShape>& nfps) const
+    {
+        std::vector<bool> found(keys.size(), false);
+        nfps.resize(keys.size());
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        for(std::size_t i = 0; i < keys.size(); ++i) {
+            auto it = map_.find(keys[i]);
+            if(it != map_.end()) { nfps[i] = it->second->nfp; found[i] = true; }
+        }
+
+        return found;
+    }
+
+    /// Store the no-fit polygons of the keys not flagged in skip.
+    void insert(const std::vector<Key>& keys,
+                const std::vector<RawShape>& nfps,
+                const std::vector<bool>& skip)
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        for(std::size_t i = 0; i < keys.size(); ++i) {
+            if(skip[i]) continue;
+            if(map_.size() >= max_entries_) map_.clear();
+            // The stored key refers to the copies of the shapes in the entry.
+            auto entry = std::make_unique<Entry>(
+                Entry{ *keys[i].fixed_contour, *keys[i].orbiter_contour, nfps[i] });
+            Key k = keys[i];
+            k.fixed_contour = &entry->fixed_contour;
+            k.orbiter_contour = &entry->orbiter_contour;
+            map_.emplace(k, std::move(entry));
+        }
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return map_.size();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        map_.clear();
+    }
+
+private:
+    struct Entry {
+        RawShape fixed_contour, orbiter_contour;
+        RawShape nfp;
+    };
+
+    // Same outer vertices, the ones the shape hash is calculated of.
+    static bool sameContour(const RawShape& a, const RawShape& b)
+    {
+        if(&a == &b) return true;
+        return sl::contourVertexCount(a) == sl::contourVertexCount(b) &&
+               std::equal(sl::cbegin(a), sl::cend(a), sl::cbegin(b),
+                          [](const TPoint<RawShape>& p, const TPoint<RawShape>& q) {
+                              return getX(p) == getX(q) && getY(p) == getY(q);
+                          });
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, std::unique_ptr<Entry>, KeyHash> map_;
+    std::size_t max_entries_;
+};
+
 template<class RawShape>
 struct NfpPConfig {
 
@@ -169,6 +308,13 @@ struct NfpPConfig {
 
     std::function<void(const ItemGroup &, NfpPConfig &config)> on_preload;
 
+    /**
+     * @brief An optional cache of the no-fit polygons. It can be shared with
+     * other placers and kept between packings to reuse the no-fit polygons of
+     * items of the same geometry.
+     */
+    std::shared_ptr<NfpCache<RawShape>> nfp_cache;
+
     NfpPConfig(): rotations({0.0, Pi/2.0, Pi, 3*Pi/2}),
         alignment(Alignment::CENTER), starting_point(Alignment::CENTER) {}
 };
@@ -612,6 +758,8 @@ private:
         }
         // /////////////////////////////////////////////////////////////////////
 
+        if(config_.nfp_cache) return calcnfpCached(trsh, *config_.nfp_cache);
+
         __parallel::enumerate(items_.begin(), items_.end(),
                               [&nfps, &trsh](const Item& sh, size_t n)
         {
@@ -625,6 +773,67 @@ private:
         return nfp::merge(nfps);
     }
 
+    // The same as above, but the no-fit polygon is calculated only once for
+    // each distinct pair of shapes and relative rotation. The cached polygons
+    // are moved to the stationary items by their rotation and translation.
+    Shapes calcnfpCached(const Item &trsh, NfpCache<RawShape>& cache)
+    {
+        using namespace nfp;
+        using Cache = NfpCache<RawShape>;
+
+        // Reference vertex of the orbiter without its translation
+        Vertex orbref = trsh.referenceVertex() - trsh.translation();
+
+        std::vector<typename Cache::Key> keys;
+        std::vector<size_t> keyidx(items_.size()), firstitem;
+        std::unordered_map<typename Cache::Key, size_t,
+                           typename Cache::KeyHash> keymap;
+
+        for(size_t n = 0; n < items_.size(); ++n) {
+            auto k = Cache::key(items_[n], trsh);
+            auto it = keymap.emplace(k, keys.size());
+            if(it.second) { keys.emplace_back(k); firstitem.emplace_back(n); }
+            keyidx[n] = it.first->second;
+        }
+
+        Shapes cached;
+        std::vector<bool> found = cache.find(keys, cached);
+
+        std::vector<size_t> missing;
+        for(size_t i = 0; i < keys.size(); ++i)
+            if(!found[i]) missing.emplace_back(i);
+
+        __parallel::enumerate(missing.begin(), missing.end(),
+            [this, &cached, &firstitem, &trsh, &orbref](size_t i, size_t)
+        {
+            const Item& sh = items_[firstitem[i]];
+            auto& fixedp = sh.transformedShape();
+            auto& orbp = trsh.transformedShape();
+            auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(fixedp, orbp);
+            correctNfpPosition(subnfp_r, sh, trsh);
+
+            sl::translate(subnfp_r.first, -(sh.translation() + orbref));
+            if(sh.rotation() != 0.)
+                sl::rotate(subnfp_r.first, Radians(-sh.rotation()));
+            cached[i] = std::move(subnfp_r.first);
+        });
+
+        if(!missing.empty()) cache.insert(keys, cached, found);
+
+        Shapes nfps(items_.size());
+
+        __parallel::enumerate(items_.begin(), items_.end(),
+            [&nfps, &cached, &keyidx, &orbref](const Item& sh, size_t n)
+        {
+            RawShape subnfp = cached[keyidx[n]];
+            if(sh.rotation() != 0.) sl::rotate(subnfp, sh.rotation());
+            sl::translate(subnfp, sh.translation() + orbref);
+            nfps[n] = std::move(subnfp);
+        });
+
+        return nfp::merge(nfps);
+    }
+
 
     template<class Level>
     Shapes calcnfp(const Item &trsh, Level)
@@ -105,6 +105,13 @@ void fill_config(PConf& pcfg, const ArrangeParams &params) {
     
     // Allow parallel execution.
     pcfg.parallel = params.parallel;
+
+    // Reuse the no-fit polygons of the copies of the same objects, also
+    // between subsequent arrange calls. The cache is shared by all arrange
+    // calls of the application, it is thread safe and it is emptied once it
+    // holds its maximum number of no-fit polygons.
+    static auto nfp_cache = std::make_shared<placers::NfpCache<clppr::Polygon>>();
+    pcfg.nfp_cache = nfp_cache;
 }
 
 // Apply penalty to object function result. This is used only when alignment
@@ -2,9 +2,121 @@
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
 #include <algorithm>
+#include <functional>
+#include <limits>
+
+#include <tbb/parallel_for.h>
 
 namespace Slic3r {
 
+// Answers which anchor regions contain a point with the very same even-odd test as ExPolygon::contains(),
+// but only visiting the edges of the anchor regions spanning the horizontal strip of the point.
+// The strips are built over the anchors once per detect_angle() and shared by all the candidate directions.
+class BridgeDetector::AnchorIndex
+{
+public:
+    AnchorIndex(const ExPolygons &anchors, bool build_strips) : m_anchors(anchors)
+    {
+        m_bboxes.reserve(anchors.size());
+        size_t num_edges = 0;
+        for (const ExPolygon &anchor : anchors) {
+            m_bboxes.emplace_back(anchor.contour.bounding_box());
+            m_bbox.merge(m_bboxes.back());
+            num_edges += anchor.contour.points.size();
+            for (const Polygon &hole : anchor.holes) {
+                m_bbox.merge(hole.points);
+                num_edges += hole.points.size();
+            }
+        }
+        if (! build_strips || num_edges == 0 || ! m_bbox.defined)
+            return;
+        // A few edges per strip.
+        m_strips.assign(std::max<size_t>(1, std::min<size_t>(num_edges / 4, 4096)), {});
+        m_strip_height = std::max<coord_t>(1, (m_bbox.max.y() - m_bbox.min.y() + coord_t(m_strips.size())) / coord_t(m_strips.size()));
+        for (uint32_t idx_anchor = 0; idx_anchor < uint32_t(anchors.size()); ++ idx_anchor) {
+            const ExPolygon &anchor = anchors[idx_anchor];
+            for (uint32_t idx_polygon = 0; idx_polygon <= uint32_t(anchor.holes.size()); ++ idx_polygon) {
+                const Points &pts = idx_polygon == 0 ? anchor.contour.points : anchor.holes[idx_polygon - 1].points;
+                if (pts.empty())
+                    continue;
+                for (size_t i = 0, j = pts.size() - 1; i < pts.size(); j = i ++) {
+                    // Only the edges crossing the horizontal ray cast from the point are counted, that is min_y <= y < max_y.
+                    coord_t min_y = std::min(pts[i].y(), pts[j].y());
+                    coord_t max_y = std::max(pts[i].y(), pts[j].y());
+                    if (min_y == max_y)
+                        continue;
+                    for (size_t strip = this->strip_idx(min_y); strip <= this->strip_idx(max_y - 1); ++ strip)
+                        m_strips[strip].push_back({ idx_anchor, idx_polygon, pts[i], pts[j] });
+                }
+            }
+        }
+    }
+
+    // Indices of the anchor regions containing the point, in increasing order.
+    // crossings is a scratch buffer, so that the caller may reuse its allocation.
+    void containing(const Point &pt, std::vector<uint32_t> &out, std::vector<std::pair<uint32_t, uint32_t>> &crossings) const
+    {
+        out.clear();
+        if (m_strips.empty()) {
+            for (uint32_t idx_anchor = 0; idx_anchor < uint32_t(m_anchors.size()); ++ idx_anchor)
+                if (m_bboxes[idx_anchor].contains(pt) && m_anchors[idx_anchor].contains(pt)) // using short-circuit evaluation to test boundingbox and only then the other
+                    out.push_back(idx_anchor);
+            return;
+        }
+        if (pt.y() < m_bbox.min.y() || pt.y() > m_bbox.max.y())
+            return;
+        // Polygons crossed by the ray an odd number of times contain the point, see Polygon::contains().
+        crossings.clear();
+        for (const Edge &edge : m_strips[this->strip_idx(pt.y())]) {
+            const Point &i = edge.i;
+            const Point &j = edge.j;
+            if (((i.y() > pt.y()) != (j.y() > pt.y()))
+                && ((double)pt.x() < (double)(j.x() - i.x()) * (double)(pt.y() - i.y()) / (double)(j.y() - i.y()) + (double)i.x()))
+                crossings.emplace_back(edge.anchor, edge.polygon);
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (auto it = crossings.begin(); it != crossings.end();) {
+            const uint32_t idx_anchor = it->first;
+            // Inside the contour and outside of all the holes.
+            bool in_contour = false;
+            bool in_hole    = false;
+            while (it != crossings.end() && it->first == idx_anchor) {
+                auto it_end = it;
+                for (; it_end != crossings.end() && *it_end == *it; ++ it_end) ;
+                if ((it_end - it) & 1)
+                    (it->second == 0 ? in_contour : in_hole) = true;
+                it = it_end;
+            }
+            if (in_contour && ! in_hole && m_bboxes[idx_anchor].contains(pt))
+                out.push_back(idx_anchor);
+        }
+    }
+
+    bool contains(const Point &pt, std::vector<uint32_t> &anchors, std::vector<std::pair<uint32_t, uint32_t>> &crossings) const
+    {
+        this->containing(pt, anchors, crossings);
+        return ! anchors.empty();
+    }
+
+private:
+    struct Edge {
+        uint32_t anchor;
+        // 0 for the contour, 1 + index of the hole otherwise.
+        uint32_t polygon;
+        // Ordered as in Polygon::contains(), so that the crossing is evaluated with the same rounding.
+        Point    i;
+        Point    j;
+    };
+
+    size_t strip_idx(coord_t y) const { return std::min(m_strips.size() - 1, size_t((y - m_bbox.min.y()) / m_strip_height)); }
+
+    const ExPolygons                &m_anchors;
+    std::vector<BoundingBox>         m_bboxes;
+    BoundingBox                      m_bbox;
+    coord_t                          m_strip_height { 1 };
+    std::vector<std::vector<Edge>>   m_strips;
+};
+
 BridgeDetector::BridgeDetector(
     ExPolygon         _expolygon,
     const ExPolygons &_lower_slices, 
@@ -92,11 +204,37 @@ bool BridgeDetector::detect_angle(double bridge_direction_override)
     /*  we'll now try several directions using a rudimentary visibility check:
         bridge in several directions and then sum the length of lines having both
         endpoints within anchors */
-        
-    bool have_coverage = false;
-    for (size_t i_angle = 0; i_angle < candidates.size(); ++ i_angle)
+    AnchorIndex anchors(this->_anchor_regions, this->use_anchor_index);
+    std::vector<uint32_t> all_anchors(this->_anchor_regions.size());
+    for (uint32_t i = 0; i < uint32_t(all_anchors.size()); ++ i)
+        all_anchors[i] = i;
+    // The candidates are evaluated independently of each other, each one only writes into its own BridgeDirection.
+    auto for_each_candidate = [this](std::vector<BridgeDirection> &candidates, const std::function<void(BridgeDirection&)> &evaluate) {
+        if (this->use_anchor_index)
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, candidates.size()),
+                [&candidates, &evaluate](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i_angle = range.begin(); i_angle < range.end(); ++ i_angle)
+                        evaluate(candidates[i_angle]);
+                });
+        else
+            for (BridgeDirection &c : candidates)
+                evaluate(c);
+    };
+    // Sort the lengths of the anchored lines to get their median.
+    auto set_median_length_anchor = [](BridgeDirection &c, std::vector<coordf_t> &dist_anchored) {
+        if (c.total_length_anchored != 0. && c.nb_lines_anchored != 0 && ! dist_anchored.empty()) {
+            std::sort(dist_anchored.begin(), dist_anchored.end());
+            c.median_length_anchor = dist_anchored[dist_anchored.size() / 2];
+        }
+    };
+    auto has_coverage = [](const std::vector<BridgeDirection> &candidates) {
+        return std::any_of(candidates.begin(), candidates.end(), 
+            [](const BridgeDirection &c) { return c.total_length_anchored != 0. && c.nb_lines_anchored != 0; });
+    };
+
+    for_each_candidate(candidates, [this, &clip_area, &anchors, &all_anchors, &set_median_length_anchor](BridgeDirection &c)
     {
-        const double angle = candidates[i_angle].angle;
+        const double angle = c.angle;
         Lines lines;
         {
             // Get an oriented bounding box around _anchor_regions.
@@ -114,33 +252,34 @@ bool BridgeDetector::detect_angle(double bridge_direction_override)
                     Point((coord_t)round(c * bbox.max.x() - s * y), (coord_t)round(c * y + s * bbox.max.x()))));
         }
 
-        //create boundingbox for anchor regions
-        std::vector<BoundingBox> anchor_bb;
-        for (ExPolygon& poly : this->_anchor_regions) {
-            anchor_bb.emplace_back(poly.contour.bounding_box());
-        }
-
         //compute stat on line with anchors, and their lengths.
-        BridgeDirection& c = candidates[i_angle];
         std::vector<coordf_t> dist_anchored;
+        std::vector<uint32_t> anchors_a, anchors_b;
+        std::vector<std::pair<uint32_t, uint32_t>> crossings;
         {
             Lines clipped_lines = intersection_ln(lines, clip_area);
             for (size_t i = 0; i < clipped_lines.size(); ++i) {
-                // this can be called 100 000 time per detect_angle, please optimise
+                // this can be called 100 000 time per detect_angle, the anchors are looked up through the index.
                 const Line &line = clipped_lines[i];
                 bool good_line = false;
                 coordf_t len = line.length();
                 //is anchored?
+                anchors.containing(line.a, anchors_a, crossings);
+                anchors.containing(line.b, anchors_b, crossings);
                 size_t line_a_anchor_idx = -1;
                 size_t line_b_anchor_idx = -1;
-                for (int i = 0; i < _anchor_regions.size(); ++i) {
-                    ExPolygon& poly = this->_anchor_regions[i];
-                    BoundingBox& polybb = anchor_bb[i];
-                    if (polybb.contains(line.a) && poly.contains(line.a)) { // using short-circuit evaluation to test boundingbox and only then the other
-                        line_a_anchor_idx = i;
+                // Walk the anchors containing either end in the order of the anchor regions, keeping the last anchor of each end
+                // until both ends are anchored, as a search over all the anchor regions would.
+                for (auto it_a = anchors_a.begin(), it_b = anchors_b.begin(); it_a != anchors_a.end() || it_b != anchors_b.end();) {
+                    const uint32_t idx = std::min(it_a == anchors_a.end() ? std::numeric_limits<uint32_t>::max() : *it_a, 
+                                                  it_b == anchors_b.end() ? std::numeric_limits<uint32_t>::max() : *it_b);
+                    if (it_a != anchors_a.end() && *it_a == idx) {
+                        line_a_anchor_idx = idx;
+                        ++ it_a;
                     }
-                    if (polybb.contains(line.b) && poly.contains(line.b)) { // using short-circuit evaluation to test boundingbox and only then the other
-                        line_b_anchor_idx = i;
+                    if (it_b != anchors_b.end() && *it_b == idx) {
+                        line_b_anchor_idx = idx;
+                        ++ it_b;
                     }
                     if (line_a_anchor_idx < clipped_lines.size() && line_b_anchor_idx < clipped_lines.size())
                         break;
@@ -154,33 +293,19 @@ bool BridgeDetector::detect_angle(double bridge_direction_override)
                         //check that the line go out of the anchor into the briding area 
                         // don't call intersection_ln here, as even if we succeed to limit the number of candidates to ~100, here we can have hundreds of lines, so that means dozen of thousands of calls (or more)!
                         // add some points (at least the middle) to test, it's quick
+                        // The line is good as soon as a point is not inside all the anchor regions.
                         Point middle_point = line.midpoint();
-                        for (int i = 0; i < _anchor_regions.size(); ++i) {
-                            ExPolygon& poly = this->_anchor_regions[i];
-                            BoundingBox& polybb = anchor_bb[i];
-                            if (!polybb.contains(middle_point) || !poly.contains(middle_point)) { // using short-circuit evaluation to test boundingbox and only then the other
-                                good_line = true;
-                                break;
-                            }
-                        }
+                        anchors.containing(middle_point, anchors_a, crossings);
+                        good_line = anchors_a != all_anchors;
                         // if still bad, the line is long enough to warrant two more test point? (1/2000 on a benchy)
                         if (!good_line && len > this->spacing * 10) {
                             //now test with to more points
                             Line middle_line;
                             middle_line.a = (line.a + middle_point) / 2;
                             middle_line.b = (line.b + middle_point) / 2;
-                            for (int i = 0; i < _anchor_regions.size(); ++i) {
-                                ExPolygon& poly = this->_anchor_regions[i];
-                                BoundingBox& polybb = anchor_bb[i];
-                                if (!polybb.contains(middle_line.a) || !poly.contains(middle_line.a)) { // using short-circuit evaluation to test boundingbox and only then the other
-                                    good_line = true;
-                                    break;
-                                }
-                                if (!polybb.contains(middle_line.b) || !poly.contains(middle_line.b)) { // using short-circuit evaluation to test boundingbox and only then the other
-                                    good_line = true;
-                                    break;
-                                }
-                            }
+                            anchors.containing(middle_line.a, anchors_a, crossings);
+                            anchors.containing(middle_line.b, anchors_b, crossings);
+                            good_line = anchors_a != all_anchors || anchors_b != all_anchors;
                         }
                         // If the line is still bad and is a long one, use the more costly intersection_ln. This case is rare enough to swallow the cost. (1/10000 on a benchy)
                         if (!good_line && len > this->spacing * 40) {
@@ -205,20 +330,9 @@ bool BridgeDetector::detect_angle(double bridge_direction_override)
                 }
             }        
         }
-        if (c.total_length_anchored == 0. || c.nb_lines_anchored == 0) {
-            continue;
-        } else {
-            have_coverage = true;
-            // compute median
-            if (!dist_anchored.empty()) {
-                std::sort(dist_anchored.begin(), dist_anchored.end());
-                c.median_length_anchor = dist_anchored[dist_anchored.size() / 2];
-            }
-
-
-            // size is 20%
-        }
-    }
+        set_median_length_anchor(c, dist_anchored);
+    });
+    bool have_coverage = has_coverage(candidates);
 
     // if no direction produced coverage, then there's no bridge direction ?
     if (!have_coverage) {
@@ -228,9 +342,9 @@ bool BridgeDetector::detect_angle(double bridge_direction_override)
             candidates = bridge_direction_candidates(true);
         } else
             candidates.emplace_back(BridgeDirection(bridge_direction_override));
-        for (size_t i_angle = 0; i_angle < candidates.size(); ++i_angle)
+        for_each_candidate(candidates, [this, &clip_area, &anchors, &set_median_length_anchor](BridgeDirection &c)
         {
-            const double angle = candidates[i_angle].angle;
+            const double angle = c.angle;
             //use the whole polygon
             Lines lines;
             {
@@ -247,13 +361,14 @@ bool BridgeDetector::detect_angle(double bridge_direction_override)
                         Point((coord_t)round(c * bbox.max.x() - s * y), (coord_t)round(c * y + s * bbox.max.x()))));
             }
             //compute stat on line with anchors, and their lengths.
-            BridgeDirection& c = candidates[i_angle];
             std::vector<coordf_t> dist_anchored;
+            std::vector<uint32_t> anchors_a;
+            std::vector<std::pair<uint32_t, uint32_t>> crossings;
             {
                 Lines clipped_lines = intersection_ln(lines, clip_area);
                 for (size_t i = 0; i < clipped_lines.size(); ++i) {
                     const Line& line = clipped_lines[i];
-                    if (expolygons_contain(this->_anchor_regions, line.a) || expolygons_contain(this->_anchor_regions, line.b)) {
+                    if (anchors.contains(line.a, anchors_a, crossings) || anchors.contains(line.b, anchors_a, crossings)) {
                         // This line has one anchor (or is totally anchored)
                         coordf_t len = line.length();
                         //store stats
@@ -270,20 +385,9 @@ bool BridgeDetector::detect_angle(double bridge_direction_override)
                     }
                 }
             }
-            if (c.total_length_anchored == 0. || c.nb_lines_anchored == 0) {
-                continue;
-            } else {
-                have_coverage = true;
-                // compute median
-                if (!dist_anchored.empty()) {
-                    std::sort(dist_anchored.begin(), dist_anchored.end());
-                    c.median_length_anchor = dist_anchored[dist_anchored.size() / 2];
-                }
-
-
-                // size is 20%
-            }
-        }
+            set_median_length_anchor(c, dist_anchored);
+        });
+        have_coverage = has_coverage(candidates);
     }
 
     // if no direction produced coverage, then there's no bridge direction
@@ -27,6 +27,9 @@ public:
     double                       resolution;
     // The final optimal angle.
     double                       angle;
+    // Look the anchors up through a spatial index and evaluate the candidate directions in parallel.
+    // Cleared only to compare with a plain search over all the anchor regions (see sandboxes/bridgedetector).
+    bool                         use_anchor_index = true;
     
     BridgeDetector(ExPolygon _expolygon, const ExPolygons &_lower_slices, coord_t _extrusion_width);
     BridgeDetector(const ExPolygons &_expolygons, const ExPolygons &_lower_slices, coord_t _extrusion_width);
@@ -42,6 +45,8 @@ private:
 
     void initialize();
 
+    class AnchorIndex;
+
     struct BridgeDirection {
         BridgeDirection(double a = -1., float along_perimeter = 0) : angle(a), coverage(0.), along_perimeter_length(along_perimeter){}
 
@@ -128,6 +128,7 @@ ExPolygons PolyTreeToExPolygons(ClipperLib::PolyTree& polytree)
 Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 {
     Polygon retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -136,6 +137,7 @@ Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 Slic3r::Polyline ClipperPath_to_Slic3rPolyline(const ClipperLib::Path &input)
 {
     Polyline retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -177,6 +179,7 @@ ExPolygons ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input)
 ClipperLib::Path Slic3rMultiPoint_to_ClipperPath(const MultiPoint &input)
 {
     ClipperLib::Path retval;
+    retval.reserve(input.points.size());
     for (Points::const_iterator pit = input.points.begin(); pit != input.points.end(); ++pit)
         retval.emplace_back((*pit)(0), (*pit)(1));
     return retval;
@@ -194,6 +197,7 @@ ClipperLib::Path Slic3rMultiPoint_to_ClipperPath_reversed(const Slic3r::MultiPoi
 ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polygons &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(input.size());
     for (Polygons::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.emplace_back(Slic3rMultiPoint_to_ClipperPath(*it));
     return retval;
@@ -202,6 +206,7 @@ ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polygons &input)
 ClipperLib::Paths  Slic3rMultiPoints_to_ClipperPaths(const ExPolygons &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(number_polygons(input));
     for (auto &ep : input) {
         retval.emplace_back(Slic3rMultiPoint_to_ClipperPath(ep.contour));
         
@@ -215,6 +220,7 @@ ClipperLib::Paths  Slic3rMultiPoints_to_ClipperPaths(const ExPolygons &input)
 ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polylines &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(input.size());
     for (Polylines::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.emplace_back(Slic3rMultiPoint_to_ClipperPath(*it));
     return retval;
@@ -490,38 +496,58 @@ ExPolygons offset2_ex(const ExPolygons &expolygons, const double delta1,
     return union_ex(polys);
 }
 
-template<class T, class TSubj, class TClip>
-T _clipper_do(const ClipperLib::ClipType     clipType,
-              TSubj &&                        subject,
-              TClip &&                        clip,
-              const ClipperLib::PolyFillType fillType,
-              const bool                     safety_offset_)
+// Copy of the paths of a ClipperUtils provider, to be modified by safety_offset().
+template<class TProvider>
+static ClipperLib::Paths provider_to_clipper_paths(const TProvider &provider)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(std::forward<TSubj>(subject));
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(std::forward<TClip>(clip));
-    
-    // perform safety offset
-    if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
+    ClipperLib::Paths retval;
+    for (const Points &points : provider) {
+        retval.emplace_back();
+        retval.back().reserve(points.size());
+        for (const Point &pt : points)
+            retval.back().emplace_back(pt.x(), pt.y());
     }
-    
+    return retval;
+}
+
+// Add subject and clip, given as ClipperUtils providers, to the clipper.
+// The points are read by the Clipper in place, only the paths to be safety offsetted
+// (the subject for union, the clip otherwise) are copied to ClipperLib::Paths.
+template<class TSubj, class TClip>
+static void _clipper_add_paths(ClipperLib::Clipper &clipper, const ClipperLib::ClipType clipType,
+    const TSubj &subject, const TClip &clip, const bool safety_offset_)
+{
+    if (safety_offset_ && clipType == ClipperLib::ctUnion) {
+        ClipperLib::Paths input_subject = provider_to_clipper_paths(subject);
+        safety_offset(&input_subject);
+        clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    } else
+        clipper.AddPaths(subject, ClipperLib::ptSubject, true);
+    if (safety_offset_ && clipType != ClipperLib::ctUnion) {
+        ClipperLib::Paths input_clip = provider_to_clipper_paths(clip);
+        safety_offset(&input_clip);
+        clipper.AddPaths(input_clip, ClipperLib::ptClip, true);
+    } else
+        clipper.AddPaths(clip, ClipperLib::ptClip, true);
+}
+
+// Output is either a ClipperLib::PolyTree or a ClipperUtils::PolygonsOutput.
+template<class TSubj, class TClip, class TOutput>
+void _clipper_do(const ClipperLib::ClipType     clipType,
+                 const TSubj &                  subject,
+                 const TClip &                  clip,
+                 const ClipperLib::PolyFillType fillType,
+                 const bool                     safety_offset_,
+                 TOutput &&                     output)
+{
     // init Clipper
     ClipperLib::Clipper clipper;
-    clipper.Clear();
     
     // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    _clipper_add_paths(clipper, clipType, subject, clip, safety_offset_);
     
     // perform operation
-    T retval;
-    clipper.Execute(clipType, retval, fillType, fillType);
-    return retval;
+    clipper.Execute(clipType, std::forward<TOutput>(output), fillType, fillType);
 }
 
 bool test_path(const ClipperLib::Path &path) {
@@ -547,23 +573,16 @@ bool test_path(const ClipperLib::Path &path) {
 // This function implmenets a following workaround:
 // 1) Peform the Clipper operation with the output to Paths. This method handles overlaps in a reasonable time.
 // 2) Run Clipper Union once again to extract the PolyTree from the result of 1).
-inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const Polygons &subject, 
-    const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
+template<class TSubj, class TClip>
+inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const TSubj &subject, 
+    const TClip &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_)
-        safety_offset((clipType == ClipperLib::ctUnion) ? &input_subject : &input_clip);
-    
     ClipperLib::Clipper clipper;
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    _clipper_add_paths(clipper, clipType, subject, clip, safety_offset_);
     // Perform the operation with the output to input_subject.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
     // if there are overapping edges.
+    ClipperLib::Paths input_subject;
     clipper.Execute(clipType, input_subject, fillType, fillType);
     // Perform an additional Union operation to generate the PolyTree ordering.
     clipper.Clear();
@@ -664,12 +683,33 @@ ClipperLib::PolyTree _clipper_do_pl(const ClipperLib::ClipType clipType, const P
 
 Polygons _clipper(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_)
 {
-    return ClipperPaths_to_Slic3rPolygons(_clipper_do<ClipperLib::Paths>(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_));
+    Polygons retval;
+    _clipper_do(clipType, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), ClipperLib::pftNonZero, safety_offset_, ClipperUtils::PolygonsOutput(retval));
+    return retval;
+}
+
+Polygons _clipper(ClipperLib::ClipType clipType, const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_)
+{
+    Polygons retval;
+    _clipper_do(clipType, ClipperUtils::ExPolygonsProvider<ExPolygons>(subject), ClipperUtils::ExPolygonsProvider<ExPolygons>(clip), ClipperLib::pftNonZero, safety_offset_, ClipperUtils::PolygonsOutput(retval));
+    return retval;
 }
 
 ExPolygons _clipper_ex(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_)
 {
-    ClipperLib::PolyTree polytree = _clipper_do_polytree2(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_);
+    ClipperLib::PolyTree polytree = _clipper_do_polytree2(clipType, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), ClipperLib::pftNonZero, safety_offset_);
+    return PolyTreeToExPolygons(polytree);
+}
+
+ExPolygons _clipper_ex(ClipperLib::ClipType clipType, const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_)
+{
+    ClipperLib::PolyTree polytree = _clipper_do_polytree2(clipType, ClipperUtils::ExPolygonsProvider<ExPolygons>(subject), ClipperUtils::ExPolygonsProvider<ExPolygons>(clip), ClipperLib::pftNonZero, safety_offset_);
+    return PolyTreeToExPolygons(polytree);
+}
+
+ExPolygons _clipper_ex(ClipperLib::ClipType clipType, const Surfaces &subject, const Polygons &clip, bool safety_offset_)
+{
+    ClipperLib::PolyTree polytree = _clipper_do_polytree2(clipType, ClipperUtils::SurfacesProvider(subject), ClipperUtils::PolygonsProvider(clip), ClipperLib::pftNonZero, safety_offset_);
     return PolyTreeToExPolygons(polytree);
 }
 
@@ -750,22 +790,26 @@ _clipper_ln(ClipperLib::ClipType clipType, const Lines &subject, const Polygons
 
 ClipperLib::PolyTree union_pt(const Polygons &subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    ClipperLib::PolyTree retval;
+    _clipper_do(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(Polygons()), ClipperLib::pftEvenOdd, safety_offset_, retval);
+    return retval;
 }
 
 ClipperLib::PolyTree union_pt(const ExPolygons &subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    ClipperLib::PolyTree retval;
+    _clipper_do(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider<ExPolygons>(subject), ClipperUtils::PolygonsProvider(Polygons()), ClipperLib::pftEvenOdd, safety_offset_, retval);
+    return retval;
 }
 
 ClipperLib::PolyTree union_pt(Polygons &&subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, std::move(subject), Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return union_pt(static_cast<const Polygons&>(subject), safety_offset_);
 }
 
 ClipperLib::PolyTree union_pt(ExPolygons &&subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, std::move(subject), Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return union_pt(static_cast<const ExPolygons&>(subject), safety_offset_);
 }
 
 // Simple spatial ordering of Polynodes
@@ -827,22 +871,14 @@ Polygons union_pt_chained_outside_in(const Polygons &subject, bool safety_offset
 
 Polygons simplify_polygons(const Polygons &subject, bool preserve_collinear)
 {
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
-    ClipperLib::Paths output;
-    if (preserve_collinear) {
-        ClipperLib::Clipper c;
-        c.PreserveCollinear(true);
-        c.StrictlySimple(true);
-        c.AddPaths(input_subject, ClipperLib::ptSubject, true);
-        c.Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
-    } else {
-        ClipperLib::SimplifyPolygons(input_subject, output, ClipperLib::pftNonZero);
-    }
-    
-    // convert into Slic3r polygons
-    return ClipperPaths_to_Slic3rPolygons(output);
+    // Same as ClipperLib::SimplifyPolygons(), reading the Slic3r polygons in place and writing the Slic3r polygons directly.
+    ClipperLib::Clipper c;
+    c.PreserveCollinear(preserve_collinear);
+    c.StrictlySimple(true);
+    c.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
+    Polygons retval;
+    c.Execute(ClipperLib::ctUnion, ClipperUtils::PolygonsOutput(retval), ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return retval;
 }
 
 ExPolygons simplify_polygons_ex(const Polygons &subject, bool preserve_collinear)
@@ -850,15 +886,12 @@ ExPolygons simplify_polygons_ex(const Polygons &subject, bool preserve_collinear
     if (! preserve_collinear)
         return union_ex(simplify_polygons(subject, false));
 
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
     ClipperLib::PolyTree polytree;
     
     ClipperLib::Clipper c;
     c.PreserveCollinear(true);
     c.StrictlySimple(true);
-    c.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    c.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
     c.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     
     // convert into ExPolygons
@@ -920,7 +953,7 @@ Polygons top_level_islands(const Slic3r::Polygons &polygons)
     ClipperLib::Clipper clipper;
     clipper.Clear();
     // perform union
-    clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::ptSubject, true);
+    clipper.AddPaths(ClipperUtils::PolygonsProvider(polygons), ClipperLib::ptSubject, true);
     ClipperLib::PolyTree polytree;
     clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd); 
     // Convert only the top level islands to the output.
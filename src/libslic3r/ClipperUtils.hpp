@@ -26,6 +26,83 @@ using ClipperLib::jtSquare;
 
 namespace Slic3r {
 
+namespace ClipperUtils {
+    // Polygons or Polylines presented to ClipperLib::Clipper::AddPaths() as a range of Points,
+    // which are read by the Clipper in place, without converting them to ClipperLib::Paths first.
+    template<typename MultiPointsType>
+    class MultiPointsProvider {
+    public:
+        MultiPointsProvider(const MultiPointsType &multipoints) : m_multipoints(multipoints) {}
+
+        class iterator {
+        public:
+            explicit iterator(typename MultiPointsType::const_iterator it) : m_it(it) {}
+            const Points& operator*() const { return m_it->points; }
+            iterator&     operator++() { ++ m_it; return *this; }
+            bool          operator!=(const iterator &rhs) const { return m_it != rhs.m_it; }
+        private:
+            typename MultiPointsType::const_iterator m_it;
+        };
+
+        iterator begin() const { return iterator(m_multipoints.begin()); }
+        iterator end()   const { return iterator(m_multipoints.end()); }
+
+    private:
+        const MultiPointsType &m_multipoints;
+    };
+    using PolygonsProvider  = MultiPointsProvider<Polygons>;
+    using PolylinesProvider = MultiPointsProvider<Polylines>;
+
+    inline const ExPolygon& get_expolygon(const ExPolygon &expolygon) { return expolygon; }
+    inline const ExPolygon& get_expolygon(const Surface &surface) { return surface.expolygon; }
+
+    // ExPolygons or Surfaces presented to ClipperLib::Clipper::AddPaths() as a range of Points
+    // (contour followed by its holes, the same order as to_polygons()), read by the Clipper in place.
+    template<typename ExPolygonsType>
+    class ExPolygonsProvider {
+    public:
+        ExPolygonsProvider(const ExPolygonsType &expolygons) : m_expolygons(expolygons) {}
+
+        class iterator {
+        public:
+            explicit iterator(typename ExPolygonsType::const_iterator it) : m_it(it), m_idx_hole(-1) {}
+            const Points& operator*() const {
+                const ExPolygon &expolygon = get_expolygon(*m_it);
+                return m_idx_hole < 0 ? expolygon.contour.points : expolygon.holes[m_idx_hole].points;
+            }
+            iterator& operator++() {
+                if (++ m_idx_hole == int(get_expolygon(*m_it).holes.size())) {
+                    ++ m_it;
+                    m_idx_hole = -1;
+                }
+                return *this;
+            }
+            bool operator!=(const iterator &rhs) const { return m_it != rhs.m_it || m_idx_hole != rhs.m_idx_hole; }
+        private:
+            typename ExPolygonsType::const_iterator m_it;
+            // -1 for the contour.
+            int                                     m_idx_hole;
+        };
+
+        iterator begin() const { return iterator(m_expolygons.begin()); }
+        iterator end()   const { return iterator(m_expolygons.end()); }
+
+    private:
+        const ExPolygonsType &m_expolygons;
+    };
+    using SurfacesProvider  = ExPolygonsProvider<Surfaces>;
+
+    // Receives the closed paths produced by ClipperLib::Clipper::Execute() directly into Polygons.
+    class PolygonsOutput {
+    public:
+        PolygonsOutput(Polygons &polygons) : m_polygons(polygons) {}
+        void begin_path(size_t num_points) { m_polygons.emplace_back(); m_polygons.back().points.reserve(num_points); }
+        void add_point(const ClipperLib::IntPoint &pt) { m_polygons.back().points.emplace_back(pt.X, pt.Y); }
+    private:
+        Polygons &m_polygons;
+    };
+}
+
 //-----------------------------------------------------------
 // legacy code from Clipper documentation
 void AddOuterPolyNodeToExPolygons(ClipperLib::PolyNode& polynode, Slic3r::ExPolygons *expolygons);
@@ -87,8 +164,14 @@ Slic3r::ExPolygons offset2_ex(const Slic3r::ExPolygons &expolygons, const double
 
 Slic3r::Polygons _clipper(ClipperLib::ClipType clipType,
     const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
+Slic3r::Polygons _clipper(ClipperLib::ClipType clipType,
+    const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false);
 Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
     const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
+Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
+    const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false);
+Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
+    const Slic3r::Surfaces &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
 Slic3r::Polylines _clipper_pl(ClipperLib::ClipType clipType,
     const Slic3r::Polylines &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
 Slic3r::Polylines _clipper_pl(ClipperLib::ClipType clipType,
@@ -112,13 +195,13 @@ diff_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safe
 inline Slic3r::ExPolygons
 diff_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctDifference, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper_ex(ClipperLib::ctDifference, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polygons
 diff(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper(ClipperLib::ctDifference, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper(ClipperLib::ctDifference, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polylines
@@ -155,13 +238,13 @@ intersection_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, b
 inline Slic3r::ExPolygons
 intersection_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctIntersection, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper_ex(ClipperLib::ctIntersection, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polygons
 intersection(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper(ClipperLib::ctIntersection, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper(ClipperLib::ctIntersection, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polylines
@@ -206,12 +289,12 @@ inline Slic3r::ExPolygons union_ex(const Slic3r::Polygons &subject, bool safety_
 
 inline Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctUnion, to_polygons(subject), Slic3r::Polygons(), safety_offset_);
+    return _clipper_ex(ClipperLib::ctUnion, subject, Slic3r::ExPolygons(), safety_offset_);
 }
 
 inline Slic3r::ExPolygons union_ex(const Slic3r::Surfaces &subject, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctUnion, to_polygons(subject), Slic3r::Polygons(), safety_offset_);
+    return _clipper_ex(ClipperLib::ctUnion, subject, Slic3r::Polygons(), safety_offset_);
 }
 
 inline Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject1, const Slic3r::ExPolygons &subject2, bool safety_offset_ = false) {
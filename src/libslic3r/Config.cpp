@@ -980,7 +980,7 @@ void ConfigBase::null_nullables()
 DynamicConfig::DynamicConfig(const ConfigBase& rhs, const t_config_option_keys& keys)
 {
 	for (const t_config_option_key& opt_key : keys)
-		this->options[opt_key] = std::unique_ptr<ConfigOption>(rhs.option(opt_key)->clone());
+		this->options[opt_key] = OptionValue(rhs.option(opt_key)->clone());
 }
 
 bool DynamicConfig::operator==(const DynamicConfig &rhs) const
@@ -990,7 +990,7 @@ bool DynamicConfig::operator==(const DynamicConfig &rhs) const
     auto it2     = rhs.options.begin();
     auto it2_end = rhs.options.end();
     for (; it1 != it1_end && it2 != it2_end; ++ it1, ++ it2)
-		if (it1->first != it2->first || *it1->second != *it2->second)
+		if (it1->first != it2->first || (it1->second.get() != it2->second.get() && *it1->second.get() != *it2->second.get()))
 			// key or value differ
 			return false;
     return it1 == it1_end && it2 == it2_end;
@@ -1001,7 +1001,7 @@ size_t DynamicConfig::remove_nil_options()
 {
 	size_t cnt_removed = 0;
 	for (auto it = options.begin(); it != options.end();)
-		if (it->second->is_nil()) {
+		if (it->second.get()->is_nil()) {
 			it = options.erase(it);
 			++ cnt_removed;
 		} else
@@ -1012,9 +1012,12 @@ size_t DynamicConfig::remove_nil_options()
 ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key, bool create)
 {
     auto it = options.find(opt_key);
-    if (it != options.end())
-        // Option was found.
+    if (it != options.end()) {
+        // Option was found. Clone a value shared with other configs, it may be modified through the pointer returned.
+        if (it->second.shared)
+            it->second = OptionValue(it->second.get()->clone());
         return it->second.get();
+    }
     if (! create)
         // Option was not found and a new option shall not be created.
         return nullptr;
@@ -1028,10 +1031,25 @@ ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key, bool cre
         // Let the parent decide what to do if the opt_key is not defined by this->def().
         return nullptr;
     ConfigOption *opt = optdef->create_default_option();
-    this->options.emplace_hint(it, opt_key, std::unique_ptr<ConfigOption>(opt));
+    this->options.emplace_hint(it, opt_key, OptionValue(opt));
     return opt;
 }
 
+std::shared_ptr<const ConfigOption> DynamicConfig::share_option(const t_config_option_key &opt_key)
+{
+    auto it = options.find(opt_key);
+    if (it == options.end())
+        return nullptr;
+    it->second.shared = true;
+    return it->second.ptr;
+}
+
+void DynamicConfig::share_options()
+{
+    for (auto &kvp : options)
+        kvp.second.shared = true;
+}
+
 const ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key) const
 {
     auto it = options.find(opt_key);
@@ -3,6 +3,8 @@
 
 #include <assert.h>
 #include <map>
+#include <memory>
+#include <iterator>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
@@ -2125,12 +2127,13 @@ public:
 
     // Copy a content of one DynamicConfig to another DynamicConfig.
     // If rhs.def() is not null, then it has to be equal to this->def(). 
+    // Values shared by rhs with other DynamicConfigs are shared with this DynamicConfig as well, the other values are cloned.
     DynamicConfig& operator=(const DynamicConfig &rhs) 
     {
         assert(this->def() == nullptr || this->def() == rhs.def());
         this->clear();
         for (const auto &kvp : rhs.options)
-            this->options[kvp.first].reset(kvp.second->clone());
+            this->options.emplace_hint(this->options.end(), kvp.first, kvp.second.copy());
         return *this;
     }
 
@@ -2153,13 +2156,16 @@ public:
         for (const auto &kvp : rhs.options) {
             auto it = this->options.find(kvp.first);
             if (it == this->options.end())
-                this->options[kvp.first].reset(kvp.second->clone());
+                this->options.emplace_hint(it, kvp.first, kvp.second.copy());
             else {
-                assert(it->second->type() == kvp.second->type());
-                if (it->second->type() == kvp.second->type())
-                    *it->second = *kvp.second;
+                assert(it->second.get()->type() == kvp.second.get()->type());
+                if (it->second.get()->type() == kvp.second.get()->type() && ! it->second.shared)
+                    // Owned value, assign in place, so that the pointers to it stay valid.
+                    // ConfigOption::operator=() would only assign the base class, set() copies the value.
+                    it->second.get()->set(kvp.second.get());
                 else
-                    it->second.reset(kvp.second->clone());
+                    // Shared value of this config, it must not be modified: point to rhs' value or its clone.
+                    it->second = kvp.second.copy();
             }
         }
         return *this;
@@ -2175,7 +2181,7 @@ public:
             if (it == this->options.end()) {
                 this->options.insert(std::make_pair(kvp.first, std::move(kvp.second)));
             } else {
-                assert(it->second->type() == kvp.second->type());
+                assert(it->second.get()->type() == kvp.second.get()->type());
                 it->second = std::move(kvp.second);
             }
         }
@@ -2227,21 +2233,22 @@ public:
     // This DynamicConfig will take ownership of opt.
     // Be careful, as this method does not test the existence of opt_key in this->def().
     bool                    set_key_value(const std::string &opt_key, ConfigOption *opt)
-    {
-        auto it = this->options.find(opt_key);
-        if (it == this->options.end()) {
-            this->options[opt_key].reset(opt);
-            return true;
-        } else {
-            it->second.reset(opt);
-            return false;
-        }
-    }
+        { return this->set_option_value(opt_key, OptionValue(opt)); }
+    // Set a value shared with other DynamicConfigs for an opt_key. Returns true if the value did not exist yet.
+    // The value is immutable, it is cloned by the first access to it through the non-const optptr().
+    bool                    set_key_value(const std::string &opt_key, std::shared_ptr<const ConfigOption> opt)
+        { return this->set_option_value(opt_key, OptionValue(std::move(opt))); }
+    // Returns the value of opt_key to be shared with other DynamicConfigs, or nullptr if the option does not exist.
+    // From now on the value is immutable and it is cloned by the first access to it through the non-const optptr(),
+    // therefore pointers to it obtained through the non-const optptr() before shall no more be used to modify it.
+    std::shared_ptr<const ConfigOption> share_option(const t_config_option_key &opt_key);
+    // Share the values of all options with the copies of this DynamicConfig instead of cloning them, see share_option().
+    void                    share_options();
 
     std::string&        opt_string(const t_config_option_key &opt_key, bool create = false)     { return this->option<ConfigOptionString>(opt_key, create)->value; }
-    const std::string&  opt_string(const t_config_option_key &opt_key) const                    { return const_cast<DynamicConfig*>(this)->opt_string(opt_key); }
+    const std::string&  opt_string(const t_config_option_key &opt_key) const                    { return this->option<ConfigOptionString>(opt_key)->value; }
     std::string&        opt_string(const t_config_option_key &opt_key, unsigned int idx)        { return this->option<ConfigOptionStrings>(opt_key)->get_at(idx); }
-    const std::string&  opt_string(const t_config_option_key &opt_key, unsigned int idx) const  { return const_cast<DynamicConfig*>(this)->opt_string(opt_key, idx); }
+    const std::string&  opt_string(const t_config_option_key &opt_key, unsigned int idx) const  { return this->option<ConfigOptionStrings>(opt_key)->get_at(idx); }
 
     double&             opt_float(const t_config_option_key &opt_key)                           { return this->option<ConfigOptionFloat>(opt_key)->value; }
     const double&       opt_float(const t_config_option_key &opt_key) const                     { return dynamic_cast<const ConfigOptionFloat*>(this->option(opt_key))->value; }
@@ -2267,12 +2274,72 @@ public:
     void                read_cli(const std::vector<std::string> &tokens, t_config_option_keys* extra, t_config_option_keys* keys = nullptr);
     bool                read_cli(int argc, const char* const argv[], t_config_option_keys* extra, t_config_option_keys* keys = nullptr);
 
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>>::const_iterator cbegin() const { return options.cbegin(); }
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>>::const_iterator cend()   const { return options.cend(); }
-    size_t                        												 size()   const { return options.size(); }
+private:
+    // Value of an option, either owned by this DynamicConfig or shared with other DynamicConfigs.
+    // A shared value is immutable: the non-const optptr() replaces it with a clone owned by this DynamicConfig (copy on write).
+    // An owned value may be modified through the pointers returned by the non-const optptr(), thus it is cloned
+    // when this DynamicConfig is copied.
+    struct OptionValue
+    {
+        OptionValue() = default;
+        explicit OptionValue(ConfigOption *opt) : ptr(opt) {}
+        explicit OptionValue(std::shared_ptr<const ConfigOption> opt) : ptr(std::const_pointer_cast<ConfigOption>(std::move(opt))), shared(true) {}
+
+        ConfigOption*                   get() const { return ptr.get(); }
+        // Value to be stored into a copy of the DynamicConfig.
+        OptionValue                     copy() const { return shared ? *this : OptionValue(ptr->clone()); }
+
+        std::shared_ptr<ConfigOption>   ptr;
+        bool                            shared { false };
+
+        template<class Archive> void serialize(Archive &ar) { ar(ptr, shared); }
+    };
+
+    bool                    set_option_value(const std::string &opt_key, OptionValue &&value)
+    {
+        auto it = this->options.find(opt_key);
+        if (it == this->options.end()) {
+            this->options.emplace_hint(it, opt_key, std::move(value));
+            return true;
+        } else {
+            it->second = std::move(value);
+            return false;
+        }
+    }
+
+public:
+    // Iterator over the options, dereferences to pairs of the option key and of the read only option value.
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::pair<const t_config_option_key&, const ConfigOption*>;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = value_type;
+        struct pointer {
+            value_type          value;
+            const value_type*   operator->() const { return &value; }
+        };
+
+        reference       operator*()  const { return { m_it->first, m_it->second.get() }; }
+        pointer         operator->() const { return { **this }; }
+        const_iterator& operator++() { ++ m_it; return *this; }
+        const_iterator  operator++(int) { const_iterator out = *this; ++ m_it; return out; }
+        bool            operator==(const const_iterator &rhs) const { return m_it == rhs.m_it; }
+        bool            operator!=(const const_iterator &rhs) const { return m_it != rhs.m_it; }
+
+    private:
+        friend class DynamicConfig;
+        explicit const_iterator(std::map<t_config_option_key, OptionValue>::const_iterator it) : m_it(it) {}
+        std::map<t_config_option_key, OptionValue>::const_iterator m_it;
+    };
+
+    const_iterator  cbegin() const { return const_iterator(options.cbegin()); }
+    const_iterator  cend()   const { return const_iterator(options.cend()); }
+    size_t          size()   const { return options.size(); }
 
 private:
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>> options;
+    std::map<t_config_option_key, OptionValue> options;
 
 	friend class cereal::access;
 	template<class Archive> void serialize(Archive &ar) { ar(options); }
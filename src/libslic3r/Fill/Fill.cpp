@@ -628,6 +628,10 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
 // Create ironing extrusions over top surfaces.
 void Layer::make_ironing()
 {
+    // The fills of this layer may have been kept from a previous run, see PrintObject::infill().
+    for (LayerRegion *layerm : m_regions)
+        layerm->ironings.clear();
+
     // LayerRegion::slices contains surfaces marked with SurfaceType.
     // Here we want to collect top surfaces extruded with the same extruder.
     // A surface will be ironed with the same extruder to not contaminate the print with another material leaking from the nozzle.
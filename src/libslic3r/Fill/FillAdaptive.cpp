@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>
+#include <deque>
 #include <numeric>
 
 // Boost pool: Don't use mutexes to synchronize memory allocation.
@@ -25,6 +26,8 @@
 #include <boost/geometry/geometries/segment.hpp>
 #include <boost/geometry/index/rtree.hpp>
 
+#include <tbb/parallel_for.h>
+
 
 namespace Slic3r {
 namespace FillAdaptive {
@@ -259,6 +262,8 @@ struct Octree
     // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
     // perfect for building up our octree.
     boost::object_pool<Cube>    pool;
+    // The subtrees below the top of the octree are built in parallel, each allocating from its own pool.
+    std::deque<boost::object_pool<Cube>> subtree_pools;
     Cube*                       root_cube { nullptr };
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
@@ -266,7 +271,11 @@ struct Octree
     Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
         : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
 
-    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+    // Bounding box of a child cube of current_cube, current_cube is at depth.
+    BoundingBoxf3 child_bbox(const Cube *current_cube, const BoundingBoxf3 &current_bbox, size_t child_idx) const;
+    Vec3d         child_center(const Cube *current_cube, size_t child_idx, int depth) const
+        { return current_cube->center + (child_centers[child_idx] * (this->cubes_properties[depth - 1].edge_length / 2.)); }
+    void          insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth, boost::object_pool<Cube> &pool);
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -1458,14 +1467,28 @@ static void transform_center(Cube *current_cube, const Eigen::Matrix3d &rot)
             transform_center(child, rot);
 }
 
-OctreePtr build_octree(
-    // Mesh is rotated to the coordinate system of the octree.
+// Subtree of the octree and the triangles intersecting its bounding box, to be inserted into it.
+struct OctreeSubtree
+{
+    Cube                    *cube;
+    BoundingBoxf3            bbox;
+    int                      depth;
+    std::vector<uint32_t>    triangles;
+};
+
+// Minimum number of subtrees to split the top of the octree into to build them in parallel.
+static constexpr size_t octree_parallel_subtrees_min = 64;
+// Number of triangles distributed to the children of a subtree by a single task.
+static constexpr size_t octree_split_block_size = 65536;
+
+static OctreePtr build_octree(
     const indexed_triangle_set  &triangle_mesh,
-    // Overhang triangles extracted from fill surfaces with stInternalBridge type,
-    // rotated to the coordinate system of the octree.
     const std::vector<Vec3d>    &overhang_triangles, 
     coordf_t                     line_spacing,
-    bool                         support_overhangs_only)
+    bool                         support_overhangs_only,
+    // Minimum number of subtrees to split the top of the octree into. With 1, the triangles are inserted
+    // one by one from the root cube.
+    size_t                       parallel_subtrees_min)
 {
     assert(line_spacing > 0);
     assert(! std::isnan(line_spacing));
@@ -1476,27 +1499,95 @@ OctreePtr build_octree(
     auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
 
     if (cubes_properties.size() > 1) {
-        Octree *octree_ptr = octree.get();
         double edge_length_half = 0.5 * cubes_properties.back().edge_length;
         Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
         int    max_depth = int(cubes_properties.size()) - 1;
-        auto process_triangle = [octree_ptr, max_depth, diag_half](const Vec3d &a, const Vec3d &b, const Vec3d &c) {
-            octree_ptr->insert_triangle(
-                a, b, c,
-                octree_ptr->root_cube,
-                BoundingBoxf3(octree_ptr->root_cube->center - diag_half, octree_ptr->root_cube->center + diag_half),
-                max_depth);
+        // Triangles are referenced by their index, the mesh triangles are followed by the overhang triangles.
+        const size_t num_mesh_triangles = triangle_mesh.indices.size();
+        assert(num_mesh_triangles + overhang_triangles.size() / 3 < size_t(std::numeric_limits<uint32_t>::max()));
+        auto triangle = [&triangle_mesh, &overhang_triangles, num_mesh_triangles](uint32_t idx) {
+            if (idx < num_mesh_triangles) {
+                const stl_triangle_vertex_indices &tri = triangle_mesh.indices[idx];
+                return std::array<Vec3d, 3>{ triangle_mesh.vertices[tri[0]].cast<double>(), triangle_mesh.vertices[tri[1]].cast<double>(), triangle_mesh.vertices[tri[2]].cast<double>() };
+            }
+            size_t i = 3 * (idx - num_mesh_triangles);
+            return std::array<Vec3d, 3>{ overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2] };
         };
+        std::vector<uint32_t> triangles;
+        triangles.reserve(num_mesh_triangles + overhang_triangles.size() / 3);
         auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
-        for (auto &tri : triangle_mesh.indices) {
-            auto a = triangle_mesh.vertices[tri[0]].cast<double>();
-            auto b = triangle_mesh.vertices[tri[1]].cast<double>();
-            auto c = triangle_mesh.vertices[tri[2]].cast<double>();
+        for (uint32_t idx = 0; idx < uint32_t(num_mesh_triangles); ++ idx) {
+            auto [a, b, c] = triangle(idx);
             if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
-                process_triangle(a, b, c);
+                triangles.emplace_back(idx);
         }
         for (size_t i = 0; i < overhang_triangles.size(); i += 3)
-            process_triangle(overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2]);
+            triangles.emplace_back(uint32_t(num_mesh_triangles + i / 3));
+
+        // Split the top of the octree into subtrees, each receiving the triangles intersecting its bounding box
+        // the same way insert_triangle() would, until there are enough subtrees to be built in parallel.
+        // A triangle ends up in the same cubes as if inserted from the root, thus the octree does not depend on the split.
+        std::vector<OctreeSubtree> subtrees;
+        subtrees.push_back({ octree->root_cube, BoundingBoxf3(octree->root_cube->center - diag_half, octree->root_cube->center + diag_half), max_depth, std::move(triangles) });
+        while (! subtrees.empty() && subtrees.size() < parallel_subtrees_min && subtrees.front().depth > 1) {
+            // Triangles of the subtrees are distributed to the children in blocks processed in parallel.
+            struct SplitBlock {
+                size_t                                  subtree_idx;
+                size_t                                  begin;
+                size_t                                  end;
+                std::array<std::vector<uint32_t>, 8>    child_triangles;
+            };
+            std::vector<SplitBlock> blocks;
+            for (size_t i = 0; i < subtrees.size(); ++ i)
+                for (size_t begin = 0; begin < subtrees[i].triangles.size(); begin += octree_split_block_size)
+                    blocks.push_back({ i, begin, std::min(begin + octree_split_block_size, subtrees[i].triangles.size()) });
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size(), 1), [&octree, &subtrees, &triangle, &blocks](const tbb::blocked_range<size_t> &range) {
+                for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+                    SplitBlock                  &block   = blocks[block_idx];
+                    const OctreeSubtree         &subtree = subtrees[block.subtree_idx];
+                    std::array<BoundingBoxf3, 8> bboxes;
+                    for (size_t i = 0; i < 8; ++ i)
+                        bboxes[i] = octree->child_bbox(subtree.cube, subtree.bbox, i);
+                    for (size_t j = block.begin; j < block.end; ++ j) {
+                        uint32_t idx = subtree.triangles[j];
+                        auto [a, b, c] = triangle(idx);
+                        for (size_t i = 0; i < 8; ++ i)
+                            if (triangle_AABB_intersects(a, b, c, bboxes[i]))
+                                block.child_triangles[i].emplace_back(idx);
+                    }
+                }
+            });
+            std::vector<OctreeSubtree> children;
+            for (auto it_block = blocks.begin(); it_block != blocks.end();) {
+                const OctreeSubtree &subtree      = subtrees[it_block->subtree_idx];
+                auto                 it_block_end = std::find_if(it_block, blocks.end(), [it_block](const SplitBlock &block) { return block.subtree_idx != it_block->subtree_idx; });
+                for (size_t i = 0; i < 8; ++ i) {
+                    std::vector<uint32_t> child_triangles;
+                    for (auto it = it_block; it != it_block_end; ++ it)
+                        append(child_triangles, std::move(it->child_triangles[i]));
+                    if (! child_triangles.empty()) {
+                        Cube *child = octree->pool.construct(octree->child_center(subtree.cube, i, subtree.depth));
+                        subtree.cube->children[i] = child;
+                        children.push_back({ child, octree->child_bbox(subtree.cube, subtree.bbox, i), subtree.depth - 1, std::move(child_triangles) });
+                    }
+                }
+                it_block = it_block_end;
+            }
+            subtrees = std::move(children);
+        }
+
+        for (size_t i = 0; i < subtrees.size(); ++ i)
+            octree->subtree_pools.emplace_back();
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, subtrees.size(), 1), [&octree, &subtrees, &triangle](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                const OctreeSubtree      &subtree = subtrees[i];
+                boost::object_pool<Cube> &pool    = octree->subtree_pools[i];
+                for (uint32_t idx : subtree.triangles) {
+                    auto [a, b, c] = triangle(idx);
+                    octree->insert_triangle(a, b, c, subtree.cube, subtree.bbox, subtree.depth, pool);
+                }
+            }
+        });
         {
             // Transform the octree to world coordinates to reduce computation when extracting infill lines.
             auto rot = transform_to_world().toRotationMatrix();
@@ -1508,35 +1599,81 @@ OctreePtr build_octree(
     return octree;
 }
 
-void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
+OctreePtr build_octree(
+    // Mesh is rotated to the coordinate system of the octree.
+    const indexed_triangle_set  &triangle_mesh,
+    // Overhang triangles extracted from fill surfaces with stInternalBridge type,
+    // rotated to the coordinate system of the octree.
+    const std::vector<Vec3d>    &overhang_triangles, 
+    coordf_t                     line_spacing,
+    bool                         support_overhangs_only)
+{
+    return build_octree(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only, octree_parallel_subtrees_min);
+}
+
+OctreePtr build_octree_sequential(
+    const indexed_triangle_set  &triangle_mesh,
+    const std::vector<Vec3d>    &overhang_triangles, 
+    coordf_t                     line_spacing,
+    bool                         support_overhangs_only)
+{
+    return build_octree(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only, 1);
+}
+
+static void collect_leaf_centers(const Cube *cube, std::vector<Vec3d> &out)
+{
+    bool leaf = true;
+    for (const Cube *child : cube->children)
+        if (child) {
+            leaf = false;
+            collect_leaf_centers(child, out);
+        }
+    if (leaf)
+        out.emplace_back(cube->center);
+}
+
+std::vector<Vec3d> octree_leaf_centers(const Octree &octree)
+{
+    std::vector<Vec3d> out;
+    collect_leaf_centers(octree.root_cube, out);
+    std::sort(out.begin(), out.end(), [](const Vec3d &a, const Vec3d &b) { return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3); });
+    return out;
+}
+
+BoundingBoxf3 Octree::child_bbox(const Cube *current_cube, const BoundingBoxf3 &current_bbox, size_t child_idx) const
+{
+    const Vec3d &child_center_dir = child_centers[child_idx];
+    // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
+    // We will rather densify the octree a bit more than necessary instead of missing a triangle.
+    BoundingBoxf3 bbox;
+    for (int k = 0; k < 3; ++ k) {
+        if (child_center_dir[k] == -1.) {
+            bbox.min[k] = current_bbox.min[k];
+            bbox.max[k] = current_cube->center[k] + EPSILON;
+        } else {
+            bbox.min[k] = current_cube->center[k] - EPSILON;
+            bbox.max[k] = current_bbox.max[k];
+        }
+    }
+    return bbox;
+}
+
+void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth, boost::object_pool<Cube> &pool)
 {
     assert(current_cube);
     assert(depth > 0);
 
     // Squared radius of a sphere around the child cube.
-    const double r2_cube = Slic3r::sqr(0.5 * this->cubes_properties[-- depth].height + EPSILON);
+    const double r2_cube = Slic3r::sqr(0.5 * this->cubes_properties[depth - 1].height + EPSILON);
 
     for (size_t i = 0; i < 8; ++ i) {
-        const Vec3d &child_center_dir = child_centers[i];
-        // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
-        // We will rather densify the octree a bit more than necessary instead of missing a triangle.
-        BoundingBoxf3 bbox;
-        for (int k = 0; k < 3; ++ k) {
-            if (child_center_dir[k] == -1.) {
-                bbox.min[k] = current_bbox.min[k];
-                bbox.max[k] = current_cube->center[k] + EPSILON;
-            } else {
-                bbox.min[k] = current_cube->center[k] - EPSILON;
-                bbox.max[k] = current_bbox.max[k];
-            }
-        }
-        Vec3d child_center = current_cube->center + (child_center_dir * (this->cubes_properties[depth].edge_length / 2.));
+        BoundingBoxf3 bbox = this->child_bbox(current_cube, current_bbox, i);
         //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
         if (triangle_AABB_intersects(a, b, c, bbox)) {
             if (! current_cube->children[i])
-                current_cube->children[i] = this->pool.construct(child_center);
-            if (depth > 0)
-                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
+                current_cube->children[i] = pool.construct(this->child_center(current_cube, i, depth));
+            if (depth > 1)
+                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth - 1, pool);
         }
     }
 }
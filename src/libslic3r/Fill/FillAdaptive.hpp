@@ -48,6 +48,17 @@ FillAdaptive::OctreePtr         build_octree(
     // If true, octree is densified below internal overhangs only.
     bool                         support_overhangs_only);
 
+// The same octree as build_octree(), built by inserting the triangles one by one from the root, single threaded.
+// Reference for testing.
+FillAdaptive::OctreePtr         build_octree_sequential(
+    const indexed_triangle_set  &triangle_mesh,
+    const std::vector<Vec3d>    &overhang_triangles, 
+    coordf_t                     line_spacing, 
+    bool                         support_overhangs_only);
+
+// Centers of the leaf cubes of the octree in world coordinates, sorted lexicographically.
+std::vector<Vec3d>              octree_leaf_centers(const Octree &octree);
+
 //
 // Some of the algorithms used by class FillAdaptive were inspired by
 // Cura Engine's class SubDivCube
@@ -12,7 +12,13 @@
 
 #include "3mf.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iomanip>
 #include <limits>
+#include <locale>
+#include <sstream>
 #include <stdexcept>
 
 #include <boost/algorithm/string/classification.hpp>
@@ -32,6 +38,12 @@ namespace pt = boost::property_tree;
 #include <Eigen/Dense>
 #include "miniz_extension.hpp"
 
+#if __has_include(<charconv>)
+    #include <charconv>
+#endif
+
+#include <tbb/task_group.h>
+
 // VERSION NUMBERS
 // 0 : .3mf, files saved by older slic3r or other applications. No version definition in them.
 // 1 : Introduction of 3mf versioning. No other change in data saved into 3mf files.
@@ -177,6 +189,164 @@ bool get_attribute_value_bool(const char** attributes, unsigned int attributes_s
     return (text != nullptr) ? (bool)::atoi(text) : true;
 }
 
+// Same as get_attribute_value_float() for an attribute value which is not null terminated.
+static float get_value_float(const char* begin, const char* end)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    double value;
+    auto [ptr, ec] = std::from_chars(begin, end, value);
+    if (ec == std::errc() && ptr == end)
+        return (float)value;
+#endif
+    // Leading whitespaces, plus sign, hexadecimal notation, trailing garbage...
+    return (float)::atof(std::string(begin, end).c_str());
+}
+
+// Same as get_attribute_value_int() for an attribute value which is not null terminated.
+static int get_value_int(const char* begin, const char* end)
+{
+#if __has_include(<charconv>)
+    int value;
+    auto [ptr, ec] = std::from_chars(begin, end, value);
+    if (ec == std::errc() && ptr == end)
+        return value;
+#endif
+    return ::atoi(std::string(begin, end).c_str());
+}
+
+// Follows the markup of a XML stream passed chunk by chunk to find the start tags of the <vertices> and <triangles>
+// elements, skipping the comments, CDATA sections, declarations and processing instructions.
+class MeshSectionFinder
+{
+public:
+    // Advances it up to the end of the first start tag of a mesh section found in [it, end) and returns true,
+    // or advances it to end and returns false.
+    bool find(const char*& it, const char* end)
+    {
+        for (; it != end; ++it) {
+            const char c = *it;
+            switch (m_state) {
+            case State::Text:
+                if (c == '<')
+                    m_state = State::Markup;
+                break;
+            case State::Markup:
+                m_count = 0;
+                if (c == '!')
+                    m_state = State::Bang;
+                else if (c == '?') {
+                    m_state = State::ProcessingInstruction;
+                    m_last  = 0;
+                } else if (c == '/')
+                    m_state = State::EndTag;
+                else {
+                    m_state = State::StartTagName;
+                    m_name_len = 0;
+                    m_name[m_name_len++] = c;
+                }
+                break;
+            case State::StartTagName:
+                if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != '/' && c != '>') {
+                    // Longer names are not of interest.
+                    m_name_len = std::min(m_name_len + 1, sizeof(m_name));
+                    m_name[m_name_len - 1] = c;
+                    break;
+                }
+                m_state = State::StartTag;
+                m_last = 0;
+                [[fallthrough]];
+            case State::StartTag:
+                if (c == '"' || c == '\'') {
+                    m_quote = c;
+                    m_state = State::StartTagQuoted;
+                } else if (c == '>') {
+                    m_state = State::Text;
+                    if (m_last != '/' && (is_name("vertices") || is_name("triangles"))) {
+                        ++it;
+                        return true;
+                    }
+                } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+                    m_last = c;
+                break;
+            case State::StartTagQuoted:
+                if (c == m_quote) {
+                    m_state = State::StartTag;
+                    m_last = c;
+                }
+                break;
+            case State::EndTag:
+                if (c == '>')
+                    m_state = State::Text;
+                break;
+            case State::Bang:
+                // "<!--" starts a comment, "<![" a CDATA section, anything else a declaration.
+                if (c == '-' && ++m_count == 2) {
+                    m_state = State::Comment;
+                    m_count = 0;
+                } else if (c == '[' && m_count == 0)
+                    m_state = State::CData;
+                else if (c != '-') {
+                    m_state = State::Declaration;
+                    m_count = 0;
+                    if (c == '[')
+                        ++m_count;
+                }
+                break;
+            case State::Comment:
+                // "-->" ends the comment.
+                if (c == '>' && m_count >= 2)
+                    m_state = State::Text;
+                m_count = (c == '-') ? m_count + 1 : 0;
+                break;
+            case State::CData:
+                // "]]>" ends the CDATA section.
+                if (c == '>' && m_count >= 2)
+                    m_state = State::Text;
+                m_count = (c == ']') ? m_count + 1 : 0;
+                break;
+            case State::Declaration:
+                // m_count is the depth of the internal subset of a document type declaration.
+                if (c == '"' || c == '\'') {
+                    m_quote = c;
+                    m_state = State::DeclarationQuoted;
+                } else if (c == '[')
+                    ++m_count;
+                else if (c == ']' && m_count > 0)
+                    --m_count;
+                else if (c == '>' && m_count == 0)
+                    m_state = State::Text;
+                break;
+            case State::DeclarationQuoted:
+                if (c == m_quote)
+                    m_state = State::Declaration;
+                break;
+            case State::ProcessingInstruction:
+                // "?>" ends the processing instruction.
+                if (c == '>' && m_last == '?')
+                    m_state = State::Text;
+                m_last = c;
+                break;
+            }
+        }
+        return false;
+    }
+
+private:
+    enum class State : unsigned char {
+        Text, Markup, StartTagName, StartTag, StartTagQuoted, EndTag, Bang, Comment, CData, Declaration, DeclarationQuoted, ProcessingInstruction
+    };
+
+    bool is_name(const char* name) const { return ::strlen(name) == m_name_len && ::memcmp(name, m_name, m_name_len) == 0; }
+
+    State  m_state { State::Text };
+    char   m_quote { 0 };
+    char   m_last { 0 };
+    size_t m_count { 0 };
+    // Only long enough for the names of the mesh sections.
+    char   m_name[10];
+    size_t m_name_len { 0 };
+};
+
 Slic3r::Transform3d get_transform_from_3mf_specs_string(const std::string& mat_str)
 {
     // check: https://3mf.io/3d-manufacturing-format/ or https://github.com/3MFConsortium/spec_core/blob/master/3MF%20Core%20Specification.md
@@ -294,8 +464,10 @@ namespace Slic3r {
         {
             std::vector<float> vertices;
             std::vector<unsigned int> triangles;
-            std::vector<std::string> custom_supports;
-            std::vector<std::string> custom_seam;
+            // Painted facets of the triangles, indexed by the triangle index and sorted.
+            // Most triangles are not painted, only the non empty strings are kept.
+            std::vector<std::pair<unsigned int, std::string>> custom_supports;
+            std::vector<std::pair<unsigned int, std::string>> custom_seam;
 
             bool empty()
             {
@@ -409,6 +581,10 @@ namespace Slic3r {
         // after returning from XML_Parse() function, thus we keep the error state here.
         bool m_parse_error { false };
         std::string m_parse_error_message;
+        // Mesh section being parsed and offset of the end of its start tag in the data passed to expat.
+        enum class MeshSection : unsigned char { None, Vertices, Triangles };
+        MeshSection m_mesh_section { MeshSection::None };
+        XML_Index m_mesh_section_offset { 0 };
         Model* m_model;
         float m_unit_factor;
         CurrentObject m_curr_object;
@@ -447,6 +623,28 @@ namespace Slic3r {
 
         bool _load_model_from_file(const std::string& filename, Model& model, DynamicPrintConfig& config, ConfigSubstitutionContext& config_substitutions);
         bool _extract_model_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
+
+        // Feeding of the model file to expat chunk by chunk. The <vertex> and <triangle> elements, which make most of a model file,
+        // are scanned directly into the current geometry, the rest is left to expat together with anything not expected there.
+        struct ModelFileFeed
+        {
+            _3MF_Importer& importer;
+            const mz_zip_archive_file_stat& stat;
+            MeshSectionFinder finder;
+            // Bytes passed to expat so far.
+            XML_Index offset { 0 };
+            // Scanning the content of a mesh section.
+            bool scanning { false };
+            // Incomplete element at the end of the last chunk, while scanning.
+            std::string pending;
+
+            ModelFileFeed(_3MF_Importer& importer, const mz_zip_archive_file_stat& stat) : importer(importer), stat(stat) {}
+        };
+        enum class MeshElementScan : unsigned char { Parsed, Incomplete, Unexpected };
+
+        void _feed_model_data(ModelFileFeed& feed, const char* data, size_t size, bool last);
+        void _feed_xml_parser(ModelFileFeed& feed, const char* data, size_t size, bool last);
+        MeshElementScan _scan_mesh_element(const char*& it, const char* end);
         void _extract_layer_heights_profile_config_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
         void _extract_layer_config_ranges_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat, ConfigSubstitutionContext& config_substitutions);
         void _extract_sla_support_points_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
@@ -850,31 +1048,18 @@ namespace Slic3r {
         XML_SetElementHandler(m_xml_parser, _3MF_Importer::_handle_start_model_xml_element, _3MF_Importer::_handle_end_model_xml_element);
         XML_SetCharacterDataHandler(m_xml_parser, _3MF_Importer::_handle_model_xml_characters);
 
-        struct CallbackData
-        {
-            XML_Parser& parser;
-            _3MF_Importer& importer;
-            const mz_zip_archive_file_stat& stat;
-
-            CallbackData(XML_Parser& parser, _3MF_Importer& importer, const mz_zip_archive_file_stat& stat) : parser(parser), importer(importer), stat(stat) {}
-        };
-
-        CallbackData data(m_xml_parser, *this, stat);
+        ModelFileFeed feed(*this, stat);
+        m_mesh_section = MeshSection::None;
 
         mz_bool res = 0;
 
         try
         {
             res = mz_zip_reader_extract_file_to_callback(&archive, stat.m_filename, [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
-                CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.parse_error()) {
-                    char error_buf[1024];
-                    ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", data->importer.parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
-                    throw Slic3r::FileIOError(error_buf);
-                }
-
+                ModelFileFeed* feed = (ModelFileFeed*)pOpaque;
+                feed->importer._feed_model_data(*feed, (const char*)pBuf, n, file_ofs + n == feed->stat.m_uncomp_size);
                 return n;
-                }, &data, 0);
+                }, &feed, 0);
         }
         catch (const version_error& e)
         {
@@ -896,6 +1081,157 @@ namespace Slic3r {
         return true;
     }
 
+    void _3MF_Importer::_feed_model_data(ModelFileFeed& feed, const char* data, size_t size, bool last)
+    {
+        // An element split between two chunks is completed with the new chunk.
+        const bool  from_pending = ! feed.pending.empty();
+        if (from_pending) {
+            feed.pending.append(data, size);
+            data = feed.pending.data();
+            size = feed.pending.size();
+        }
+        const char* it  = data;
+        const char* end = data + size;
+        while (it != end) {
+            if (feed.scanning) {
+                while (it != end && (*it == ' ' || *it == '\t' || *it == '\r' || *it == '\n'))
+                    ++it;
+                if (it == end)
+                    break;
+                if (*it == '<') {
+                    MeshElementScan scan = _scan_mesh_element(it, end);
+                    if (scan == MeshElementScan::Parsed)
+                        continue;
+                    if (scan == MeshElementScan::Incomplete && ! last)
+                        break;
+                }
+                // The end tag of the section, or anything unexpected: expat takes over up to the next mesh section.
+                feed.scanning = false;
+            } else {
+                const char* begin = it;
+                bool        found = feed.finder.find(it, end);
+                _feed_xml_parser(feed, begin, it - begin, false);
+                // Make sure that expat just parsed the start tag found.
+                feed.scanning = found && m_mesh_section != MeshSection::None && m_mesh_section_offset == feed.offset;
+            }
+        }
+        if (from_pending)
+            feed.pending.erase(0, it - data);
+        else
+            feed.pending.assign(it, end);
+        if (last)
+            _feed_xml_parser(feed, "", 0, true);
+    }
+
+    void _3MF_Importer::_feed_xml_parser(ModelFileFeed& feed, const char* data, size_t size, bool last)
+    {
+        if (!XML_Parse(m_xml_parser, data, (int)size, last ? 1 : 0) || parse_error()) {
+            char error_buf[1024];
+            ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", parse_error_message(), feed.stat.m_filename, (int)XML_GetCurrentLineNumber(m_xml_parser));
+            throw Slic3r::FileIOError(error_buf);
+        }
+        feed.offset += XML_Index(size);
+    }
+
+    _3MF_Importer::MeshElementScan _3MF_Importer::_scan_mesh_element(const char*& it, const char* end)
+    {
+        auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+
+        // Same as the handling of the elements by expat, for the <vertex x="" y="" z=""/> and
+        // <triangle v1="" v2="" v3="" slic3rpe:custom_supports="" slic3rpe:custom_seam=""/> elements.
+        const bool  vertex = m_mesh_section == MeshSection::Vertices;
+        const char* tag    = vertex ? VERTEX_TAG : TRIANGLE_TAG;
+        const char* p      = it + 1;
+        for (; *tag != 0; ++tag, ++p) {
+            if (p == end)
+                return MeshElementScan::Incomplete;
+            if (*p != *tag)
+                return MeshElementScan::Unexpected;
+        }
+
+        static constexpr size_t MAX_VALUES = 5;
+        const char* keys[MAX_VALUES] = { X_ATTR, Y_ATTR, Z_ATTR, nullptr, nullptr };
+        if (! vertex) {
+            keys[0] = V1_ATTR;
+            keys[1] = V2_ATTR;
+            keys[2] = V3_ATTR;
+            keys[3] = CUSTOM_SUPPORTS_ATTR;
+            keys[4] = CUSTOM_SEAM_ATTR;
+        }
+        std::pair<const char*, const char*> values[MAX_VALUES];
+        for (;;) {
+            if (p == end)
+                return MeshElementScan::Incomplete;
+            if (*p == '/') {
+                if (++p == end)
+                    return MeshElementScan::Incomplete;
+                if (*p != '>')
+                    return MeshElementScan::Unexpected;
+                ++p;
+                break;
+            }
+            // Attributes are separated by whitespaces.
+            if (! is_space(*p))
+                return MeshElementScan::Unexpected;
+            while (p != end && is_space(*p))
+                ++p;
+            if (p == end)
+                return MeshElementScan::Incomplete;
+            if (*p == '/')
+                continue;
+            const char* name_begin = p;
+            while (p != end && *p != '=' && ! is_space(*p) && *p != '/' && *p != '>')
+                ++p;
+            const char* name_end = p;
+            while (p != end && is_space(*p))
+                ++p;
+            if (p == end)
+                return MeshElementScan::Incomplete;
+            if (name_begin == name_end || *p != '=')
+                return MeshElementScan::Unexpected;
+            ++p;
+            while (p != end && is_space(*p))
+                ++p;
+            if (p == end)
+                return MeshElementScan::Incomplete;
+            const char quote = *p;
+            if (quote != '"' && quote != '\'')
+                return MeshElementScan::Unexpected;
+            const char* value_begin = ++p;
+            for (; p != end && *p != quote; ++p)
+                // Entity and character references and whitespaces to be normalized.
+                if (*p == '&' || *p == '<' || *p == '\t' || *p == '\r' || *p == '\n')
+                    return MeshElementScan::Unexpected;
+            if (p == end)
+                return MeshElementScan::Incomplete;
+            const char* value_end = p++;
+            for (size_t i = 0; i < MAX_VALUES; ++i)
+                if (keys[i] != nullptr && ::strncmp(keys[i], name_begin, name_end - name_begin) == 0 && keys[i][name_end - name_begin] == 0) {
+                    if (values[i].first != nullptr)
+                        // Duplicate attribute, let expat report it.
+                        return MeshElementScan::Unexpected;
+                    values[i] = { value_begin, value_end };
+                    break;
+                }
+        }
+        it = p;
+
+        // missing values are set equal to ZERO
+        if (vertex) {
+            for (size_t i = 0; i < 3; ++i)
+                m_curr_object.geometry.vertices.push_back(m_unit_factor * (values[i].first ? get_value_float(values[i].first, values[i].second) : 0.0f));
+        } else {
+            for (size_t i = 0; i < 3; ++i)
+                m_curr_object.geometry.triangles.push_back((unsigned int)(values[i].first ? get_value_int(values[i].first, values[i].second) : 0));
+            const unsigned int triangle_idx = (unsigned int)(m_curr_object.geometry.triangles.size() / 3 - 1);
+            if (values[3].first != values[3].second)
+                m_curr_object.geometry.custom_supports.emplace_back(triangle_idx, std::string(values[3].first, values[3].second));
+            if (values[4].first != values[4].second)
+                m_curr_object.geometry.custom_seam.emplace_back(triangle_idx, std::string(values[4].first, values[4].second));
+        }
+        return MeshElementScan::Parsed;
+    }
+
     void _3MF_Importer::_extract_print_config_from_archive(
         mz_zip_archive& archive, 
         const mz_zip_archive_file_stat& stat, 
@@ -1601,12 +1937,14 @@ namespace Slic3r {
     {
         // reset current vertices
         m_curr_object.geometry.vertices.clear();
+        m_mesh_section = MeshSection::Vertices;
+        m_mesh_section_offset = XML_GetCurrentByteIndex(m_xml_parser) + XML_GetCurrentByteCount(m_xml_parser);
         return true;
     }
 
     bool _3MF_Importer::_handle_end_vertices()
     {
-        // do nothing
+        m_mesh_section = MeshSection::None;
         return true;
     }
 
@@ -1630,12 +1968,18 @@ namespace Slic3r {
     {
         // reset current triangles
         m_curr_object.geometry.triangles.clear();
+        m_curr_object.geometry.custom_supports.clear();
+        m_curr_object.geometry.custom_seam.clear();
+        // a closed mesh has twice as many triangles as vertices
+        m_curr_object.geometry.triangles.reserve(2 * m_curr_object.geometry.vertices.size());
+        m_mesh_section = MeshSection::Triangles;
+        m_mesh_section_offset = XML_GetCurrentByteIndex(m_xml_parser) + XML_GetCurrentByteCount(m_xml_parser);
         return true;
     }
 
     bool _3MF_Importer::_handle_end_triangles()
     {
-        // do nothing
+        m_mesh_section = MeshSection::None;
         return true;
     }
 
@@ -1654,8 +1998,13 @@ namespace Slic3r {
         m_curr_object.geometry.triangles.push_back((unsigned int)get_attribute_value_int(attributes, num_attributes, V2_ATTR));
         m_curr_object.geometry.triangles.push_back((unsigned int)get_attribute_value_int(attributes, num_attributes, V3_ATTR));
 
-        m_curr_object.geometry.custom_supports.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR));
-        m_curr_object.geometry.custom_seam.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR));
+        const unsigned int triangle_idx = (unsigned int)(m_curr_object.geometry.triangles.size() / 3 - 1);
+        std::string custom_supports = get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR);
+        if (! custom_supports.empty())
+            m_curr_object.geometry.custom_supports.emplace_back(triangle_idx, std::move(custom_supports));
+        std::string custom_seam = get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR);
+        if (! custom_seam.empty())
+            m_curr_object.geometry.custom_seam.emplace_back(triangle_idx, std::move(custom_seam));
         return true;
     }
 
@@ -1936,6 +2285,7 @@ namespace Slic3r {
         }
 
         unsigned int geo_tri_count = (unsigned int)geometry.triangles.size() / 3;
+        std::vector<int> vertex_map;
 
         for (const ObjectMetadata::VolumeMetadata& volume_data : volumes)
         {
@@ -1958,33 +2308,35 @@ namespace Slic3r {
                 }
             }
 
-            // splits volume out of imported geometry
-			TriangleMesh triangle_mesh;
-            stl_file    &stl             = triangle_mesh.stl;
+            // splits volume out of imported geometry, mapping the object vertices to the vertices of the volume
 			unsigned int triangles_count = volume_data.last_triangle_id - volume_data.first_triangle_id + 1;
-			stl.stats.type = inmemory;
-            stl.stats.number_of_facets = (uint32_t)triangles_count;
-            stl.stats.original_num_facets = (int)stl.stats.number_of_facets;
-            stl_allocate(&stl);
-
             unsigned int src_start_id = volume_data.first_triangle_id * 3;
+            indexed_triangle_set its;
+            its.indices.reserve(triangles_count);
+            vertex_map.assign(geometry.vertices.size() / 3, -1);
 
             for (unsigned int i = 0; i < triangles_count; ++i)
             {
                 unsigned int ii = i * 3;
-                stl_facet& facet = stl.facet_start[i];
+                stl_triangle_vertex_indices face;
                 for (unsigned int v = 0; v < 3; ++v)
                 {
-                    unsigned int tri_id = geometry.triangles[src_start_id + ii + v] * 3;
-                    if (tri_id + 2 >= geometry.vertices.size()) {
+                    unsigned int vertex_id = geometry.triangles[src_start_id + ii + v];
+                    if (vertex_id >= vertex_map.size()) {
                         add_error("Malformed triangle mesh");
                         return false;
                     }
-                    facet.vertex[v] = Vec3f(geometry.vertices[tri_id + 0], geometry.vertices[tri_id + 1], geometry.vertices[tri_id + 2]);
+                    int &dst_vertex_id = vertex_map[vertex_id];
+                    if (dst_vertex_id == -1) {
+                        dst_vertex_id = int(its.vertices.size());
+                        its.vertices.emplace_back(geometry.vertices[vertex_id * 3 + 0], geometry.vertices[vertex_id * 3 + 1], geometry.vertices[vertex_id * 3 + 2]);
+                    }
+                    face(v) = dst_vertex_id;
                 }
+                its.indices.emplace_back(face);
             }
 
-			stl_get_size(&stl);
+			TriangleMesh triangle_mesh(std::move(its));
 			triangle_mesh.repair();
 
 			ModelVolume* volume = object.add_volume(std::move(triangle_mesh));
@@ -1994,15 +2346,13 @@ namespace Slic3r {
             volume->calculate_convex_hull();
 
             // recreate custom supports and seam from previously loaded attribute
-            for (unsigned i=0; i<triangles_count; ++i) {
-                size_t index = src_start_id/3 + i;
-                assert(index < geometry.custom_supports.size());
-                assert(index < geometry.custom_seam.size());
-                if (! geometry.custom_supports[index].empty())
-                    volume->supported_facets.set_triangle_from_string(i, geometry.custom_supports[index]);
-                if (! geometry.custom_seam[index].empty())
-                    volume->seam_facets.set_triangle_from_string(i, geometry.custom_seam[index]);
-            }
+            auto set_painted_facets = [first = volume_data.first_triangle_id, triangles_count](FacetsAnnotation& facets, const std::vector<std::pair<unsigned int, std::string>>& painted) {
+                auto it = std::lower_bound(painted.begin(), painted.end(), first, [](const std::pair<unsigned int, std::string>& p, unsigned int idx) { return p.first < idx; });
+                for (; it != painted.end() && it->first < first + triangles_count; ++it)
+                    facets.set_triangle_from_string(int(it->first - first), it->second);
+            };
+            set_painted_facets(volume->supported_facets, geometry.custom_supports);
+            set_painted_facets(volume->seam_facets, geometry.custom_seam);
 
 
             // apply the remaining volume's metadata
@@ -2119,18 +2469,35 @@ namespace Slic3r {
 
         bool m_fullpath_sources{ true };
 
+        // Archive entry deflated by a background task, done is set once the task finished.
+        struct PendingEntry
+        {
+            std::unique_ptr<MZ_DeflatedEntry> entry;
+            std::string content;
+            std::atomic<bool> done{ false };
+            bool ok{ false };
+
+            explicit PendingEntry(std::unique_ptr<MZ_DeflatedEntry> entry) : entry(std::move(entry)) {}
+        };
+        // The entries are stored into the archive in the order they were added, as soon as they and all the preceding ones are deflated.
+        std::deque<std::unique_ptr<PendingEntry>> m_pending_entries;
+        tbb::task_group m_deflate_tasks;
+
     public:
         bool save_model_to_file(const std::string& filename, Model& model, const DynamicPrintConfig* config, bool fullpath_sources, const ThumbnailData* thumbnail_data = nullptr);
 
     private:
         bool _save_model_to_file(const std::string& filename, Model& model, const DynamicPrintConfig* config, const ThumbnailData* thumbnail_data);
+        bool _add_file_to_archive(mz_zip_archive& archive, const std::string& name, std::string content);
+        bool _add_deflated_entry_to_archive(mz_zip_archive& archive, std::unique_ptr<MZ_DeflatedEntry> entry);
+        bool _store_pending_entries(mz_zip_archive& archive, bool wait);
         bool _add_content_types_file_to_archive(mz_zip_archive& archive);
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(std::stringstream& stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(std::stringstream& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
+        bool _add_object_to_model_stream(MZ_DeflatedEntry& stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_mesh_to_object_stream(MZ_DeflatedEntry& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_build_to_model_stream(MZ_DeflatedEntry& stream, const BuildItemsList& build_items);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_config_ranges_file_to_archive(mz_zip_archive& archive, Model& model, const DynamicPrintConfig& global_config);
         bool _add_sla_support_points_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2151,6 +2518,8 @@ namespace Slic3r {
     {
         mz_zip_archive archive;
         mz_zip_zero_struct(&archive);
+        // Entries still being deflated when bailing out are dropped.
+        ScopeGuard pending_entries_guard([this]() { m_deflate_tasks.wait(); m_pending_entries.clear(); });
 
         if (!open_zip_writer(&archive, filename)) {
             add_error("Unable to open the file");
@@ -2286,6 +2655,14 @@ namespace Slic3r {
             return false;
         }
 
+        // Store the entries still being deflated.
+        if (!_store_pending_entries(archive, true))
+        {
+            close_zip_writer(&archive);
+            boost::filesystem::remove(filename);
+            return false;
+        }
+
         if (!mz_zip_writer_finalize_archive(&archive))
         {
             close_zip_writer(&archive);
@@ -2299,6 +2676,47 @@ namespace Slic3r {
         return true;
     }
 
+    bool _3MF_Exporter::_add_file_to_archive(mz_zip_archive& archive, const std::string& name, std::string content)
+    {
+        // Deflate the content in the background, the archive entries being independent of each other.
+        m_pending_entries.emplace_back(std::make_unique<PendingEntry>(std::make_unique<MZ_DeflatedEntry>(name)));
+        PendingEntry* pending = m_pending_entries.back().get();
+        pending->content = std::move(content);
+        m_deflate_tasks.run([pending]() {
+            pending->entry->append(pending->content);
+            pending->content = std::string();
+            pending->ok = pending->entry->finish();
+            pending->done.store(true, std::memory_order_release);
+        });
+        return _store_pending_entries(archive, false);
+    }
+
+    bool _3MF_Exporter::_add_deflated_entry_to_archive(mz_zip_archive& archive, std::unique_ptr<MZ_DeflatedEntry> entry)
+    {
+        bool ok = entry->finish();
+        m_pending_entries.emplace_back(std::make_unique<PendingEntry>(std::move(entry)));
+        m_pending_entries.back()->ok = ok;
+        m_pending_entries.back()->done.store(true, std::memory_order_release);
+        return _store_pending_entries(archive, false);
+    }
+
+    bool _3MF_Exporter::_store_pending_entries(mz_zip_archive& archive, bool wait)
+    {
+        if (wait)
+            m_deflate_tasks.wait();
+        while (!m_pending_entries.empty() && m_pending_entries.front()->done.load(std::memory_order_acquire))
+        {
+            PendingEntry& pending = *m_pending_entries.front();
+            if (!pending.ok || !pending.entry->add_to_archive(archive))
+            {
+                add_error("Unable to add " + pending.entry->name() + " to archive");
+                return false;
+            }
+            m_pending_entries.pop_front();
+        }
+        return true;
+    }
+
     bool _3MF_Exporter::_add_content_types_file_to_archive(mz_zip_archive& archive)
     {
         std::stringstream stream;
@@ -2311,7 +2729,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, CONTENT_TYPES_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+        if (!_add_file_to_archive(archive, CONTENT_TYPES_FILE, std::move(out)))
         {
             add_error("Unable to add content types file to archive");
             return false;
@@ -2328,7 +2746,7 @@ namespace Slic3r {
         void* png_data = tdefl_write_image_to_png_file_in_memory_ex((const void*)thumbnail_data.pixels.data(), thumbnail_data.width, thumbnail_data.height, 4, &png_size, MZ_DEFAULT_LEVEL, 1);
         if (png_data != nullptr)
         {
-            res = mz_zip_writer_add_mem(&archive, THUMBNAIL_FILE.c_str(), (const void*)png_data, png_size, MZ_DEFAULT_COMPRESSION);
+            res = _add_file_to_archive(archive, THUMBNAIL_FILE, std::string((const char*)png_data, png_size));
             mz_free(png_data);
         }
 
@@ -2349,7 +2767,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, RELATIONSHIPS_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+        if (!_add_file_to_archive(archive, RELATIONSHIPS_FILE, std::move(out)))
         {
             add_error("Unable to add relationships file to archive");
             return false;
@@ -2358,8 +2776,51 @@ namespace Slic3r {
         return true;
     }
 
+    // Number formatting of the vertices and triangles of the model file, the hot loop of the 3MF export.
+    // Vertices are written the way std::ostream with std::setprecision(max_digits10) did before, that is with printf("%.9g").
+    static constexpr size_t MODEL_NUMBER_BUFFER_SIZE = 32;
+
+    static inline char* append_vertex_coordinate(char* ptr, float value)
+    {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        std::to_chars_result res = std::to_chars(ptr, ptr + MODEL_NUMBER_BUFFER_SIZE, value, std::chars_format::general, std::numeric_limits<float>::max_digits10);
+        if (res.ec == std::errc())
+            return res.ptr;
+#endif
+        // printf() would use the decimal separator of the C locale set by the application, the classic locale is used instead.
+        std::ostringstream ss;
+        ss.imbue(std::locale::classic());
+        ss << std::setprecision(std::numeric_limits<float>::max_digits10) << value;
+        const std::string str = ss.str();
+        return std::copy_n(str.data(), std::min(str.size(), MODEL_NUMBER_BUFFER_SIZE), ptr);
+    }
+
+    static inline char* append_index(char* ptr, unsigned int value)
+    {
+#if __has_include(<charconv>)
+        return std::to_chars(ptr, ptr + MODEL_NUMBER_BUFFER_SIZE, value).ptr;
+#else
+        char  digits[MODEL_NUMBER_BUFFER_SIZE];
+        char* end = digits;
+        do {
+            *end ++ = char('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        return std::reverse_copy(digits, end, ptr);
+#endif
+    }
+
+    static inline char* append_literal(char* ptr, const char* literal)
+    {
+        for (; *literal != 0; ++ literal)
+            *ptr ++ = *literal;
+        return ptr;
+    }
+
     bool _3MF_Exporter::_add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data)
     {
+        // The model file is formatted straight into its deflate stream, the whole XML is never held in memory.
+        auto entry = std::make_unique<MZ_DeflatedEntry>(MODEL_FILE);
         std::stringstream stream;
         // https://en.cppreference.com/w/cpp/types/numeric_limits/max_digits10
         // Conversion of a floating-point value to text and back is exact as long as at least max_digits10 were used (9 for float, 17 for double).
@@ -2384,6 +2845,7 @@ namespace Slic3r {
         stream << " <" << METADATA_TAG << " name=\"Application\">" << SLIC3R_APP_KEY << "</" << METADATA_TAG << ">\n";
         stream << " <" << METADATA_TAG << " name=\"ApplicationVersion\">" << SLIC3R_VERSION_FULL << "</" << METADATA_TAG << ">\n";
         stream << " <" << RESOURCES_TAG << ">\n";
+        entry->append(stream.str());
 
         // Instance transformations, indexed by the 3MF object ID (which is a linear serialization of all instances of all ModelObjects).
         BuildItemsList build_items;
@@ -2403,27 +2865,25 @@ namespace Slic3r {
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(stream, object_id, *obj, build_items, object_it->second.volumes_offsets))
+            if (!_add_object_to_model_stream(*entry, object_id, *obj, build_items, object_it->second.volumes_offsets))
             {
                 add_error("Unable to add object to archive");
                 return false;
             }
         }
 
-        stream << " </" << RESOURCES_TAG << ">\n";
+        entry->append(std::string(" </") + RESOURCES_TAG + ">\n");
 
         // Store the transformations of all the ModelInstances of all ModelObjects, indexed in a linear fashion.
-        if (!_add_build_to_model_stream(stream, build_items))
+        if (!_add_build_to_model_stream(*entry, build_items))
         {
             add_error("Unable to add build to archive");
             return false;
         }
 
-        stream << "</" << MODEL_TAG << ">\n";
-
-        std::string out = stream.str();
+        entry->append(std::string("</") + MODEL_TAG + ">\n");
 
-        if (!mz_zip_writer_add_mem(&archive, MODEL_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+        if (!_add_deflated_entry_to_archive(archive, std::move(entry)))
         {
             add_error("Unable to add model file to archive");
             return false;
@@ -2432,7 +2892,7 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(std::stringstream& stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_object_to_model_stream(MZ_DeflatedEntry& stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
     {
         unsigned int id = 0;
         for (const ModelInstance* instance : object.instances)
@@ -2442,7 +2902,7 @@ namespace Slic3r {
                 continue;
 
             unsigned int instance_id = object_id + id;
-            stream << "  <" << OBJECT_TAG << " id=\"" << instance_id << "\" type=\"model\">\n";
+            stream.append(std::string("  <") + OBJECT_TAG + " id=\"" + std::to_string(instance_id) + "\" type=\"model\">\n");
 
             if (id == 0)
             {
@@ -2454,9 +2914,9 @@ namespace Slic3r {
             }
             else
             {
-                stream << "   <" << COMPONENTS_TAG << ">\n";
-                stream << "    <" << COMPONENT_TAG << " objectid=\"" << object_id << "\" />\n";
-                stream << "   </" << COMPONENTS_TAG << ">\n";
+                stream.append(std::string("   <") + COMPONENTS_TAG + ">\n");
+                stream.append(std::string("    <") + COMPONENT_TAG + " objectid=\"" + std::to_string(object_id) + "\" />\n");
+                stream.append(std::string("   </") + COMPONENTS_TAG + ">\n");
             }
 
             Transform3d t = instance->get_matrix();
@@ -2464,7 +2924,7 @@ namespace Slic3r {
             assert(instance_id == build_items.size() + 1);
             build_items.emplace_back(instance_id, t, instance->printable);
 
-            stream << "  </" << OBJECT_TAG << ">\n";
+            stream.append(std::string("  </") + OBJECT_TAG + ">\n");
 
             ++id;
         }
@@ -2473,10 +2933,13 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_mesh_to_object_stream(std::stringstream& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_mesh_to_object_stream(MZ_DeflatedEntry& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
     {
-        stream << "   <" << MESH_TAG << ">\n";
-        stream << "    <" << VERTICES_TAG << ">\n";
+        stream.append(std::string("   <") + MESH_TAG + ">\n");
+        stream.append(std::string("    <") + VERTICES_TAG + ">\n");
+
+        // Large enough for a vertex or a triangle without its custom data.
+        char buf[8 * MODEL_NUMBER_BUFFER_SIZE];
 
         unsigned int vertices_count = 0;
         for (ModelVolume* volume : object.volumes)
@@ -2504,16 +2967,22 @@ namespace Slic3r {
 
             for (size_t i = 0; i < its.vertices.size(); ++i)
             {
-                stream << "     <" << VERTEX_TAG << " ";
                 Vec3f v = (matrix * its.vertices[i].cast<double>()).cast<float>();
-                stream << "x=\"" << v(0) << "\" ";
-                stream << "y=\"" << v(1) << "\" ";
-                stream << "z=\"" << v(2) << "\" />\n";
+                char *ptr = append_literal(buf, "     <");
+                ptr = append_literal(ptr, VERTEX_TAG);
+                ptr = append_literal(ptr, " x=\"");
+                ptr = append_vertex_coordinate(ptr, v(0));
+                ptr = append_literal(ptr, "\" y=\"");
+                ptr = append_vertex_coordinate(ptr, v(1));
+                ptr = append_literal(ptr, "\" z=\"");
+                ptr = append_vertex_coordinate(ptr, v(2));
+                ptr = append_literal(ptr, "\" />\n");
+                stream.append(buf, ptr - buf);
             }
         }
 
-        stream << "    </" << VERTICES_TAG << ">\n";
-        stream << "    <" << TRIANGLES_TAG << ">\n";
+        stream.append(std::string("    </") + VERTICES_TAG + ">\n");
+        stream.append(std::string("    <") + TRIANGLES_TAG + ">\n");
 
         unsigned int triangles_count = 0;
         for (ModelVolume* volume : object.volumes)
@@ -2533,31 +3002,35 @@ namespace Slic3r {
 
             for (int i = 0; i < int(its.indices.size()); ++ i)
             {
-                stream << "     <" << TRIANGLE_TAG << " ";
+                char *ptr = append_literal(buf, "     <");
+                ptr = append_literal(ptr, TRIANGLE_TAG);
                 for (int j = 0; j < 3; ++j)
                 {
-                    stream << "v" << j + 1 << "=\"" << its.indices[i][j] + volume_it->second.first_vertex_id << "\" ";
+                    ptr = append_literal(ptr, j == 0 ? " v1=\"" : j == 1 ? "\" v2=\"" : "\" v3=\"");
+                    ptr = append_index(ptr, its.indices[i][j] + volume_it->second.first_vertex_id);
                 }
+                ptr = append_literal(ptr, "\" ");
+                stream.append(buf, ptr - buf);
 
                 std::string custom_supports_data_string = volume->supported_facets.get_triangle_as_string(i);
                 if (! custom_supports_data_string.empty())
-                    stream << CUSTOM_SUPPORTS_ATTR << "=\"" << custom_supports_data_string << "\" ";
+                    stream.append(std::string(CUSTOM_SUPPORTS_ATTR) + "=\"" + custom_supports_data_string + "\" ");
 
                 std::string custom_seam_data_string = volume->seam_facets.get_triangle_as_string(i);
                 if (! custom_seam_data_string.empty())
-                    stream << CUSTOM_SEAM_ATTR << "=\"" << custom_seam_data_string << "\" ";
+                    stream.append(std::string(CUSTOM_SEAM_ATTR) + "=\"" + custom_seam_data_string + "\" ");
 
-                stream << "/>\n";
+                stream.append("/>\n", 3);
             }
         }
 
-        stream << "    </" << TRIANGLES_TAG << ">\n";
-        stream << "   </" << MESH_TAG << ">\n";
+        stream.append(std::string("    </") + TRIANGLES_TAG + ">\n");
+        stream.append(std::string("   </") + MESH_TAG + ">\n");
 
         return true;
     }
 
-    bool _3MF_Exporter::_add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items)
+    bool _3MF_Exporter::_add_build_to_model_stream(MZ_DeflatedEntry& entry, const BuildItemsList& build_items)
     {
         if (build_items.size() == 0)
         {
@@ -2565,6 +3038,8 @@ namespace Slic3r {
             return false;
         }
 
+        std::stringstream stream;
+        stream << std::setprecision(std::numeric_limits<float>::max_digits10);
         stream << " <" << BUILD_TAG << ">\n";
 
         for (const BuildItem& item : build_items)
@@ -2583,6 +3058,7 @@ namespace Slic3r {
         }
 
         stream << " </" << BUILD_TAG << ">\n";
+        entry.append(stream.str());
 
         return true;
     }
@@ -2615,7 +3091,7 @@ namespace Slic3r {
 
         if (!out.empty())
         {
-            if (!mz_zip_writer_add_mem(&archive, LAYER_HEIGHTS_PROFILE_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+            if (!_add_file_to_archive(archive, LAYER_HEIGHTS_PROFILE_FILE, std::move(out)))
             {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
@@ -2693,17 +3169,17 @@ namespace Slic3r {
 
         if (!default_out.empty())
         {
-            if (!mz_zip_writer_add_mem(&archive, SLIC3R_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)default_out.data(), default_out.length(), MZ_DEFAULT_COMPRESSION))
+            if (!_add_file_to_archive(archive, SLIC3R_LAYER_CONFIG_RANGES_FILE, default_out))
             {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
             }
-            if (!mz_zip_writer_add_mem(&archive, SUPER_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)default_out.data(), default_out.length(), MZ_DEFAULT_COMPRESSION))
+            if (!_add_file_to_archive(archive, SUPER_LAYER_CONFIG_RANGES_FILE, std::move(default_out)))
             {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
             }
-            if (!mz_zip_writer_add_mem(&archive, PRUSA_LAYER_CONFIG_RANGES_FILE.c_str(), (const void*)prusa_out.data(), prusa_out.length(), MZ_DEFAULT_COMPRESSION))
+            if (!_add_file_to_archive(archive, PRUSA_LAYER_CONFIG_RANGES_FILE, std::move(prusa_out)))
             {
                 add_error("Unable to add layer heights profile file to archive");
                 return false;
@@ -2743,7 +3219,7 @@ namespace Slic3r {
             // Adds version header at the beginning:
             out = std::string("support_points_format_version=") + std::to_string(support_points_format_version) + std::string("\n") + out;
 
-            if (!mz_zip_writer_add_mem(&archive, SLA_SUPPORT_POINTS_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+            if (!_add_file_to_archive(archive, SLA_SUPPORT_POINTS_FILE, std::move(out)))
             {
                 add_error("Unable to add sla support points file to archive");
                 return false;
@@ -2798,7 +3274,7 @@ namespace Slic3r {
             // Adds version header at the beginning:
             out = std::string("drain_holes_format_version=") + std::to_string(drain_holes_format_version) + std::string("\n") + out;
             
-            if (!mz_zip_writer_add_mem(&archive, SLA_DRAIN_HOLES_FILE.c_str(), static_cast<const void*>(out.data()), out.length(), mz_uint(MZ_DEFAULT_COMPRESSION)))
+            if (!_add_file_to_archive(archive, SLA_DRAIN_HOLES_FILE, std::move(out)))
             {
                 add_error("Unable to add sla support points file to archive");
                 return false;
@@ -2828,7 +3304,7 @@ namespace Slic3r {
 
         if (!out.empty())
         {
-            if (!mz_zip_writer_add_mem(&archive, config_name.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+            if (!_add_file_to_archive(archive, config_name, std::move(out)))
             {
                 add_error("Unable to add print config file to archive");
                 return false;
@@ -2967,7 +3443,7 @@ namespace Slic3r {
 
         std::string out = stream.str();
 
-        if (!mz_zip_writer_add_mem(&archive, file_path.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+        if (!_add_file_to_archive(archive, file_path, std::move(out)))
         {
             add_error("Unable to add model config file to archive");
             return false;
@@ -3024,7 +3500,7 @@ bool _3MF_Exporter::_add_custom_gcode_per_print_z_file_to_archive( mz_zip_archiv
 
     if (!out.empty())
     {
-        if (!mz_zip_writer_add_mem(&archive, CUSTOM_GCODE_PER_PRINT_Z_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+        if (!_add_file_to_archive(archive, CUSTOM_GCODE_PER_PRINT_Z_FILE, std::move(out)))
         {
             add_error("Unable to add custom Gcodes per print_z file to archive");
             return false;
@@ -615,19 +615,20 @@ void AMFParserContext::endElement(const char * /* name */)
 
     // Faces of the current volume:
     case NODE_TYPE_TRIANGLE:
+    {
         assert(m_object && m_volume);
-        // drop illegal vertex references.
-        if (strtoul(m_value[0].c_str(), nullptr, 10) < m_object_vertices.size() &&
-            strtoul(m_value[1].c_str(), nullptr, 10) < m_object_vertices.size() &&
-            strtoul(m_value[2].c_str(), nullptr, 10) < m_object_vertices.size()) {
-            m_volume_facets.emplace_back(atoi(m_value[0].c_str()));
-            m_volume_facets.emplace_back(atoi(m_value[1].c_str()));
-            m_volume_facets.emplace_back(atoi(m_value[2].c_str()));
+        // Parse the vertex indices only once, drop illegal vertex references.
+        unsigned long indices[3] = { strtoul(m_value[0].c_str(), nullptr, 10), strtoul(m_value[1].c_str(), nullptr, 10), strtoul(m_value[2].c_str(), nullptr, 10) };
+        if (indices[0] < m_object_vertices.size() && indices[1] < m_object_vertices.size() && indices[2] < m_object_vertices.size()) {
+            m_volume_facets.emplace_back(int(indices[0]));
+            m_volume_facets.emplace_back(int(indices[1]));
+            m_volume_facets.emplace_back(int(indices[2]));
         }
         m_value[0].clear();
         m_value[1].clear();
         m_value[2].clear();
         break;
+    }
 
     // Closing the current volume. Create an STL from m_volume_facets pointing to m_object_vertices.
     case NODE_TYPE_VOLUME:
@@ -13,10 +13,15 @@
 #include "ClipperUtils.hpp"
 #include "libslic3r.h"
 #include "PrintConfig.hpp"
+#include "Thread.hpp"
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
+#include <exception>
 #include <map>
+#include <mutex>
 #include <math.h>
 #include <unordered_set>
 #include <string_view>
@@ -35,6 +40,7 @@
 #include "SVG.hpp"
 
 #include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
 
 #include <Shiny/Shiny.h>
 
@@ -130,7 +136,7 @@ std::string OozePrevention::pre_toolchange(GCode& gcodegen)
         /*  We don't call gcodegen.travel_to() because we don't need retraction (it was already
             triggered by the caller) nor avoid_crossing_perimeters and also because the coordinates
             of the destination point must not be transformed by origin nor current extruder offset.  */
-            gcode += gcodegen.writer().travel_to_xy(unscale(standby_point), 0.0, "move to standby position");
+            gcodegen.writer().travel_to_xy(gcode, unscale(standby_point), 0.0, "move to standby position");
     }
 
     if (gcodegen.config().standby_temperature_delta.value != 0 && gcodegen.writer().tool_is_extruder() && this->_get_temp(gcodegen) > 0) {
@@ -210,8 +216,8 @@ std::string Wipe::wipe(GCode& gcodegen, bool toolchange)
                 double dE = length * (segment_length / wipe_dist) * 0.95;
                 //FIXME one shall not generate the unnecessary G1 Fxxx commands, here wipe_speed is a constant inside this cycle.
                 // Is it here for the cooling markers? Or should it be outside of the cycle?
-                    gcode += gcodegen.writer().set_speed(wipe_speed * 60, "", gcodegen.enable_cooling_markers() ? ";_WIPE" : "");
-                gcode += gcodegen.writer().extrude_to_xy(
+                    gcodegen.writer().set_speed(gcode, wipe_speed * 60, "", gcodegen.enable_cooling_markers() ? ";_WIPE" : "");
+                gcodegen.writer().extrude_to_xy(gcode,
                     gcodegen.point_to_gcode(line.b),
                     -dE,
                     "wipe and retract"
@@ -672,6 +678,239 @@ namespace DoExport {
     }
 } // namespace DoExport
 
+// Runs GCode::_process_output_block() on a worker thread, so that the cooling, the fan mover and the file output
+// of a layer overlap with the generation of the next layers. The blocks are processed in the order they were pushed
+// by the same CoolingBuffer / FanMover, thus the file is the same as if they were processed by the generating thread.
+class GCode::ExportPipeline
+{
+public:
+    ExportPipeline(GCode &gcodegen, FILE *file) : m_gcodegen(gcodegen), m_file(file)
+        { m_thread = create_thread([this]() { this->run(); }); }
+    // Discards the blocks not processed yet, the export was canceled or failed.
+    ~ExportPipeline()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.clear();
+            m_stop = true;
+        }
+        m_cond_pushed.notify_one();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    // Blocks if the worker thread is too far behind.
+    void push(OutputBlock &&block)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond_popped.wait(lock, [this]() { return m_queue.size() < max_queued || m_exception; });
+            if (m_exception)
+                std::rethrow_exception(m_exception);
+            m_queue.emplace_back(std::move(block));
+        }
+        m_cond_pushed.notify_one();
+    }
+
+    // Wait until all the pushed blocks are written.
+    void drain()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond_popped.wait(lock, [this]() { return (m_queue.empty() && ! m_busy) || m_exception; });
+        if (m_exception)
+            std::rethrow_exception(m_exception);
+    }
+
+    // Write all the pushed blocks and stop the worker thread.
+    void finish()
+    {
+        this->drain();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond_pushed.notify_one();
+        m_thread.join();
+    }
+
+private:
+    void run()
+    {
+        set_current_thread_name("slic3r_gcodeout");
+        for (;;) {
+            OutputBlock block;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond_pushed.wait(lock, [this]() { return ! m_queue.empty() || m_stop; });
+                if (m_queue.empty())
+                    return;
+                block = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_busy = true;
+            }
+            std::exception_ptr exception;
+            try {
+                m_gcodegen._process_output_block(m_file, block);
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_busy = false;
+                if (exception) {
+                    m_exception = exception;
+                    m_queue.clear();
+                }
+            }
+            m_cond_popped.notify_one();
+            if (exception)
+                return;
+        }
+    }
+
+    // Enough to keep the worker thread busy, while limiting the memory held by the G-code of the layers in flight.
+    static constexpr size_t     max_queued = 16;
+
+    GCode                      &m_gcodegen;
+    FILE                       *m_file;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cond_pushed;
+    std::condition_variable     m_cond_popped;
+    std::deque<OutputBlock>     m_queue;
+    bool                        m_busy { false };
+    bool                        m_stop { false };
+    std::exception_ptr          m_exception;
+    boost::thread               m_thread;
+};
+
+// Signed distance field over the lower layer, used by the seam placer to penalize the overhangs.
+static std::unique_ptr<EdgeGrid::Grid> make_lower_layer_edge_grid(const Layer &layer)
+{
+    assert(layer.lower_layer != nullptr);
+    const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
+    auto grid = make_unique<EdgeGrid::Grid>();
+    grid->create(layer.lower_layer->lslices, distance_field_resolution);
+    grid->calculate_sdf();
+#if 0
+    {
+        static int iRun = 0;
+        BoundingBox bbox = grid->bbox();
+        bbox.min(0) -= scale_(5.f);
+        bbox.min(1) -= scale_(5.f);
+        bbox.max(0) += scale_(5.f);
+        bbox.max(1) += scale_(5.f);
+        EdgeGrid::save_png(*grid, bbox, scale_(0.1f), debug_out_path("GCode_extrude_loop_edge_grid-%d.png", iRun++));
+    }
+#endif
+    return grid;
+}
+
+// Builds the lower layer edge grids of the seam placer and the boundaries of the avoid crossing perimeters planner
+// on worker threads, one batch of layers ahead of the layers being exported. These used to be built lazily
+// by the export thread. The export only reads the print, thus the workers can read it concurrently.
+class GCode::LayerGeometryPrecompute
+{
+public:
+    struct Geometry {
+        std::unique_ptr<EdgeGrid::Grid>                                 lower_layer_edge_grid;
+        std::shared_ptr<const AvoidCrossingPerimeters::LayerBoundaries> travel_boundaries;
+    };
+
+    // Layers in the order of their export.
+    LayerGeometryPrecompute(std::vector<const Layer*> &&layers, bool travel_boundaries) :
+        m_layers(std::move(layers)), m_geometry(m_layers.size()), m_travel_boundaries(travel_boundaries)
+    {
+        m_batches.resize((m_layers.size() + batch_size - 1) / batch_size);
+    }
+    ~LayerGeometryPrecompute()
+    {
+        for (std::unique_ptr<tbb::task_group> &batch : m_batches)
+            if (batch) {
+                batch->cancel();
+                try {
+                    batch->wait();
+                } catch (...) {
+                }
+            }
+    }
+
+    // To be called in the order of the export. Returns an empty Geometry for a layer, which was not expected.
+    Geometry take(const Layer *layer)
+    {
+        auto it = std::find(m_layers.begin() + m_next, m_layers.end(), layer);
+        if (it == m_layers.end())
+            return {};
+        m_next = it - m_layers.begin();
+        size_t batch = m_next / batch_size;
+        // Keep the workers busy with the next batch while the current one is being exported.
+        for (size_t i = batch; i < std::min(batch + 2, m_batches.size()); ++ i)
+            this->start_batch(i);
+        m_batches[batch]->wait();
+        return std::move(m_geometry[m_next ++]);
+    }
+
+private:
+    void start_batch(size_t batch)
+    {
+        if (m_batches[batch])
+            return;
+        m_batches[batch] = std::make_unique<tbb::task_group>();
+        m_batches[batch]->run([this, batch]() {
+            tbb::parallel_for(tbb::blocked_range<size_t>(batch * batch_size, std::min(m_layers.size(), (batch + 1) * batch_size)),
+                [this](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    const Layer &layer = *m_layers[i];
+                    // Same condition as GCode::extrude_loop(), which extrudes the perimeters of object layers.
+                    if (layer.lower_layer != nullptr && dynamic_cast<const SupportLayer*>(&layer) == nullptr &&
+                        std::any_of(layer.regions().begin(), layer.regions().end(), [](const LayerRegion *layerm) { return ! layerm->perimeters.entities().empty(); }))
+                        m_geometry[i].lower_layer_edge_grid = make_lower_layer_edge_grid(layer);
+                    if (m_travel_boundaries)
+                        m_geometry[i].travel_boundaries = AvoidCrossingPerimeters::precompute_layer(layer);
+                }
+            });
+        });
+    }
+
+    // Bounds the memory held by the precomputed geometry.
+    static constexpr size_t                         batch_size = 16;
+
+    std::vector<const Layer*>                       m_layers;
+    std::vector<Geometry>                           m_geometry;
+    std::vector<std::unique_ptr<tbb::task_group>>   m_batches;
+    size_t                                          m_next { 0 };
+    bool                                            m_travel_boundaries;
+};
+
+GCode::GCode() :
+    m_origin(Vec2d::Zero()),
+    m_enable_loop_clipping(true), 
+    m_enable_cooling_markers(false), 
+    m_enable_extrusion_role_markers(false), 
+    m_last_processor_extrusion_role(erNone),
+    m_layer_count(0),
+    m_layer_index(-1), 
+    m_layer(nullptr), 
+    m_volumetric_speed(0),
+    m_last_pos_defined(false),
+    m_last_extrusion_role(erNone),
+#if ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
+    m_last_width(0.0f),
+#endif // ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
+#if ENABLE_GCODE_VIEWER_DATA_CHECKING
+    m_last_mm3_per_mm(0.0),
+#if !ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
+    m_last_width(0.0f),
+#endif // !ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
+#endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
+    m_brim_done(false),
+    m_second_layer_things_done(false),
+    m_silent_time_estimator_enabled(false),
+    m_last_obj_copy(nullptr, Point(std::numeric_limits<coord_t>::max(), std::numeric_limits<coord_t>::max())),
+    m_last_too_small(ExtrusionRole::erNone)
+{}
+
+GCode::~GCode() = default;
+
 void GCode::do_export(Print* print, const char* path, GCodeProcessor::Result* result, ThumbnailsGeneratorCallback thumbnail_cb)
 {
     PROFILE_CLEAR();
@@ -729,12 +968,7 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessor::Result* re
     }
 
     BOOST_LOG_TRIVIAL(debug) << "Start processing gcode, " << log_memory_info();
-    //klipper can hide gcode into a macro, so add guessed init gcode to the processor.
-    if (this->config().start_gcode_manual) {
-        std::string gcode = m_writer.preamble();
-        m_processor.process_string(gcode, [print]() { print->throw_if_canceled(); });
-    }
-    m_processor.process_file(path_tmp, true, [print]() { print->throw_if_canceled(); });
+    m_processor.finalize_stream(path_tmp, true);
     DoExport::update_print_estimated_times_stats(m_processor, print->m_print_statistics);
     if (result != nullptr)
         *result = std::move(m_processor.extract_result());
@@ -1190,6 +1424,12 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     m_enable_extrusion_role_markers = false;
 #endif /* HAS_PRESSURE_EQUALIZER */
 
+    //klipper can hide gcode into a macro, so add guessed init gcode to the processor.
+    if (this->config().start_gcode_manual)
+        m_processor.process_string(m_writer.preamble());
+    // The processor is fed with the G-code as it is written (see _process_output_block()), instead of reading the file again.
+    m_processor.start_stream();
+
     // Write information on the generator.
     _write_format(file, "; %s\n\n", Slic3r::header_slic3r_generated().c_str());
 
@@ -1503,12 +1743,9 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     m_last_pos_defined = false;
 
     //flush FanMover buffer to avoid modifying the start gcode if it's manual.
-    if (this->config().start_gcode_manual && this->m_fan_mover.get() != nullptr) {
-        std::string to_write = this->m_fan_mover.get()->process_gcode("", true);
-        const char* gcode_to_write = to_write.c_str();
-        // writes string to file
-        fwrite(gcode_to_write, 1, ::strlen(gcode_to_write), file);
-    }
+    // Written as an empty flushing block, so that the flushed lines also go through the processor (see _process_output_block()).
+    if (this->config().start_gcode_manual)
+        _write(file, "", true);
 
     // Process filament-specific gcode.
    /* if (has_wipe_tower) {
@@ -1594,6 +1831,21 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     if ((initial_extruder_id != (uint16_t)-1) && !this->config().start_gcode_manual && print.config().first_layer_bed_temperature.get_at(initial_extruder_id) != 0)
         this->_print_first_layer_bed_temperature(file, print, start_gcode, initial_extruder_id, true);
 
+    // Cool, post-process and write the layers on a worker thread, while the next layers are being generated.
+    // Not when the wipe tower restores the fan speed set by the cooling buffer (see WipeTowerIntegration::append_tcr()).
+    const std::vector<unsigned char> &toolchange_part_fan = print.config().filament_enable_toolchange_part_fan.values;
+    bool pipelined_export = ! print.m_serial_gcode_export && boost::thread::hardware_concurrency() > 1 &&
+        ! (has_wipe_tower && std::find(toolchange_part_fan.begin(), toolchange_part_fan.end(), true) != toolchange_part_fan.end());
+#ifdef HAS_PRESSURE_EQUALIZER
+    pipelined_export &= ! m_pressure_equalizer;
+#endif /* HAS_PRESSURE_EQUALIZER */
+    if (pipelined_export)
+        m_export_pipeline = std::make_unique<ExportPipeline>(*this, file);
+    // Stop the worker thread before the file is closed, also if canceled.
+    ScopeGuard export_pipeline_guard([this]() { m_export_pipeline.reset(); });
+    bool precompute_layer_geometry = ! print.m_serial_gcode_export && boost::thread::hardware_concurrency() > 1;
+    ScopeGuard layer_geometry_guard([this]() { m_layer_geometry.reset(); });
+
     // Do all objects for each layer.
     if (initial_extruder_id != (uint16_t)-1)
         if (print.config().complete_objects.value) {
@@ -1643,10 +1895,19 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
                 //reinit the seam placer on the new object
                 m_seam_placer.init(print);
                 // Reset the cooling buffer internal state (the current position, feed rate, accelerations).
+                if (m_export_pipeline)
+                    m_export_pipeline->drain();
                 m_cooling_buffer->reset();
                 m_cooling_buffer->set_current_extruder(initial_extruder_id);
                 // Pair the object layers with the support layers by z, extrude them.
                 std::vector<LayerToPrint> layers_to_print = collect_layers_to_print(object);
+                if (precompute_layer_geometry) {
+                    std::vector<const Layer*> layers;
+                    layers.reserve(layers_to_print.size());
+                    for (const LayerToPrint &ltp : layers_to_print)
+                        layers.emplace_back(ltp.layer());
+                    m_layer_geometry = std::make_unique<LayerGeometryPrecompute>(std::move(layers), print.config().avoid_crossing_perimeters.value);
+                }
                 for (LayerToPrint &ltp : layers_to_print) {
                     std::vector<LayerToPrint> lrs;
                     lrs.emplace_back(std::move(ltp));
@@ -1710,6 +1971,13 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
                 }
                 print.throw_if_canceled();
             }
+            if (precompute_layer_geometry) {
+                std::vector<const Layer*> layers;
+                for (const std::pair<coordf_t, std::vector<LayerToPrint>> &layer : layers_to_print)
+                    for (const LayerToPrint &ltp : layer.second)
+                        layers.emplace_back(ltp.layer());
+                m_layer_geometry = std::make_unique<LayerGeometryPrecompute>(std::move(layers), print.config().avoid_crossing_perimeters.value);
+            }
             // Extrude the layers.
             for (auto &layer : layers_to_print) {
                 const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
@@ -1727,6 +1995,12 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
                 _write(file, m_wipe_tower->finalize(*this));
         }
 
+    // The end G-code reads the fan state of the writer, set by the cooling buffer.
+    if (m_export_pipeline) {
+        m_export_pipeline->finish();
+        m_export_pipeline.reset();
+    }
+
     // Write end commands to file.
     _write(file, this->retract());
     //if needed, write the gcode_label_objects_end
@@ -1810,6 +2084,11 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, uint16_t current_extruder_id, DynamicConfig *config_override)
+{
+    return this->placeholder_parser_process(name, *PlaceholderParser::compile_template(templ), current_extruder_id, config_override);
+}
+
+std::string GCode::placeholder_parser_process(const std::string &name, const PlaceholderParser::CompiledTemplate &templ, uint16_t current_extruder_id, DynamicConfig *config_override)
 {
     DynamicConfig default_config;
     if (config_override == nullptr)
@@ -2365,7 +2644,7 @@ void GCode::process_layer(
         config.set_key_value("layer_z",     new ConfigOptionFloat(print_z));
         config.set_key_value("max_layer_z", new ConfigOptionFloat(m_max_layer_z));
         gcode += this->placeholder_parser_process("before_layer_gcode",
-            print.config().before_layer_gcode.value, m_writer.tool()->id(), &config)
+            *m_before_layer_gcode_template, m_writer.tool()->id(), &config)
             + "\n";
     }
     // print z move to next layer UNLESS
@@ -2391,7 +2670,7 @@ void GCode::process_layer(
         config.set_key_value("layer_num", new ConfigOptionInt(m_layer_index));
         config.set_key_value("layer_z",   new ConfigOptionFloat(print_z));
         gcode += this->placeholder_parser_process("layer_gcode",
-            print.config().layer_gcode.value, m_writer.tool()->id(), &config)
+            *m_layer_gcode_template, m_writer.tool()->id(), &config)
             + "\n";
         config.set_key_value("max_layer_z", new ConfigOptionFloat(m_max_layer_z));
     }
@@ -2587,6 +2866,13 @@ void GCode::process_layer(
 
     // Extrude the skirt, brim, support, perimeters, infill ordered by the extruders.
     std::vector<std::unique_ptr<EdgeGrid::Grid>> lower_layer_edge_grids(layers.size());
+    std::vector<std::shared_ptr<const AvoidCrossingPerimeters::LayerBoundaries>> travel_boundaries(layers.size());
+    if (m_layer_geometry)
+        for (size_t i = 0; i < layers.size(); ++ i) {
+            LayerGeometryPrecompute::Geometry geometry = m_layer_geometry->take(layers[i].layer());
+            lower_layer_edge_grids[i] = std::move(geometry.lower_layer_edge_grid);
+            travel_boundaries[i]      = std::move(geometry.travel_boundaries);
+        }
     for (uint16_t extruder_id : layer_tools.extruders)
     {
         gcode += (layer_tools.has_wipe_tower && m_wipe_tower) ?
@@ -2696,7 +2982,7 @@ void GCode::process_layer(
                 m_layer = layers[instance_to_print.layer_id].layer();
                 m_print_object_instance_id = static_cast<uint16_t>(instance_to_print.instance_id);
                 if (m_config.avoid_crossing_perimeters)
-                    m_avoid_crossing_perimeters.init_layer(*m_layer);
+                    m_avoid_crossing_perimeters.init_layer(*m_layer, travel_boundaries[instance_to_print.layer_id]);
                 //print object label to help the printer firmware know where it is (for removing the objects)
                 if (this->config().gcode_label_objects) {
                     m_gcode_label_objects_start = std::string("; printing object ") + instance_to_print.print_object.model_object()->name
@@ -2860,19 +3146,8 @@ void GCode::process_layer(
     }
 
 
-    // Apply cooling logic; this may alter speeds.
-    if (m_cooling_buffer)
-        gcode = m_cooling_buffer->process_layer(gcode, layer.id(), (support_layer != nullptr && object_layer == nullptr));
-
-#ifdef HAS_PRESSURE_EQUALIZER
-    // Apply pressure equalization if enabled;
-    // printf("G-code before filter:\n%s\n", gcode.c_str());
-    if (m_pressure_equalizer)
-        gcode = m_pressure_equalizer->process(gcode.c_str(), false);
-    // printf("G-code after filter:\n%s\n", out.c_str());
-#endif /* HAS_PRESSURE_EQUALIZER */
-
-    _write(file, gcode);
+    // Apply cooling logic (this may alter speeds) and write the layer, possibly on the export pipeline thread.
+    _write_layer(file, std::move(gcode), layer.id(), (support_layer != nullptr && object_layer == nullptr));
     BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z <<
         log_memory_info();
 
@@ -2888,6 +3163,9 @@ void GCode::apply_print_config(const PrintConfig &print_config)
 {
     m_writer.apply_print_config(print_config);
     m_config.apply(print_config);
+    m_before_layer_gcode_template = PlaceholderParser::compile_template(m_config.before_layer_gcode.value);
+    m_layer_gcode_template        = PlaceholderParser::compile_template(m_config.layer_gcode.value);
+    m_feature_gcode_template      = PlaceholderParser::compile_template(m_config.feature_gcode.value);
 }
 
 void GCode::append_full_config(const Print &print, std::string &str)
@@ -2992,26 +3270,9 @@ std::string GCode::extrude_loop_vase(const ExtrusionLoop &original_loop, const s
     // next copies (if any) would not detect the correct orientation
     ExtrusionLoop loop_to_seam = original_loop;
 
-    if (m_layer->lower_layer != nullptr && lower_layer_edge_grid != nullptr) {
-        if (!*lower_layer_edge_grid) {
-            // Create the distance field for a layer below.
-            const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
-            *lower_layer_edge_grid = make_unique<EdgeGrid::Grid>();
-            (*lower_layer_edge_grid)->create(m_layer->lower_layer->lslices, distance_field_resolution);
-            (*lower_layer_edge_grid)->calculate_sdf();
-#if 0
-            {
-                static int iRun = 0;
-                BoundingBox bbox = (*lower_layer_edge_grid)->bbox();
-                bbox.min(0) -= scale_(5.f);
-                bbox.min(1) -= scale_(5.f);
-                bbox.max(0) += scale_(5.f);
-                bbox.max(1) += scale_(5.f);
-                EdgeGrid::save_png(*(*lower_layer_edge_grid), bbox, scale_(0.1f), debug_out_path("GCode_extrude_loop_edge_grid-%d.png", iRun++));
-            }
-#endif
-        }
-    }
+    if (m_layer->lower_layer != nullptr && lower_layer_edge_grid != nullptr && ! *lower_layer_edge_grid)
+        // Create the distance field for a layer below, unless already precomputed.
+        *lower_layer_edge_grid = make_lower_layer_edge_grid(*m_layer);
 
     // extrude all loops ccw
     //no! this was decided in perimeter_generator
@@ -3139,7 +3400,7 @@ std::string GCode::extrude_loop_vase(const ExtrusionLoop &original_loop, const s
             if (path == paths.begin() && step == Step::INCR){
                 if (paths.back().role() == erExternalPerimeter && m_layer != NULL && m_config.perimeters.value > 1 && paths.front().size() >= 2 && paths.back().polyline.points.size() >= 3) {
                     paths[0].polyline.points.erase(paths[0].polyline.points.begin());
-                    gcode += m_writer.extrude_to_xy(this->point_to_gcode(paths[0].polyline.points.front()), 0);
+                    m_writer.extrude_to_xy(gcode, this->point_to_gcode(paths[0].polyline.points.front()), 0);
                 }
             }
 
@@ -3164,11 +3425,11 @@ std::string GCode::extrude_loop_vase(const ExtrusionLoop &original_loop, const s
                     coordf_t current_height_internal = current_height + height_increment / 2;
                     //ensure you go to the good xyz
                     if( (last_point - previous).norm() > EPSILON)
-                        gcode += m_writer.extrude_to_xyz(last_point, 0, description);
+                        m_writer.extrude_to_xyz(gcode, last_point, 0, description);
                     //extrusions
                     for (int i = 0; i < nb_sections - 1; i++) {
                         Vec3d new_point = last_point + pos_increment;
-                        gcode += m_writer.extrude_to_xyz(new_point,
+                        m_writer.extrude_to_xyz(gcode, new_point,
                             e_per_mm_per_height * (line_length / nb_sections) * current_height_internal,
                             description);
                         current_height_internal += height_increment;
@@ -3178,7 +3439,7 @@ std::string GCode::extrude_loop_vase(const ExtrusionLoop &original_loop, const s
                     last_point.x() = this->point_to_gcode(line.b).x();
                     last_point.y() = this->point_to_gcode(line.b).y();
                     last_point.z() = current_z + z_per_length * line_length;
-                    gcode += m_writer.extrude_to_xyz(
+                    m_writer.extrude_to_xyz(gcode,
                         last_point,
                         e_per_mm_per_height * (line_length / nb_sections) * current_height_internal,
                         comment);
@@ -3254,7 +3515,7 @@ std::string GCode::extrude_loop_vase(const ExtrusionLoop &original_loop, const s
         inward_point.rotate(angle, paths.front().polyline.points.front());
         
         // generate the travel move
-        gcode += m_writer.travel_to_xy(this->point_to_gcode(inward_point), 0.0, "move inwards before travel");
+        m_writer.travel_to_xy(gcode, this->point_to_gcode(inward_point), 0.0, "move inwards before travel");
     }
 
     return gcode;
@@ -3321,26 +3582,9 @@ std::string GCode::extrude_loop(const ExtrusionLoop &original_loop, const std::s
     // next copies (if any) would not detect the correct orientation
     ExtrusionLoop loop_to_seam = original_loop;
 
-    if (m_layer->lower_layer != nullptr && lower_layer_edge_grid != nullptr) {
-        if (! *lower_layer_edge_grid) {
-            // Create the distance field for a layer below.
-            const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
-            *lower_layer_edge_grid = make_unique<EdgeGrid::Grid>();
-            (*lower_layer_edge_grid)->create(m_layer->lower_layer->lslices, distance_field_resolution);
-            (*lower_layer_edge_grid)->calculate_sdf();
-            #if 0
-            {
-                static int iRun = 0;
-                BoundingBox bbox = (*lower_layer_edge_grid)->bbox();
-                bbox.min(0) -= scale_(5.f);
-                bbox.min(1) -= scale_(5.f);
-                bbox.max(0) += scale_(5.f);
-                bbox.max(1) += scale_(5.f);
-                EdgeGrid::save_png(*(*lower_layer_edge_grid), bbox, scale_(0.1f), debug_out_path("GCode_extrude_loop_edge_grid-%d.png", iRun++));
-            }
-            #endif
-        }
-    }
+    if (m_layer->lower_layer != nullptr && lower_layer_edge_grid != nullptr && ! *lower_layer_edge_grid)
+        // Create the distance field for a layer below, unless already precomputed.
+        *lower_layer_edge_grid = make_lower_layer_edge_grid(*m_layer);
 
     // extrude all loops ccw
     //no! this was decided in perimeter_generator
@@ -3463,7 +3707,7 @@ std::string GCode::extrude_loop(const ExtrusionLoop &original_loop, const std::s
                 for (Point& pt : path.polyline.points) {
                     prev_point = current_point;
                     current_point = pt;
-                    gcode += m_writer.travel_to_xy(this->point_to_gcode(pt), 0.0, config().gcode_comments ? "; extra wipe" : "");
+                    m_writer.travel_to_xy(gcode, this->point_to_gcode(pt), 0.0, config().gcode_comments ? "; extra wipe" : "");
                     this->set_last_pos(pt);
                 }
             }
@@ -3499,7 +3743,7 @@ std::string GCode::extrude_loop(const ExtrusionLoop &original_loop, const std::s
         Point  pt = ((nd * nd >= l2) ? next_pos : (current_pos + vec_dist * (nd / sqrt(l2)))).cast<coord_t>();
         pt.rotate(angle, current_point);
         // generate the travel move
-        gcode += m_writer.travel_to_xy(this->point_to_gcode(pt), 0.0, "move inwards before travel");
+        m_writer.travel_to_xy(gcode, this->point_to_gcode(pt), 0.0, "move inwards before travel");
         this->set_last_pos(pt);
         gcode += ";" + GCodeProcessor::Wipe_End_Tag + "\n";
 
@@ -3601,7 +3845,7 @@ std::string GCode::extrude_multi_path3D(const ExtrusionMultiPath3D &multipath3D,
                 Line line(path.polyline.points[i], path.polyline.points[i + 1]);
                 const double line_length = line.length() * SCALING_FACTOR;
                 path_length += line_length;
-                gcode += m_writer.extrude_to_xyz(
+                m_writer.extrude_to_xyz(gcode,
                     this->point_to_gcode(line.b, path.z_offsets.size()>i+1 ? path.z_offsets[i+1] : 0),
                     e_per_mm * line_length,
                     comment);
@@ -3708,7 +3952,7 @@ std::string GCode::extrude_path_3D(const ExtrusionPath3D &path, const std::strin
             Line line(path.polyline.points[i], path.polyline.points[i + 1]);
             const double line_length = line.length() * SCALING_FACTOR;
             path_length += line_length;
-            gcode += m_writer.extrude_to_xyz(
+            m_writer.extrude_to_xyz(gcode,
                 this->point_to_gcode(line.b, path.z_offsets.size()>i ? path.z_offsets[i] : 0),
                 e_per_mm * line_length,
                 comment);
@@ -3823,7 +4067,7 @@ std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fill
 }
 
 
-void GCode::_post_process(std::string& what, bool flush) {
+void GCode::_post_process(std::string& what, bool flush, const Tool* tool) {
 
     //if enabled, move the fan startup earlier.
     if (this->config().fan_speedup_time.value != 0 || this->config().fan_kickstart.value > 0) {
@@ -3835,6 +4079,7 @@ void GCode::_post_process(std::string& what, bool flush) {
                 this->config().use_relative_e_distances.value,
                 this->config().fan_speedup_overhangs.value,
                 (float)this->config().fan_kickstart.value));
+        this->m_fan_mover->set_current_tool(tool);
         what = this->m_fan_mover->process_gcode(what, flush);
     }
 
@@ -3843,14 +4088,52 @@ void GCode::_post_process(std::string& what, bool flush) {
 void GCode::_write(FILE* file, const char *what, bool flush /*=false*/)
 {
     if (what != nullptr) {
-        
-        //const char * gcode_pp = _post_process(what).c_str();
-        std::string str_preproc{ what };
-        _post_process(str_preproc, flush);
-        const char* gcode = str_preproc.c_str();
-        // writes string to file
-        fwrite(gcode, 1, ::strlen(gcode), file);
+        OutputBlock block;
+        block.gcode = what;
+        block.flush = flush;
+        _write_block(file, std::move(block));
+    }
+}
+
+void GCode::_write_layer(FILE* file, std::string &&gcode, size_t layer_id, bool append_time_only)
+{
+    OutputBlock block;
+    block.gcode            = std::move(gcode);
+    block.layer_id         = layer_id;
+    block.append_time_only = append_time_only;
+    _write_block(file, std::move(block));
+}
+
+void GCode::_write_block(FILE* file, OutputBlock &&block)
+{
+    // Snapshot of the current tool, the post-processing may be done after the next toolchanges were generated.
+    block.tool = m_writer.tool() != nullptr ? m_writer.tool() : m_writer.get_tool(0);
+    if (m_export_pipeline)
+        m_export_pipeline->push(std::move(block));
+    else
+        _process_output_block(file, block);
+}
+
+void GCode::_process_output_block(FILE* file, OutputBlock &block)
+{
+    if (block.layer_id != size_t(-1)) {
+        // Apply cooling logic; this may alter speeds.
+        if (m_cooling_buffer) {
+            m_cooling_buffer->set_current_tool(block.tool);
+            block.gcode = m_cooling_buffer->process_layer(block.gcode, block.layer_id, block.append_time_only);
+        }
+#ifdef HAS_PRESSURE_EQUALIZER
+        // Apply pressure equalization if enabled;
+        // printf("G-code before filter:\n%s\n", gcode.c_str());
+        if (m_pressure_equalizer)
+            block.gcode = m_pressure_equalizer->process(block.gcode.c_str(), false);
+        // printf("G-code after filter:\n%s\n", out.c_str());
+#endif /* HAS_PRESSURE_EQUALIZER */
     }
+    _post_process(block.gcode, block.flush, block.tool);
+    // writes string to file
+    fwrite(block.gcode.c_str(), 1, block.gcode.size(), file);
+    m_processor.process_buffer(block.gcode);
 }
 
 void GCode::_writeln(FILE* file, const std::string &what)
@@ -3925,7 +4208,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, const std::string &descri
                 // normal & legacy pathcode
                 for (const Line& line : path.polyline.lines()) {
                     if (line.a == line.b) continue; //todo: investigate if it happens (it happens in perimeters)
-                    gcode += m_writer.extrude_to_xy(
+                    m_writer.extrude_to_xy(gcode,
                         this->point_to_gcode(line.b),
                         e_per_mm * unscaled(line.length()),
                         comment);
@@ -3967,7 +4250,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, const std::string &descri
                             //Create a point
                             Point inter_point1 = line.point_at(scale_d(length1));
                             //extrude very reduced
-                            gcode += m_writer.extrude_to_xy(
+                            m_writer.extrude_to_xy(gcode,
                                 this->point_to_gcode(inter_point1),
                                 e_per_mm * (length1) * mult1,
                                 comment);
@@ -3976,21 +4259,21 @@ std::string GCode::_extrude(const ExtrusionPath &path, const std::string &descri
                             if (line_length - length1 > length2) {
                                 Point inter_point2 = line.point_at(scale_d(length1 + length2));
                                 //extrude reduced
-                                gcode += m_writer.extrude_to_xy(
+                                m_writer.extrude_to_xy(gcode,
                                     this->point_to_gcode(inter_point2),
                                     e_per_mm * (length2) * mult2,
                                     comment);
                                 sum += e_per_mm * (length2) * mult2;
 
                                 //extrude normal
-                                gcode += m_writer.extrude_to_xy(
+                                m_writer.extrude_to_xy(gcode,
                                     this->point_to_gcode(line.b),
                                     e_per_mm * (line_length - (length1 + length2)),
                                     comment);
                                 sum += e_per_mm * (line_length - (length1 + length2));
                             } else {
                                 mult2 = 1 - coeff * (length2 / (line_length - length1));
-                                gcode += m_writer.extrude_to_xy(
+                                m_writer.extrude_to_xy(gcode,
                                     this->point_to_gcode(line.b),
                                     e_per_mm * (line_length - length1) * mult2,
                                     comment);
@@ -3998,14 +4281,14 @@ std::string GCode::_extrude(const ExtrusionPath &path, const std::string &descri
                             }
                         } else {
                             double mult = std::max(0.1, 1 - coeff * (scale_(path.width) / line_length));
-                            gcode += m_writer.extrude_to_xy(
+                            m_writer.extrude_to_xy(gcode,
                                 this->point_to_gcode(line.b),
                                 e_per_mm * line_length * mult,
                                 comment);
                         }
                     } else {
                         // nothing special, angle is too shallow to have any impact.
-                        gcode += m_writer.extrude_to_xy(
+                        m_writer.extrude_to_xy(gcode,
                             this->point_to_gcode(line.b),
                             e_per_mm * unscaled(line.length()),
                             comment);
@@ -4226,7 +4509,7 @@ std::string GCode::_before_extrude(const ExtrusionPath &path, const std::string
         config.set_key_value("layer_num", new ConfigOptionInt(m_layer_index + 1));
         config.set_key_value("layer_z", new ConfigOptionFloat(m_layer == nullptr ? m_last_height : m_layer->print_z));
         gcode += this->placeholder_parser_process("feature_gcode",
-            m_config.feature_gcode.value, m_writer.tool()->id(), &config)
+            *m_feature_gcode_template, m_writer.tool()->id(), &config)
             + "\n";
     }
     if (m_enable_extrusion_role_markers) {
@@ -4296,7 +4579,7 @@ std::string GCode::_before_extrude(const ExtrusionPath &path, const std::string
             comment += ";_EXTERNAL_PERIMETER";
     }
     // F is mm per minute.
-    gcode += m_writer.set_speed(F, "", comment);
+    m_writer.set_speed(gcode, F, "", comment);
 
     return gcode;
 }
@@ -4437,7 +4720,7 @@ void GCode::write_travel_to(std::string &gcode, const Polyline& travel, std::str
             } else if (current_speed < max_speed) {
                 current_speed = max_speed;
             }
-            gcode += m_writer.travel_to_xy(
+            m_writer.travel_to_xy(gcode,
                 this->point_to_gcode(travel.points[idx_print]),
                 current_speed>2 ? double(uint32_t(current_speed * 60)) : current_speed * 60,
                 comment);
@@ -4467,14 +4750,14 @@ void GCode::write_travel_to(std::string &gcode, const Polyline& travel, std::str
 
         //finish writing moves at current speed
         for (; idx_print < travel.size(); ++idx_print)
-            gcode += m_writer.travel_to_xy(this->point_to_gcode(travel.points[idx_print]),
+            m_writer.travel_to_xy(gcode, this->point_to_gcode(travel.points[idx_print]),
                 current_speed > 2 ? double(uint32_t(current_speed * 60)) : current_speed * 60,
                 comment);
         this->set_last_pos(travel.points.back());
     } else if (travel.size() >= 2) {
         for (size_t i = 1; i < travel.size(); ++i)
             // use G1 because we rely on paths being straight (G0 may make round paths)
-            gcode += m_writer.travel_to_xy(this->point_to_gcode(travel.points[i]), 0.0, comment);
+            m_writer.travel_to_xy(gcode, this->point_to_gcode(travel.points[i]), 0.0, comment);
         this->set_last_pos(travel.points.back());
     }
 }
@@ -122,34 +122,8 @@ public:
 
 class GCode : ExtrusionVisitorConst  {
 public:        
-    GCode() : 
-    	m_origin(Vec2d::Zero()),
-        m_enable_loop_clipping(true), 
-        m_enable_cooling_markers(false), 
-        m_enable_extrusion_role_markers(false), 
-        m_last_processor_extrusion_role(erNone),
-        m_layer_count(0),
-        m_layer_index(-1), 
-        m_layer(nullptr), 
-        m_volumetric_speed(0),
-        m_last_pos_defined(false),
-        m_last_extrusion_role(erNone),
-#if ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
-        m_last_width(0.0f),
-#endif // ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
-#if ENABLE_GCODE_VIEWER_DATA_CHECKING
-        m_last_mm3_per_mm(0.0),
-#if !ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
-        m_last_width(0.0f),
-#endif // !ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
-#endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
-        m_brim_done(false),
-        m_second_layer_things_done(false),
-        m_silent_time_estimator_enabled(false),
-        m_last_obj_copy(nullptr, Point(std::numeric_limits<coord_t>::max(), std::numeric_limits<coord_t>::max())),
-        m_last_too_small(ExtrusionRole::erNone)
-        {}
-    ~GCode() {}
+    GCode();
+    ~GCode();
 
     // throws std::runtime_exception on error,
     // throws CanceledException through print->throw_if_canceled().
@@ -172,6 +146,7 @@ public:
     // Process a template through the placeholder parser, collect error messages to be reported
     // inside the generated string and after the G-code export finishes.
     std::string     placeholder_parser_process(const std::string &name, const std::string &templ, uint16_t current_extruder_id, DynamicConfig *config_override = nullptr);
+    std::string     placeholder_parser_process(const std::string &name, const PlaceholderParser::CompiledTemplate &templ, uint16_t current_extruder_id, DynamicConfig *config_override = nullptr);
     bool            enable_cooling_markers() const { return m_enable_cooling_markers; }
     std::string     extrusion_role_to_string_for_parser(const ExtrusionRole &);
 
@@ -339,6 +314,10 @@ private:
     PlaceholderParser::ContextData      m_placeholder_parser_context;
     // Collection of templates, on which the placeholder substitution failed.
     std::map<std::string, std::string>  m_placeholder_parser_failed_templates;
+    // Custom G-code templates processed for each layer or extrusion role change, compiled by apply_print_config().
+    PlaceholderParser::CompiledTemplatePtr m_before_layer_gcode_template;
+    PlaceholderParser::CompiledTemplatePtr m_layer_gcode_template;
+    PlaceholderParser::CompiledTemplatePtr m_feature_gcode_template;
     OozePrevention                      m_ooze_prevention;
     Wipe                                m_wipe;
     AvoidCrossingPerimeters             m_avoid_crossing_perimeters;
@@ -434,6 +413,27 @@ private:
     // Write a string into a file.
     void _write(FILE* file, const std::string& what, bool flush = false) { this->_write(file, what.c_str(), flush); }
     void _write(FILE* file, const char *what, bool flush = false);
+    // Write the G-code of a layer into a file, after passing it through the cooling buffer.
+    void _write_layer(FILE* file, std::string &&gcode, size_t layer_id, bool append_time_only);
+
+    // A piece of G-code on its way to the file: cooling buffer (for layers), fan mover, fwrite.
+    struct OutputBlock {
+        std::string gcode;
+        // Tool active when the block was generated, its fan offset is used for the fan commands.
+        const Tool* tool = nullptr;
+        // Layer to cool, size_t(-1) if the block doesn't go through the cooling buffer.
+        size_t      layer_id = size_t(-1);
+        bool        append_time_only = false;
+        bool        flush = false;
+    };
+    void _write_block(FILE* file, OutputBlock &&block);
+    void _process_output_block(FILE* file, OutputBlock &block);
+    // Processes the OutputBlocks on a worker thread while the next layers are generated, see _do_export().
+    class ExportPipeline;
+    std::unique_ptr<ExportPipeline> m_export_pipeline;
+    // Computes the geometry looked up by the export of the next layers on worker threads, see _do_export().
+    class LayerGeometryPrecompute;
+    std::unique_ptr<LayerGeometryPrecompute> m_layer_geometry;
 
     // Write a string into a file. 
     // Add a newline, if the string does not end with a newline already.
@@ -445,7 +445,7 @@ private:
 
     //some post-processing on the file, with their data class
     std::unique_ptr<FanMover> m_fan_mover;
-    void _post_process(std::string& what, bool flush = true);
+    void _post_process(std::string& what, bool flush = true, const Tool* tool = nullptr);
 
     std::string _extrude(const ExtrusionPath &path, const std::string &description, double speed = -1);
     std::string _before_extrude(const ExtrusionPath &path, const std::string &description, double speed = -1);
@@ -983,6 +983,64 @@ static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons
     init_boundary_distances(boundary);
 }
 
+// Boundary for the travels inside the object, following the second perimeter.
+static void init_internal_boundary(AvoidCrossingPerimeters::Boundary *boundary, const Layer &layer)
+{
+    const float perimeter_spacing = get_perimeter_spacing(layer);
+    std::vector<std::pair<ExPolygon, ExPolygons>> boundary_growth;
+    //create better slice (on second perimeter instead of the first)
+    ExPolygons expoly_boundary;
+    //as we are going to reduce, do it expoli per expoli
+    for (const ExPolygon& origin : layer.lslices) {
+        ExPolygons second_peri = offset_ex(origin, -perimeter_spacing * 1.5f);
+        //there is a collapse! try to add missing parts
+        if (second_peri.size() > 1) {
+            // get the bits that are collapsed
+            ExPolygons missing_parts = diff_ex({ origin }, offset_ex(second_peri, perimeter_spacing * 1.51f), true);
+            //have to grow a bit to be able to fit inside the reduced thing
+            // then intersect to be sure it don't stick out of the initial poly
+            missing_parts = intersection_ex({ origin }, offset_ex(missing_parts, perimeter_spacing * 1.1f));
+            // offset to second peri (-first) where possible, then union and reduce to the first.
+            second_peri = offset_ex(union_ex(missing_parts, offset_ex(origin, -perimeter_spacing * 0.9f)), -perimeter_spacing * .6f);
+        } else if (second_peri.size() == 0) {
+            // try again with the first perimeter (should be 0.5, but even with overlapping peri, it's almost never a 50% overlap, so it's better that way)
+            second_peri = offset_ex(origin, -perimeter_spacing * .6f);
+        }
+        append(expoly_boundary, second_peri);
+        boundary_growth.push_back({ origin, second_peri });
+    }
+    init_boundary(boundary, to_polygons(expoly_boundary));
+    boundary->boundary_growth = boundary_growth;
+}
+
+// Initialize the boundaries only when it is necessary, a boundary computed empty is computed again at the next travel.
+const AvoidCrossingPerimeters::Boundary& AvoidCrossingPerimeters::internal_boundary(const Layer &layer)
+{
+    if (m_internal_used == nullptr || m_internal_used->boundaries.empty()) {
+        if (m_precomputed && m_precomputed->layer == &layer) {
+            m_internal_used = &m_precomputed->internal;
+        } else {
+            init_internal_boundary(&m_internal, layer);
+            m_internal_used = &m_internal;
+        }
+    }
+    return *m_internal_used;
+}
+
+// Initialize the boundary only when exist any external travel for the current layer.
+const AvoidCrossingPerimeters::Boundary& AvoidCrossingPerimeters::external_boundary(const Layer &layer)
+{
+    if (m_external_used == nullptr || m_external_used->boundaries.empty()) {
+        if (m_precomputed && m_precomputed->layer == &layer) {
+            m_external_used = &m_precomputed->external;
+        } else {
+            init_boundary(&m_external, get_boundary_external(layer));
+            m_external_used = &m_external;
+        }
+    }
+    return *m_external_used;
+}
+
 // Plan travel, which avoids perimeter crossings by following the boundaries of the layer.
 Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &point, bool *could_be_wipe_disabled)
 {
@@ -1006,48 +1064,18 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     if (!use_external && (is_support_layer || !lslices.empty()
         /*|| (!lslices.empty() && !any_expolygon_contains(lslices, lslices_bboxes, m_grid_lslice, travel)) already done by the caller */
         )) {
-        // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty()) {
-            std::vector<std::pair<ExPolygon, ExPolygons>> boundary_growth;
-            //create better slice (on second perimeter instead of the first)
-            ExPolygons expoly_boundary;
-            //as we are going to reduce, do it expoli per expoli
-            for (const ExPolygon& origin : lslices) {
-                ExPolygons second_peri = offset_ex(origin, -perimeter_spacing * 1.5f);
-                //there is a collapse! try to add missing parts
-                if (second_peri.size() > 1) {
-                    // get the bits that are collapsed
-                    ExPolygons missing_parts = diff_ex({ origin }, offset_ex(second_peri, perimeter_spacing * 1.51f), true);
-                    //have to grow a bit to be able to fit inside the reduced thing
-                    // then intersect to be sure it don't stick out of the initial poly
-                    missing_parts = intersection_ex({ origin }, offset_ex(missing_parts, perimeter_spacing * 1.1f));
-                    // offset to second peri (-first) where possible, then union and reduce to the first.
-                    second_peri = offset_ex(union_ex(missing_parts, offset_ex(origin, -perimeter_spacing * 0.9f)), -perimeter_spacing * .6f);
-                } else if (second_peri.size() == 0) {
-                    // try again with the first perimeter (should be 0.5, but even with overlapping peri, it's almost never a 50% overlap, so it's better that way)
-                    second_peri = offset_ex(origin, -perimeter_spacing * .6f);
-                }
-                append(expoly_boundary, second_peri);
-                boundary_growth.push_back({ origin, second_peri });
-            }
-            init_boundary(&m_internal, to_polygons(expoly_boundary));
-            m_internal.boundary_growth = boundary_growth;
-        }
-
+        const Boundary &internal = this->internal_boundary(*gcodegen.layer());
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), perimeter_spacing, result_pl);
+        if (!internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, internal.bbox)) {
+            travel_intersection_count = avoid_perimeters(internal, startf.cast<coord_t>(), endf.cast<coord_t>(), perimeter_spacing, result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
     } else if(use_external) {
-        // Initialize m_external only when exist any external travel for the current layer.
-        if (m_external.boundaries.empty())
-            init_boundary(&m_external, get_boundary_external(*gcodegen.layer()));
-
+        const Boundary &external = this->external_boundary(*gcodegen.layer());
         // Trim the travel line by the bounding box.
-        if (!m_external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_external.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_external, startf.cast<coord_t>(), endf.cast<coord_t>(), 0, result_pl);
+        if (!external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, external.bbox)) {
+            travel_intersection_count = avoid_perimeters(external, startf.cast<coord_t>(), endf.cast<coord_t>(), 0, result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -1088,20 +1116,27 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+void AvoidCrossingPerimeters::init_layer(const Layer &layer, std::shared_ptr<const LayerBoundaries> precomputed)
 {
     m_internal.clear();
     m_external.clear();
-
-    BoundingBox bbox_slice(get_extents(layer.lslices));
-    bbox_slice.offset(SCALED_EPSILON);
-
-    m_grid_lslice.set_bbox(bbox_slice);
-    //FIXME 1mm grid?
-    m_grid_lslice.create(layer.lslices, coord_t(scale_(1.)));
+    m_internal_used = nullptr;
+    m_external_used = nullptr;
+    m_precomputed   = precomputed && precomputed->layer == &layer ? std::move(precomputed) : nullptr;
     m_init = true;
 }
 
+// Computes both boundaries, as travel_to() would do on demand. Only reads the print, thus it may run on a worker thread.
+std::shared_ptr<const AvoidCrossingPerimeters::LayerBoundaries> AvoidCrossingPerimeters::precompute_layer(const Layer &layer)
+{
+    auto boundaries = std::make_shared<LayerBoundaries>();
+    boundaries->layer = &layer;
+    if (dynamic_cast<const SupportLayer*>(&layer) != nullptr || ! layer.lslices.empty())
+        init_internal_boundary(&boundaries->internal, layer);
+    init_boundary(&boundaries->external, get_boundary_external(layer));
+    return boundaries;
+}
+
 #if 0
 static double travel_length(const std::vector<TravelPoint> &travel) {
     double total_length = 0;
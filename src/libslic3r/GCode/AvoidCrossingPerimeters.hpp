@@ -5,6 +5,8 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <memory>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -22,7 +24,9 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
-    void        init_layer(const Layer &layer);
+    struct LayerBoundaries;
+    // The boundaries of the layer are computed on demand, unless they were precomputed by precompute_layer().
+    void        init_layer(const Layer &layer, std::shared_ptr<const LayerBoundaries> precomputed = nullptr);
     bool        is_init() { return m_init; }
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
@@ -53,6 +57,14 @@ public:
         }
     };
 
+    // Boundaries of a layer computed ahead of the G-code export of the layer, possibly on a worker thread.
+    struct LayerBoundaries {
+        const Layer *layer { nullptr };
+        Boundary     internal;
+        Boundary     external;
+    };
+    static std::shared_ptr<const LayerBoundaries> precompute_layer(const Layer &layer);
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -63,12 +75,18 @@ private:
 
     bool m_init{ false };
 
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid m_grid_lslice;
+    const Boundary& internal_boundary(const Layer &layer);
+    const Boundary& external_boundary(const Layer &layer);
+
     // Store all needed data for travels inside object
     Boundary m_internal;
     // Store all needed data for travels outside object
     Boundary m_external;
+    // Boundaries of the layer passed to init_layer(), if precomputed.
+    std::shared_ptr<const LayerBoundaries> m_precomputed;
+    // m_internal / m_external or the precomputed ones, chosen at the first travel after init_layer().
+    const Boundary *m_internal_used { nullptr };
+    const Boundary *m_external_used { nullptr };
 };
 
 } // namespace Slic3r
@@ -9,6 +9,7 @@ namespace Slic3r {
 
 class GCode;
 class Layer;
+class Tool;
 struct PerExtruderAdjustments;
 
 // A standalone G-code filter, to control cooling of the print.
@@ -25,6 +26,8 @@ public:
     CoolingBuffer(GCode &gcodegen);
     void        reset();
     void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
+    /// tool to emit the fan commands for, instead of the current tool of the writer (which may be ahead if the layers are cooled behind their generation).
+    void        set_current_tool(const Tool *tool) { m_current_tool = tool; }
     /// process the laer :check the time and apply fan / speed change
     /// append_time_only: if he layer is only support, then you can put this at true to not process the layer but just append its time to the next one.
     std::string process_layer(const std::string &gcode, size_t layer_id, bool append_time_only = false);
@@ -37,6 +40,7 @@ private:
     // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
     // Returns the adjusted G-code.
     std::string apply_layer_cooldown(const std::string &gcode, size_t layer_id, float layer_time, std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
+    std::string set_fan(uint8_t speed);
 
     GCode&              m_gcodegen;
     std::string         m_gcode;
@@ -45,6 +49,7 @@ private:
     std::vector<char>   m_axis;
     std::vector<float>  m_current_pos;
     unsigned int        m_current_extruder;
+    const Tool*         m_current_tool = nullptr;
 
     //saved previous unslowed layer 
     std::map<size_t, float> saved_layer_time_support;
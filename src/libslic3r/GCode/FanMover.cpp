@@ -265,10 +265,10 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                                 _remove_slow_fan(fan_baseline, kickstart);
                                 // print me
                                 if (!m_buffer.empty() && (m_buffer_time_size - m_buffer.front().time * 0.1) > nb_seconds_delay) {
-                                    _print_in_middle_G1(m_buffer.front(), m_buffer_time_size - nb_seconds_delay, m_writer.set_fan(100, true));
+                                    _print_in_middle_G1(m_buffer.front(), m_buffer_time_size - nb_seconds_delay, set_fan(100));
                                     remove_from_buffer(m_buffer.begin());
                                 } else {
-                                    m_process_output += m_writer.set_fan(100, true);
+                                    m_process_output += set_fan(100);
                                 }
                                 //write it in the queue if possible
                                 const float kickstart_duration = kickstart * float(fan_speed - m_front_buffer_fan_speed) / 100.f;
@@ -329,7 +329,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
                                 float kickstart_duration = kickstart * float(fan_speed - m_back_buffer_fan_speed) / 100.f;
                                 //if kickstart, write the M106 S[fan_baseline] first
                                 //set the target speed and set the kickstart flag
-                                put_in_buffer(BufferData(m_writer.set_fan(100, true), 0, fan_speed, true));
+                                put_in_buffer(BufferData(set_fan(100), 0, fan_speed, true));
                                 //kickstart!
                                 //m_process_output += m_writer.set_fan(100, true);
                                 //add the normal speed line for the future
@@ -426,7 +426,7 @@ void FanMover::_process_gcode_line(GCodeReader& reader, const GCodeReader::GCode
             if (frontdata.fan_speed < 0 || frontdata.fan_speed != m_front_buffer_fan_speed || frontdata.is_kickstart) {
                 if (frontdata.is_kickstart && frontdata.fan_speed < m_front_buffer_fan_speed) {
                     //you have to slow down! not kickstart! rewrite the fan speed.
-                    m_process_output += m_writer.set_fan(frontdata.fan_speed,true);
+                    m_process_output += set_fan(frontdata.fan_speed);
                     m_front_buffer_fan_speed = frontdata.fan_speed;
                 } else {
                     m_process_output += frontdata.raw + "\n";
@@ -39,6 +39,8 @@ private:
 
     GCodeReader m_parser{};
     GCodeWriter& m_writer;
+    // tool to emit the fan commands for, if the G-code is processed behind the writer.
+    const Tool* m_current_tool = nullptr;
 
     //current value (at the back of the buffer), when parsing a new line
     ExtrusionRole current_role = ExtrusionRole::erCustom;
@@ -68,8 +70,12 @@ public:
 
     // Adds the gcode contained in the given string to the analysis and returns it after removing the workcodes
     const std::string& process_gcode(const std::string& gcode, bool flush);
+    void set_current_tool(const Tool* tool) { m_current_tool = tool; }
 
 private:
+    std::string set_fan(uint8_t speed) {
+        return m_current_tool == nullptr ? m_writer.set_fan(speed, true) : m_writer.set_fan_for_tool(m_current_tool, speed, true);
+    }
     BufferData& put_in_buffer(BufferData&& data) {
         m_buffer_time_size += data.time;
         m_buffer.emplace_back(data);
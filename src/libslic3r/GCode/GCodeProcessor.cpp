@@ -4,6 +4,7 @@
 #include "GCodeProcessor.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
@@ -17,6 +18,7 @@
 #endif
 
 #include <chrono>
+#include <cstring>
 
 static const float INCHES_TO_MM = 25.4f;
 static const float MMMIN_TO_MMSEC = 1.0f / 60.0f;
@@ -331,17 +333,25 @@ void GCodeProcessor::TimeProcessor::reset()
     machines[static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Normal)].enabled = true;
 }
 
-void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
+void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, size_t offset)
 {
+    // The M73 lines are added all over the file.
+    assert(offset == 0 || ! export_remaining_time_enabled);
+
     boost::nowide::ifstream in(filename);
     if (!in.good())
         throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nCannot open file for reading.\n"));
+    if (offset > 0)
+        in.seekg(offset);
 
-    // temporary file to contain modified gcode
+    // temporary file to contain modified gcode (the tail of the file is rewritten in place from memory)
     std::string out_path = filename + ".postprocess";
-    FILE* out = boost::nowide::fopen(out_path.c_str(), "wb");
-    if (out == nullptr)
-        throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nCannot open file for writing.\n"));
+    FILE* out = nullptr;
+    if (offset == 0) {
+        out = boost::nowide::fopen(out_path.c_str(), "wb");
+        if (out == nullptr)
+            throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nCannot open file for writing.\n"));
+    }
 
     auto time_in_minutes = [](float time_in_seconds) {
         return int(::roundf(time_in_seconds / 60.0f));
@@ -475,7 +485,8 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
 
     while (std::getline(in, gcode_line)) {
         if (!in.good()) {
-            fclose(out);
+            if (out != nullptr)
+                fclose(out);
             throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nError while reading from file.\n"));
         }
 
@@ -499,10 +510,24 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
         }
 
         export_line += gcode_line;
-        if (export_line.length() > 65535)
+        if (out != nullptr && export_line.length() > 65535)
             write_string(export_line);
     }
 
+    if (out == nullptr) {
+        in.close();
+        boost::nowide::fstream tail(filename, std::ios::in | std::ios::out | std::ios::binary);
+        tail.seekp(offset);
+        tail.write(export_line.data(), export_line.size());
+        tail.close();
+        if (! tail)
+            throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nIs the disk full?\n"));
+        // The placeholders may be longer than their replacement.
+        if (boost::filesystem::file_size(filename) > offset + export_line.size())
+            boost::filesystem::resize_file(filename, offset + export_line.size());
+        return;
+    }
+
     if (!export_line.empty())
         write_string(export_line);
 
@@ -531,6 +556,200 @@ const std::vector<std::pair<GCodeProcessor::EProducer, std::string>> GCodeProces
     { EProducer::KissSlicer,  "KISSlicer" }
 };
 
+static inline float position_from_um(int64_t um)
+{
+    return float(double(um) / 1000.);
+}
+
+// Returns false if the coordinate is not decoded back exactly from micrometers.
+static inline bool position_to_um(float value, int64_t& um)
+{
+    if (! (std::abs(value) < 1e9f))
+        return false;
+    um = int64_t(std::llround(double(value) * 1000.));
+    return position_from_um(um) == value;
+}
+
+void GCodeProcessor::MoveVertices::push_back(const MoveVertex& move)
+{
+    const size_t idx = m_types.size();
+    if (idx % Position_Block_Size == 0)
+        m_position_checkpoints.push_back({ m_position_um, m_position_floats.size() });
+    PositionDelta delta;
+    for (int i = 0; i < 3; ++i) {
+        int64_t um;
+        bool    in_um = position_to_um(move.position[i], um);
+        if (in_um && std::abs(um - m_position_um[i]) <= std::numeric_limits<int16_t>::max())
+            delta[i] = int16_t(um - m_position_um[i]);
+        else {
+            // Too far from the previous position or not a multiple of micrometer, for example shifted by an extruder offset.
+            delta[i] = Position_Escape;
+            m_position_floats.emplace_back(move.position[i]);
+        }
+        // The decoder restarts from an escaped coordinate the same way.
+        if (in_um)
+            m_position_um[i] = um;
+    }
+    m_position_deltas.emplace_back(delta);
+    m_types.emplace_back(move.type);
+    m_delta_extruder.emplace_back(move.delta_extruder);
+    m_time.emplace_back(move.time);
+    m_extrusion_role.push_back(move.extrusion_role, idx);
+    m_extruder_id.push_back(move.extruder_id, idx);
+    m_cp_color_id.push_back(move.cp_color_id, idx);
+    m_feedrate.push_back(move.feedrate, idx);
+    m_width.push_back(move.width, idx);
+    m_height.push_back(move.height, idx);
+    m_mm3_per_mm.push_back(move.mm3_per_mm, idx);
+    m_fan_speed.push_back(move.fan_speed, idx);
+    m_layer_duration.push_back(move.layer_duration, idx);
+    m_temperature.push_back(move.temperature, idx);
+}
+
+void GCodeProcessor::MoveVertices::shrink_to_fit()
+{
+    m_types.shrink_to_fit();
+    m_position_deltas.shrink_to_fit();
+    m_position_floats.shrink_to_fit();
+    m_position_checkpoints.shrink_to_fit();
+    m_delta_extruder.shrink_to_fit();
+    m_time.shrink_to_fit();
+    m_extrusion_role.shrink_to_fit();
+    m_extruder_id.shrink_to_fit();
+    m_cp_color_id.shrink_to_fit();
+    m_feedrate.shrink_to_fit();
+    m_width.shrink_to_fit();
+    m_height.shrink_to_fit();
+    m_mm3_per_mm.shrink_to_fit();
+    m_fan_speed.shrink_to_fit();
+    m_layer_duration.shrink_to_fit();
+    m_temperature.shrink_to_fit();
+}
+
+size_t GCodeProcessor::MoveVertices::memsize() const
+{
+    return sizeof(*this) + SLIC3R_STDVEC_MEMSIZE(m_types, EMoveType) + SLIC3R_STDVEC_MEMSIZE(m_position_deltas, PositionDelta) +
+        SLIC3R_STDVEC_MEMSIZE(m_position_floats, float) + SLIC3R_STDVEC_MEMSIZE(m_position_checkpoints, PositionCheckpoint) +
+        SLIC3R_STDVEC_MEMSIZE(m_delta_extruder, float) + SLIC3R_STDVEC_MEMSIZE(m_time, float) +
+        m_extrusion_role.memsize() + m_extruder_id.memsize() + m_cp_color_id.memsize() + m_feedrate.memsize() + m_width.memsize() +
+        m_height.memsize() + m_mm3_per_mm.memsize() + m_fan_speed.memsize() + m_layer_duration.memsize() + m_temperature.memsize();
+}
+
+GCodeProcessor::MoveVertex GCodeProcessor::MoveVertices::operator[](size_t idx) const
+{
+    assert(idx < this->size());
+    return *const_iterator(*this, idx);
+}
+
+GCodeProcessor::MoveVertices::const_iterator GCodeProcessor::MoveVertices::begin() const
+{
+    return const_iterator(*this, 0);
+}
+
+GCodeProcessor::MoveVertices::const_iterator GCodeProcessor::MoveVertices::end() const
+{
+    return const_iterator(*this, this->size());
+}
+
+GCodeProcessor::MoveVertices::const_iterator GCodeProcessor::MoveVertices::iterator_at(size_t idx) const
+{
+    return const_iterator(*this, std::min(idx, this->size()));
+}
+
+GCodeProcessor::MoveVertices::const_iterator::const_iterator(const MoveVertices& moves, size_t idx) : m_moves(&moves), m_idx(idx)
+{
+    if (idx == moves.size())
+        // end()
+        return;
+    // Decode the positions starting with the checkpoint of the block.
+    const PositionCheckpoint& checkpoint = moves.m_position_checkpoints[idx / Position_Block_Size];
+    m_position_um = checkpoint.position_um;
+    m_float_idx   = checkpoint.float_idx;
+    for (m_idx = idx - idx % Position_Block_Size; m_idx <= idx; ++m_idx)
+        this->decode_position();
+    m_idx = idx;
+    this->seek_run(moves.m_extrusion_role, m_extrusion_role);
+    this->seek_run(moves.m_extruder_id, m_extruder_id);
+    this->seek_run(moves.m_cp_color_id, m_cp_color_id);
+    this->seek_run(moves.m_feedrate, m_feedrate);
+    this->seek_run(moves.m_width, m_width);
+    this->seek_run(moves.m_height, m_height);
+    this->seek_run(moves.m_mm3_per_mm, m_mm3_per_mm);
+    this->seek_run(moves.m_fan_speed, m_fan_speed);
+    this->seek_run(moves.m_layer_duration, m_layer_duration);
+    this->seek_run(moves.m_temperature, m_temperature);
+    this->decode_attributes();
+}
+
+GCodeProcessor::MoveVertices::const_iterator& GCodeProcessor::MoveVertices::const_iterator::operator++()
+{
+    if (++m_idx < m_moves->size()) {
+        this->decode_position();
+        this->next_run(m_moves->m_extrusion_role, m_extrusion_role);
+        this->next_run(m_moves->m_extruder_id, m_extruder_id);
+        this->next_run(m_moves->m_cp_color_id, m_cp_color_id);
+        this->next_run(m_moves->m_feedrate, m_feedrate);
+        this->next_run(m_moves->m_width, m_width);
+        this->next_run(m_moves->m_height, m_height);
+        this->next_run(m_moves->m_mm3_per_mm, m_mm3_per_mm);
+        this->next_run(m_moves->m_fan_speed, m_fan_speed);
+        this->next_run(m_moves->m_layer_duration, m_layer_duration);
+        this->next_run(m_moves->m_temperature, m_temperature);
+        this->decode_attributes();
+    }
+    return *this;
+}
+
+void GCodeProcessor::MoveVertices::const_iterator::decode_position()
+{
+    const PositionDelta& delta = m_moves->m_position_deltas[m_idx];
+    for (int i = 0; i < 3; ++i) {
+        if (delta[i] == Position_Escape) {
+            m_move.position[i] = m_moves->m_position_floats[m_float_idx++];
+            int64_t um;
+            if (position_to_um(m_move.position[i], um))
+                m_position_um[i] = um;
+        }
+        else {
+            m_position_um[i] += delta[i];
+            m_move.position[i] = position_from_um(m_position_um[i]);
+        }
+    }
+}
+
+void GCodeProcessor::MoveVertices::const_iterator::decode_attributes()
+{
+    m_move.type           = m_moves->m_types[m_idx];
+    m_move.delta_extruder = m_moves->m_delta_extruder[m_idx];
+    m_move.time           = m_moves->m_time[m_idx];
+    m_move.extrusion_role = m_moves->m_extrusion_role.values[m_extrusion_role.run];
+    m_move.extruder_id    = m_moves->m_extruder_id.values[m_extruder_id.run];
+    m_move.cp_color_id    = m_moves->m_cp_color_id.values[m_cp_color_id.run];
+    m_move.feedrate       = m_moves->m_feedrate.values[m_feedrate.run];
+    m_move.width          = m_moves->m_width.values[m_width.run];
+    m_move.height         = m_moves->m_height.values[m_height.run];
+    m_move.mm3_per_mm     = m_moves->m_mm3_per_mm.values[m_mm3_per_mm.run];
+    m_move.fan_speed      = m_moves->m_fan_speed.values[m_fan_speed.run];
+    m_move.layer_duration = m_moves->m_layer_duration.values[m_layer_duration.run];
+    m_move.temperature    = m_moves->m_temperature.values[m_temperature.run];
+}
+
+template<typename T>
+void GCodeProcessor::MoveVertices::const_iterator::seek_run(const RunLengthColumn<T>& column, RunCursor& cursor)
+{
+    cursor.run        = column.run_of(m_idx);
+    cursor.next_start = cursor.run + 1 < column.starts.size() ? column.starts[cursor.run + 1] : std::numeric_limits<size_t>::max();
+}
+
+template<typename T>
+void GCodeProcessor::MoveVertices::const_iterator::next_run(const RunLengthColumn<T>& column, RunCursor& cursor)
+{
+    if (m_idx == cursor.next_start) {
+        ++cursor.run;
+        cursor.next_start = cursor.run + 1 < column.starts.size() ? column.starts[cursor.run + 1] : std::numeric_limits<size_t>::max();
+    }
+}
+
 unsigned int GCodeProcessor::s_result_id = 0;
 
 GCodeProcessor::GCodeProcessor()
@@ -858,6 +1077,10 @@ void GCodeProcessor::reset()
 
     m_time_processor.reset();
 
+    m_stream_rest.clear();
+    m_stream_size = 0;
+    m_stream_placeholder_offset = std::string::npos;
+
     m_result.reset();
     m_result.id = ++s_result_id;
 
@@ -922,7 +1145,7 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
     // process gcode
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(MoveVertex());
+    m_result.moves.push_back(MoveVertex());
     m_parser.parse_file(filename, [this, cancel_callback, &last_cancel_callback_time](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (cancel_callback != nullptr) {
             // call the cancel callback every 100 ms
@@ -935,14 +1158,81 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
         process_gcode_line(line);
         });
 
-    // update width/height of wipe moves
-    for (MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
-            move.height = Wipe_Height;
+    this->finalize(filename, apply_postprocess, 0);
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+    m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+}
+
+void GCodeProcessor::start_stream()
+{
+    m_result.id = ++s_result_id;
+    // 1st move must be a dummy move
+    m_result.moves.push_back(MoveVertex());
+}
+
+void GCodeProcessor::process_buffer(const std::string& buffer)
+{
+    // Same line splitting as GCodeReader::parse_file(), which parses each line up to its first end of line character.
+    auto callback = [this](GCodeReader& reader, const GCodeReader::GCodeLine& line) { process_gcode_line(line); };
+    auto process_line = [this, &callback](const char* begin, const char* end) {
+        GCodeReader::GCodeLine line;
+        m_parser.parse_line(begin, line, callback);
+        if (m_stream_placeholder_offset == std::string::npos && *begin == ';' && end - begin >= 6 && strncmp(begin, "; _GP_", 6) == 0) {
+            std::string_view str(begin, end - begin);
+            if (str == First_Line_M73_Placeholder_Tag || str == Last_Line_M73_Placeholder_Tag || str == Estimated_Printing_Time_Placeholder_Tag)
+                m_stream_placeholder_offset = m_stream_size;
         }
+    };
+
+    const char* ptr = buffer.c_str();
+    const char* end = ptr + buffer.size();
+    while (ptr != end) {
+        const char* eol = static_cast<const char*>(memchr(ptr, '\n', end - ptr));
+        if (eol == nullptr) {
+            m_stream_rest.append(ptr, end);
+            break;
+        }
+        if (m_stream_rest.empty()) {
+            // The line ends with '\n', parse_line() stops there.
+            process_line(ptr, eol);
+            m_stream_size += eol + 1 - ptr;
+        } else {
+            // First line continuing the rest of the previous buffer.
+            m_stream_rest.append(ptr, eol + 1);
+            process_line(m_stream_rest.c_str(), m_stream_rest.c_str() + m_stream_rest.size() - 1);
+            m_stream_size += m_stream_rest.size();
+            m_stream_rest.clear();
+        }
+        ptr = eol + 1;
+    }
+}
+
+void GCodeProcessor::finalize_stream(const std::string& filename, bool apply_postprocess)
+{
+    size_t postprocess_offset = m_stream_placeholder_offset;
+    if (! m_stream_rest.empty()) {
+        // Last line without end of line, the post-processing adds it.
+        m_parser.parse_line(m_stream_rest, [this](GCodeReader& reader, const GCodeReader::GCodeLine& line) { process_gcode_line(line); });
+        postprocess_offset = std::min(postprocess_offset, m_stream_size);
+        m_stream_size += m_stream_rest.size();
+        m_stream_rest.clear();
     }
+    if (m_time_processor.export_remaining_time_enabled)
+        // M73 lines are added all over the file. Their values are the remaining times, known only after
+        // the last line was processed, and they are inserted at the layer changes and at every minute
+        // of printing, therefore the whole file is rewritten once. Reserving fixed width lines while
+        // exporting would save that pass, but it would change the exported G-code.
+        postprocess_offset = 0;
+    else if (postprocess_offset == std::string::npos)
+        // Nothing to fill in.
+        apply_postprocess = false;
+    this->finalize(filename, apply_postprocess, postprocess_offset);
+}
 
+void GCodeProcessor::finalize(const std::string& filename, bool apply_postprocess, size_t postprocess_offset)
+{
     // process the time blocks
     for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Count); ++i) {
         TimeMachine& machine = m_time_processor.machines[i];
@@ -956,28 +1246,22 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
 
     // post-process to add M73 lines into the gcode
     if (apply_postprocess)
-        m_time_processor.post_process(filename);
+        m_time_processor.post_process(filename, postprocess_offset);
 
     //update times for results
-    for (size_t i = 0; i < m_result.moves.size(); i++) {
+    const std::vector<float>& layer_times = m_result.time_statistics.modes[0].layers_times;
+    m_result.moves.transform_layer_durations([&layer_times](float layer_duration) {
         //field layer_duration contains the layer id for the move in which the layer_duration has to be set.
-        size_t layer_id = size_t(m_result.moves[i].layer_duration);
-        std::vector<float>& layer_times = m_result.time_statistics.modes[0].layers_times;
-        if (layer_times.size() > layer_id - 1 && layer_id > 0)
-            m_result.moves[i].layer_duration = layer_times[layer_id - 1];
-        else
-            m_result.moves[i].layer_duration = 0;
-}
+        size_t layer_id = size_t(layer_duration);
+        return (layer_times.size() > layer_id - 1 && layer_id > 0) ? layer_times[layer_id - 1] : 0.f;
+    });
+    m_result.moves.shrink_to_fit();
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     m_mm3_per_mm_compare.output();
     m_height_compare.output();
     m_width_compare.output();
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
 
-#if ENABLE_GCODE_VIEWER_STATISTICS
-    m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-
     //result is now updated
     m_result.computed_timestamp = std::time(0);
 }
@@ -2701,7 +2985,11 @@ void GCodeProcessor::store_move_vertex(EMoveType type)
         m_time_processor.machines[0].time, //time: set later
         m_temperature
     };
-    m_result.moves.emplace_back(vertex);
+    if (type == EMoveType::Wipe) {
+        vertex.width = Wipe_Width;
+        vertex.height = Wipe_Height;
+    }
+    m_result.moves.push_back(vertex);
 }
 
 float GCodeProcessor::minimum_feedrate(PrintEstimatedTimeStatistics::ETimeMode mode, float feedrate) const
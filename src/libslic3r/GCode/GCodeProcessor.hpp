@@ -9,7 +9,10 @@
 
 #include <cstdint>
 #include <ctime>
+#include <algorithm>
 #include <array>
+#include <iterator>
+#include <limits>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -255,7 +258,8 @@ namespace Slic3r {
             void reset();
 
             // post process the file with the given filename to add remaining time lines M73
-            void post_process(const std::string& filename);
+            // if offset != 0, only the lines starting at offset are processed (and rewritten in place), there must not be any M73 line to add.
+            void post_process(const std::string& filename, size_t offset = 0);
         };
 
     public:
@@ -279,6 +283,129 @@ namespace Slic3r {
             float volumetric_rate() const { return feedrate * mm3_per_mm; }
         };
 
+        // Moves of the processed G-code stored by columns, a large G-code produces tens of millions of moves.
+        // The positions are delta encoded in micrometers, a coordinate not representable that way or too far from the previous one
+        // is stored as a float.
+        // The attributes, which change rarely, are run-length encoded.
+        // Iterate the moves with const_iterator, which decodes each move from the previous one. operator[] decodes a single move
+        // from the nearest position checkpoint, it is meant for sparse access only.
+        class MoveVertices
+        {
+        public:
+            class const_iterator;
+
+            void            push_back(const MoveVertex& move);
+            size_t          size() const { return m_types.size(); }
+            bool            empty() const { return m_types.empty(); }
+            void            clear() { *this = MoveVertices(); }
+            void            shrink_to_fit();
+            size_t          memsize() const;
+
+            MoveVertex      operator[](size_t idx) const;
+            const_iterator  begin() const;
+            const_iterator  end() const;
+            // Iterator pointing to the move with the given index.
+            const_iterator  iterator_at(size_t idx) const;
+
+            // Replace the layer duration of all moves by f(layer_duration).
+            template<typename F> void transform_layer_durations(F f) { for (float& v : m_layer_duration.values) v = f(v); }
+
+        private:
+            template<typename T> struct RunLengthColumn
+            {
+                // Value of each run and index of the first move of each run.
+                std::vector<T>          values;
+                std::vector<uint32_t>   starts;
+
+                void   push_back(const T& value, size_t idx) {
+                    if (values.empty() || !(values.back() == value)) {
+                        values.emplace_back(value);
+                        starts.emplace_back(uint32_t(idx));
+                    }
+                }
+                size_t run_of(size_t idx) const { return std::upper_bound(starts.begin(), starts.end(), uint32_t(idx)) - starts.begin() - 1; }
+                size_t memsize() const { return values.capacity() * sizeof(T) + starts.capacity() * sizeof(uint32_t); }
+                void   shrink_to_fit() { values.shrink_to_fit(); starts.shrink_to_fit(); }
+            };
+
+            // Delta of a position to the previous one in micrometers, Position_Escape marks a coordinate stored in m_position_floats.
+            using PositionDelta = std::array<int16_t, 3>;
+            static constexpr int16_t Position_Escape = std::numeric_limits<int16_t>::min();
+            // State of the position decoder before the first move of each block of Position_Block_Size moves.
+            static constexpr size_t  Position_Block_Size = 64;
+            struct PositionCheckpoint
+            {
+                std::array<int64_t, 3>  position_um;
+                size_t                  float_idx;
+            };
+
+            std::vector<EMoveType>              m_types;
+            std::vector<PositionDelta>          m_position_deltas;
+            std::vector<float>                  m_position_floats;
+            std::vector<PositionCheckpoint>     m_position_checkpoints;
+            std::array<int64_t, 3>              m_position_um{ 0, 0, 0 };
+            std::vector<float>                  m_delta_extruder;
+            std::vector<float>                  m_time;
+            RunLengthColumn<ExtrusionRole>      m_extrusion_role;
+            RunLengthColumn<unsigned char>      m_extruder_id;
+            RunLengthColumn<unsigned char>      m_cp_color_id;
+            RunLengthColumn<float>              m_feedrate;
+            RunLengthColumn<float>              m_width;
+            RunLengthColumn<float>              m_height;
+            RunLengthColumn<float>              m_mm3_per_mm;
+            RunLengthColumn<float>              m_fan_speed;
+            RunLengthColumn<float>              m_layer_duration;
+            RunLengthColumn<float>              m_temperature;
+        };
+
+        class MoveVertices::const_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = MoveVertex;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const MoveVertex*;
+            using reference         = const MoveVertex&;
+
+            const MoveVertex&   operator*() const { return m_move; }
+            const MoveVertex*   operator->() const { return &m_move; }
+            const_iterator&     operator++();
+            bool                operator==(const const_iterator& rhs) const { return m_idx == rhs.m_idx; }
+            bool                operator!=(const const_iterator& rhs) const { return m_idx != rhs.m_idx; }
+            size_t              index() const { return m_idx; }
+
+        private:
+            friend class MoveVertices;
+            // Run of a run-length encoded column containing the current move and the index of the first move of the next run.
+            struct RunCursor
+            {
+                size_t run;
+                size_t next_start;
+            };
+
+            const_iterator(const MoveVertices& moves, size_t idx);
+            void decode_position();
+            void decode_attributes();
+            template<typename T> void seek_run(const RunLengthColumn<T>& column, RunCursor& cursor);
+            template<typename T> void next_run(const RunLengthColumn<T>& column, RunCursor& cursor);
+
+            const MoveVertices*     m_moves;
+            size_t                  m_idx;
+            MoveVertex              m_move;
+            std::array<int64_t, 3>  m_position_um;
+            size_t                  m_float_idx;
+            RunCursor               m_extrusion_role;
+            RunCursor               m_extruder_id;
+            RunCursor               m_cp_color_id;
+            RunCursor               m_feedrate;
+            RunCursor               m_width;
+            RunCursor               m_height;
+            RunCursor               m_mm3_per_mm;
+            RunCursor               m_fan_speed;
+            RunCursor               m_layer_duration;
+            RunCursor               m_temperature;
+        };
+
         struct Result
         {
             struct SettingsIds
@@ -295,7 +422,7 @@ namespace Slic3r {
                 }
             };
             unsigned int id;
-            std::vector<MoveVertex> moves;
+            MoveVertices moves;
             Pointfs bed_shape;
             SettingsIds settings_ids;
             size_t extruders_count;
@@ -310,7 +437,7 @@ namespace Slic3r {
             void reset()
             {
                 time = 0;
-                moves = std::vector<MoveVertex>();
+                moves.clear();
                 bed_shape = Pointfs();
                 extruder_colors = std::vector<std::string>();
                 extruders_count = 0;
@@ -319,7 +446,7 @@ namespace Slic3r {
 #else
             void reset()
             {
-                moves = std::vector<MoveVertex>();
+                moves.clear();
                 bed_shape = Pointfs();
                 extruder_colors = std::vector<std::string>();
                 extruders_count = 0;
@@ -455,6 +582,14 @@ namespace Slic3r {
 
         TimeProcessor m_time_processor;
 
+        // Streaming of the exported G-code, see process_buffer().
+        // Incomplete last line of the buffers processed so far.
+        std::string m_stream_rest;
+        // Number of bytes processed so far.
+        size_t m_stream_size;
+        // Offset of the first placeholder line to fill in by finalize_stream(), or std::string::npos.
+        size_t m_stream_placeholder_offset;
+
         Result m_result;
         static unsigned int s_result_id;
 
@@ -485,6 +620,13 @@ namespace Slic3r {
         void process_file(const std::string& filename, bool apply_postprocess, std::function<void()> cancel_callback = nullptr);
         void process_string(const std::string& gcode, std::function<void()> cancel_callback = nullptr);
 
+        // Process the gcode while it is being written to a file, instead of reading the file again with process_file().
+        // Call start_stream(), then process_buffer() with all the data written to the file in order, then finalize_stream() once the file is closed.
+        void start_stream();
+        void process_buffer(const std::string& buffer);
+        // If apply_postprocess, fills in the time estimates of the file. Without the M73 lines, only the lines from the first placeholder to the end are rewritten.
+        void finalize_stream(const std::string& filename, bool apply_postprocess);
+
         float get_time(PrintEstimatedTimeStatistics::ETimeMode mode) const;
         std::string get_time_dhm(PrintEstimatedTimeStatistics::ETimeMode mode) const;
         std::vector<std::pair<CustomGCode::Type, std::pair<float, float>>> get_custom_gcode_times(PrintEstimatedTimeStatistics::ETimeMode mode, bool include_remaining) const;
@@ -495,6 +637,8 @@ namespace Slic3r {
 
     private:
         void process_gcode_line(const GCodeReader::GCodeLine& line);
+        // Shared by process_file() and finalize_stream(), once all the lines are processed.
+        void finalize(const std::string& filename, bool apply_postprocess, size_t postprocess_offset);
 
         // Process tags embedded into comments
         void process_tags(const std::string_view comment);
@@ -1,6 +1,7 @@
 #include "SpiralVase.hpp"
 #include "GCode.hpp"
 #include <sstream>
+#include <vector>
 
 namespace Slic3r {
 
@@ -21,20 +22,28 @@ std::string SpiralVase::process_layer(const std::string &gcode)
         return gcode;
     }
     
+    // Parse the layer once. The lines are rewritten from the parsed lines, once the total XY length of the layer is known.
+    struct ParsedLine {
+        GCodeReader::GCodeLine line;
+        // Valid for G1 lines, calculated from the position before the line.
+        float                  dist_XY   = 0.f;
+        bool                   extruding = false;
+    };
+    std::vector<ParsedLine> lines;
     // Get total XY length for this layer by summing all extrusion moves.
     float total_layer_length = 0;
     float layer_height = 0;
     float z = 0.f;
-    
     {
-        //FIXME Performance warning: This copies the GCodeConfig of the reader.
-        GCodeReader r = m_reader;  // clone
         bool set_z = false;
-        r.parse_buffer(gcode, [&total_layer_length, &layer_height, &z, &set_z]
+        m_reader.parse_buffer(gcode, [&lines, &total_layer_length, &layer_height, &z, &set_z]
             (GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+            ParsedLine parsed { line };
             if (line.cmd_is("G1")) {
-                if (line.extruding(reader)) {
-                    total_layer_length += line.dist_XY(reader);
+                parsed.dist_XY   = line.dist_XY(reader);
+                parsed.extruding = line.extruding(reader);
+                if (parsed.extruding) {
+                    total_layer_length += parsed.dist_XY;
                 } else if (line.has(Z)) {
                     layer_height += line.dist_Z(reader);
                     if (!set_z) {
@@ -43,13 +52,15 @@ std::string SpiralVase::process_layer(const std::string &gcode)
                     }
                 }
             }
+            lines.emplace_back(std::move(parsed));
         });
     }
     
-    // Remove layer height from initial Z.
+    // Remove layer height from initial Z.
     z -= layer_height;
     
     std::string new_gcode;
+    new_gcode.reserve(gcode.size() + gcode.size() / 4);
     //FIXME Tapering of the transition layer only works reliably with relative extruder distances.
     // For absolute extruder distances it will be switched off.
     // Tapering the absolute extruder distances requires to process every extrusion value after the first transition
@@ -60,43 +71,37 @@ std::string SpiralVase::process_layer(const std::string &gcode)
     bool  keep_first_travel = m_transition_layer;
     float layer_height_factor = layer_height / total_layer_length;
     float len = 0.f;
-    m_reader.parse_buffer(gcode, [&keep_first_travel , &new_gcode, &z, total_layer_length, layer_height_factor, transition, &len]
-        (GCodeReader &reader, GCodeReader::GCodeLine line) {
-        if (line.cmd_is("G1")) {
-            if (line.has_z()) {
-                // If this is the initial Z move of the layer, replace it with a
-                // (redundant) move to the last Z of previous layer.
-                line.set(reader, Z, z);
+    // The reader already went through the layer while parsing it, it keeps the original (not rewritten) Z and E
+    // of the last move as the reference for the next layer.
+    for (ParsedLine &parsed : lines) {
+        GCodeReader::GCodeLine &line = parsed.line;
+        if (line.cmd_is("G1") && line.has_z()) {
+            // If this is the initial Z move of the layer, replace it with a
+            // (redundant) move to the last Z of previous layer.
+            line.set(m_reader, Z, z);
+            new_gcode += line.raw() + '\n';
+        } else if (line.cmd_is("G1") && parsed.dist_XY > 0) {
+            // horizontal move
+            if (parsed.extruding) {
+                keep_first_travel = false;
+                len += parsed.dist_XY;
+                line.set(m_reader, Z, z + len * layer_height_factor);
+                if (transition && line.has(E))
+                    // Transition layer, modulate the amount of extrusion from zero to the final value.
+                    line.set(m_reader, E, line.value(E) * len / total_layer_length);
+                new_gcode += line.raw() + '\n';
+            } else if (keep_first_travel) {
+                //we can travel until the first spiral extrusion
                 new_gcode += line.raw() + '\n';
-                return;
-            } else {
-                float dist_XY = line.dist_XY(reader);
-                if (dist_XY > 0) {
-                    // horizontal move
-                    if (line.extruding(reader)) {
-                        keep_first_travel = false;
-                        len += dist_XY;
-                        line.set(reader, Z, z + len * layer_height_factor);
-                        if (transition && line.has(E))
-                            // Transition layer, modulate the amount of extrusion from zero to the final value.
-                            line.set(reader, E, line.value(E) * len / total_layer_length);
-                        new_gcode += line.raw() + '\n';
-                    } else if (keep_first_travel) {
-                        //we can travel until the first spiral extrusion
-                        new_gcode += line.raw() + '\n';
-                    }
-                    return;
-                
-                    /*  Skip travel moves: the move to first perimeter point will
-                        cause a visible seam when loops are not aligned in XY; by skipping
-                        it we blend the first loop move in the XY plane (although the smoothness
-                        of such blend depend on how long the first segment is; maybe we should
-                        enforce some minimum length?).  */
-                }
             }
-        }
-        new_gcode += line.raw() + '\n';
-    });
+            /*  Skip travel moves: the move to first perimeter point will
+                cause a visible seam when loops are not aligned in XY; by skipping
+                it we blend the first loop move in the XY plane (although the smoothness
+                of such blend depend on how long the first segment is; maybe we should
+                enforce some minimum length?).  */
+        } else
+            new_gcode += line.raw() + '\n';
+    }
     
     return new_gcode;
 }
@@ -1,58 +1,99 @@
 #include "GCodeWriter.hpp"
 #include "CustomGCode.hpp"
 
-#include <boost/lexical_cast.hpp>
-
 #include <algorithm>
 #include <assert.h>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <sstream>
+
+#if __has_include(<charconv>)
+    #include <charconv>
+#endif
 
 #define FLAVOR_IS(val) this->config.gcode_flavor.value == val
 #define FLAVOR_IS_NOT(val) this->config.gcode_flavor.value != val
-#define COMMENT(comment) if (this->config.gcode_comments.value && !comment.empty()) gcode << " ; " << comment;
-#define PRECISION(val, precision) to_string_nozero(val, precision)
+// These ones append to a std::string named gcode.
+#define COMMENT(comment) if (this->config.gcode_comments.value && !comment.empty()) { gcode += " ; "; gcode += comment; }
+#define PRECISION(val, precision) append_nozero(gcode, val, precision)
 #define XYZ_NUM(val) PRECISION(val, this->config.gcode_precision_xyz.value)
-#define FLOAT_PRECISION(val, precision) std::defaultfloat << std::setprecision(precision) << (val)
-#define F_NUM(val) FLOAT_PRECISION(val, 8)
+#define F_NUM(val) append_float(gcode, val, 8)
 #define E_NUM(val) PRECISION(val, this->config.gcode_precision_e.value)
 
 namespace Slic3r {
 
-std::string to_string_nozero(double value, int32_t max_precision) {
+// Large enough for the fixed notation of a non-integral double (less than 2^52, so at most 16 digits before the '.')
+// with 15 decimals, and for the %.17g notation of any double.
+static constexpr size_t NUMBER_BUFFER_SIZE = 64;
+
+// Write value into buf with printf("%.*f") (fixed) or printf("%.*g") semantic in the C locale, return the end of the written characters.
+// std::to_chars is locale independent and doesn't allocate, but not all the standard libraries we compile with
+// implement it for floating point values (__cpp_lib_to_chars is only defined by the ones that do).
+static inline char* format_number(char *buf, double value, int precision, bool fixed)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::to_chars_result res = std::to_chars(buf, buf + NUMBER_BUFFER_SIZE, value, fixed ? std::chars_format::fixed : std::chars_format::general, precision);
+    if (res.ec == std::errc())
+        return res.ptr;
+#endif
+    int len = snprintf(buf, NUMBER_BUFFER_SIZE, fixed ? "%.*f" : "%.*g", precision, value);
+    assert(len >= 0 && len < int(NUMBER_BUFFER_SIZE));
+    char *end = buf + std::clamp(len, 0, int(NUMBER_BUFFER_SIZE) - 1);
+    // printf() uses the decimal separator of the C locale set by the application, replace it with '.'.
+    const char *decimal_point = localeconv()->decimal_point;
+    if (decimal_point != nullptr && strcmp(decimal_point, ".") != 0 && *decimal_point != 0) {
+        const size_t decimal_point_len = strlen(decimal_point);
+        if (char *it = std::search(buf, end, decimal_point, decimal_point + decimal_point_len); it != end) {
+            *it = '.';
+            end = std::copy(it + decimal_point_len, end, it + 1);
+        }
+    }
+    return end;
+}
+
+void append_nozero(std::string &out, double value, int32_t max_precision)
+{
+    char  buf[NUMBER_BUFFER_SIZE];
+    char *end;
     double intpart;
     if (modf(value, &intpart) == 0.0) {
-        //shortcut for int
-        return boost::lexical_cast<std::string>(intpart);
+        //shortcut for int, printed like boost::lexical_cast<std::string>(double), ie with %.17g
+        end = format_number(buf, intpart, 17, false);
     } else {
-        std::stringstream ss;
         //first, get the int part, to see how many digit it takes
         int long10 = 0;
         if (intpart > 9)
             long10 = (int)std::floor(std::log10(std::abs(intpart)));
         //set the usable precision: there is only 15-16 decimal digit in a double
-        ss << std::fixed << std::setprecision(int(std::min(15 - long10, int(max_precision)))) << value;
-        std::string ret = ss.str();
-        uint8_t nb_del = 0;
-        if (ret.find('.') != std::string::npos) {
-            uint8_t idx_char;
-            for (idx_char = uint8_t(ss.tellp()) - 1; idx_char > 0; idx_char--) {
-                if (ret[idx_char] == '0')
-                    nb_del++;
-                else
-                    break;
-            }
+        end = format_number(buf, value, std::max(0, std::min(15 - long10, int(max_precision))), true);
+        if (std::find(buf, end, '.') != end) {
+            // remove the trailing zeros
+            while (end - 1 > buf && *(end - 1) == '0')
+                --end;
             // remove the '.' at the end of the int
-            if (idx_char > 0 && ret[idx_char] == '.')
-                nb_del++;
+            if (end - 1 > buf && *(end - 1) == '.')
+                --end;
         }
-
-        if (nb_del > 0)
-            return ret.substr(0, ret.size() - nb_del);
-        else
-            return ret;
     }
+    out.append(buf, end);
+}
+
+std::string to_string_nozero(double value, int32_t max_precision)
+{
+    std::string out;
+    append_nozero(out, value, max_precision);
+    return out;
+}
+
+void append_float(std::string &out, double value, int precision)
+{
+    char buf[NUMBER_BUFFER_SIZE];
+    out.append(buf, format_number(buf, value, precision, false));
 }
 
     std::string GCodeWriter::PausePrintCode = "M601";
@@ -256,10 +297,14 @@ std::string GCodeWriter::set_bed_temperature(uint32_t temperature, bool wait)
 }
 
 std::string GCodeWriter::set_fan(const uint8_t speed, bool dont_save, uint16_t default_tool)
+{
+    return this->set_fan_for_tool(m_tool == nullptr ? get_tool(default_tool) : m_tool, speed, dont_save);
+}
+
+std::string GCodeWriter::set_fan_for_tool(const Tool *tool, const uint8_t speed, bool dont_save)
 {
     std::ostringstream gcode;
 
-    const Tool *tool = m_tool == nullptr ? get_tool(default_tool) : m_tool;
     //add fan_offset
     int8_t fan_speed = int8_t(std::min(uint8_t(100), speed));
     if (tool != nullptr)
@@ -320,30 +365,34 @@ uint32_t GCodeWriter::get_acceleration() const
 }
 
 std::string GCodeWriter::write_acceleration(){
+    std::string gcode;
+    this->write_acceleration(gcode);
+    return gcode;
+}
+
+void GCodeWriter::write_acceleration(std::string &gcode){
     if (m_current_acceleration == m_last_acceleration || m_current_acceleration == 0)
-        return "";
+        return;
 
     m_last_acceleration = m_current_acceleration;
 
-    std::ostringstream gcode;
+    const std::string acceleration = std::to_string(m_current_acceleration);
 	//try to set only printing acceleration, travel should be untouched if possible
     if (FLAVOR_IS(gcfRepetier)) {
         // M201: Set max printing acceleration
-        gcode << "M201 X" << m_current_acceleration << " Y" << m_current_acceleration;
+        gcode += "M201 X" + acceleration + " Y" + acceleration;
     } else if(FLAVOR_IS(gcfMarlin) || FLAVOR_IS(gcfLerdge) || FLAVOR_IS(gcfSprinter)){
         // M204: Set printing acceleration
-        gcode << "M204 P" << m_current_acceleration;
+        gcode += "M204 P" + acceleration;
     } else  if (FLAVOR_IS(gcfRepRap)) {
         // M204: Set printing & travel acceleration
-        gcode << "M204 P" << m_current_acceleration <<" T" << m_current_acceleration;
+        gcode += "M204 P" + acceleration + " T" + acceleration;
     } else {
         // M204: Set default acceleration
-        gcode << "M204 S" << m_current_acceleration;
+        gcode += "M204 S" + acceleration;
     }
-    if (this->config.gcode_comments) gcode << " ; adjust acceleration";
-    gcode << "\n";
-    
-    return gcode.str();
+    if (this->config.gcode_comments) gcode += " ; adjust acceleration";
+    gcode += "\n";
 }
 
 std::string GCodeWriter::reset_e(bool force)
@@ -445,21 +494,33 @@ std::string GCodeWriter::toolchange(uint16_t tool_id)
 }
 
 std::string GCodeWriter::set_speed(double F, const std::string &comment, const std::string &cooling_marker) const
+{
+    std::string gcode;
+    this->set_speed(gcode, F, comment, cooling_marker);
+    return gcode;
+}
+
+void GCodeWriter::set_speed(std::string &gcode, double F, const std::string &comment, const std::string &cooling_marker) const
 {
     assert(F > 0.);
     assert(F < 100000.);
-    std::ostringstream gcode;
-    gcode << "G1 F" << F_NUM(F);
+    gcode += "G1 F";
+    F_NUM(F);
     COMMENT(comment);
-    gcode << cooling_marker;
-    gcode << "\n";
-    return gcode.str();
+    gcode += cooling_marker;
+    gcode += "\n";
 }
 
 std::string GCodeWriter::travel_to_xy(const Vec2d &point, double F, const std::string &comment)
 {
-    std::ostringstream gcode;
-    gcode << write_acceleration();
+    std::string gcode;
+    this->travel_to_xy(gcode, point, F, comment);
+    return gcode;
+}
+
+void GCodeWriter::travel_to_xy(std::string &gcode, const Vec2d &point, double F, const std::string &comment)
+{
+    this->write_acceleration(gcode);
 
     double speed = this->config.travel_speed.value * 60.0;
     if ((F > 0) & (F < speed))
@@ -468,15 +529,24 @@ std::string GCodeWriter::travel_to_xy(const Vec2d &point, double F, const std::s
     m_pos.x() = point.x();
     m_pos.y() = point.y();
     
-    gcode << "G1 X" << XYZ_NUM(point.x())
-          <<   " Y" << XYZ_NUM(point.y())
-          <<   " F" << F_NUM(speed);
+    gcode += "G1 X";
+    XYZ_NUM(point.x());
+    gcode += " Y";
+    XYZ_NUM(point.y());
+    gcode += " F";
+    F_NUM(speed);
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
 }
 
 std::string GCodeWriter::travel_to_xyz(const Vec3d &point, double F, const std::string &comment)
+{
+    std::string gcode;
+    this->travel_to_xyz(gcode, point, F, comment);
+    return gcode;
+}
+
+void GCodeWriter::travel_to_xyz(std::string &gcode, const Vec3d &point, double F, const std::string &comment)
 {
     /*  If target Z is lower than current Z but higher than nominal Z we
         don't perform the Z move but we only move in the XY plane and
@@ -489,7 +559,8 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, double F, const std::
         // and a retract could be skipped (https://github.com/prusa3d/PrusaSlicer/issues/2154
         if (std::abs(m_lifted) < EPSILON)
             m_lifted = 0.;
-        return this->travel_to_xy(to_2d(point), F, comment);
+        this->travel_to_xy(gcode, to_2d(point), F, comment);
+        return;
     }
     
     /*  In all the other cases, we perform an actual XYZ move and cancel
@@ -501,19 +572,21 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, double F, const std::
     if ((F > 0) & (F < speed))
         speed = F;
 
-    std::ostringstream gcode;
-    gcode << write_acceleration();
-    gcode << "G1 X" << XYZ_NUM(point.x())
-          << " Y" << XYZ_NUM(point.y());
+    this->write_acceleration(gcode);
+    gcode += "G1 X";
+    XYZ_NUM(point.x());
+    gcode += " Y";
+    XYZ_NUM(point.y());
+    gcode += " Z";
     if (config.z_step > SCALING_FACTOR)
-        gcode << " Z" << PRECISION(point.z(), 6);
+        PRECISION(point.z(), 6);
     else
-        gcode << " Z" << XYZ_NUM(point.z());
-    gcode <<   " F" << F_NUM(speed);
+        XYZ_NUM(point.z());
+    gcode += " F";
+    F_NUM(speed);
 
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
 }
 
 std::string GCodeWriter::travel_to_z(double z, const std::string &comment)
@@ -539,18 +612,21 @@ std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
 {
     m_pos.z() = z;
 
-    std::ostringstream gcode;
+    std::string gcode;
 
-    gcode << write_acceleration();    if (config.z_step > SCALING_FACTOR)
-        gcode << "G1 Z" << PRECISION(z, 6);
+    this->write_acceleration(gcode);
+    gcode += "G1 Z";
+    if (config.z_step > SCALING_FACTOR)
+        PRECISION(z, 6);
     else
-        gcode << "G1 Z" << XYZ_NUM(z);
+        XYZ_NUM(z);
 
     const double speed = this->config.travel_speed_z.value == 0.0 ? this->config.travel_speed.value : this->config.travel_speed_z.value;
-    gcode <<   " F" << F_NUM(speed * 60.0);
+    gcode += " F";
+    F_NUM(speed * 60.0);
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
+    return gcode;
 }
 
 bool GCodeWriter::will_move_z(double z) const
@@ -566,24 +642,41 @@ bool GCodeWriter::will_move_z(double z) const
 }
 
 std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std::string &comment)
+{
+    std::string gcode;
+    this->extrude_to_xy(gcode, point, dE, comment);
+    return gcode;
+}
+
+void GCodeWriter::extrude_to_xy(std::string &gcode, const Vec2d &point, double dE, const std::string &comment)
 {
     assert(dE == dE);
     m_pos.x() = point.x();
     m_pos.y() = point.y();
     bool is_extrude = m_tool->extrude(dE) != 0;
 
-    std::ostringstream gcode;
-    gcode << write_acceleration();
-    gcode << "G1 X" << XYZ_NUM(point.x())
-        << " Y" << XYZ_NUM(point.y());
-    if(is_extrude)
-        gcode <<    " " << m_extrusion_axis << E_NUM(m_tool->E());
+    this->write_acceleration(gcode);
+    gcode += "G1 X";
+    XYZ_NUM(point.x());
+    gcode += " Y";
+    XYZ_NUM(point.y());
+    if (is_extrude) {
+        gcode += " ";
+        gcode += m_extrusion_axis;
+        E_NUM(m_tool->E());
+    }
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
 }
 
 std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment)
+{
+    std::string gcode;
+    this->extrude_to_xyz(gcode, point, dE, comment);
+    return gcode;
+}
+
+void GCodeWriter::extrude_to_xyz(std::string &gcode, const Vec3d &point, double dE, const std::string &comment)
 {
     assert(dE == dE);
     m_pos.x() = point.x();
@@ -591,16 +684,20 @@ std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std
     m_lifted = 0;
     bool is_extrude = m_tool->extrude(dE) != 0;
 
-    std::ostringstream gcode;
-    gcode << write_acceleration();
-    gcode << "G1 X" << XYZ_NUM(point.x())
-        << " Y" << XYZ_NUM(point.y())
-        << " Z" << XYZ_NUM(point.z() + m_pos.z());
-    if (is_extrude)
-            gcode <<    " " << m_extrusion_axis << E_NUM(m_tool->E());
+    this->write_acceleration(gcode);
+    gcode += "G1 X";
+    XYZ_NUM(point.x());
+    gcode += " Y";
+    XYZ_NUM(point.y());
+    gcode += " Z";
+    XYZ_NUM(point.z() + m_pos.z());
+    if (is_extrude) {
+        gcode += " ";
+        gcode += m_extrusion_axis;
+        E_NUM(m_tool->E());
+    }
     COMMENT(comment);
-    gcode << "\n";
-    return gcode.str();
+    gcode += "\n";
 }
 
 std::string GCodeWriter::retract(bool before_wipe)
@@ -638,7 +735,7 @@ std::string GCodeWriter::retract_for_toolchange(bool before_wipe)
 
 std::string GCodeWriter::_retract(double length, double restart_extra, double restart_extra_toolchange, const std::string &comment)
 {
-    std::ostringstream gcode;
+    std::string gcode;
     
     /*  If firmware retraction is enabled, we use a fake value of 1
         since we ignore the actual configured retract_length which 
@@ -660,29 +757,32 @@ std::string GCodeWriter::_retract(double length, double restart_extra, double re
     if (dE != 0) {
         if (this->config.use_firmware_retraction) {
             if (FLAVOR_IS(gcfMachinekit))
-                gcode << "G22 ; retract\n";
+                gcode += "G22 ; retract\n";
             else
-                gcode << "G10 ; retract\n";
+                gcode += "G10 ; retract\n";
         } else {
-            gcode << "G1 " << m_extrusion_axis << E_NUM(m_tool->E())
-                           << " F" << F_NUM(m_tool->retract_speed() * 60.);
+            gcode += "G1 ";
+            gcode += m_extrusion_axis;
+            E_NUM(m_tool->E());
+            gcode += " F";
+            F_NUM(m_tool->retract_speed() * 60.);
             COMMENT(comment);
-            gcode << "\n";
+            gcode += "\n";
         }
     }
     
     if (FLAVOR_IS(gcfMakerWare))
-        gcode << "M103 ; extruder off\n";
+        gcode += "M103 ; extruder off\n";
     
-    return gcode.str();
+    return gcode;
 }
 
 std::string GCodeWriter::unretract()
 {
-    std::ostringstream gcode;
+    std::string gcode;
     
     if (FLAVOR_IS(gcfMakerWare))
-        gcode << "M101 ; extruder on\n";
+        gcode += "M101 ; extruder on\n";
     
     double dE = m_tool->unretract();
     assert(dE >= 0);
@@ -690,20 +790,23 @@ std::string GCodeWriter::unretract()
     if (dE != 0) {
         if (this->config.use_firmware_retraction) {
             if (FLAVOR_IS(gcfMachinekit))
-                 gcode << "G23 ; unretract\n";
+                 gcode += "G23 ; unretract\n";
             else
-                 gcode << "G11 ; unretract\n";
-            gcode << this->reset_e();
+                 gcode += "G11 ; unretract\n";
+            gcode += this->reset_e();
         } else {
             // use G1 instead of G0 because G0 will blend the restart with the previous travel move
-            gcode << "G1 " << m_extrusion_axis << E_NUM(m_tool->E())
-                           << " F" << F_NUM(m_tool->deretract_speed() * 60.);
-            if (this->config.gcode_comments) gcode << " ; unretract";
-            gcode << "\n";
+            gcode += "G1 ";
+            gcode += m_extrusion_axis;
+            E_NUM(m_tool->E());
+            gcode += " F";
+            F_NUM(m_tool->deretract_speed() * 60.);
+            if (this->config.gcode_comments) gcode += " ; unretract";
+            gcode += "\n";
         }
     }
     
-    return gcode.str();
+    return gcode;
 }
 
 /*  If this method is called more than once before calling unlift(),
@@ -10,6 +10,14 @@
 
 namespace Slic3r {
 
+// Print the number with at most max_precision decimals, without the trailing zeros (and '.').
+std::string to_string_nozero(double value, int32_t max_precision);
+// Append to out the number as to_string_nozero() prints it, without any temporary string or stream:
+// appending to a reused buffer doesn't allocate once the buffer is large enough.
+void        append_nozero(std::string &out, double value, int32_t max_precision);
+// Append to out the number as a stream with std::defaultfloat and std::setprecision(precision) prints it.
+void        append_float(std::string &out, double value, int precision);
+
 class GCodeWriter {
 public:
     static std::string PausePrintCode;
@@ -49,6 +57,9 @@ public:
     uint8_t get_fan() { return m_last_fan_speed; }
     /// set fan at speed. Save it as current fan speed if !dont_save, and use tool default_tool if the internal m_tool is null (no toolchange done yet).
     std::string set_fan(uint8_t speed, bool dont_save = false, uint16_t default_tool = 0);
+    /// set fan at speed with the fan offset of the given tool instead of the current one. Used by the post-processing
+    /// of the G-code export, which may run behind the G-code generation (and its toolchanges).
+    std::string set_fan_for_tool(const Tool *tool, uint8_t speed, bool dont_save = false);
     void        set_acceleration(uint32_t acceleration);
     uint32_t    get_acceleration() const;
     std::string write_acceleration();
@@ -70,6 +81,13 @@ public:
     bool        will_move_z(double z) const;
     std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string());
     std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string());
+    // Same as above, but append the G-code line to gcode instead of returning a new string.
+    // Used by the extrusion & travel loops of GCode, which write every line into the same layer buffer.
+    void        set_speed(std::string &gcode, double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string()) const;
+    void        travel_to_xy(std::string &gcode, const Vec2d &point, double F = 0.0, const std::string &comment = std::string());
+    void        travel_to_xyz(std::string &gcode, const Vec3d &point, double F = 0.0, const std::string &comment = std::string());
+    void        extrude_to_xy(std::string &gcode, const Vec2d &point, double dE, const std::string &comment = std::string());
+    void        extrude_to_xyz(std::string &gcode, const Vec3d &point, double dE, const std::string &comment = std::string());
     std::string retract(bool before_wipe = false);
     std::string retract_for_toolchange(bool before_wipe = false);
     std::string unretract();
@@ -101,6 +119,7 @@ private:
     double          m_lifted;
     Vec3d           m_pos = Vec3d::Zero();
 
+    void        write_acceleration(std::string &gcode);
     std::string _travel_to_z(double z, const std::string &comment);
     std::string _retract(double length, double restart_extra, double restart_extra_toolchange, const std::string &comment);
 
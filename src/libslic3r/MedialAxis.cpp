@@ -41,10 +41,18 @@ MedialAxis::build(Polylines &polylines)
 void
 MedialAxis::polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* polylines)
 {
-    std::map<const VD::edge_type*, std::pair<coordf_t, coordf_t> > thickness;
     Lines lines = voronoi_edges;
-    VD vd;
-    construct_voronoi(lines.begin(), lines.end(), &vd);
+    // The Voronoi diagram, its builder and the flat vectors of edge data keep their buffers
+    // for the next medial axis built on this thread.
+    static thread_local VD                                            vd;
+    static thread_local boost::polygon::default_voronoi_builder       builder;
+    static thread_local std::vector<std::pair<coordf_t, coordf_t>>    thickness;
+    static thread_local std::vector<char>                             valid_edges;
+    static thread_local std::vector<char>                             edges;
+    vd.clear();
+    builder.clear();
+    boost::polygon::insert(lines.begin(), lines.end(), &builder);
+    builder.construct(&vd);
 
     typedef const VD::edge_type   edge_t;
     
@@ -72,36 +80,39 @@ MedialAxis::polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* po
     
     // collect valid edges (i.e. prune those not belonging to MAT)
     // note: this keeps twins, so it inserts twice the number of the valid edges
-    std::set<const VD::edge_type*> valid_edges;
-    {
-        std::set<const edge_t*> seen_edges;
-        for (VD::const_edge_iterator edge = vd.edges().begin(); edge != vd.edges().end(); ++edge) {
-            // if we only process segments representing closed loops, none if the
-            // infinite edges (if any) would be part of our MAT anyway
-            if (edge->is_secondary() || edge->is_infinite()) continue;
-        
-            // don't re-validate twins
-            if (seen_edges.find(&*edge) != seen_edges.end()) continue;  // TODO: is this needed?
-            seen_edges.insert(&*edge);
-            seen_edges.insert(edge->twin());
-            
-            if (!this->validate_edge(&*edge, lines, thickness)) continue;
-            valid_edges.insert(&*edge);
-            valid_edges.insert(edge->twin());
-        }
+    // the edge data are indexed by edge_idx()
+    thickness.assign(vd.num_edges(), std::make_pair(0., 0.));
+    valid_edges.assign(vd.num_edges(), false);
+    for (VD::const_edge_iterator edge = vd.edges().begin(); edge != vd.edges().end(); ++edge) {
+        // if we only process segments representing closed loops, none if the
+        // infinite edges (if any) would be part of our MAT anyway
+        if (edge->is_secondary() || edge->is_infinite()) continue;
+
+        // don't re-validate twins, the edges are visited in the order of their index
+        size_t idx      = edge_idx(vd, &*edge);
+        size_t twin_idx = edge_idx(vd, edge->twin());
+        if (twin_idx < idx) continue;
+
+        if (!this->validate_edge(&*edge, lines, thickness[idx])) continue;
+        thickness[twin_idx] = std::make_pair(thickness[idx].second, thickness[idx].first);
+        valid_edges[idx]      = true;
+        valid_edges[twin_idx] = true;
     }
-    std::set<const VD::edge_type*> edges = valid_edges;
-    
-    // iterate through the valid edges to build polylines
-    while (!edges.empty()) {
-        const edge_t* edge = *edges.begin();
-        if (thickness[edge].first > this->max_width*1.001) {
+    edges = valid_edges;
+
+    // iterate through the valid edges to build polylines, starting with the edge of the lowest index
+    for (size_t next_idx = 0;; ++next_idx) {
+        next_idx = std::find(edges.begin() + next_idx, edges.end(), true) - edges.begin();
+        if (next_idx == edges.size())
+            break;
+        const edge_t* edge = &vd.edges()[next_idx];
+        if (thickness[next_idx].first > this->max_width*1.001) {
             //std::cerr << "Error, edge.first has a thickness of " << unscaled(this->thickness[edge].first) << " > " << unscaled(this->max_width) << "\n";
             //(void)this->edges.erase(edge);
             //(void)this->edges.erase(edge->twin());
             //continue;
         }
-        if (thickness[edge].second > this->max_width*1.001) {
+        if (thickness[next_idx].second > this->max_width*1.001) {
             //std::cerr << "Error, edge.second has a thickness of " << unscaled(this->thickness[edge].second) << " > " << unscaled(this->max_width) << "\n";
             //(void)this->edges.erase(edge);
             //(void)this->edges.erase(edge->twin());
@@ -112,20 +123,20 @@ MedialAxis::polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* po
         ThickPolyline polyline;
         polyline.points.push_back(Point( edge->vertex0()->x(), edge->vertex0()->y() ));
         polyline.points.push_back(Point( edge->vertex1()->x(), edge->vertex1()->y() ));
-        polyline.width.push_back(thickness[edge].first);
-        polyline.width.push_back(thickness[edge].second);
+        polyline.width.push_back(thickness[next_idx].first);
+        polyline.width.push_back(thickness[next_idx].second);
         
         // remove this edge and its twin from the available edges
-        (void)edges.erase(edge);
-        (void)edges.erase(edge->twin());
+        edges[next_idx] = false;
+        edges[edge_idx(vd, edge->twin())] = false;
         
         // get next points
-        this->process_edge_neighbors(edge, &polyline, edges, valid_edges, thickness);
+        this->process_edge_neighbors(vd, edge, &polyline, edges, valid_edges, thickness);
         
         // get previous points
         {
             ThickPolyline rpolyline;
-            this->process_edge_neighbors(edge->twin(), &rpolyline, edges, valid_edges, thickness);
+            this->process_edge_neighbors(vd, edge->twin(), &rpolyline, edges, valid_edges, thickness);
             polyline.points.insert(polyline.points.begin(), rpolyline.points.rbegin(), rpolyline.points.rend());
             polyline.width.insert(polyline.width.begin(), rpolyline.width.rbegin(), rpolyline.width.rend());
             polyline.endpoints.first = rpolyline.endpoints.second;
@@ -161,7 +172,7 @@ MedialAxis::polyline_from_voronoi(const Lines& voronoi_edges, ThickPolylines* po
 }
 
 void
-MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* polyline, std::set<const VD::edge_type*> &edges, std::set<const VD::edge_type*> &valid_edges, std::map<const VD::edge_type*, std::pair<coordf_t, coordf_t> > &thickness)
+MedialAxis::process_edge_neighbors(const VD &vd, const VD::edge_type* edge, ThickPolyline* polyline, std::vector<char> &edges, const std::vector<char> &valid_edges, const std::vector<std::pair<coordf_t, coordf_t>> &thickness)
 {
     while (true) {
         // Since rot_next() works on the edge starting point but we want
@@ -173,7 +184,7 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
         std::vector<const VD::edge_type*> neighbors;
         for (const VD::edge_type* neighbor = twin->rot_next(); neighbor != twin;
             neighbor = neighbor->rot_next()) {
-            if (valid_edges.count(neighbor) > 0) neighbors.push_back(neighbor);
+            if (valid_edges[edge_idx(vd, neighbor)]) neighbors.push_back(neighbor);
         }
     
         // if we have a single neighbor then we can continue recursively
@@ -181,14 +192,15 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
             const VD::edge_type* neighbor = neighbors.front();
             
             // break if this is a closed loop
-            if (edges.count(neighbor) == 0) return;
+            size_t neighbor_idx = edge_idx(vd, neighbor);
+            if (!edges[neighbor_idx]) return;
             
             Point new_point(neighbor->vertex1()->x(), neighbor->vertex1()->y());
             polyline->points.push_back(new_point);
-            polyline->width.push_back(thickness[neighbor].second);
+            polyline->width.push_back(thickness[neighbor_idx].second);
             
-            (void)edges.erase(neighbor);
-            (void)edges.erase(neighbor->twin());
+            edges[neighbor_idx] = false;
+            edges[edge_idx(vd, neighbor->twin())] = false;
             edge = neighbor;
         } else if (neighbors.size() == 0) {
             polyline->endpoints.second = true;
@@ -201,7 +213,7 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
 }
 
 bool
-MedialAxis::validate_edge(const VD::edge_type* edge, Lines &lines, std::map<const VD::edge_type*, std::pair<coordf_t, coordf_t> > &thickness)
+MedialAxis::validate_edge(const VD::edge_type* edge, Lines &lines, std::pair<coordf_t, coordf_t> &thickness)
 {
     // prevent overflows and detect almost-infinite edges
     if (std::abs(edge->vertex0()->x()) > double(CLIPPER_MAX_COORD_UNSCALED) ||
@@ -319,8 +331,7 @@ MedialAxis::validate_edge(const VD::edge_type* edge, Lines &lines, std::map<cons
     if (w0 > this->max_width*1.05 && w1 > this->max_width*1.05)
         return false;
     
-    thickness[edge]         = std::make_pair(w0, w1);
-    thickness[edge->twin()] = std::make_pair(w1, w0);
+    thickness = std::make_pair(w0, w1);
     
     return true;
 }
@@ -895,7 +895,7 @@ const BoundingBoxf3& ModelObject::raw_mesh_bounding_box() const
         m_raw_mesh_bounding_box.reset();
         for (const ModelVolume *v : this->volumes)
             if (v->is_model_part())
-                m_raw_mesh_bounding_box.merge(v->mesh().transformed_bounding_box(v->get_matrix()));
+                m_raw_mesh_bounding_box.merge(v->transformed_mesh_bounding_box(v->get_matrix()));
     }
     return m_raw_mesh_bounding_box;
 }
@@ -904,7 +904,7 @@ BoundingBoxf3 ModelObject::full_raw_mesh_bounding_box() const
 {
 	BoundingBoxf3 bb;
 	for (const ModelVolume *v : this->volumes)
-		bb.merge(v->mesh().transformed_bounding_box(v->get_matrix()));
+		bb.merge(v->transformed_mesh_bounding_box(v->get_matrix()));
 	return bb;
 }
 
@@ -922,7 +922,7 @@ const BoundingBoxf3& ModelObject::raw_bounding_box() const
         for (const ModelVolume *v : this->volumes)
         {
             if (v->is_model_part())
-                m_raw_bounding_box.merge(v->mesh().transformed_bounding_box(inst_matrix * v->get_matrix()));
+                m_raw_bounding_box.merge(v->transformed_mesh_bounding_box(inst_matrix * v->get_matrix()));
         }
     }
 	return m_raw_bounding_box;
@@ -940,13 +940,13 @@ BoundingBoxf3 ModelObject::instance_bounding_box(const ModelInstance & instance,
     for (ModelVolume* v : this->volumes)
     {
         if (v->is_model_part())
-            bb.merge(v->mesh().transformed_bounding_box(inst_matrix * v->get_matrix()));
+            bb.merge(v->transformed_mesh_bounding_box(inst_matrix * v->get_matrix()));
     }
     return bb;
 }
 
 // Calculate 2D convex hull of of a projection of the transformed printable volumes into the XY plane.
-// This method is cheap in that it does not make any unnecessary copy of the volume meshes.
+// This method is cheap in that it only projects the vertices of the convex hulls of the volume meshes.
 // This method is used by the auto arrange function.
 Polygon ModelObject::convex_hull_2d(const Transform3d &trafo_instance) const
 {
@@ -954,22 +954,10 @@ Polygon ModelObject::convex_hull_2d(const Transform3d &trafo_instance) const
     for (const ModelVolume *v : this->volumes)
         if (v->is_model_part()) {
             Transform3d trafo = trafo_instance * v->get_matrix();
-			const indexed_triangle_set &its = v->mesh().its;
-			if (its.vertices.empty()) {
-                // Using the STL faces.
-				const stl_file& stl = v->mesh().stl;
-				for (const stl_facet &facet : stl.facet_start)
-                    for (size_t j = 0; j < 3; ++ j) {
-                        Vec3d p = trafo * facet.vertex[j].cast<double>();
-                        pts.emplace_back(coord_t(scale_(p.x())), coord_t(scale_(p.y())));
-                    }
-            } else {
-                // Using the shared vertices should be a bit quicker than using the STL faces.
-                for (size_t i = 0; i < its.vertices.size(); ++ i) {
-                    Vec3d p = trafo * its.vertices[i].cast<double>();
-                    pts.emplace_back(coord_t(scale_(p.x())), coord_t(scale_(p.y())));
-                }
-            }
+            v->visit_convex_hull_vertices([&pts, &trafo](const stl_vertex &pt) {
+                Vec3d p = trafo * pt.cast<double>();
+                pts.emplace_back(coord_t(scale_(p.x())), coord_t(scale_(p.y())));
+            });
         }
     std::sort(pts.begin(), pts.end(), [](const Point& a, const Point& b) { return a(0) < b(0) || (a(0) == b(0) && a(1) < b(1)); });
     pts.erase(std::unique(pts.begin(), pts.end(), [](const Point& a, const Point& b) { return a(0) == b(0) && a(1) == b(1); }), pts.end());
@@ -1493,9 +1481,8 @@ double ModelObject::get_instance_min_z(size_t instance_idx) const
 
         Transform3d mv = mi * v->get_matrix();
         const TriangleMesh& hull = v->get_convex_hull();
-		for (const stl_facet &facet : hull.stl.facet_start)
-			for (int i = 0; i < 3; ++ i)
-				min_z = std::min(min_z, (mv * facet.vertex[i].cast<double>()).z());
+		for (const stl_vertex &v : hull.its.vertices)
+			min_z = std::min(min_z, (mv * v.cast<double>()).z());
     }
 
     return min_z + inst->get_offset(Z);
@@ -1709,6 +1696,13 @@ const TriangleMesh& ModelVolume::get_convex_hull() const
     return *m_convex_hull.get();
 }
 
+BoundingBoxf3 ModelVolume::transformed_mesh_bounding_box(const Transform3d &trafo) const
+{
+    BoundingBoxf3 bbox;
+    this->visit_convex_hull_vertices([&bbox, &trafo](const stl_vertex &v) { bbox.merge(trafo * v.cast<double>()); });
+    return bbox;
+}
+
 ModelVolumeType ModelVolume::type_from_string(const std::string &s)
 {
     // Legacy support
@@ -1979,6 +1973,9 @@ arrangement::ArrangePolygon ModelInstance::get_arrange_polygon() const
 
 indexed_triangle_set FacetsAnnotation::get_facets(const ModelVolume& mv, EnforcerBlockerType type) const
 {
+    // Nothing painted, don't build the selector.
+    if (this->empty())
+        return {};
     TriangleSelector selector(mv.mesh());
     selector.deserialize(m_data);
     indexed_triangle_set out = selector.get_facets(type);
@@ -577,6 +577,9 @@ public:
 
     // The triangular model.
     const TriangleMesh& mesh() const { return *m_mesh.get(); }
+    // The mesh is shared and never modified once shared, a new mesh is assigned instead. Therefore the pointer
+    // identifies the revision of the mesh, for example to validate caches of data derived from the mesh.
+    const std::shared_ptr<const TriangleMesh>& mesh_ptr() const { return m_mesh; }
     void                set_mesh(const TriangleMesh &mesh) { m_mesh = std::make_shared<const TriangleMesh>(mesh); }
     void                set_mesh(TriangleMesh &&mesh) { m_mesh = std::make_shared<const TriangleMesh>(std::move(mesh)); }
     void                set_mesh(std::shared_ptr<const TriangleMesh> &mesh) { m_mesh = mesh; }
@@ -635,6 +638,23 @@ public:
     void                calculate_convex_hull();
     const TriangleMesh& get_convex_hull() const;
     std::shared_ptr<const TriangleMesh> get_convex_hull_shared_ptr() const { return m_convex_hull; }
+    // Call visitor for the vertices of the convex hull of the mesh, or of the mesh itself if its convex hull was not calculated.
+    // Any affine transformation of these vertices has the same bounding box and the same 2D convex hull as that of the mesh.
+    template<typename Visitor> void visit_convex_hull_vertices(Visitor &&visitor) const {
+        // The convex hull is missing for meshes of a single facet and empty if qhull failed.
+        const TriangleMesh &mesh = m_convex_hull && ! m_convex_hull->empty() ? *m_convex_hull : this->mesh();
+        if (mesh.has_shared_vertices()) {
+            for (const stl_vertex &v : mesh.its.vertices)
+                visitor(v);
+        } else {
+            // Not indexed yet (not repaired), the vertices are stored with the admesh facets.
+            for (const stl_facet &facet : mesh.stl.facet_start)
+                for (const stl_vertex &v : facet.vertex)
+                    visitor(v);
+        }
+    }
+    // Bounding box of the mesh transformed by trafo, calculated from the vertices of its convex hull.
+    BoundingBoxf3       transformed_mesh_bounding_box(const Transform3d &trafo) const;
     // Get count of errors in the mesh
     int                 get_mesh_errors_count() const;
 
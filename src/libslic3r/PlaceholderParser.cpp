@@ -2,6 +2,7 @@
 #include "Exception.hpp"
 #include "Flow.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <ctime>
 #include <iomanip>
@@ -554,21 +555,11 @@ namespace client
 
         static void regex_op(expr &lhs, boost::iterator_range<Iterator> &rhs, char op)
         {
-            const std::string *subject  = nullptr;
-            if (lhs.type == TYPE_STRING) {
-                // One type is string, the other could be converted to string.
-                subject = &lhs.s();
-            } else {
+            if (lhs.type != TYPE_STRING)
                 lhs.throw_exception("Left hand side of a regex match must be a string.");
-            }
             try {
                 std::string pattern(++ rhs.begin(), -- rhs.end());
-                bool result = SLIC3R_REGEX_NAMESPACE::regex_match(*subject, SLIC3R_REGEX_NAMESPACE::regex(pattern));
-                if (op == '!')
-                    result = ! result;
-                lhs.reset();
-                lhs.type = TYPE_BOOL;
-                lhs.data.b = result;
+                regex_op(lhs, SLIC3R_REGEX_NAMESPACE::regex(pattern), op);
             } catch (SLIC3R_REGEX_NAMESPACE::regex_error &ex) {
                 // Syntax error in the regular expression
                 boost::throw_exception(qi::expectation_failure<Iterator>(
@@ -576,6 +567,19 @@ namespace client
             }
         }
 
+        // Same as above with the regular expression already compiled.
+        static void regex_op(expr &lhs, const SLIC3R_REGEX_NAMESPACE::regex &rhs, char op)
+        {
+            if (lhs.type != TYPE_STRING)
+                lhs.throw_exception("Left hand side of a regex match must be a string.");
+            bool result = SLIC3R_REGEX_NAMESPACE::regex_match(lhs.s(), rhs);
+            if (op == '!')
+                result = ! result;
+            lhs.reset();
+            lhs.type = TYPE_BOOL;
+            lhs.data.b = result;
+        }
+
         static void regex_matches     (expr &lhs, boost::iterator_range<Iterator> &rhs) { return regex_op(lhs, rhs, '='); }
         static void regex_doesnt_match(expr &lhs, boost::iterator_range<Iterator> &rhs) { return regex_op(lhs, rhs, '!'); }
 
@@ -1560,15 +1564,794 @@ static std::string process_macro(const std::string &templ, client::MyContext &co
     return output;
 }
 
+namespace client
+{
+    typedef std::string::const_iterator              compiled_iterator;
+    typedef boost::iterator_range<compiled_iterator> compiled_range;
+    typedef expr<compiled_iterator>                  compiled_expr;
+
+    // Expression of a macro compiled by TemplateCompiler. It is evaluated with the same semantic actions
+    // the macro_processor grammar calls while parsing, in the same order.
+    struct MacroExpression
+    {
+        enum Op {
+            opLiteral,
+            opScalarVariable,
+            opVectorVariable,
+            opIdentity,
+            opMinus,
+            opNot,
+            opToInt,
+            opAdd,
+            opSub,
+            opMul,
+            opDiv,
+            opMod,
+            opEqual,
+            opNotEqual,
+            opLower,
+            opGreater,
+            opLeq,
+            opGeq,
+            opRegexMatches,
+            opRegexDoesntMatch,
+            opOr,
+            opAnd,
+            opTernary,
+            opMin,
+            opMax,
+            opRandom,
+            opExists,
+            opDefault,
+            opIgnoreLegacy,
+        };
+
+        Op                                              op = opLiteral;
+        // Range of the template covered by the expression. The variable name of the variable references.
+        compiled_range                                  it_range;
+        std::vector<MacroExpression>                    args;
+        // Value of opLiteral, or of the ignore_legacy flag.
+        compiled_expr                                   value;
+        // Value of the default_double(), default_int(), default_bool() and default_string() functions.
+        std::unique_ptr<ConfigOption>                   default_value;
+        std::unique_ptr<SLIC3R_REGEX_NAMESPACE::regex>  regex;
+    };
+
+    static compiled_expr evaluate(const MacroExpression &expression, const MyContext *ctx)
+    {
+        typedef MacroExpression ME;
+        switch (expression.op) {
+        case ME::opLiteral:
+            return expression.value;
+        case ME::opScalarVariable:
+        case ME::opVectorVariable:
+        {
+            compiled_range                opt_key = expression.it_range;
+            OptWithPos<compiled_iterator> opt;
+            compiled_expr                 out;
+            MyContext::resolve_variable(ctx, opt_key, opt);
+            if (expression.op == ME::opScalarVariable)
+                MyContext::scalar_variable_reference(ctx, opt, out);
+            else {
+                compiled_expr index = evaluate(expression.args.front(), ctx);
+                int           idx   = 0;
+                MyContext::evaluate_index(index, idx);
+                MyContext::vector_variable_reference(ctx, opt, idx, index.it_range.end(), out);
+            }
+            return out;
+        }
+        case ME::opIdentity:
+            return evaluate(expression.args.front(), ctx);
+        case ME::opMinus:
+            return evaluate(expression.args.front(), ctx).unary_minus(expression.it_range.begin());
+        case ME::opNot:
+            return evaluate(expression.args.front(), ctx).unary_not(expression.it_range.begin());
+        case ME::opToInt:
+            return evaluate(expression.args.front(), ctx).unary_integer(expression.it_range.begin());
+        case ME::opRegexMatches:
+        case ME::opRegexDoesntMatch:
+        {
+            compiled_expr lhs = evaluate(expression.args.front(), ctx);
+            compiled_expr::regex_op(lhs, *expression.regex, expression.op == ME::opRegexMatches ? '=' : '!');
+            return lhs;
+        }
+        case ME::opTernary:
+        {
+            // Both branches are evaluated, as by the grammar.
+            compiled_expr cond  = evaluate(expression.args[0], ctx);
+            compiled_expr value = evaluate(expression.args[1], ctx);
+            compiled_expr other = evaluate(expression.args[2], ctx);
+            compiled_expr::ternary_op(cond, value, other);
+            return cond;
+        }
+        case ME::opExists:
+        case ME::opDefault:
+        {
+            compiled_range    opt_key = expression.it_range;
+            compiled_iterator end_pos = expression.it_range.end();
+            compiled_expr     out;
+            MyContext::check_variable(ctx, opt_key, end_pos, out,
+                std::unique_ptr<ConfigOption>(expression.default_value ? expression.default_value->clone() : nullptr));
+            return out;
+        }
+        case ME::opIgnoreLegacy:
+            MyContext::ignore_legacy = expression.value.b();
+            return compiled_expr();
+        default:
+            break;
+        }
+        // Binary operators and functions of two parameters, the result is stored into the left hand side.
+        compiled_expr lhs = evaluate(expression.args[0], ctx);
+        compiled_expr rhs = evaluate(expression.args[1], ctx);
+        switch (expression.op) {
+        case ME::opAdd:         lhs += rhs; break;
+        case ME::opSub:         lhs -= rhs; break;
+        case ME::opMul:         lhs *= rhs; break;
+        case ME::opDiv:         lhs /= rhs; break;
+        case ME::opMod:         lhs %= rhs; break;
+        case ME::opEqual:       compiled_expr::equal(lhs, rhs); break;
+        case ME::opNotEqual:    compiled_expr::not_equal(lhs, rhs); break;
+        case ME::opLower:       compiled_expr::lower(lhs, rhs); break;
+        case ME::opGreater:     compiled_expr::greater(lhs, rhs); break;
+        case ME::opLeq:         compiled_expr::leq(lhs, rhs); break;
+        case ME::opGeq:         compiled_expr::geq(lhs, rhs); break;
+        case ME::opOr:          compiled_expr::logical_or(lhs, rhs); break;
+        case ME::opAnd:         compiled_expr::logical_and(lhs, rhs); break;
+        case ME::opMin:         compiled_expr::min(lhs, rhs); break;
+        case ME::opMax:         compiled_expr::max(lhs, rhs); break;
+        case ME::opRandom:      MyContext::random(ctx, lhs, rhs); break;
+        default:                assert(false);
+        }
+        return lhs;
+    }
+
+    struct TemplateNode;
+
+    // {if}, {elsif} or {else} block of an {if} macro.
+    struct IfBranch
+    {
+        // Null for the {else} block.
+        std::unique_ptr<MacroExpression>    condition;
+        std::vector<TemplateNode>           block;
+    };
+
+    // Part of a template or of a block of an {if} macro, see the text_block rule.
+    struct TemplateNode
+    {
+        enum Type {
+            // Free text, already unescaped.
+            ntText,
+            // [scalar_variable] or [vector_variable_index]
+            ntLegacyVariable,
+            // [vector_variable[index_variable]]
+            ntLegacyVectorVariable,
+            // {expression}
+            ntMacro,
+            // {if}..{elsif}..{else}..{endif}
+            ntIf,
+        };
+
+        Type                                type = ntText;
+        std::string                         text;
+        compiled_range                      opt_key;
+        compiled_range                      opt_index;
+        std::unique_ptr<MacroExpression>    expression;
+        std::vector<IfBranch>               branches;
+    };
+
+    static void process_block(const std::vector<TemplateNode> &block, const MyContext *ctx, std::string &output)
+    {
+        for (const TemplateNode &node : block)
+            switch (node.type) {
+            case TemplateNode::ntText:
+                output += node.text;
+                break;
+            case TemplateNode::ntLegacyVariable:
+            case TemplateNode::ntLegacyVectorVariable:
+            {
+                compiled_range opt_key   = node.opt_key;
+                compiled_range opt_index = node.opt_index;
+                std::string    value;
+                if (node.type == TemplateNode::ntLegacyVariable)
+                    MyContext::legacy_variable_expansion(ctx, opt_key, value);
+                else
+                    MyContext::legacy_variable_expansion2(ctx, opt_key, opt_index, value);
+                output += value;
+                break;
+            }
+            case TemplateNode::ntMacro:
+                output += evaluate(*node.expression, ctx).to_string();
+                break;
+            case TemplateNode::ntIf:
+            {
+                // All the conditions and blocks are evaluated as by the grammar, the first block with a true condition is output.
+                bool        not_yet_consumed = true;
+                std::string taken;
+                for (const IfBranch &branch : node.branches) {
+                    bool cond = not_yet_consumed;
+                    if (branch.condition) {
+                        compiled_expr value = evaluate(*branch.condition, ctx);
+                        compiled_expr::evaluate_boolean(value, cond);
+                    }
+                    std::string text;
+                    process_block(branch.block, ctx, text);
+                    compiled_expr::set_if(cond, not_yet_consumed, text, taken);
+                }
+                output += taken;
+                break;
+            }
+            }
+    }
+
+    // Same as the keywords of the macro_processor grammar: they are not valid identifiers.
+    static const std::vector<std::string> s_macro_keywords {
+        "and", "if", "int", "else", "elsif", "endif", "false", "min", "max", "random", "not", "or", "true",
+        "exists", "default_double", "default_int", "default_bool", "default_string", "ignore_legacy"
+    };
+
+    // Characters skipped by the macro processor between its tokens (and at the start of the template).
+    static inline bool is_macro_space(char c) { return boost::spirit::char_encoding::iso8859_1::isspace(static_cast<unsigned char>(c)); }
+    static inline bool is_identifier_start(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+    static inline bool is_identifier_char(char c) { return is_identifier_start(c) || (c >= '0' && c <= '9'); }
+
+    // Length of the UTF-8 character starting at it, as accepted by the utf8_char_skipper_parser, 0 if invalid.
+    static size_t utf8_char_length(compiled_iterator it, compiled_iterator end)
+    {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if ((c & 0xC0) == 0x80)
+            return 0;
+        size_t cnt = 0;
+        for (unsigned char mask = 0x80u; c & mask; mask >>= 1)
+            ++ cnt;
+        cnt = (cnt == 0) ? 1 : std::min<size_t>(cnt, 4);
+        if (size_t(end - it) < cnt)
+            return 0;
+        for (size_t i = 1; i + 1 < cnt; ++ i)
+            if ((static_cast<unsigned char>(it[i]) & 0xC0) != 0x80)
+                return 0;
+        return cnt;
+    }
+
+    // Recursive descent parser of the macro_processor grammar, building the TemplateNodes and the MacroExpressions of a template.
+    // It accepts the valid templates only and throws CompileFailure otherwise: the template is then processed as a whole
+    // by the macro processor, which reports the error.
+    class TemplateCompiler
+    {
+    public:
+        struct CompileFailure {};
+
+        TemplateCompiler(const std::string &templ) : m_it(templ.begin()), m_end(templ.end()) {}
+
+        std::vector<TemplateNode> compile()
+        {
+            // The macro processor skips the leading white spaces.
+            this->skip_spaces();
+            return this->text_block(false);
+        }
+
+    private:
+        compiled_iterator m_it;
+        compiled_iterator m_end;
+
+        [[noreturn]] static void fail() { throw CompileFailure(); }
+
+        void skip_spaces()
+        {
+            while (m_it != m_end && is_macro_space(*m_it))
+                ++ m_it;
+        }
+
+        // Identifier or keyword starting at it, empty if there is none.
+        compiled_range word(compiled_iterator it) const
+        {
+            compiled_iterator end = it;
+            if (end != m_end && is_identifier_start(*end))
+                while (end != m_end && is_identifier_char(*end))
+                    ++ end;
+            return compiled_range(it, end);
+        }
+
+        static bool is_keyword(const compiled_range &word)
+        {
+            return std::find(s_macro_keywords.begin(), s_macro_keywords.end(), std::string(word.begin(), word.end())) != s_macro_keywords.end();
+        }
+
+        bool keyword(const char *keyword)
+        {
+            this->skip_spaces();
+            compiled_range w = this->word(m_it);
+            if (! boost::equals(w, keyword))
+                return false;
+            m_it = w.end();
+            return true;
+        }
+
+        bool literal(const char *literal)
+        {
+            this->skip_spaces();
+            size_t len = strlen(literal);
+            if (size_t(m_end - m_it) < len || ! std::equal(literal, literal + len, m_it))
+                return false;
+            m_it += len;
+            return true;
+        }
+
+        void expect(const char *literal)
+        {
+            if (! this->literal(literal))
+                fail();
+        }
+
+        compiled_range identifier()
+        {
+            this->skip_spaces();
+            compiled_range w = this->word(m_it);
+            if (w.empty() || is_keyword(w))
+                fail();
+            m_it = w.end();
+            return w;
+        }
+
+        // String literal or regular expression enclosed in delimiters, a delimiter may be escaped by a backslash.
+        compiled_range delimited(char delimiter)
+        {
+            this->skip_spaces();
+            compiled_iterator begin = m_it;
+            if (m_it == m_end || *m_it != delimiter)
+                fail();
+            for (++ m_it; m_it != m_end && *m_it != delimiter;)
+                if (*m_it == '\\')
+                    m_it += (m_it + 1 == m_end) ? 1 : 2;
+                else if (size_t len = utf8_char_length(m_it, m_end); len > 0)
+                    m_it += len;
+                else
+                    fail();
+            if (m_it == m_end)
+                fail();
+            return compiled_range(begin, ++ m_it);
+        }
+
+        static MacroExpression make(MacroExpression::Op op, compiled_iterator begin, compiled_iterator end)
+        {
+            MacroExpression out;
+            out.op       = op;
+            out.it_range = compiled_range(begin, end);
+            return out;
+        }
+
+        static MacroExpression unary(MacroExpression::Op op, compiled_iterator begin, MacroExpression &&arg)
+        {
+            MacroExpression out = make(op, begin, arg.it_range.end());
+            out.args.emplace_back(std::move(arg));
+            return out;
+        }
+
+        static MacroExpression binary(MacroExpression::Op op, MacroExpression &&lhs, MacroExpression &&rhs)
+        {
+            MacroExpression out = make(op, lhs.it_range.begin(), rhs.it_range.end());
+            out.args.emplace_back(std::move(lhs));
+            out.args.emplace_back(std::move(rhs));
+            return out;
+        }
+
+        std::vector<TemplateNode> text_block(bool in_if)
+        {
+            std::vector<TemplateNode> out;
+            std::string               text;
+            auto                      flush_text = [&out, &text]() {
+                if (! text.empty()) {
+                    out.emplace_back();
+                    out.back().text = std::move(text);
+                    text.clear();
+                }
+            };
+            while (m_it != m_end) {
+                char c = *m_it;
+                if (c == '\\') {
+                    // escape character: can escape '[' and '{' or is printed as-is.
+                    if (++ m_it != m_end && (*m_it == '[' || *m_it == '{'))
+                        text += *m_it ++;
+                    else
+                        text += c;
+                } else if (c == '[') {
+                    flush_text();
+                    out.emplace_back(this->legacy_variable_expansion());
+                } else if (c == '{') {
+                    if (in_if) {
+                        // {elsif}, {else} or {endif} ends the block of an {if} macro.
+                        compiled_iterator it = m_it + 1;
+                        while (it != m_end && is_macro_space(*it))
+                            ++ it;
+                        compiled_range w = this->word(it);
+                        if (boost::equals(w, "elsif") || boost::equals(w, "else") || boost::equals(w, "endif"))
+                            break;
+                    }
+                    flush_text();
+                    out.emplace_back(this->macro());
+                } else if (size_t len = utf8_char_length(m_it, m_end); len > 0) {
+                    text.append(m_it, m_it + len);
+                    m_it += len;
+                } else
+                    fail();
+            }
+            if (in_if && m_it == m_end)
+                // {endif} is missing.
+                fail();
+            flush_text();
+            return out;
+        }
+
+        TemplateNode legacy_variable_expansion()
+        {
+            TemplateNode out;
+            ++ m_it;
+            out.opt_key = this->identifier();
+            if (this->literal("]")) {
+                out.type = TemplateNode::ntLegacyVariable;
+                return out;
+            }
+            this->expect("[");
+            out.type      = TemplateNode::ntLegacyVectorVariable;
+            out.opt_index = this->identifier();
+            this->expect("]");
+            this->expect("]");
+            return out;
+        }
+
+        TemplateNode macro()
+        {
+            TemplateNode out;
+            ++ m_it;
+            if (this->keyword("if")) {
+                out.type = TemplateNode::ntIf;
+                bool has_else = false;
+                for (;;) {
+                    IfBranch branch;
+                    if (! has_else)
+                        branch.condition = std::make_unique<MacroExpression>(this->conditional_expression());
+                    this->expect("}");
+                    branch.block = this->text_block(true);
+                    out.branches.emplace_back(std::move(branch));
+                    this->expect("{");
+                    if (this->keyword("endif"))
+                        break;
+                    if (has_else)
+                        fail();
+                    if (this->keyword("else"))
+                        has_else = true;
+                    else if (! this->keyword("elsif"))
+                        fail();
+                }
+            } else {
+                out.type       = TemplateNode::ntMacro;
+                out.expression = std::make_unique<MacroExpression>(this->additive_expression());
+            }
+            this->expect("}");
+            return out;
+        }
+
+        MacroExpression conditional_expression()
+        {
+            MacroExpression out = this->logical_or_expression();
+            if (this->literal("?")) {
+                MacroExpression value = this->conditional_expression();
+                this->expect(":");
+                MacroExpression other = this->conditional_expression();
+                compiled_iterator end = other.it_range.end();
+                out = binary(MacroExpression::opTernary, std::move(out), std::move(value));
+                out.args.emplace_back(std::move(other));
+                out.it_range = compiled_range(out.it_range.begin(), end);
+            }
+            return out;
+        }
+
+        MacroExpression logical_or_expression()
+        {
+            MacroExpression out = this->logical_and_expression();
+            while (this->keyword("or") || this->literal("||"))
+                out = binary(MacroExpression::opOr, std::move(out), this->logical_and_expression());
+            return out;
+        }
+
+        MacroExpression logical_and_expression()
+        {
+            MacroExpression out = this->equality_expression();
+            while (this->keyword("and") || this->literal("&&"))
+                out = binary(MacroExpression::opAnd, std::move(out), this->equality_expression());
+            return out;
+        }
+
+        MacroExpression equality_expression()
+        {
+            MacroExpression out = this->relational_expression();
+            for (;;) {
+                if (this->literal("=="))
+                    out = binary(MacroExpression::opEqual, std::move(out), this->relational_expression());
+                else if (this->literal("!=") || this->literal("<>"))
+                    out = binary(MacroExpression::opNotEqual, std::move(out), this->relational_expression());
+                else if (this->literal("=~"))
+                    out = this->regular_expression(MacroExpression::opRegexMatches, std::move(out));
+                else if (this->literal("!~"))
+                    out = this->regular_expression(MacroExpression::opRegexDoesntMatch, std::move(out));
+                else
+                    return out;
+            }
+        }
+
+        MacroExpression regular_expression(MacroExpression::Op op, MacroExpression &&lhs)
+        {
+            compiled_range  range = this->delimited('/');
+            MacroExpression out   = make(op, lhs.it_range.begin(), range.end());
+            out.args.emplace_back(std::move(lhs));
+            try {
+                out.regex = std::make_unique<SLIC3R_REGEX_NAMESPACE::regex>(std::string(range.begin() + 1, range.end() - 1));
+            } catch (SLIC3R_REGEX_NAMESPACE::regex_error &) {
+                fail();
+            }
+            return out;
+        }
+
+        MacroExpression relational_expression()
+        {
+            MacroExpression out = this->additive_expression();
+            for (;;) {
+                if (this->literal("<="))
+                    out = binary(MacroExpression::opLeq, std::move(out), this->additive_expression());
+                else if (this->literal(">="))
+                    out = binary(MacroExpression::opGeq, std::move(out), this->additive_expression());
+                else if (this->literal("<"))
+                    out = binary(MacroExpression::opLower, std::move(out), this->additive_expression());
+                else if (this->literal(">"))
+                    out = binary(MacroExpression::opGreater, std::move(out), this->additive_expression());
+                else
+                    return out;
+            }
+        }
+
+        MacroExpression additive_expression()
+        {
+            MacroExpression out = this->multiplicative_expression();
+            for (;;) {
+                if (this->literal("+"))
+                    out = binary(MacroExpression::opAdd, std::move(out), this->multiplicative_expression());
+                else if (this->literal("-"))
+                    out = binary(MacroExpression::opSub, std::move(out), this->multiplicative_expression());
+                else
+                    return out;
+            }
+        }
+
+        MacroExpression multiplicative_expression()
+        {
+            MacroExpression out = this->unary_expression();
+            for (;;) {
+                if (this->literal("*"))
+                    out = binary(MacroExpression::opMul, std::move(out), this->unary_expression());
+                else if (this->literal("/"))
+                    out = binary(MacroExpression::opDiv, std::move(out), this->unary_expression());
+                else if (this->literal("%"))
+                    out = binary(MacroExpression::opMod, std::move(out), this->unary_expression());
+                else
+                    return out;
+            }
+        }
+
+        // Function of two parameters, after its name.
+        MacroExpression function_2params(MacroExpression::Op op, compiled_iterator begin)
+        {
+            this->expect("(");
+            MacroExpression param1 = this->conditional_expression();
+            this->expect(",");
+            MacroExpression out = binary(op, std::move(param1), this->conditional_expression());
+            this->expect(")");
+            out.it_range = compiled_range(begin, m_it);
+            return out;
+        }
+
+        // default_double(), default_int(), default_bool() or default_string(), after its name.
+        template<typename ParseDefault>
+        MacroExpression function_default(compiled_iterator begin, ParseDefault parse_default)
+        {
+            this->expect("(");
+            MacroExpression out = make(MacroExpression::opDefault, begin, begin);
+            out.it_range      = this->identifier();
+            this->expect(",");
+            this->skip_spaces();
+            out.default_value = parse_default();
+            this->expect(")");
+            return out;
+        }
+
+        bool parse_bool(bool &value)
+        {
+            if (this->keyword("true"))
+                value = true;
+            else if (this->keyword("false"))
+                value = false;
+            else
+                return false;
+            return true;
+        }
+
+        MacroExpression unary_expression()
+        {
+            typedef MacroExpression ME;
+            this->skip_spaces();
+            compiled_iterator begin = m_it;
+            if (m_it == m_end)
+                fail();
+            if (compiled_range w = this->word(m_it); ! w.empty()) {
+                if (! is_keyword(w)) {
+                    // Scalar variable reference, or a reference to a field of a vector variable.
+                    ME out = make(ME::opScalarVariable, begin, this->identifier().end());
+                    if (this->literal("[")) {
+                        out.op = ME::opVectorVariable;
+                        out.args.emplace_back(this->additive_expression());
+                        this->expect("]");
+                    }
+                    return out;
+                }
+                bool value = false;
+                if (this->parse_bool(value)) {
+                    ME out = make(ME::opLiteral, begin, m_it);
+                    out.value = compiled_expr(value, begin, m_it);
+                    return out;
+                }
+                m_it = w.end();
+                if (boost::equals(w, "not"))
+                    return unary(ME::opNot, begin, this->unary_expression());
+                if (boost::equals(w, "min"))
+                    return this->function_2params(ME::opMin, begin);
+                if (boost::equals(w, "max"))
+                    return this->function_2params(ME::opMax, begin);
+                if (boost::equals(w, "random"))
+                    return this->function_2params(ME::opRandom, begin);
+                if (boost::equals(w, "int")) {
+                    this->expect("(");
+                    ME out = unary(ME::opToInt, begin, this->unary_expression());
+                    this->expect(")");
+                    return out;
+                }
+                if (boost::equals(w, "exists")) {
+                    this->expect("(");
+                    ME out = make(ME::opExists, begin, begin);
+                    out.it_range = this->identifier();
+                    this->expect(")");
+                    return out;
+                }
+                if (boost::equals(w, "default_double"))
+                    return this->function_default(begin, [this]() {
+                        qi::real_parser<double, strict_real_policies_without_nan_inf> strict_double;
+                        double value = 0.;
+                        if (! qi::parse(m_it, m_end, strict_double, value))
+                            fail();
+                        return std::make_unique<ConfigOptionFloat>(value);
+                    });
+                if (boost::equals(w, "default_int"))
+                    return this->function_default(begin, [this]() {
+                        int value = 0;
+                        if (! qi::parse(m_it, m_end, qi::int_, value))
+                            fail();
+                        return std::make_unique<ConfigOptionInt>(value);
+                    });
+                if (boost::equals(w, "default_bool"))
+                    return this->function_default(begin, [this]() {
+                        bool value = false;
+                        if (! this->parse_bool(value))
+                            fail();
+                        return std::make_unique<ConfigOptionBool>(value);
+                    });
+                if (boost::equals(w, "default_string"))
+                    return this->function_default(begin, [this]() {
+                        compiled_range range = this->delimited('"');
+                        return std::make_unique<ConfigOptionString>(std::string(range.begin() + 1, range.end() - 1));
+                    });
+                if (boost::equals(w, "ignore_legacy")) {
+                    this->expect("(");
+                    ME out = make(ME::opIgnoreLegacy, begin, begin);
+                    bool value = false;
+                    if (! this->parse_bool(value))
+                        fail();
+                    out.value = compiled_expr(value);
+                    this->expect(")");
+                    return out;
+                }
+                // The other keywords don't start an expression.
+                fail();
+            }
+            switch (*m_it) {
+            case '(':
+            {
+                ++ m_it;
+                ME out = unary(ME::opIdentity, begin, this->conditional_expression());
+                this->expect(")");
+                out.it_range = compiled_range(begin, m_it);
+                return out;
+            }
+            case '-':
+                ++ m_it;
+                return unary(ME::opMinus, begin, this->unary_expression());
+            case '+':
+                ++ m_it;
+                return unary(ME::opIdentity, begin, this->unary_expression());
+            case '!':
+                ++ m_it;
+                return unary(ME::opNot, begin, this->unary_expression());
+            case '"':
+            {
+                compiled_range range = this->delimited('"');
+                ME out = make(ME::opLiteral, begin, m_it);
+                out.value = compiled_expr(std::string(range.begin() + 1, range.end() - 1), range.begin(), range.end());
+                return out;
+            }
+            default:
+                break;
+            }
+            // Number literals, parsed by the parsers of the grammar.
+            qi::real_parser<double, strict_real_policies_without_nan_inf> strict_double;
+            double d = 0.;
+            int    i = 0;
+            ME     out;
+            if (qi::parse(m_it, m_end, strict_double, d)) {
+                out = make(ME::opLiteral, begin, m_it);
+                out.value = compiled_expr(d, begin, m_it);
+            } else if (qi::parse(m_it, m_end, qi::int_, i)) {
+                out = make(ME::opLiteral, begin, m_it);
+                out.value = compiled_expr(i, begin, m_it);
+            } else
+                fail();
+            return out;
+        }
+    };
+}
+
+struct PlaceholderParser::CompiledTemplate
+{
+    // Copy of the template, the nodes refer to it.
+    std::string                         source;
+    // False if the template could not be compiled, it is then processed as a whole by the macro processor.
+    bool                                compiled = false;
+    std::vector<client::TemplateNode>   nodes;
+};
+
+PlaceholderParser::CompiledTemplatePtr PlaceholderParser::compile_template(const std::string &templ)
+{
+    auto out = std::make_shared<CompiledTemplate>();
+    out->source = templ;
+    try {
+        out->nodes    = client::TemplateCompiler(out->source).compile();
+        out->compiled = true;
+    } catch (client::TemplateCompiler::CompileFailure &) {
+    }
+    return out;
+}
+
 std::string PlaceholderParser::process(const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, ContextData *context_data) const
 {
+    return templ.empty() ? std::string() : this->process(*compile_template(templ), current_extruder_id, config_override, context_data);
+}
+
+std::string PlaceholderParser::process(const CompiledTemplate &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, ContextData *context_data) const
+{
+    if (templ.source.empty())
+        return std::string();
     client::MyContext context;
     context.external_config 	= this->external_config();
     context.config              = &this->config();
     context.config_override     = config_override;
     context.current_extruder_id = current_extruder_id;
     context.context_data        = context_data;
-    return process_macro(templ, context);
+    if (templ.compiled) {
+        try {
+            std::string output;
+            client::process_block(templ.nodes, &context, output);
+            return output;
+        } catch (std::exception &) {
+            // Process the whole template to report the error at its position in the template.
+            context.error_message.clear();
+        }
+    }
+    return process_macro(templ.source, context);
 }
 
 // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
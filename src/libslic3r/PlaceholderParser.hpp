@@ -3,6 +3,7 @@
 
 #include "libslic3r.h"
 #include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
@@ -49,9 +50,16 @@ public:
     // External config is not owned by PlaceholderParser. It has a lowest priority when looking up an option.
 	const DynamicConfig*	external_config() const  			{ return m_external_config; }
 
+    // A template parsed once, to be processed by process() as many times as needed, for example for each layer.
+    // It doesn't depend on the config: the variables are resolved each time the template is processed.
+    struct CompiledTemplate;
+    using CompiledTemplatePtr = std::shared_ptr<const CompiledTemplate>;
+    static CompiledTemplatePtr compile_template(const std::string &templ);
+
     // Fill in the template using a macro processing language.
     // Throws Slic3r::PlaceholderParserError on syntax or runtime error.
     std::string process(const std::string &templ, unsigned int current_extruder_id = 0, const DynamicConfig *config_override = nullptr, ContextData *context = nullptr) const;
+    std::string process(const CompiledTemplate &templ, unsigned int current_extruder_id = 0, const DynamicConfig *config_override = nullptr, ContextData *context = nullptr) const;
     
     // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
     // Throws Slic3r::PlaceholderParserError on syntax or runtime error.
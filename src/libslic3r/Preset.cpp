@@ -294,11 +294,11 @@ std::string Preset::remove_suffix_modified(const std::string &name)
 // Update new extruder fields at the printer profile.
 void Preset::normalize(DynamicPrintConfig &config)
 {
-    auto *nozzle_diameter = dynamic_cast<const ConfigOptionFloats*>(config.option("nozzle_diameter"));
+    auto *nozzle_diameter = dynamic_cast<const ConfigOptionFloats*>(std::as_const(config).option("nozzle_diameter"));
     if (nozzle_diameter != nullptr)
         // Loaded the FFF Printer settings. Verify, that all extruder dependent values have enough values.
         config.set_num_extruders((unsigned int)nozzle_diameter->values.size());
-    if (config.option("filament_diameter") != nullptr) {
+    if (std::as_const(config).option("filament_diameter") != nullptr) {
         // This config contains single or multiple filament presets.
         // Ensure that the filament preset vector options contain the correct number of values.
         size_t n = (nozzle_diameter == nullptr) ? 1 : nozzle_diameter->values.size();
@@ -306,21 +306,19 @@ void Preset::normalize(DynamicPrintConfig &config)
         for (const std::string &key : Preset::filament_options()) {
             if (key == "compatible_prints" || key == "compatible_printers")
                 continue;
-            auto *opt = config.option(key, false);
-            /*assert(opt != nullptr);
-            assert(opt->is_vector());*/
-            if (opt != nullptr && opt->is_vector())
-                static_cast<ConfigOptionVectorBase*>(opt)->resize(n, defaults.option(key));
+            /*assert(config.option(key) != nullptr);
+            assert(config.option(key)->is_vector());*/
+            config.resize_vector(key, n, defaults.option(key));
         }
         // The following keys are mandatory for the UI, but they are not part of FullPrintConfig, therefore they are handled separately.
         for (const std::string &key : { "filament_settings_id" }) {
-            auto *opt = config.option(key, false);
+            auto *opt = std::as_const(config).option(key);
             assert(opt == nullptr || opt->type() == coStrings);
-            if (opt != nullptr && opt->type() == coStrings)
-                static_cast<ConfigOptionStrings*>(opt)->values.resize(n, std::string());
+            if (opt != nullptr && opt->type() == coStrings && static_cast<const ConfigOptionStrings*>(opt)->values.size() != n)
+                config.option<ConfigOptionStrings>(key)->values.resize(n, std::string());
         }
     }
-    auto *milling_diameter = dynamic_cast<const ConfigOptionFloats*>(config.option("milling_diameter"));
+    auto *milling_diameter = dynamic_cast<const ConfigOptionFloats*>(std::as_const(config).option("milling_diameter"));
     if (milling_diameter != nullptr)
         // Loaded the FFF Printer settings. Verify, that all extruder dependent values have enough values.
         config.set_num_milling((unsigned int)milling_diameter->values.size());
@@ -996,6 +994,8 @@ void PresetCollection::load_presets(
                     if (! incorrect_keys.empty())
                         BOOST_LOG_TRIVIAL(error) << "Error in a preset file: The preset \"" <<
                             preset.file << "\" contains the following incorrect keys: " << incorrect_keys << ", which were removed";
+                    // Share the values of the preset with its copies, for example with the edited preset, instead of cloning them.
+                    preset.config.share_options();
                     preset.loaded = true;
                 } catch (const std::ifstream::failure &err) {
                     throw Slic3r::RuntimeError(std::string("The selected preset cannot be loaded: ") + preset.file + "\n\tReason: " + err.what());
@@ -187,24 +187,33 @@ public:
 
     // Returns the name of the preset, from which this preset inherits.
     static std::string& inherits(DynamicPrintConfig &cfg) { return cfg.option<ConfigOptionString>("inherits", true)->value; }
+    static const std::string& inherits(const DynamicPrintConfig &cfg) { return Preset::option_string(cfg, "inherits"); }
     std::string&        inherits() { return Preset::inherits(this->config); }
-    const std::string&  inherits() const { return Preset::inherits(const_cast<Preset*>(this)->config); }
+    const std::string&  inherits() const { return Preset::inherits(this->config); }
 
     // Returns the "compatible_prints_condition".
     static std::string& compatible_prints_condition(DynamicPrintConfig &cfg) { return cfg.option<ConfigOptionString>("compatible_prints_condition", true)->value; }
+    static const std::string& compatible_prints_condition(const DynamicPrintConfig &cfg) { return Preset::option_string(cfg, "compatible_prints_condition"); }
     std::string&        compatible_prints_condition() { 
 		assert(this->type == TYPE_FFF_FILAMENT || this->type == TYPE_SLA_MATERIAL);
         return Preset::compatible_prints_condition(this->config);
     }
-    const std::string&  compatible_prints_condition() const { return const_cast<Preset*>(this)->compatible_prints_condition(); }
+    const std::string&  compatible_prints_condition() const {
+		assert(this->type == TYPE_FFF_FILAMENT || this->type == TYPE_SLA_MATERIAL);
+        return Preset::compatible_prints_condition(this->config);
+    }
 
     // Returns the "compatible_printers_condition".
     static std::string& compatible_printers_condition(DynamicPrintConfig &cfg) { return cfg.option<ConfigOptionString>("compatible_printers_condition", true)->value; }
+    static const std::string& compatible_printers_condition(const DynamicPrintConfig &cfg) { return Preset::option_string(cfg, "compatible_printers_condition"); }
     std::string&        compatible_printers_condition() {
 		assert(this->type == TYPE_FFF_PRINT || this->type == TYPE_SLA_PRINT || this->type == TYPE_FFF_FILAMENT || this->type == TYPE_SLA_MATERIAL);
         return Preset::compatible_printers_condition(this->config);
     }
-    const std::string&  compatible_printers_condition() const { return const_cast<Preset*>(this)->compatible_printers_condition(); }
+    const std::string&  compatible_printers_condition() const {
+		assert(this->type == TYPE_FFF_PRINT || this->type == TYPE_SLA_PRINT || this->type == TYPE_FFF_FILAMENT || this->type == TYPE_SLA_MATERIAL);
+        return Preset::compatible_printers_condition(this->config);
+    }
 
     // Return a printer technology, return ptFFF if the printer technology is not set.
     static PrinterTechnology printer_technology(const DynamicPrintConfig &cfg) {
@@ -254,6 +263,14 @@ public:
 protected:
     friend class        PresetCollection;
     friend class        PresetBundle;
+
+private:
+    // Value of a string option, an empty string if the option does not exist. Does not modify the config.
+    static const std::string& option_string(const DynamicPrintConfig &cfg, const char *opt_key) {
+        static const std::string empty;
+        auto *opt = cfg.option<ConfigOptionString>(opt_key);
+        return opt ? opt->value : empty;
+    }
 };
 
 bool is_compatible_with_print  (const PresetWithVendorProfile &preset, const PresetWithVendorProfile &active_print, const PresetWithVendorProfile &active_printer);
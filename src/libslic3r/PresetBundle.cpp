@@ -96,6 +96,11 @@ PresetBundle::PresetBundle() :
         preset.inherits();
     }
 
+    // The presets are loaded on top of copies of the default presets, share the default values with them instead of cloning them.
+    for (PresetCollection *presets : std::initializer_list<PresetCollection*>{ &this->fff_prints, &this->sla_prints, &this->filaments, &this->sla_materials, &this->printers })
+        for (size_t i = 0; i < presets->num_default_presets(); ++ i)
+            presets->default_preset(i).config.share_options();
+
     // Re-activate the default presets, so their "edited" preset copies will be updated with the additional configuration values above.
     this->fff_prints       .select_preset(0);
     this->sla_prints   .select_preset(0);
@@ -552,11 +557,10 @@ DynamicPrintConfig PresetBundle::full_fff_config() const
 		while (filament_configs.size() < num_extruders)
             filament_configs.emplace_back(&this->filaments.first_visible().config);
         for (const DynamicPrintConfig *cfg : filament_configs) {
-            // The compatible_prints/printers_condition() returns a reference to configuration key, which may not yet exist.
-            DynamicPrintConfig &cfg_rw = *const_cast<DynamicPrintConfig*>(cfg);
-            compatible_printers_condition.emplace_back(Preset::compatible_printers_condition(cfg_rw));
-            compatible_prints_condition  .emplace_back(Preset::compatible_prints_condition(cfg_rw));
-            inherits                     .emplace_back(Preset::inherits(cfg_rw));
+            // Read through the const accessors, which neither add the missing keys nor unshare the values of the preset.
+            compatible_printers_condition.emplace_back(Preset::compatible_printers_condition(*cfg));
+            compatible_prints_condition  .emplace_back(Preset::compatible_prints_condition(*cfg));
+            inherits                     .emplace_back(Preset::inherits(*cfg));
         }
         // Option values to set a ConfigOptionVector from.
         std::vector<const ConfigOption*> filament_opts(num_extruders, nullptr);
@@ -1123,6 +1127,9 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
     std::string              active_physical_printer;
     size_t                   presets_loaded = 0;
     size_t                   ph_printers_loaded = 0;
+    // Option values parsed from the preset sections, addressed by their key and string value.
+    // The flattened presets inherit most of their values from common parents, the presets share a single instance of them.
+    std::map<std::pair<t_config_option_key, std::string>, std::shared_ptr<const ConfigOption>> parsed_values;
 
     for (const auto &section : tree) {
         PresetCollection         *presets = nullptr;
@@ -1210,7 +1217,7 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
             std::string 			  alias_name;
             std::vector<std::string>  renamed_from;
             try {
-                auto parse_config_section = [&section, &alias_name, &renamed_from, &substitution_context, &path, &flags](DynamicPrintConfig &config) {
+                auto parse_config_section = [&section, &alias_name, &renamed_from, &substitution_context, &path, &flags, &parsed_values](DynamicPrintConfig &config) {
                     substitution_context.substitutions.clear();
                     for (auto &kvp : section.second) {
                     	if (kvp.first == "alias")
@@ -1222,7 +1229,25 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
                        		}
                     	}
                         // Throws on parsing error. For system presets, no substituion is being done, but an exception is thrown.
-                        config.set_deserialize(kvp.first, kvp.second.data(), substitution_context);
+                        t_config_option_key    opt_key = kvp.first;
+                        std::string            value   = kvp.second.data();
+                        PrintConfigDef::handle_legacy(opt_key, value);
+                        const ConfigOptionDef *optdef  = config.def()->get(opt_key);
+                        if (opt_key != kvp.first || value != kvp.second.data() || optdef == nullptr || ! optdef->shortcut.empty()) {
+                            // Legacy, aliased or shortcut option, which may set another option than opt_key.
+                            config.set_deserialize(kvp.first, kvp.second.data(), substitution_context);
+                            continue;
+                        }
+                        auto key = std::make_pair(std::move(opt_key), std::move(value));
+                        auto it  = parsed_values.find(key);
+                        if (it != parsed_values.end()) {
+                            config.set_key_value(kvp.first, it->second);
+                        } else {
+                            size_t num_substitutions = substitution_context.substitutions.size();
+                            config.set_deserialize(kvp.first, kvp.second.data(), substitution_context);
+                            if (substitution_context.substitutions.size() == num_substitutions)
+                                parsed_values.emplace(std::move(key), config.share_option(kvp.first));
+                        }
                     }
                     if (flags.has(LoadConfigBundleAttribute::ConvertFromPrusa))
                         config.convert_from_prusa();
@@ -1233,7 +1258,8 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
                     parse_config_section(config_src);
                     default_config = &presets->default_preset_for(config_src).config;
                     config = *default_config;
-                    config.apply(config_src);
+                    // Move the parsed values, so that the values shared with the other presets stay shared.
+                    config += std::move(config_src);
                 } else {
                     default_config = &presets->default_preset().config;
                     config = *default_config;
@@ -1251,13 +1277,13 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
             if (flags.has(LoadConfigBundleAttribute::LoadSystem) && presets == &printers) {
                 // Filter out printer presets, which are not mentioned in the vendor profile.
                 // These presets are considered not installed.
-                auto printer_model   = config.opt_string("printer_model");
+                auto printer_model   = std::as_const(config).opt_string("printer_model");
                 if (printer_model.empty()) {
                     BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle \"" << path << "\": The printer preset \"" << 
                         section.first << "\" defines no printer model, it will be ignored.";
                     continue;
                 }
-                auto printer_variant = config.opt_string("printer_variant");
+                auto printer_variant = std::as_const(config).opt_string("printer_variant");
                 if (printer_variant.empty()) {
                     BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle \"" << path << "\": The printer preset \"" << 
                         section.first << "\" defines no printer variant, it will be ignored.";
@@ -1310,6 +1336,8 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
                 // Store the print/filament/printer presets at the same location as the upstream Slic3r.
 #endif
                 / presets->section_name() / file_name).make_preferred();
+            // Share the values of the preset with its copies, for example with the edited preset, instead of cloning them.
+            config.share_options();
             // Load the preset into the list of presets, save it to disk.
             Preset &loaded = presets->load_preset(file_path.string(), preset_name, std::move(config), false);
             if (flags.has(LoadConfigBundleAttribute::SaveImported))
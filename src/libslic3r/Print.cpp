@@ -21,12 +21,17 @@
 #include <float.h>
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <limits>
+#include <mutex>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 // Mark string for localization and translate.
 #define L(s) Slic3r::I18N::translate(s)
 
@@ -1194,8 +1199,14 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
             if (! diff.empty()) {
                 region.config_apply_only(this_region_config, diff, false);
                 for (PrintObject *print_object : m_objects)
-                    if (region_id < print_object->region_volumes.size() && ! print_object->region_volumes[region_id].empty())
-                        update_apply_status(print_object->invalidate_state_by_config_options(diff));
+                    if (region_id < print_object->region_volumes.size() && ! print_object->region_volumes[region_id].empty()) {
+                        // The region only exists in the layer ranges of its volumes, for example in a single layer range
+                        // with its own config: only invalidate the layers inside these ranges.
+                        std::vector<t_layer_height_range> z_ranges;
+                        for (const std::pair<t_layer_height_range, int> &volume_and_range : print_object->region_volumes[region_id])
+                            z_ranges.emplace_back(volume_and_range.first);
+                        update_apply_status(print_object->invalidate_state_by_config_options(diff, z_ranges));
+                    }
             }
         }
     }
@@ -1810,23 +1821,77 @@ void Print::auto_assign_extruders(ModelObject* model_object) const
 }
 
 // Slicing process, running at a background thread.
+// Run the PrintObject steps of all the objects.
+// The steps of a single object (posPerimeters -> posPrepareInfill -> posInfill -> posIroning -> posSupportMaterial)
+// depend on each other, but the objects are independent, so the chains of the objects are executed concurrently.
+// The per layer tbb::parallel_for loops inside the steps are nested into the per object tasks, so a plate
+// of many small objects fills the thread pool, while a single big object still gets all the threads.
+void Print::process_objects()
+{
+    if (m_serial_object_processing || m_objects.size() < 2) {
+        for (PrintObject *obj : m_objects)
+            obj->make_perimeters();
+        this->set_status(70, L("Infilling layers"));
+        for (PrintObject *obj : m_objects)
+            obj->infill();
+        for (PrintObject *obj : m_objects)
+            obj->ironing();
+        for (PrintObject *obj : m_objects)
+            obj->generate_support_material();
+        return;
+    }
+
+    // Slice serially, the slicing is already parallelized over the layers and it touches the ModelObjects.
+    for (PrintObject *obj : m_objects)
+        obj->slice();
+
+    // An exception (cancelation, slicing error) must not escape a task: it would cancel the TBB task group
+    // of the other objects, whose nested per layer loops would return early with half of the layers processed
+    // and their step would then be marked as done. Instead, the first exception is captured, the other objects
+    // stop before entering their next step and the exception is rethrown once all the tasks finished.
+    // The step state machine (set_started() / set_done()) is guarded by the shared PrintBase::m_state_mutex.
+    static constexpr void (PrintObject::*object_steps[])() = {
+        &PrintObject::make_perimeters, &PrintObject::infill, &PrintObject::ironing, &PrintObject::generate_support_material
+    };
+    std::exception_ptr  exception;
+    std::mutex          exception_mutex;
+    std::atomic<bool>   failed { false };
+    // Same status as the serial branch, emitted by the first object to reach the infill.
+    std::once_flag      infill_status;
+    BOOST_LOG_TRIVIAL(debug) << "Processing " << m_objects.size() << " objects in parallel - start";
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_objects.size(), 1),
+        [this, &exception, &exception_mutex, &failed, &infill_status](const tbb::blocked_range<size_t> &range) {
+        for (size_t object_idx = range.begin(); object_idx < range.end(); ++ object_idx) {
+            PrintObject *obj = m_objects[object_idx];
+            try {
+                for (auto step : object_steps) {
+                    if (failed)
+                        break;
+                    if (step == &PrintObject::infill)
+                        std::call_once(infill_status, [this]() { this->set_status(70, L("Infilling layers")); });
+                    (obj->*step)();
+                }
+            } catch (...) {
+                std::scoped_lock lock(exception_mutex);
+                if (! exception)
+                    exception = std::current_exception();
+                failed = true;
+            }
+        }
+    }, tbb::simple_partitioner());
+    BOOST_LOG_TRIVIAL(debug) << "Processing " << m_objects.size() << " objects in parallel - end";
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
 void Print::process()
 {
     m_timestamp_last_change = std::time(0);
     name_tbb_thread_pool_threads();
     bool something_done = !is_step_done_unguarded(psBrim);
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
-    for (PrintObject *obj : m_objects)
-        obj->make_perimeters();
-    this->set_status(70, L("Infilling layers"));
-    //note: as object seems to be sliced independantly, it's maybe possible to add a tbb parallel_loop with simple partitioner on infill,
-    //  as prepare_infill has some function not // 
-    for (PrintObject *obj : m_objects)
-        obj->infill();
-    for (PrintObject *obj : m_objects)
-        obj->ironing();
-    for (PrintObject *obj : m_objects)
-        obj->generate_support_material();
+    this->process_objects();
     if (this->set_started(psWipeTower)) {
         m_wipe_tower_data.clear();
         m_tool_ordering.clear();
@@ -8,6 +8,7 @@
 #include "Flow.hpp"
 #include "Point.hpp"
 #include "Slicing.hpp"
+#include "SlicingMeshCache.hpp"
 #include "Surface.hpp"
 #include "GCode/ToolOrdering.hpp"
 #include "GCode/WipeTower.hpp"
@@ -224,7 +225,11 @@ protected:
     // Invalidates all PrintObject and Print steps.
     bool                    invalidate_all_steps();
     // Invalidate steps based on a set of parameters changed.
-    bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys);
+    bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys)
+        { return this->invalidate_state_by_config_options(opt_keys, {}); }
+    // Invalidate steps based on a set of parameters changed for the layers inside z_ranges only (object Z, same as Layer::slice_z).
+    // The perimeters and the infill of the other layers are kept if they were already generated. Empty z_ranges means the whole object.
+    bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys, const std::vector<t_layer_height_range> &z_ranges);
     // If ! m_slicing_params.valid, recalculate.
     void                    update_slicing_parameters();
 
@@ -259,6 +264,14 @@ private:
     void _generate_support_material();
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> prepare_adaptive_infill_data();
 
+    // A step invalidated for some layer ranges only: the layers outside of dirty_z_ranges keep their data.
+    struct PartialStep {
+        bool                              active { false };
+        std::vector<t_layer_height_range> dirty_z_ranges;
+    };
+    // Flags of the layers to be (re)computed by a step, all of them if the step is not partially invalidated.
+    std::vector<char> dirty_layers(const PartialStep &partial) const;
+
     // XYZ in scaled coordinates
     Vec3crd									m_size;
     PrintObjectConfig                       m_config;
@@ -283,6 +296,15 @@ private:
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
     bool                                    m_typed_slices = false;
+    // Layer ranges to recompute by make_perimeters() and infill() after a change of a layer range or region config.
+    PartialStep                             m_partial_perimeters;
+    PartialStep                             m_partial_infill;
+    // Fingerprints of the fill_surfaces the fills of each layer were generated from, to regenerate only the fills
+    // of the layers touched by prepare_infill() after a partial invalidation.
+    std::vector<uint64_t>                   m_fills_fingerprints;
+    // Meshes of the volumes transformed into this object and prepared for slicing, reused by the following slicing
+    // as long as the meshes and the transformations do not change.
+    mutable SlicingMeshCache                m_slicing_mesh_cache;
 
     std::vector<ExPolygons> slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below) const;
     std::vector<ExPolygons> slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode) const
@@ -296,6 +318,7 @@ private:
         { return this->slice_volumes(z, mode, 0, mode, volumes); }
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, SlicingMode mode, const ModelVolume &volume) const;
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, const std::vector<t_layer_height_range> &ranges, SlicingMode mode, const ModelVolume &volume) const;
+    SlicingMeshCache::EntryPtr prepare_volumes_for_slicing(const std::vector<const ModelVolume*> &volumes) const;
 
 
 };
@@ -481,7 +504,13 @@ public:
     const PrintStatistics&      print_statistics() const { return m_print_statistics; }
     PrintStatistics&            print_statistics() { return m_print_statistics; }
     std::time_t                 timestamp_last_change() const { return m_timestamp_last_change; }
-
+    // Process the PrintObjects one after the other inside process() instead of concurrently.
+    // Used for benchmarking and for debugging.
+    void                        set_serial_object_processing(bool serial) { m_serial_object_processing = serial; }
+    // Generate the G-code without post-processing and writing it from a worker thread,
+    // and without precomputing the geometry of the next layers on worker threads.
+    // Used for benchmarking and for checking that the output is the same.
+    void                        set_serial_gcode_export(bool serial) { m_serial_gcode_export = serial; }
 
     // Wipe tower support.
     bool                        has_wipe_tower() const;
@@ -521,6 +550,8 @@ private:
     Polylines           _reorder_brim_polyline(Polylines lines, ExtrusionEntityCollection &out, const Flow &flow);
     void                _make_wipe_tower();
     void                finalize_first_layer_convex_hull();
+    // Run the PrintObject steps (posPerimeters .. posSupportMaterial) of all the objects.
+    void                process_objects();
 
     // Islands of objects and their supports extruded at the 1st layer.
     Polygons            first_layer_islands() const;
@@ -556,6 +587,10 @@ private:
     PrintStatistics                         m_print_statistics;
     // tiem of last change, to see if the gui need to be updated
     std::time_t                             m_timestamp_last_change;
+    // process_objects() runs the objects one after the other if set.
+    bool                                    m_serial_object_processing { false };
+    // GCode::do_export() doesn't pipeline the cooling / fan mover / file output nor precompute the layer geometry if set.
+    bool                                    m_serial_gcode_export { false };
 
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
@@ -6446,11 +6446,9 @@ void DynamicPrintConfig::set_num_extruders(unsigned int num_extruders)
             // Don't resize this field, as it is presented to the user at the "Dependencies" page of the Printer profile and we don't want to present
             // empty fields there, if not defined by the system profile.
             continue;
-        auto* opt = this->option(key, false);
-        assert(opt != nullptr);
-        assert(opt->is_vector());
-        if (opt != nullptr && opt->is_vector())
-            static_cast<ConfigOptionVectorBase*>(opt)->resize(num_extruders, defaults.option(key));
+        assert(std::as_const(*this).option(key) != nullptr);
+        assert(std::as_const(*this).option(key)->is_vector());
+        this->resize_vector(key, num_extruders, defaults.option(key));
     }
 }
 
@@ -6458,14 +6456,21 @@ void DynamicPrintConfig::set_num_milling(unsigned int num_milling)
 {
     const auto& defaults = FullPrintConfig::defaults();
     for (const std::string& key : print_config_def.milling_option_keys()) {
-        auto* opt = this->option(key, false);
-        assert(opt != nullptr);
-        assert(opt->is_vector());
-        if (opt != nullptr && opt->is_vector())
-            static_cast<ConfigOptionVectorBase*>(opt)->resize(num_milling, defaults.option(key));
+        assert(std::as_const(*this).option(key) != nullptr);
+        assert(std::as_const(*this).option(key)->is_vector());
+        this->resize_vector(key, num_milling, defaults.option(key));
     }
 }
 
+void DynamicPrintConfig::resize_vector(const t_config_option_key &opt_key, size_t n, const ConfigOption *opt_default)
+{
+    // Check the size through the const accessor, the non-const one clones a value shared with other configs.
+    const ConfigOption *opt = std::as_const(*this).option(opt_key);
+    if (opt != nullptr && opt->is_vector() && static_cast<const ConfigOptionVectorBase*>(opt)->size() != n)
+        if (ConfigOption *opt_rw = this->option(opt_key, false); opt_rw != nullptr)
+            static_cast<ConfigOptionVectorBase*>(opt_rw)->resize(n, opt_default);
+}
+
 std::string DynamicPrintConfig::validate()
 {
     // Full print config is initialized from the defaults.
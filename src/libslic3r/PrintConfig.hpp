@@ -477,6 +477,10 @@ public:
 
     void 				set_num_milling(unsigned int num_milling);
 
+    // Resize a vector option to n values, if it exists. The option is only accessed for writing if its size changes,
+    // so that a value shared with other configs is not cloned needlessly.
+    void                resize_vector(const t_config_option_key &opt_key, size_t n, const ConfigOption *opt_default);
+
     // Validate the PrintConfig. Returns an empty string on success, otherwise an error message is returned.
     std::string         validate();
 
@@ -2063,7 +2067,7 @@ namespace cereal {
             assert(optdef != nullptr);
             assert(optdef->serialization_key_ordinal > 0);
             archive(optdef->serialization_key_ordinal);
-            optdef->save_option_to_archive(archive, it->second.get());
+            optdef->save_option_to_archive(archive, it->second);
         }
     }
 }
@@ -20,6 +20,7 @@
 #include <float.h>
 
 #include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
 
 #include <Shiny/Shiny.h>
 
@@ -118,6 +119,9 @@ namespace Slic3r {
         m_print->throw_if_canceled();
         this->_slice(layer_height_profile);
         m_print->throw_if_canceled();
+        // Drop the prepared meshes of the volumes, which were deleted or whose mesh changed.
+        m_slicing_mesh_cache.remove_unused(*this->model_object());
+        BOOST_LOG_TRIVIAL(debug) << "Slicing mesh cache of object " << this->model_object()->name << ": " << format_memsize_MB(m_slicing_mesh_cache.memsize());
         // Fix the model.
         //FIXME is this the right place to do? It is done repeateadly at the UI and now here at the backend.
         std::string warning = this->_fix_slicing_errors();
@@ -291,9 +295,23 @@ namespace Slic3r {
         }
     }
 
+    std::vector<char> PrintObject::dirty_layers(const PartialStep &partial) const
+    {
+        std::vector<char> dirty(m_layers.size(), ! partial.active);
+        if (partial.active)
+            for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx) {
+                // Same test as PrintObject::slice_volume(): the ranges are closed at the bottom and open at the top.
+                coordf_t slice_z = m_layers[layer_idx]->slice_z;
+                dirty[layer_idx] = std::any_of(partial.dirty_z_ranges.begin(), partial.dirty_z_ranges.end(),
+                    [slice_z](const t_layer_height_range &range) { return slice_z > range.first - EPSILON && slice_z < range.second + EPSILON; });
+            }
+        return dirty;
+    }
+
     // 1) Merges typed region slices into stInternal type.
     // 2) Increases an "extra perimeters" counter at region slices where needed.
     // 3) Generates perimeters, gap fills and fill regions (fill regions of type stInternal).
+    // If only some layer ranges were invalidated, the other layers keep their perimeters.
     void PrintObject::make_perimeters()
     {
         // prerequisites
@@ -314,9 +332,14 @@ namespace Slic3r {
             m_typed_slices = false;
         }
 
+        const std::vector<char> dirty = this->dirty_layers(m_partial_perimeters);
+        const int nb_layers_dirty = int(std::count(dirty.begin(), dirty.end(), char(1)));
+        if (m_partial_perimeters.active)
+            BOOST_LOG_TRIVIAL(info) << "Generating perimeters of " << nb_layers_dirty << " layers out of " << m_layers.size();
+
         // atomic counter for gui progress
         std::atomic<int> atomic_count{ 0 };
-        int nb_layers_update = std::max(1, (int)m_layers.size() / 20);
+        int nb_layers_update = std::max(1, nb_layers_dirty / 20);
         std::chrono::time_point<std::chrono::system_clock> last_update = std::chrono::system_clock::now();
 
         // compare each layer to the one below, and mark those slices needing
@@ -334,8 +357,10 @@ namespace Slic3r {
             BOOST_LOG_TRIVIAL(debug) << "Generating extra perimeters for region " << region_id << " in parallel - start";
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, m_layers.size() - 1),
-                [this, &region, region_id](const tbb::blocked_range<size_t>& range) {
+                [this, &region, region_id, &dirty](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                    if (! dirty[layer_idx])
+                        continue;
                     m_print->throw_if_canceled();
                     LayerRegion& layerm = *m_layers[layer_idx]->m_regions[region_id];
                     const LayerRegion& upper_layerm = *m_layers[layer_idx + 1]->m_regions[region_id];
@@ -392,8 +417,10 @@ namespace Slic3r {
         BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this, &atomic_count, &last_update, nb_layers_update](const tbb::blocked_range<size_t>& range) {
+            [this, &dirty, &atomic_count, &last_update, nb_layers_update, nb_layers_dirty](const tbb::blocked_range<size_t>& range) {
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                if (! dirty[layer_idx])
+                    continue;
                 std::chrono::time_point<std::chrono::system_clock> start_make_perimeter = std::chrono::system_clock::now();
                 m_print->throw_if_canceled();
                 m_layers[layer_idx]->make_perimeters();
@@ -405,7 +432,7 @@ namespace Slic3r {
                     if ((static_cast<std::chrono::duration<double>>(end_make_perimeter - last_update)).count() > 0.2) {
                         // note: i don't care if a thread erase last_update in-between here
                         last_update = std::chrono::system_clock::now();
-                        m_print->set_status( int((nb_layers_done * 100) / m_layers.size()), L("Generating perimeters: layer %s / %s"), { std::to_string(nb_layers_done), std::to_string(m_layers.size()) });
+                        m_print->set_status( int((nb_layers_done * 100) / nb_layers_dirty), L("Generating perimeters: layer %s / %s"), { std::to_string(nb_layers_done), std::to_string(nb_layers_dirty) });
                     }
                 }
             }
@@ -418,8 +445,10 @@ namespace Slic3r {
             BOOST_LOG_TRIVIAL(debug) << "Generating milling post-process in parallel - start";
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, m_layers.size()),
-                [this](const tbb::blocked_range<size_t>& range) {
+                [this, &dirty](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                    if (! dirty[layer_idx])
+                        continue;
                     m_print->throw_if_canceled();
                     m_layers[layer_idx]->make_milling_post_process();
                 }
@@ -439,12 +468,21 @@ namespace Slic3r {
 
         m_print->set_status(30, L("Preparing infill"));
 
+        // Log the duration of each step.
+        std::chrono::time_point<std::chrono::system_clock> step_start = std::chrono::system_clock::now();
+        auto log_step_time = [&step_start](const char *step) {
+            std::chrono::time_point<std::chrono::system_clock> now = std::chrono::system_clock::now();
+            BOOST_LOG_TRIVIAL(info) << "Preparing infill - " << step << " took " << std::chrono::duration<double>(now - step_start).count() << " s";
+            step_start = now;
+        };
+
         // This will assign a type (top/bottom/internal) to $layerm->slices.
         // Then the classifcation of $layerm->slices is transfered onto 
         // the $layerm->fill_surfaces by clipping $layerm->fill_surfaces
         // by the cummulative area of the previous $layerm->fill_surfaces.
         this->detect_surfaces_type();
         m_print->throw_if_canceled();
+        log_step_time("detect_surfaces_type");
 
         // Decide what surfaces are to be filled.
         // Here the stTop / stBottomBridge / stBottom infill is turned to just stInternal if zero top / bottom infill layers are configured.
@@ -455,6 +493,7 @@ namespace Slic3r {
                 region->prepare_fill_surfaces();
                 m_print->throw_if_canceled();
             }
+        log_step_time("prepare_fill_surfaces");
 
         // this will detect bridges and reverse bridges
         // and rearrange top/bottom/internal surfaces
@@ -467,10 +506,12 @@ namespace Slic3r {
         //FIXME This does not likely merge surfaces, which are supported by a material with different colors, but same properties.
         this->process_external_surfaces();
         m_print->throw_if_canceled();
+        log_step_time("process_external_surfaces");
 
         // Add solid fills to ensure the shell vertical thickness.
         this->discover_vertical_shells();
         m_print->throw_if_canceled();
+        log_step_time("discover_vertical_shells");
 
         // Debugging output.
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
@@ -492,9 +533,12 @@ namespace Slic3r {
         //note: only if not "ensure vertical shell"
         this->discover_horizontal_shells();
         m_print->throw_if_canceled();
+        log_step_time("discover_horizontal_shells");
 
     //as there is some too thin solid surface, please deleted them and merge all of the surfacesthat are contigous.
         this->clean_surfaces();
+        m_print->throw_if_canceled();
+        log_step_time("clean_surfaces");
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
         for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
@@ -514,6 +558,7 @@ namespace Slic3r {
     // Also one wishes the perimeters to be supported by a full infill.
         this->clip_fill_surfaces();
         m_print->throw_if_canceled();
+        log_step_time("clip_fill_surfaces");
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
         for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
@@ -529,6 +574,7 @@ namespace Slic3r {
     // to remove only half of the combined infill
         this->bridge_over_infill();
         m_print->throw_if_canceled();
+        log_step_time("bridge_over_infill");
         this->replaceSurfaceType(stPosInternal | stDensSolid,
             stPosInternal | stDensSolid | stModOverBridge,
             stPosInternal | stDensSolid | stModBridge);
@@ -545,15 +591,18 @@ namespace Slic3r {
             stPosTop | stDensSolid | stModOverBridge,
             stPosBottom | stDensSolid | stModBridge);
         m_print->throw_if_canceled();
+        log_step_time("replaceSurfaceType");
 
         // combine fill surfaces to honor the "infill every N layers" option
         this->combine_infill();
         m_print->throw_if_canceled();
+        log_step_time("combine_infill");
 
         // count the distance from the nearest top surface, to allow to use denser infill
         // if needed and if infill_dense_layers is positive.
         this->tag_under_bridge();
         m_print->throw_if_canceled();
+        log_step_time("tag_under_bridge");
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
         for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
@@ -572,6 +621,46 @@ namespace Slic3r {
         this->set_done(posPrepareInfill);
     }
 
+    // Hash of the input of Layer::make_fills() left by prepare_infill() and by the perimeter generator.
+    static uint64_t fills_fingerprint(const Layer &layer)
+    {
+        uint64_t hash = 0;
+        auto add = [&hash](uint64_t value) { hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2); };
+        auto add_double = [&add](double value) { uint64_t bits; memcpy(&bits, &value, sizeof(bits)); add(bits); };
+        auto add_polygon = [&add](const Polygon &polygon) {
+            add(polygon.points.size());
+            for (const Point &pt : polygon.points) {
+                add(uint64_t(pt.x()));
+                add(uint64_t(pt.y()));
+            }
+        };
+        auto add_expolygon = [&add, &add_polygon](const ExPolygon &expolygon) {
+            add_polygon(expolygon.contour);
+            add(expolygon.holes.size());
+            for (const Polygon &hole : expolygon.holes)
+                add_polygon(hole);
+        };
+        for (const LayerRegion *layerm : layer.regions()) {
+            add(layerm->fill_surfaces.surfaces.size());
+            for (const Surface &surface : layerm->fill_surfaces.surfaces) {
+                add(uint64_t(surface.surface_type));
+                add_double(surface.thickness);
+                add(surface.thickness_layers);
+                add_double(surface.bridge_angle);
+                add(surface.extra_perimeters);
+                add(surface.maxNbSolidLayersOnTop);
+                add(surface.priority);
+                add_expolygon(surface.expolygon);
+            }
+            add(layerm->fill_no_overlap_expolygons.size());
+            for (const ExPolygon &expolygon : layerm->fill_no_overlap_expolygons)
+                add_expolygon(expolygon);
+        }
+        return hash;
+    }
+
+    // If only some layer ranges were invalidated, the fills are regenerated for these layers
+    // and for the layers whose fill_surfaces were modified by prepare_infill().
     void PrintObject::infill()
     {
         // prerequisites
@@ -580,19 +669,41 @@ namespace Slic3r {
         if (this->set_started(posInfill)) {
             auto [adaptive_fill_octree, support_fill_octree] = this->prepare_adaptive_infill_data();
 
+            std::vector<char>     dirty = this->dirty_layers(m_partial_infill);
+            std::vector<uint64_t> fingerprints(m_layers.size());
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, m_layers.size()),
+                [this, &fingerprints](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx)
+                    fingerprints[layer_idx] = fills_fingerprint(*m_layers[layer_idx]);
+            });
+            // The octrees are built over the whole object from the configs of all the regions.
+            if (adaptive_fill_octree || support_fill_octree || m_fills_fingerprints.size() != m_layers.size())
+                std::fill(dirty.begin(), dirty.end(), char(1));
+            else
+                for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx)
+                    dirty[layer_idx] |= fingerprints[layer_idx] != m_fills_fingerprints[layer_idx];
+            m_fills_fingerprints.resize(m_layers.size());
+            const int nb_layers_dirty = int(std::count(dirty.begin(), dirty.end(), char(1)));
+            if (m_partial_infill.active)
+                BOOST_LOG_TRIVIAL(info) << "Filling " << nb_layers_dirty << " layers out of " << m_layers.size();
+
             // atomic counter for gui progress
             std::atomic<int> atomic_count{ 0 };
-            int nb_layers_update = std::max(1, (int)m_layers.size() / 20);
+            int nb_layers_update = std::max(1, nb_layers_dirty / 20);
             std::chrono::time_point<std::chrono::system_clock> last_update = std::chrono::system_clock::now();
 
             BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, m_layers.size()),
-                [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree, &atomic_count , &last_update, nb_layers_update](const tbb::blocked_range<size_t>& range) {
+                [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree, &dirty, &fingerprints, &atomic_count , &last_update, nb_layers_update, nb_layers_dirty](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                    if (! dirty[layer_idx])
+                        continue;
                     std::chrono::time_point<std::chrono::system_clock> start_make_fill = std::chrono::system_clock::now();
                     m_print->throw_if_canceled();
                     m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get());
+                    m_fills_fingerprints[layer_idx] = fingerprints[layer_idx];
 
                     // updating progress
                     int nb_layers_done = (++atomic_count);
@@ -601,7 +712,7 @@ namespace Slic3r {
                         if ((static_cast<std::chrono::duration<double>>(end_make_fill - last_update)).count() > 0.2) {
                             // note: i don't care if a thread erase last_update in-between here
                             last_update = std::chrono::system_clock::now();
-                            m_print->set_status( int((nb_layers_done * 100) / m_layers.size()), L("Infilling layer %s / %s"), { std::to_string(nb_layers_done), std::to_string(m_layers.size()) });
+                            m_print->set_status( int((nb_layers_done * 100) / nb_layers_dirty), L("Infilling layer %s / %s"), { std::to_string(nb_layers_done), std::to_string(nb_layers_dirty) });
                         }
                     }
                 }
@@ -696,9 +807,18 @@ namespace Slic3r {
         for (size_t i = 1; i < overhangs.size(); ++i)
             append(overhangs.front(), std::move(overhangs[i]));
 
-        return std::make_pair(
-            adaptive_line_spacing ? build_octree(mesh, overhangs.front(), adaptive_line_spacing, false) : OctreePtr(),
-            support_line_spacing ? build_octree(mesh, overhangs.front(), support_line_spacing, true) : OctreePtr());
+        // Build the two octrees concurrently, each of them is built in parallel as well.
+        OctreePtr adaptive_fill_octree;
+        OctreePtr support_fill_octree;
+        tbb::task_group task_group;
+        if (adaptive_line_spacing)
+            task_group.run([&mesh, &overhangs, adaptive_line_spacing, &adaptive_fill_octree] {
+                adaptive_fill_octree = build_octree(mesh, overhangs.front(), adaptive_line_spacing, false);
+            });
+        if (support_line_spacing)
+            support_fill_octree = build_octree(mesh, overhangs.front(), support_line_spacing, true);
+        task_group.wait();
+        return std::make_pair(std::move(adaptive_fill_octree), std::move(support_fill_octree));
     }
 
     void PrintObject::clear_layers()
@@ -734,11 +854,18 @@ namespace Slic3r {
 
     // Called by Print::apply().
     // This method only accepts PrintObjectConfig and PrintRegionConfig option keys.
-    bool PrintObject::invalidate_state_by_config_options(const std::vector<t_config_option_key>& opt_keys)
+    bool PrintObject::invalidate_state_by_config_options(const std::vector<t_config_option_key>& opt_keys, const std::vector<t_layer_height_range>& z_ranges)
     {
         if (opt_keys.empty())
             return false;
 
+        // The perimeters and the infill outside of z_ranges may be kept if they were generated completely before,
+        // or if only some of their layers are waiting to be regenerated.
+        // m_partial_* is only modified here and by invalidate_step(), after the background processing was stopped.
+        PartialStep partial_perimeters = this->is_step_done_unguarded(posPerimeters) ? PartialStep{ true, {} } : m_partial_perimeters;
+        PartialStep partial_infill     = this->is_step_done_unguarded(posInfill)     ? PartialStep{ true, {} } : m_partial_infill;
+        bool all_layers = z_ranges.empty();
+
         std::vector<PrintObjectStep> steps;
         bool invalidated = false;
         for (const t_config_option_key& opt_key : opt_keys) {
@@ -942,12 +1069,28 @@ namespace Slic3r {
                 // for legacy, if we can't handle this option let's invalidate all steps
                 this->invalidate_all_steps();
                 invalidated = true;
+                all_layers = true;
             }
         }
 
         sort_remove_duplicates(steps);
         for (PrintObjectStep step : steps)
             invalidated |= this->invalidate_step(step);
+
+        // invalidate_step() dropped the partial state of the invalidated steps, restore it extended by z_ranges.
+        if (! all_layers && std::find(steps.begin(), steps.end(), posSlice) == steps.end()) {
+            auto extend = [&z_ranges](PartialStep &partial) {
+                append(partial.dirty_z_ranges, z_ranges);
+                return partial;
+            };
+            if (partial_perimeters.active && std::find(steps.begin(), steps.end(), posPerimeters) != steps.end())
+                m_partial_perimeters = extend(partial_perimeters);
+            // The fills depend on the region config and on the output of the perimeters and prepare_infill steps, the later
+            // is tracked by m_fills_fingerprints.
+            if (partial_infill.active && std::any_of(steps.begin(), steps.end(), [](PrintObjectStep step)
+                    { return step == posPerimeters || step == posPrepareInfill || step == posInfill; }))
+                m_partial_infill = extend(partial_infill);
+        }
         return invalidated;
     }
 
@@ -955,6 +1098,12 @@ namespace Slic3r {
     {
         bool invalidated = Inherited::invalidate_step(step);
 
+        // All the layers will be recomputed, unless Print::apply() restricts the invalidation to some layer ranges.
+        if (step == posSlice || step == posPerimeters)
+            m_partial_perimeters = PartialStep();
+        if (step == posSlice || step == posPerimeters || step == posPrepareInfill || step == posInfill)
+            m_partial_infill = PartialStep();
+
         // propagate to dependent steps
         if (step == posPerimeters) {
             invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning });
@@ -989,6 +1138,8 @@ namespace Slic3r {
         // Then reset some of the depending values.
         this->m_slicing_params.valid = false;
         this->region_volumes.clear();
+        m_partial_perimeters = PartialStep();
+        m_partial_infill     = PartialStep();
         return result;
     }
 
@@ -3239,79 +3390,72 @@ namespace Slic3r {
 //FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
 static void fix_mesh_connectivity(TriangleMesh &mesh)
 {
-    auto nr_degenerated = mesh.stl.stats.degenerate_facets;
-    stl_check_facets_exact(&mesh.stl);
-    if (nr_degenerated != mesh.stl.stats.degenerate_facets)
-        // stl_check_facets_exact() removed some newly degenerated faces. Some faces could become degenerate after some mesh transformation.
-        stl_generate_shared_vertices(&mesh.stl, mesh.its);
+    // Some faces could become degenerate after some mesh transformation. Merge the vertices collapsed onto each other
+    // and remove the degenerate faces.
+    if (int removed = its_merge_vertices(mesh.its); removed > 0) {
+        mesh.stl.stats.number_of_facets = uint32_t(mesh.its.indices.size());
+        mesh.stl.stats.degenerate_facets += removed;
+    }
 }
 
-    std::vector<ExPolygons> PrintObject::slice_volumes(
-        const std::vector<float>& z,
-        SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below,
-        const std::vector<const ModelVolume*>& volumes) const
+    // Compose the meshes of the volumes, transform them into the coordinate system of this object and initialize the slicer over them.
+    // The prepared slicer is taken from the cache if neither the meshes nor the transformations changed since the last slicing.
+    // Returns nullptr if the volumes have no facets.
+    SlicingMeshCache::EntryPtr PrintObject::prepare_volumes_for_slicing(const std::vector<const ModelVolume*>& volumes) const
     {
-        std::vector<ExPolygons> layers;
-        if (!volumes.empty()) {
-            // Compose mesh.
-            //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
-            TriangleMesh mesh(volumes.front()->mesh());
-            mesh.transform(volumes.front()->get_matrix(), true);
-            assert(mesh.repaired);
-            if (volumes.size() == 1 && mesh.repaired)
-                fix_mesh_connectivity(mesh);
-            for (size_t idx_volume = 1; idx_volume < volumes.size(); ++idx_volume) {
-                const ModelVolume& model_volume = *volumes[idx_volume];
-                TriangleMesh vol_mesh(model_volume.mesh());
-                vol_mesh.transform(model_volume.get_matrix(), true);
-                mesh.merge(vol_mesh);
-            }
-            if (mesh.stl.stats.number_of_facets > 0) {
+        if (volumes.empty())
+            return SlicingMeshCache::EntryPtr();
+        Transform3d trafo = m_trafo;
+        trafo.pretranslate(Vec3d(-unscale<double>(m_center_offset.x()), -unscale<double>(m_center_offset.y()), 0));
+        const Print* print = this->print();
+        return m_slicing_mesh_cache.get(volumes, trafo, float(m_config.slice_closing_radius.value), float(m_config.model_precision.value),
+            [this, &volumes](TriangleMesh& mesh) {
+                // Compose mesh.
+                //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
+                mesh = volumes.front()->mesh();
+                mesh.transform(volumes.front()->get_matrix(), true);
+                if (volumes.size() == 1 && mesh.repaired)
+                    fix_mesh_connectivity(mesh);
+                for (size_t idx_volume = 1; idx_volume < volumes.size(); ++idx_volume) {
+                    const ModelVolume& model_volume = *volumes[idx_volume];
+                    TriangleMesh vol_mesh(model_volume.mesh());
+                    vol_mesh.transform(model_volume.get_matrix(), true);
+                    mesh.merge(vol_mesh);
+                }
+                if (mesh.stl.stats.number_of_facets == 0)
+                    return false;
                 mesh.transform(m_trafo, true);
                 // apply XY shift
                 mesh.translate(-unscale<float>(m_center_offset.x()), -unscale<float>(m_center_offset.y()), 0);
-                // perform actual slicing
-                const Print* print = this->print();
-                auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print]() {print->throw_if_canceled(); });
                 // TriangleMeshSlicer needs shared vertices, also this calls the repair() function.
                 mesh.require_shared_vertices();
-                TriangleMeshSlicer mslicer(float(m_config.slice_closing_radius.value), float(m_config.model_precision.value));
-                mslicer.init(&mesh, callback);
-                mslicer.slice(z, mode, slicing_mode_normal_below_layer, mode_below, &layers, callback);
-                m_print->throw_if_canceled();
-            }
-        }
-        return layers;
+                return true;
+            },
+            [print]() { print->throw_if_canceled(); });
     }
 
-    std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float>& z, SlicingMode mode, const ModelVolume& volume) const
+    std::vector<ExPolygons> PrintObject::slice_volumes(
+        const std::vector<float>& z,
+        SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below,
+        const std::vector<const ModelVolume*>& volumes) const
     {
         std::vector<ExPolygons> layers;
         if (!z.empty()) {
-            // Compose mesh.
-            //FIXME better to split the mesh into separate shells, perform slicing over each shell separately and then to use a Boolean operation to merge them.
-            TriangleMesh mesh(volume.mesh());
-            mesh.transform(volume.get_matrix(), true);
-		if (mesh.repaired)
-            fix_mesh_connectivity(mesh);
-            if (mesh.stl.stats.number_of_facets > 0) {
-                mesh.transform(m_trafo, true);
-                // apply XY shift
-                mesh.translate(-unscale<float>(m_center_offset.x()), -unscale<float>(m_center_offset.y()), 0);
+            if (SlicingMeshCache::EntryPtr prepared = this->prepare_volumes_for_slicing(volumes); prepared) {
                 // perform actual slicing
-                TriangleMeshSlicer mslicer(float(m_config.slice_closing_radius.value), float(m_config.model_precision.value));
                 const Print* print = this->print();
-                auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print]() {print->throw_if_canceled(); });
-                // TriangleMeshSlicer needs the shared vertices.
-                mesh.require_shared_vertices();
-                mslicer.init(&mesh, callback);
-                mslicer.slice(z, mode, &layers, callback);
+                prepared->slicer.slice(z, mode, slicing_mode_normal_below_layer, mode_below, &layers, [print]() { print->throw_if_canceled(); });
                 m_print->throw_if_canceled();
             }
         }
         return layers;
     }
 
+    std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float>& z, SlicingMode mode, const ModelVolume& volume) const
+    {
+        return this->slice_volumes(z, mode, { &volume });
+    }
+
     // Filter the zs not inside the ranges. The ranges are closed at the bottom and open at the top, they are sorted lexicographically and non overlapping.
     std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float>& z, const std::vector<t_layer_height_range>& ranges, SlicingMode mode, const ModelVolume& volume) const
     {
@@ -3321,26 +3465,29 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
                 // All layers fit into a single range.
                 out = this->slice_volume(z, mode, volume);
             } else {
-                std::vector<float> 					   z_filtered;
                 std::vector<std::pair<size_t, size_t>> n_filtered;
-                z_filtered.reserve(z.size());
                 n_filtered.reserve(2 * ranges.size());
                 size_t i = 0;
                 for (const t_layer_height_range& range : ranges) {
                     for (; i < z.size() && z[i] < range.first; ++i);
                     size_t first = i;
-                    for (; i < z.size() && z[i] < range.second; ++i)
-                        z_filtered.emplace_back(z[i]);
+                    for (; i < z.size() && z[i] < range.second; ++i);
                     if (i > first)
                         n_filtered.emplace_back(std::make_pair(first, i));
                 }
-                if (!n_filtered.empty()) {
-                    std::vector<ExPolygons> layers = this->slice_volume(z_filtered, mode, volume);
+                SlicingMeshCache::EntryPtr prepared = n_filtered.empty() ? SlicingMeshCache::EntryPtr() : this->prepare_volumes_for_slicing({ &volume });
+                if (prepared) {
+                    // Slice each range separately with the same slicer, so that its Z index of facets limits
+                    // the work to the facets spanning that range, instead of the facets spanning all the ranges.
+                    const Print* print = this->print();
                     out.assign(z.size(), ExPolygons());
-                    i = 0;
-                    for (const std::pair<size_t, size_t>& span : n_filtered)
+                    for (const std::pair<size_t, size_t>& span : n_filtered) {
+                        std::vector<ExPolygons> layers;
+                        prepared->slicer.slice(std::vector<float>(z.begin() + span.first, z.begin() + span.second), mode, &layers, [print]() { print->throw_if_canceled(); });
+                        m_print->throw_if_canceled();
                         for (size_t j = span.first; j < span.second; ++j)
-                            out[j] = std::move(layers[i++]);
+                            out[j] = std::move(layers[j - span.first]);
+                    }
                 }
             }
         }
@@ -3473,6 +3620,41 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
         // We only want infill under ceilings; this is almost like an
         // internal support material.
         // Proceed top-down, skipping the bottom layer.
+        //
+        // The inputs of the sweep are collected in parallel first. The fill surfaces of a layer are modified by the sweep
+        // only after they were read as the lower layer, and the modification does not touch the solid fill surfaces,
+        // thus only the fill surfaces of the modified layers have to be collected again by the serial sweep.
+        struct LayerFillSurfaces {
+            // Cummulative fill surfaces.
+            Polygons fill_surfaces;
+            // Solid surfaces to be supported.
+            Polygons overhangs;
+            // Sparse / void internal surfaces.
+            Polygons internal_surfaces;
+        };
+        auto is_clipped = [](const LayerRegion *layerm) {
+            return layerm->region()->config().fill_density.value != 0 && ! layerm->region()->config().infill_dense.value;
+        };
+        std::vector<LayerFillSurfaces> layers_fill_surfaces(m_layers.size());
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &layers_fill_surfaces](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                    m_print->throw_if_canceled();
+                    LayerFillSurfaces &out = layers_fill_surfaces[layer_id];
+                    for (const LayerRegion* layerm : m_layers[layer_id]->m_regions)
+                        for (const Surface& surface : layerm->fill_surfaces.surfaces) {
+                            Polygons polygons = to_polygons(surface.expolygon);
+                            if (surface.has_fill_solid())
+                                polygons_append(out.overhangs, polygons);
+                            if (surface.has_pos_internal() && (surface.has_fill_sparse() || surface.has_fill_void()))
+                                polygons_append(out.internal_surfaces, polygons);
+                            polygons_append(out.fill_surfaces, std::move(polygons));
+                        }
+                }
+            });
+        m_print->throw_if_canceled();
+
         Polygons upper_internal;
         for (int layer_id = int(m_layers.size()) - 1; layer_id > 0; --layer_id) {
             Layer* layer = m_layers[layer_id];
@@ -3483,24 +3665,17 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
             polygons_append(slices, layer->lslices);
             // Cummulative fill surfaces.
             Polygons fill_surfaces;
+            if (layer_id + 1 < int(m_layers.size()) && std::any_of(layer->m_regions.begin(), layer->m_regions.end(), is_clipped)) {
+                // Modified by the previous step of the sweep.
+                for (const LayerRegion* layerm : layer->m_regions)
+                    for (const Surface& surface : layerm->fill_surfaces.surfaces)
+                        polygons_append(fill_surfaces, to_polygons(surface.expolygon));
+            } else
+                fill_surfaces = std::move(layers_fill_surfaces[layer_id].fill_surfaces);
             // Solid surfaces to be supported.
-            Polygons overhangs;
-            for (const LayerRegion* layerm : layer->m_regions)
-                for (const Surface& surface : layerm->fill_surfaces.surfaces) {
-                    Polygons polygons = to_polygons(surface.expolygon);
-                    if (surface.has_fill_solid())
-                        polygons_append(overhangs, polygons);
-                    polygons_append(fill_surfaces, std::move(polygons));
-                }
-            Polygons lower_layer_fill_surfaces;
-            Polygons lower_layer_internal_surfaces;
-            for (const LayerRegion* layerm : lower_layer->m_regions)
-                for (const Surface& surface : layerm->fill_surfaces.surfaces) {
-                    Polygons polygons = to_polygons(surface.expolygon);
-                    if (surface.has_pos_internal() && (surface.has_fill_sparse() || surface.has_fill_void()))
-                        polygons_append(lower_layer_internal_surfaces, polygons);
-                    polygons_append(lower_layer_fill_surfaces, std::move(polygons));
-                }
+            Polygons overhangs = std::move(layers_fill_surfaces[layer_id].overhangs);
+            const Polygons &lower_layer_fill_surfaces     = layers_fill_surfaces[layer_id - 1].fill_surfaces;
+            const Polygons &lower_layer_internal_surfaces = layers_fill_surfaces[layer_id - 1].internal_surfaces;
             // We also need to support perimeters when there's at least one full unsupported loop
             {
                 // Get perimeters area as the difference between slices and fill_surfaces
@@ -3520,7 +3695,7 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
             upper_internal = intersection(overhangs, lower_layer_internal_surfaces);
             // Apply new internal infill to regions.
             for (LayerRegion* layerm : lower_layer->m_regions) {
-                if (layerm->region()->config().fill_density.value == 0 || layerm->region()->config().infill_dense.value)
+                if (! is_clipped(layerm))
                     continue;
                 SurfaceType internal_surface_types[] = { stPosInternal | stDensSparse, stPosInternal | stDensVoid };
                 Polygons internal;
@@ -3546,7 +3721,10 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
         BOOST_LOG_TRIVIAL(trace) << "discover_horizontal_shells()";
 
         for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
-            for (size_t i = 0; i < m_layers.size(); ++i) {
+            const PrintRegionConfig &region_config = this->print()->regions()[region_id]->config();
+
+            // Retype the infill of layer i and scatter its top / bottom surfaces to its neighbors.
+            auto discover_layer = [this, region_id](size_t i) {
                 m_print->throw_if_canceled();
                 Layer* layer = m_layers[i];
                 LayerRegion* layerm = layer->regions()[region_id];
@@ -3562,7 +3740,7 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
 
                 // If ensure_vertical_shell_thickness, then the rest has already been performed by discover_vertical_shells().
                 if (region_config.ensure_vertical_shell_thickness.value)
-                    continue;
+                    return;
 
                 coordf_t print_z = layer->print_z;
                 coordf_t bottom_z = layer->bottom_z();
@@ -3601,7 +3779,7 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
                     solid = union_ex(solid);
                     //                Slic3r::debugf "Layer %d has %s surfaces\n", $i, (($type & stTop) != 0) ? 'top' : 'bottom';
 
-                                    // Scatter top / bottom regions to other layers. Scattering process is inherently serial, it is difficult to parallelize without locking.
+                                    // Scatter top / bottom regions to other layers. Scattering is serial inside a cluster of layers, see below.
                     for (int n = ((type & stPosTop) == stPosTop) ? int(i) - 1 : int(i) + 1;
 
                         ((type & stPosTop) == stPosTop) ?
@@ -3740,7 +3918,73 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
                     }
                 EXTERNAL:;
                 } // foreach type (stTop, stBottom, stBottomBridge)
-            } // for each layer
+            };
+
+            // Scattering modifies the fill_surfaces of the neighbor layers, and each layer reads its own fill_surfaces,
+            // which may have been modified by scattering from its neighbors. Group the layers into clusters of overlapping
+            // ranges of touched layers: layers are processed in their original order inside a cluster, while the clusters
+            // touch disjoint layers and they are processed in parallel with the same result as the serial sweep.
+            // Top / bottom surfaces are never added to fill_surfaces here, thus a layer without them now will not have any later.
+            struct Cluster {
+                // Range of layers touched by the cluster.
+                int                 first;
+                int                 last;
+                // Layers to process, ascending.
+                std::vector<size_t> layers;
+            };
+            std::vector<Cluster> clusters;
+            for (size_t i = 0; i < m_layers.size(); ++ i) {
+                const LayerRegion *layerm = m_layers[i]->regions()[region_id];
+                bool active = region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
+                    (i % region_config.solid_infill_every_layers) == 0;
+                int  first  = int(i);
+                int  last   = int(i);
+                if (! region_config.ensure_vertical_shell_thickness.value) {
+                    auto has_type = [layerm](SurfaceType type) {
+                        auto is_type = [type](const Surface &surface) { return surface.surface_type == type; };
+                        return std::any_of(layerm->slices().surfaces.begin(), layerm->slices().surfaces.end(), is_type) ||
+                            std::any_of(layerm->fill_surfaces.surfaces.begin(), layerm->fill_surfaces.surfaces.end(), is_type);
+                    };
+                    // Same extents as the scattering loop of discover_layer().
+                    if (region_config.top_solid_layers.value > 0 && has_type(stPosTop | stDensSolid)) {
+                        active = true;
+                        while (first > 0 && (int(i) - (first - 1) < region_config.top_solid_layers.value ||
+                            m_layers[i]->print_z - m_layers[first - 1]->print_z < region_config.top_solid_min_thickness.value - EPSILON))
+                            -- first;
+                    }
+                    if (region_config.bottom_solid_layers.value > 0 &&
+                        (has_type(stPosBottom | stDensSolid) || has_type(stPosBottom | stDensSolid | stModBridge))) {
+                        active = true;
+                        while (last + 1 < int(m_layers.size()) && ((last + 1) - int(i) < region_config.bottom_solid_layers.value ||
+                            m_layers[last + 1]->bottom_z() - m_layers[i]->bottom_z() < region_config.bottom_solid_min_thickness.value - EPSILON))
+                            ++ last;
+                    }
+                }
+                if (! active)
+                    continue;
+                Cluster cluster { first, last, {} };
+                // Merge the preceding clusters overlapping the range of this layer, keeping the layers ascending.
+                while (! clusters.empty() && clusters.back().last >= cluster.first) {
+                    Cluster &prev = clusters.back();
+                    cluster.first = std::min(cluster.first, prev.first);
+                    cluster.last  = std::max(cluster.last, prev.last);
+                    prev.layers.insert(prev.layers.end(), cluster.layers.begin(), cluster.layers.end());
+                    cluster.layers = std::move(prev.layers);
+                    clusters.pop_back();
+                }
+                cluster.layers.emplace_back(i);
+                clusters.emplace_back(std::move(cluster));
+            }
+
+            BOOST_LOG_TRIVIAL(debug) << "Discovering horizontal shells for region " << region_id << " in parallel - start : " << clusters.size() << " clusters";
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, clusters.size()),
+                [&clusters, &discover_layer](const tbb::blocked_range<size_t>& range) {
+                    for (size_t idx_cluster = range.begin(); idx_cluster < range.end(); ++ idx_cluster)
+                        for (size_t i : clusters[idx_cluster].layers)
+                            discover_layer(i);
+                });
+            BOOST_LOG_TRIVIAL(debug) << "Discovering horizontal shells for region " << region_id << " in parallel - end";
         } // for each region
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
@@ -3857,75 +4101,85 @@ static void fix_mesh_connectivity(TriangleMesh &mesh)
                 combine[m_layers.size() - 1] = num_layers;
             }
 
+            // The layers combined into the layer_idx are (layer_idx - combine[layer_idx], layer_idx], the combinations
+            // do not overlap, thus they are processed in parallel.
+            std::vector<size_t> combined_layers;
+            for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++layer_idx)
+                if (combine[layer_idx] > 1)
+                    combined_layers.emplace_back(layer_idx);
+
             // loop through layers to which we have assigned layers to combine
-            for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++layer_idx) {
-                m_print->throw_if_canceled();
-                size_t num_layers = combine[layer_idx];
-                if (num_layers <= 1)
-                    continue;
-                // Get all the LayerRegion objects to be combined.
-                std::vector<LayerRegion*> layerms;
-                layerms.reserve(num_layers);
-                for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++i)
-                    layerms.emplace_back(m_layers[i]->regions()[region_id]);
-                // We need to perform a multi-layer intersection, so let's split it in pairs.
-                // Initialize the intersection with the candidates of the lowest layer.
-                ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(stPosInternal | stDensSparse));
-                // Start looping from the second layer and intersect the current intersection with it.
-                for (size_t i = 1; i < layerms.size(); ++i)
-                    intersection = intersection_ex(
-                        to_polygons(intersection),
-                        to_polygons(layerms[i]->fill_surfaces.filter_by_type(stPosInternal | stDensSparse)),
-                        false);
-                double area_threshold = layerms.front()->infill_area_threshold();
-                if (!intersection.empty() && area_threshold > 0.)
-                    intersection.erase(std::remove_if(intersection.begin(), intersection.end(),
-                        [area_threshold](const ExPolygon& expoly) { return expoly.area() <= area_threshold; }),
-                        intersection.end());
-                if (intersection.empty())
-                    continue;
-                //            Slic3r::debugf "  combining %d %s regions from layers %d-%d\n",
-                //                scalar(@$intersection),
-                //                ($type == stInternal ? 'internal' : 'internal-solid'),
-                //                $layer_idx-($every-1), $layer_idx;
-                            // intersection now contains the regions that can be combined across the full amount of layers,
-                            // so let's remove those areas from all layers.
-                Polygons intersection_with_clearance;
-                intersection_with_clearance.reserve(intersection.size());
-                //TODO: check if that 'hack' isn't counter-productive : the overlap is done at perimetergenerator (so before this)
-                // and the not-overlap area is stored in the LayerRegion object
-                float clearance_offset =
-                    0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
-                    // Because fill areas for rectilinear and honeycomb are grown 
-                    // later to overlap perimeters, we need to counteract that too.
-                    ((region->config().fill_pattern.value == ipRectilinear ||
-                        region->config().fill_pattern.value == ipMonotonic ||
-                        region->config().fill_pattern.value == ipGrid ||
-                        region->config().fill_pattern.value == ipLine ||
-                        region->config().fill_pattern.value == ipHoneycomb) ? 1.5f : 0.5f) *
-                    layerms.back()->flow(frSolidInfill).scaled_width();
-                for (ExPolygon& expoly : intersection)
-                    polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
-                for (LayerRegion* layerm : layerms) {
-                    Polygons internal = to_polygons(layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSparse));
-                    layerm->fill_surfaces.remove_type(stPosInternal | stDensSparse);
-                    layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance, false), stPosInternal | stDensSparse);
-                    if (layerm == layerms.back()) {
-                        // Apply surfaces back with adjusted depth to the uppermost layer.
-                        Surface templ(stPosInternal | stDensSparse, ExPolygon());
-                        templ.thickness = 0.;
-                        for (LayerRegion* layerm2 : layerms)
-                            templ.thickness += layerm2->layer()->height;
-                        templ.thickness_layers = (unsigned short)layerms.size();
-                        layerm->fill_surfaces.append(intersection, templ);
-                    } else {
-                        // Save void surfaces.
-                        layerm->fill_surfaces.append(
-                            intersection_ex(internal, intersection_with_clearance, false),
-                            stPosInternal | stDensVoid);
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, combined_layers.size()),
+                [this, region, region_id, &combine, &combined_layers](const tbb::blocked_range<size_t>& range) {
+                for (size_t idx_combined = range.begin(); idx_combined < range.end(); ++ idx_combined) {
+                    m_print->throw_if_canceled();
+                    size_t layer_idx = combined_layers[idx_combined];
+                    size_t num_layers = combine[layer_idx];
+                    // Get all the LayerRegion objects to be combined.
+                    std::vector<LayerRegion*> layerms;
+                    layerms.reserve(num_layers);
+                    for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++i)
+                        layerms.emplace_back(m_layers[i]->regions()[region_id]);
+                    // We need to perform a multi-layer intersection, so let's split it in pairs.
+                    // Initialize the intersection with the candidates of the lowest layer.
+                    ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(stPosInternal | stDensSparse));
+                    // Start looping from the second layer and intersect the current intersection with it.
+                    for (size_t i = 1; i < layerms.size(); ++i)
+                        intersection = intersection_ex(
+                            to_polygons(intersection),
+                            to_polygons(layerms[i]->fill_surfaces.filter_by_type(stPosInternal | stDensSparse)),
+                            false);
+                    double area_threshold = layerms.front()->infill_area_threshold();
+                    if (!intersection.empty() && area_threshold > 0.)
+                        intersection.erase(std::remove_if(intersection.begin(), intersection.end(),
+                            [area_threshold](const ExPolygon& expoly) { return expoly.area() <= area_threshold; }),
+                            intersection.end());
+                    if (intersection.empty())
+                        continue;
+                    //            Slic3r::debugf "  combining %d %s regions from layers %d-%d\n",
+                    //                scalar(@$intersection),
+                    //                ($type == stInternal ? 'internal' : 'internal-solid'),
+                    //                $layer_idx-($every-1), $layer_idx;
+                                // intersection now contains the regions that can be combined across the full amount of layers,
+                                // so let's remove those areas from all layers.
+                    Polygons intersection_with_clearance;
+                    intersection_with_clearance.reserve(intersection.size());
+                    //TODO: check if that 'hack' isn't counter-productive : the overlap is done at perimetergenerator (so before this)
+                    // and the not-overlap area is stored in the LayerRegion object
+                    float clearance_offset =
+                        0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
+                        // Because fill areas for rectilinear and honeycomb are grown 
+                        // later to overlap perimeters, we need to counteract that too.
+                        ((region->config().fill_pattern.value == ipRectilinear ||
+                            region->config().fill_pattern.value == ipMonotonic ||
+                            region->config().fill_pattern.value == ipGrid ||
+                            region->config().fill_pattern.value == ipLine ||
+                            region->config().fill_pattern.value == ipHoneycomb) ? 1.5f : 0.5f) *
+                        layerms.back()->flow(frSolidInfill).scaled_width();
+                    for (ExPolygon& expoly : intersection)
+                        polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
+                    for (LayerRegion* layerm : layerms) {
+                        Polygons internal = to_polygons(layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSparse));
+                        layerm->fill_surfaces.remove_type(stPosInternal | stDensSparse);
+                        layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance, false), stPosInternal | stDensSparse);
+                        if (layerm == layerms.back()) {
+                            // Apply surfaces back with adjusted depth to the uppermost layer.
+                            Surface templ(stPosInternal | stDensSparse, ExPolygon());
+                            templ.thickness = 0.;
+                            for (LayerRegion* layerm2 : layerms)
+                                templ.thickness += layerm2->layer()->height;
+                            templ.thickness_layers = (unsigned short)layerms.size();
+                            layerm->fill_surfaces.append(intersection, templ);
+                        } else {
+                            // Save void surfaces.
+                            layerm->fill_surfaces.append(
+                                intersection_ex(internal, intersection_with_clearance, false),
+                                stPosInternal | stDensVoid);
+                        }
                     }
                 }
-            }
+            });
         }
     }
 
@@ -106,7 +106,7 @@ const Vec3i32& IndexedMesh::indices(size_t idx) const
 }
 
 Vec3d IndexedMesh::normal_by_face_id(int face_id) const {
-    return m_tm->stl.facet_start[face_id].normal.cast<double>();
+    return m_tm->facet_normal(face_id).cast<double>();
 }
 
 IndexedMesh::hit_result
@@ -34,11 +34,12 @@ legend("tan(a) as cura - topographic lines distance limit", "sqrt(tan(a)) as "+S
 namespace Slic3r
 {
 
-static inline std::pair<float, float> face_z_span(const stl_facet &f)
+static inline std::pair<float, float> face_z_span(const indexed_triangle_set &its, const stl_triangle_vertex_indices &f)
 {
-	return std::pair<float, float>(
-		std::min(std::min(f.vertex[0](2), f.vertex[1](2)), f.vertex[2](2)),
-		std::max(std::max(f.vertex[0](2), f.vertex[1](2)), f.vertex[2](2)));
+	const float z0 = its.vertices[f(0)](2);
+	const float z1 = its.vertices[f(1)](2);
+	const float z2 = its.vertices[f(2)](2);
+	return std::pair<float, float>(std::min(std::min(z0, z1), z2), std::max(std::max(z0, z1), z2));
 }
 
 // By Florens Waserfall aka @platch:
@@ -88,9 +89,9 @@ void SlicingAdaptive::prepare(const ModelObject &object)
 
     // 1) Collect faces from mesh.
     m_faces.reserve(mesh.stl.stats.number_of_facets);
-    for (const stl_facet &face : mesh.stl.facet_start) {
-    	Vec3f n = face.normal.normalized();
-		m_faces.emplace_back(FaceZ({ face_z_span(face), std::abs(n.z()), std::sqrt(n.x() * n.x() + n.y() * n.y()) }));
+    for (size_t face_idx = 0; face_idx < mesh.its.indices.size(); ++ face_idx) {
+    	Vec3f n = mesh.facet_normal(face_idx);
+		m_faces.emplace_back(FaceZ({ face_z_span(mesh.its, mesh.its.indices[face_idx]), std::abs(n.z()), std::sqrt(n.x() * n.x() + n.y() * n.y()) }));
     }
 
 	// 2) Sort faces lexicographically by their Z span.
@@ -0,0 +1,110 @@
+#include "SlicingMeshCache.hpp"
+#include "Model.hpp"
+
+#include <algorithm>
+
+namespace Slic3r {
+
+std::atomic<size_t> SlicingMeshCache::s_total_memsize { 0 };
+
+bool SlicingMeshCache::Key::matches(const std::vector<const ModelVolume*> &volumes, const Transform3d &trafo, float closing_radius, float model_precision) const
+{
+    if (volumes.size() != this->volume_ids.size() || closing_radius != this->closing_radius || model_precision != this->model_precision ||
+        trafo.matrix() != this->trafo.matrix())
+        return false;
+    for (size_t i = 0; i < volumes.size(); ++ i)
+        if (volumes[i]->id() != this->volume_ids[i] ||
+            // If the mesh is still alive, the pointer was not reused by another mesh.
+            this->meshes[i].lock() != volumes[i]->mesh_ptr() ||
+            volumes[i]->get_matrix().matrix() != this->volume_trafos[i].matrix())
+            return false;
+    return true;
+}
+
+bool SlicingMeshCache::Key::used_by(const ModelObject &model_object) const
+{
+    for (size_t i = 0; i < this->volume_ids.size(); ++ i) {
+        auto it = std::find_if(model_object.volumes.begin(), model_object.volumes.end(),
+            [id = this->volume_ids[i]](const ModelVolume *volume) { return volume->id() == id; });
+        if (it == model_object.volumes.end() || this->meshes[i].lock() != (*it)->mesh_ptr())
+            return false;
+    }
+    return true;
+}
+
+SlicingMeshCache::EntryPtr SlicingMeshCache::get(
+    const std::vector<const ModelVolume*> &volumes, const Transform3d &trafo, float closing_radius, float model_precision,
+    const PrepareFn &prepare, TriangleMeshSlicer::throw_on_cancel_callback_type throw_on_cancel)
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        for (const std::pair<Key, EntryPtr> &entry : m_entries)
+            if (entry.first.matches(volumes, trafo, closing_radius, model_precision))
+                return entry.second;
+    }
+
+    // Prepare the mesh outside of the lock, it is the expensive part.
+    auto entry = std::make_shared<Entry>(closing_radius, model_precision);
+    if (! prepare(entry->mesh))
+        return EntryPtr();
+    entry->slicer.init(&entry->mesh, throw_on_cancel);
+    entry->memsize = entry->mesh.memsize() + entry->slicer.memsize();
+
+    Key key;
+    key.volume_ids.reserve(volumes.size());
+    key.meshes.reserve(volumes.size());
+    key.volume_trafos.reserve(volumes.size());
+    for (const ModelVolume *volume : volumes) {
+        key.volume_ids.emplace_back(volume->id());
+        key.meshes.emplace_back(volume->mesh_ptr());
+        key.volume_trafos.emplace_back(volume->get_matrix());
+    }
+    key.trafo           = trafo;
+    key.closing_radius  = closing_radius;
+    key.model_precision = model_precision;
+
+    std::scoped_lock lock(m_mutex);
+    // Replace an entry of the same volumes, which was prepared for another revision or transformation.
+    for (size_t i = 0; i < m_entries.size(); ++ i)
+        if (m_entries[i].first.volume_ids == key.volume_ids) {
+            this->erase(i);
+            break;
+        }
+    s_total_memsize += entry->memsize;
+    m_entries.emplace_back(std::move(key), entry);
+    return entry;
+}
+
+void SlicingMeshCache::erase(size_t idx)
+{
+    s_total_memsize -= m_entries[idx].second->memsize;
+    m_entries.erase(m_entries.begin() + idx);
+}
+
+void SlicingMeshCache::remove_unused(const ModelObject &model_object)
+{
+    std::scoped_lock lock(m_mutex);
+    for (size_t i = 0; i < m_entries.size();)
+        if (! m_entries[i].first.used_by(model_object))
+            this->erase(i);
+        else
+            ++ i;
+}
+
+void SlicingMeshCache::clear()
+{
+    std::scoped_lock lock(m_mutex);
+    while (! m_entries.empty())
+        this->erase(m_entries.size() - 1);
+}
+
+size_t SlicingMeshCache::memsize() const
+{
+    std::scoped_lock lock(m_mutex);
+    size_t out = 0;
+    for (const std::pair<Key, EntryPtr> &entry : m_entries)
+        out += entry.second->memsize;
+    return out;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,91 @@
+#ifndef slic3r_SlicingMeshCache_hpp_
+#define slic3r_SlicingMeshCache_hpp_
+
+#include "libslic3r.h"
+#include "ObjectID.hpp"
+#include "TriangleMesh.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Slic3r {
+
+class ModelObject;
+class ModelVolume;
+
+// Cache of the meshes of ModelVolumes transformed into the coordinate system of a PrintObject, repaired
+// and with a TriangleMeshSlicer initialized over them (the edge map and, once a partial Z range is sliced,
+// the Z index of facets).
+// Re-slicing after a change, which does not modify the geometry (layer height, slicing settings),
+// reuses the prepared slicer instead of copying, transforming, repairing and indexing the mesh again.
+//
+// An entry is identified by the ObjectIDs of the source volumes, by the revisions of their meshes
+// (ModelVolume meshes are immutable and shared, a new mesh is assigned on every change),
+// by the transformations of the volumes and of the object and by the slicer parameters.
+class SlicingMeshCache
+{
+public:
+    struct Entry
+    {
+        Entry(float closing_radius, float model_precision) : slicer(closing_radius, model_precision) {}
+        Entry(const Entry &) = delete;
+        Entry& operator=(const Entry &) = delete;
+
+        TriangleMesh        mesh;
+        // Initialized over mesh, which has to stay at the same address.
+        TriangleMeshSlicer  slicer;
+        // Memory occupied by the mesh and by the slicer.
+        size_t              memsize { 0 };
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    // Prepares the mesh of the volumes by calling the prepare callback. The callback shall fill in the mesh
+    // and return false if the mesh is empty. The slicer is then initialized by the cache.
+    using PrepareFn = std::function<bool(TriangleMesh &mesh)>;
+
+    SlicingMeshCache() = default;
+    SlicingMeshCache(const SlicingMeshCache &) = delete;
+    SlicingMeshCache& operator=(const SlicingMeshCache &) = delete;
+    ~SlicingMeshCache() { this->clear(); }
+
+    // Returns the cached entry or prepares a new one. Returns nullptr if the mesh is empty.
+    // Thread safe.
+    EntryPtr    get(const std::vector<const ModelVolume*> &volumes, const Transform3d &trafo, float closing_radius, float model_precision,
+                    const PrepareFn &prepare, TriangleMeshSlicer::throw_on_cancel_callback_type throw_on_cancel);
+    // Release the entries of volumes, which are no more part of the model object or whose mesh changed.
+    void        remove_unused(const ModelObject &model_object);
+    void        clear();
+
+    size_t      memsize() const;
+    // Memory occupied by all the SlicingMeshCache instances, reported by log_memory_info().
+    static size_t total_memsize() { return s_total_memsize; }
+
+private:
+    struct Key
+    {
+        std::vector<ObjectID>                           volume_ids;
+        // Revisions of the meshes of the volumes.
+        std::vector<std::weak_ptr<const TriangleMesh>>  meshes;
+        std::vector<Transform3d>                        volume_trafos;
+        Transform3d                                     trafo;
+        float                                           closing_radius;
+        float                                           model_precision;
+
+        bool matches(const std::vector<const ModelVolume*> &volumes, const Transform3d &trafo, float closing_radius, float model_precision) const;
+        bool used_by(const ModelObject &model_object) const;
+    };
+
+    void        erase(size_t idx);
+
+    mutable std::mutex                          m_mutex;
+    std::vector<std::pair<Key, EntryPtr>>       m_entries;
+
+    static std::atomic<size_t>                  s_total_memsize;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_SlicingMeshCache_hpp_ */
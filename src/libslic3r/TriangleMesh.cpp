@@ -20,6 +20,8 @@
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/task_arena.h>
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
@@ -45,58 +47,71 @@ namespace Slic3r {
 
 TriangleMesh::TriangleMesh(const Pointf3s &points, const std::vector<Vec3i32>& facets) : repaired(false)
 {
-    stl_file &stl = this->stl;
+    this->its.vertices.reserve(points.size());
+    for (const Vec3d &pt : points)
+        this->its.vertices.emplace_back(pt.cast<float>());
+    this->its.indices = facets;
     stl.stats.type = inmemory;
+    stl.stats.number_of_facets = uint32_t(facets.size());
+    stl.stats.original_num_facets = int(stl.stats.number_of_facets);
+    stl_get_size(&stl, this->its);
+}
 
-    // count facets and allocate memory
-    stl.stats.number_of_facets = (uint32_t)facets.size();
-    stl.stats.original_num_facets = stl.stats.number_of_facets;
-    stl_allocate(&stl);
-
-	for (uint32_t i = 0; i < stl.stats.number_of_facets; ++ i) {
-        stl_facet facet;
-        facet.vertex[0] = points[facets[i](0)].cast<float>();
-        facet.vertex[1] = points[facets[i](1)].cast<float>();
-        facet.vertex[2] = points[facets[i](2)].cast<float>();
-        facet.extra[0] = 0;
-        facet.extra[1] = 0;
-
-        stl_normal normal;
-        stl_calculate_normal(normal, &facet);
-        stl_normalize_vector(normal);
-        facet.normal = normal;
-
-        stl.facet_start[i] = facet;
-    }
-    stl_get_size(&stl);
+TriangleMesh::TriangleMesh(const indexed_triangle_set &M) : TriangleMesh(indexed_triangle_set(M))
+{
 }
 
-TriangleMesh::TriangleMesh(const indexed_triangle_set &M) : repaired(false)
+TriangleMesh::TriangleMesh(indexed_triangle_set &&M) : repaired(false)
 {
+    this->its = std::move(M);
     stl.stats.type = inmemory;
-    
-    // count facets and allocate memory
-    stl.stats.number_of_facets = uint32_t(M.indices.size());
+    stl.stats.number_of_facets = uint32_t(this->its.indices.size());
     stl.stats.original_num_facets = int(stl.stats.number_of_facets);
-    stl_allocate(&stl);
-    
-    for (uint32_t i = 0; i < stl.stats.number_of_facets; ++ i) {
-        stl_facet facet;
-        facet.vertex[0] = M.vertices[size_t(M.indices[i](0))];
-        facet.vertex[1] = M.vertices[size_t(M.indices[i](1))];
-        facet.vertex[2] = M.vertices[size_t(M.indices[i](2))];
-        facet.extra[0] = 0;
-        facet.extra[1] = 0;
-        
-        stl_normal normal;
-        stl_calculate_normal(normal, &facet);
-        stl_normalize_vector(normal);
-        facet.normal = normal;
-        
-        stl.facet_start[i] = facet;
+    stl_get_size(&stl, this->its);
+}
+
+bool TriangleMesh::write_ascii(const char* output_file)
+{
+    this->require_facets();
+    bool result = stl_write_ascii(&this->stl, output_file, "");
+    this->release_facets();
+    return result;
+}
+
+bool TriangleMesh::write_binary(const char* output_file)
+{
+    this->require_facets();
+    bool result = stl_write_binary(&this->stl, output_file, "");
+    this->release_facets();
+    return result;
+}
+
+void TriangleMesh::require_facets()
+{
+    if (this->stl.facet_start.empty() && ! this->its.indices.empty())
+        stl_facets_from_its(&this->stl, this->its);
+}
+
+void TriangleMesh::release_facets()
+{
+    if (this->has_shared_vertices()) {
+        std::vector<stl_facet>().swap(this->stl.facet_start);
+        std::vector<stl_neighbors>().swap(this->stl.neighbors_start);
     }
-    
-    stl_get_size(&stl);
+}
+
+// Meshes with at least this number of facets are connected by sorting their edges in parallel, smaller meshes by hashing them.
+static constexpr uint32_t check_facets_parallel_min_facets = 100000;
+// Sorting the edges of a mesh with ordered facets is about three times the work of hashing them,
+// so the sort only pays off if it is spread over at least this number of threads.
+static constexpr int      check_facets_parallel_min_threads = 4;
+
+static void check_facets_exact(stl_file &stl)
+{
+    if (stl.stats.number_of_facets >= check_facets_parallel_min_facets && tbb::this_task_arena::max_concurrency() >= check_facets_parallel_min_threads)
+        stl_check_facets_exact_parallel(&stl);
+    else
+        stl_check_facets_exact(&stl);
 }
 
 // #define SLIC3R_TRACE_REPAIR
@@ -113,6 +128,9 @@ void TriangleMesh::repair(bool update_shared_vertices)
     if (this->stl.stats.number_of_facets == 0)
     	return;
 
+    // admesh repairs the facets, expand a mesh created as an indexed triangle set.
+    this->require_facets();
+
     BOOST_LOG_TRIVIAL(debug) << "TriangleMesh::repair() started";
 
     // checking exact
@@ -120,7 +138,7 @@ void TriangleMesh::repair(bool update_shared_vertices)
 	BOOST_LOG_TRIVIAL(trace) << "\tstl_check_faces_exact";
 #endif /* SLIC3R_TRACE_REPAIR */
 	assert(stl_validate(&this->stl));
-	stl_check_facets_exact(&stl);
+	check_facets_exact(stl);
     assert(stl_validate(&this->stl));
     stl.stats.facets_w_1_bad_edge = (stl.stats.connected_facets_2_edge - stl.stats.connected_facets_3_edge);
     stl.stats.facets_w_2_bad_edge = (stl.stats.connected_facets_1_edge - stl.stats.connected_facets_2_edge);
@@ -210,17 +228,47 @@ void TriangleMesh::repair(bool update_shared_vertices)
     	this->require_shared_vertices();
 }
 
+// Signed volume of an indexed mesh, the sum of the signed volumes of the tetrahedra spanned by the faces and the first vertex.
+static double its_signed_volume(const indexed_triangle_set &its)
+{
+    if (its.indices.empty())
+        return 0.;
+    const Vec3d p0 = its.vertices[its.indices.front()(0)].cast<double>();
+    double volume = 0.;
+    for (const stl_triangle_vertex_indices &face : its.indices) {
+        Vec3d v0 = its.vertices[face(0)].cast<double>() - p0;
+        Vec3d v1 = its.vertices[face(1)].cast<double>() - p0;
+        Vec3d v2 = its.vertices[face(2)].cast<double>() - p0;
+        volume += v0.dot(v1.cross(v2));
+    }
+    return volume / 6.;
+}
+
 float TriangleMesh::volume()
 {
-    if (this->stl.stats.volume == -1) 
-        stl_calculate_volume(&this->stl);
+    if (this->stl.stats.volume == -1) {
+        if (this->stl.facet_start.empty()) {
+            // Indexed mesh: Reverse the faces if the volume is negative, as stl_calculate_volume() does.
+            double volume = its_signed_volume(this->its);
+            if (volume < 0.) {
+                for (stl_triangle_vertex_indices &face : this->its.indices)
+                    std::swap(face(0), face(1));
+                volume = - volume;
+            }
+            this->stl.stats.volume = float(volume);
+        } else
+            stl_calculate_volume(&this->stl);
+    }
     return this->stl.stats.volume;
 }
 
 void TriangleMesh::check_topology()
 {
+    bool indexed = this->stl.facet_start.empty() && this->has_shared_vertices();
+    this->require_facets();
+
     // checking exact
-    stl_check_facets_exact(&stl);
+    check_facets_exact(stl);
     stl.stats.facets_w_1_bad_edge = (stl.stats.connected_facets_2_edge - stl.stats.connected_facets_3_edge);
     stl.stats.facets_w_2_bad_edge = (stl.stats.connected_facets_1_edge - stl.stats.connected_facets_2_edge);
     stl.stats.facets_w_3_bad_edge = (stl.stats.number_of_facets - stl.stats.connected_facets_1_edge);
@@ -243,6 +291,12 @@ void TriangleMesh::check_topology()
             }
         }
     }
+
+    if (indexed) {
+        // Degenerate facets may have been removed, index the facets again.
+        stl_generate_shared_vertices(&this->stl, this->its);
+        this->release_facets();
+    }
 }
 
 void TriangleMesh::reset_repair_stats() {
@@ -272,27 +326,36 @@ void TriangleMesh::WriteOBJFile(const char* output_file) const
 
 void TriangleMesh::scale(float factor)
 {
-    stl_scale(&(this->stl), factor);
-	for (stl_vertex& v : this->its.vertices)
-		v *= factor;
+    this->scale(Vec3d(factor, factor, factor));
 }
 
 void TriangleMesh::scale(const Vec3d &versor)
 {
-    stl_scale_versor(&this->stl, versor.cast<float>());
+    if (this->stl.facet_start.empty()) {
+        // Indexed mesh, scale the statistics the same way stl_scale_versor() does.
+        if (this->stl.stats.volume > 0.0)
+            this->stl.stats.volume *= float(versor.x() * versor.y() * versor.z());
+    } else
+        stl_scale_versor(&this->stl, versor.cast<float>());
 	for (stl_vertex& v : this->its.vertices) {
 		v.x() *= versor.x();
 		v.y() *= versor.y();
 		v.z() *= versor.z();
 	}
+    if (this->stl.facet_start.empty())
+        stl_get_size(&this->stl, this->its);
 }
 
 void TriangleMesh::translate(float x, float y, float z)
 {
     if (x == 0.f && y == 0.f && z == 0.f)
         return;
-    stl_translate_relative(&(this->stl), x, y, z);
 	stl_vertex shift(x, y, z);
+    if (this->stl.facet_start.empty()) {
+        this->stl.stats.min += shift;
+        this->stl.stats.max += shift;
+    } else
+        stl_translate_relative(&(this->stl), x, y, z);
 	for (stl_vertex& v : this->its.vertices)
 		v += shift;
 }
@@ -310,16 +373,22 @@ void TriangleMesh::rotate(float angle, const Axis &axis)
     // admesh uses degrees
     angle = Slic3r::Geometry::rad2deg(angle);
     
+    bool facets = ! this->stl.facet_start.empty();
     if (axis == X) {
-        stl_rotate_x(&this->stl, angle);
+        if (facets)
+            stl_rotate_x(&this->stl, angle);
         its_rotate_x(this->its, angle);
     } else if (axis == Y) {
-        stl_rotate_y(&this->stl, angle);
+        if (facets)
+            stl_rotate_y(&this->stl, angle);
         its_rotate_y(this->its, angle);
     } else if (axis == Z) {
-        stl_rotate_z(&this->stl, angle);
+        if (facets)
+            stl_rotate_z(&this->stl, angle);
         its_rotate_z(this->its, angle);
     }
+    if (! facets)
+        stl_get_size(&this->stl, this->its);
 }
 
 void TriangleMesh::rotate(float angle, const Vec3d& axis)
@@ -330,29 +399,35 @@ void TriangleMesh::rotate(float angle, const Vec3d& axis)
     Vec3d axis_norm = axis.normalized();
     Transform3d m = Transform3d::Identity();
     m.rotate(Eigen::AngleAxisd(angle, axis_norm));
-    stl_transform(&stl, m);
-    its_transform(its, m);
+    this->transform(m);
 }
 
 void TriangleMesh::mirror(const Axis &axis)
 {
-    if (axis == X) {
-        stl_mirror_yz(&this->stl);
+    if (this->stl.facet_start.empty()) {
+        // Indexed mesh: Mirror the vertices and flip the faces to keep them oriented outwards, as stl_mirror_*() do.
         for (stl_vertex &v : this->its.vertices)
-      		v(0) *= -1.0;
+      		v(int(axis)) *= -1.f;
+        for (stl_triangle_vertex_indices &face : this->its.indices)
+            std::swap(face(0), face(1));
+        stl_get_size(&this->stl, this->its);
+    } else if (axis == X) {
+        stl_mirror_yz(&this->stl);
     } else if (axis == Y) {
         stl_mirror_xz(&this->stl);
-        for (stl_vertex &v : this->its.vertices)
-      		v(1) *= -1.0;
     } else if (axis == Z) {
         stl_mirror_xy(&this->stl);
-        for (stl_vertex &v : this->its.vertices)
-      		v(2) *= -1.0;
     }
 }
 
 void TriangleMesh::transform(const Transform3d& t, bool fix_left_handed)
 {
+    if (this->stl.facet_start.empty()) {
+        // Indexed mesh: The faces of a left handed transformation are flipped by its_transform().
+        its_transform(its, t, fix_left_handed);
+        stl_get_size(&this->stl, this->its);
+        return;
+    }
     stl_transform(&stl, t);
     its_transform(its, t);
 	if (fix_left_handed && t.matrix().block(0, 0, 3, 3).determinant() < 0.) {
@@ -366,6 +441,11 @@ void TriangleMesh::transform(const Transform3d& t, bool fix_left_handed)
 
 void TriangleMesh::transform(const Matrix3d& m, bool fix_left_handed)
 {
+    if (this->stl.facet_start.empty()) {
+        its_transform(its, m, fix_left_handed);
+        stl_get_size(&this->stl, this->its);
+        return;
+    }
     stl_transform(&stl, m);
     its_transform(its, m);
     if (fix_left_handed && m.determinant() < 0.) {
@@ -391,8 +471,11 @@ void TriangleMesh::rotate(double angle, Point* center)
         return;
     Vec2f c = center->cast<float>();
     this->translate(-c(0), -c(1), 0);
-    stl_rotate_z(&this->stl, (float)angle);
     its_rotate_z(this->its, (float)angle);
+    if (this->stl.facet_start.empty())
+        stl_get_size(&this->stl, this->its);
+    else
+        stl_rotate_z(&this->stl, (float)angle);
     this->translate(c(0), c(1), 0);
 }
 
@@ -402,7 +485,7 @@ void TriangleMesh::rotate(double angle, Point* center)
 bool TriangleMesh::is_splittable() const
 {
     std::vector<unsigned char> visited;
-    find_unvisited_neighbors(visited);
+    find_unvisited_neighbors(its_face_neighbors(this->its), visited);
 
     // Try finding an unvisited facet. If there are none, the mesh is not splittable.
     auto it = std::find(visited.begin(), visited.end(), false);
@@ -413,14 +496,15 @@ bool TriangleMesh::is_splittable() const
  * Visit all unvisited neighboring facets that are reachable from the first unvisited facet,
  * and return them.
  * 
+ * @param face_neighbors Neighbors of the facets as returned by its_face_neighbors().
  * @param facet_visited A reference to a vector of booleans. Contains whether or not a
  *                      facet with the same index has been visited.
  * @return A deque with all newly visited facets.
  */
-std::deque<uint32_t> TriangleMesh::find_unvisited_neighbors(std::vector<unsigned char> &facet_visited) const
+std::deque<uint32_t> TriangleMesh::find_unvisited_neighbors(const std::vector<Vec3i32> &face_neighbors, std::vector<unsigned char> &facet_visited) const
 {
     // Make sure we're not operating on a broken mesh.
-    if (!this->repaired)
+    if (!this->repaired || ! this->has_shared_vertices())
         throw Slic3r::RuntimeError("find_unvisited_neighbors() requires repair()");
 
     // If the visited list is empty, populate it with false for every facet.
@@ -442,12 +526,14 @@ std::deque<uint32_t> TriangleMesh::find_unvisited_neighbors(std::vector<unsigned
     while (! facet_queue.empty()) {
         uint32_t facet_idx = facet_queue.front();
         facet_queue.pop();
-        for (int neighbor_idx : this->stl.neighbors_start[facet_idx].neighbor)
+        for (int i = 0; i < 3; ++ i) {
+            int neighbor_idx = face_neighbors[facet_idx](i);
             if (neighbor_idx != -1 && ! facet_visited[neighbor_idx]) {
                 facet_queue.push(uint32_t(neighbor_idx));
                 facet_visited[neighbor_idx] = true;
                 facets.emplace_back(uint32_t(neighbor_idx));
             }
+        }
     }
 
     return facets;
@@ -461,50 +547,80 @@ std::deque<uint32_t> TriangleMesh::find_unvisited_neighbors(std::vector<unsigned
 TriangleMeshPtrs TriangleMesh::split() const
 {
     // Loop while we have remaining facets.
+    std::vector<Vec3i32>       face_neighbors = its_face_neighbors(this->its);
     std::vector<unsigned char> facet_visited;
+    // Map from a vertex of this mesh to a vertex of the part being split off, reset for each part.
+    std::vector<int>           vertex_map(this->its.vertices.size(), -1);
     TriangleMeshPtrs meshes;
     for (;;) {
-        std::deque<uint32_t> facets = find_unvisited_neighbors(facet_visited);
+        std::deque<uint32_t> facets = find_unvisited_neighbors(face_neighbors, facet_visited);
         if (facets.empty())
             break;
 
         // Create a new mesh for the part that was just split off.
-        TriangleMesh* mesh = new TriangleMesh;
-        meshes.emplace_back(mesh);
-        mesh->stl.stats.type = inmemory;
-        mesh->stl.stats.number_of_facets = (uint32_t)facets.size();
-        mesh->stl.stats.original_num_facets = mesh->stl.stats.number_of_facets;
-        stl_allocate(&mesh->stl);
-
-        // Assign the facets to the new mesh.
-        bool first = true;
-        for (auto facet = facets.begin(); facet != facets.end(); ++ facet) {
-            mesh->stl.facet_start[facet - facets.begin()] = this->stl.facet_start[*facet];
-            stl_facet_stats(&mesh->stl, this->stl.facet_start[*facet], first);
+        indexed_triangle_set its;
+        its.indices.reserve(facets.size());
+        for (uint32_t facet_idx : facets) {
+            const stl_triangle_vertex_indices &face = this->its.indices[facet_idx];
+            stl_triangle_vertex_indices new_face;
+            for (int j = 0; j < 3; ++ j) {
+                int &new_vertex = vertex_map[face(j)];
+                if (new_vertex == -1) {
+                    new_vertex = int(its.vertices.size());
+                    its.vertices.emplace_back(this->its.vertices[face(j)]);
+                }
+                new_face(j) = new_vertex;
+            }
+            its.indices.emplace_back(new_face);
         }
+        for (uint32_t facet_idx : facets)
+            for (int j = 0; j < 3; ++ j)
+                vertex_map[this->its.indices[facet_idx](j)] = -1;
+        meshes.emplace_back(new TriangleMesh(std::move(its)));
     }
 
     return meshes;
 }
 
+// Append the facets of the admesh structure to an indexed triangle set, without sharing the vertices.
+static void its_append_facets(indexed_triangle_set &its, const std::vector<stl_facet> &facets)
+{
+    its.vertices.reserve(its.vertices.size() + 3 * facets.size());
+    its.indices.reserve(its.indices.size() + facets.size());
+    for (const stl_facet &facet : facets) {
+        int idx = int(its.vertices.size());
+        its.vertices.insert(its.vertices.end(), facet.vertex, facet.vertex + 3);
+        its.indices.emplace_back(idx, idx + 1, idx + 2);
+    }
+}
+
 void TriangleMesh::merge(const TriangleMesh &mesh)
 {
+    // The merged mesh is indexed. The vertices of a mesh not indexed yet are not shared,
+    // they will be merged by the repair() of the merged mesh.
+    if (! this->stl.facet_start.empty()) {
+        its_append_facets(this->its, this->stl.facet_start);
+        std::vector<stl_facet>().swap(this->stl.facet_start);
+        std::vector<stl_neighbors>().swap(this->stl.neighbors_start);
+    }
+    if (mesh.stl.facet_start.empty()) {
+        int offset = int(this->its.vertices.size());
+        this->its.vertices.insert(this->its.vertices.end(), mesh.its.vertices.begin(), mesh.its.vertices.end());
+        this->its.indices.reserve(this->its.indices.size() + mesh.its.indices.size());
+        for (const stl_triangle_vertex_indices &face : mesh.its.indices)
+            this->its.indices.emplace_back(face + stl_triangle_vertex_indices(offset, offset, offset));
+    } else
+        its_append_facets(this->its, mesh.stl.facet_start);
+
     // reset stats and metadata
-    int number_of_facets = this->stl.stats.number_of_facets;
-    this->its.clear();
     this->repaired = false;
-    
-    // update facet count and allocate more memory
-    this->stl.stats.number_of_facets = number_of_facets + mesh.stl.stats.number_of_facets;
-    this->stl.stats.original_num_facets = this->stl.stats.number_of_facets;
-    stl_reallocate(&this->stl);
-    
-    // copy facets
-    for (uint32_t i = 0; i < mesh.stl.stats.number_of_facets; ++ i)
-        this->stl.facet_start[number_of_facets + i] = mesh.stl.facet_start[i];
+    this->stl.stats.type = inmemory;
+    this->stl.stats.number_of_facets = uint32_t(this->its.indices.size());
+    this->stl.stats.original_num_facets = int(this->stl.stats.number_of_facets);
+    this->stl.stats.volume = -1.f;
     
     // update size
-    stl_get_size(&this->stl);
+    stl_get_size(&this->stl, this->its);
 }
 
 // Calculate projection of the mesh into the XY plane, in scaled coordinates.
@@ -512,13 +628,14 @@ void TriangleMesh::merge(const TriangleMesh &mesh)
 ExPolygons TriangleMesh::horizontal_projection() const
 {
     Polygons pp;
-    pp.reserve(this->stl.stats.number_of_facets);
-	for (const stl_facet &facet : this->stl.facet_start) {
+    pp.reserve(this->its.indices.size());
+	for (const stl_triangle_vertex_indices &face : this->its.indices) {
         Polygon p;
         p.points.resize(3);
-        p.points[0] = Point::new_scale(facet.vertex[0](0), facet.vertex[0](1));
-        p.points[1] = Point::new_scale(facet.vertex[1](0), facet.vertex[1](1));
-        p.points[2] = Point::new_scale(facet.vertex[2](0), facet.vertex[2](1));
+        for (int j = 0; j < 3; ++ j) {
+            const stl_vertex &v = this->its.vertices[face(j)];
+            p.points[j] = Point::new_scale(v(0), v(1));
+        }
         p.make_counter_clockwise();  // do this after scaling, as winding order might change while doing that
         pp.emplace_back(p);
     }
@@ -636,14 +753,16 @@ std::vector<ExPolygons> TriangleMesh::slice(const std::vector<double> &z)
 void TriangleMesh::require_shared_vertices()
 {
     BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::require_shared_vertices - start";
-    assert(stl_validate(&this->stl));
     if (!this->repaired) 
         this->repair();
-    if (this->its.vertices.empty()) {
+    if (this->its.vertices.empty() && ! this->stl.facet_start.empty()) {
         BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::require_shared_vertices - stl_generate_shared_vertices";
+        assert(stl_validate(&this->stl));
         stl_generate_shared_vertices(&this->stl, this->its);
+        assert(stl_validate(&this->stl, this->its));
     }
-    assert(stl_validate(&this->stl, this->its));
+    // From now on the mesh is stored as the indexed triangle set only.
+    this->release_facets();
     BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::require_shared_vertices - end";
 }
 
@@ -654,33 +773,116 @@ size_t TriangleMesh::memsize() const
 }
 
 // Release optional data from the mesh if the object is on the Undo / Redo stack only. Returns the amount of memory released.
+// The indexed triangle set is the mesh itself, only the neighbors of a mesh not indexed yet may be released.
 size_t TriangleMesh::release_optional()
 {
-	size_t memsize_released = sizeof(stl_neighbors) * this->stl.neighbors_start.size() + this->its.memsize();
-	// The indexed triangle set may be recalculated using the stl_generate_shared_vertices() function.
-	this->its.clear();
+	size_t memsize_released = sizeof(stl_neighbors) * this->stl.neighbors_start.size();
 	// The neighbors structure may be recalculated using the stl_check_facets_exact() function.
-	this->stl.neighbors_start.clear();
+	std::vector<stl_neighbors>().swap(this->stl.neighbors_start);
 	return memsize_released;
 }
 
 // Restore optional data possibly released by release_optional().
 void TriangleMesh::restore_optional()
 {
-	if (! this->stl.facet_start.empty()) {
+	if (! this->stl.facet_start.empty() && this->stl.neighbors_start.empty()) {
 		// Save the old stats before calling stl_check_faces_exact, as it may modify the statistics.
 		stl_stats stats = this->stl.stats;
-		if (this->stl.neighbors_start.empty()) {
-			stl_reallocate(&this->stl);
-			stl_check_facets_exact(&this->stl);
-		}
-		if (this->its.vertices.empty())
-			stl_generate_shared_vertices(&this->stl, this->its);
+		stl_reallocate(&this->stl);
+		check_facets_exact(this->stl);
 		// Restore the old statistics.
 		this->stl.stats = stats;
 	}
 }
 
+std::vector<Vec3i32> its_face_neighbors(const indexed_triangle_set &its)
+{
+    // Edges sorted by their vertex indices, so that the edges shared by two faces are consecutive.
+    struct EdgeToFace {
+        int vertex_low;
+        int vertex_high;
+        // Face index * 3 + edge index in the face.
+        int face_edge;
+        bool operator<(const EdgeToFace &other) const { return vertex_low < other.vertex_low || (vertex_low == other.vertex_low && vertex_high < other.vertex_high); }
+    };
+    std::vector<EdgeToFace> edges;
+    edges.reserve(its.indices.size() * 3);
+    for (int face_idx = 0; face_idx < int(its.indices.size()); ++ face_idx)
+        for (int i = 0; i < 3; ++ i) {
+            int a = its.indices[face_idx](i);
+            int b = its.indices[face_idx]((i + 1) % 3);
+            edges.push_back({ std::min(a, b), std::max(a, b), face_idx * 3 + i });
+        }
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<Vec3i32> out(its.indices.size(), Vec3i32(-1, -1, -1));
+    for (size_t i = 0; i + 1 < edges.size();) {
+        const EdgeToFace &a = edges[i];
+        const EdgeToFace &b = edges[i + 1];
+        if (a.vertex_low == b.vertex_low && a.vertex_high == b.vertex_high && a.face_edge / 3 != b.face_edge / 3) {
+            // Pair the edge with the next one, a non-manifold edge shared by more than two faces is paired twice at most.
+            out[a.face_edge / 3](a.face_edge % 3) = b.face_edge / 3;
+            out[b.face_edge / 3](b.face_edge % 3) = a.face_edge / 3;
+            i += 2;
+        } else
+            ++ i;
+    }
+    return out;
+}
+
+int its_merge_vertices(indexed_triangle_set &its)
+{
+    // Sort the vertices lexicographically to find the duplicates.
+    std::vector<int> order(its.vertices.size());
+    for (int i = 0; i < int(order.size()); ++ i)
+        order[i] = i;
+    auto less = [&its](int a, int b) {
+        const stl_vertex &va = its.vertices[a];
+        const stl_vertex &vb = its.vertices[b];
+        return va.x() < vb.x() || (va.x() == vb.x() && (va.y() < vb.y() || (va.y() == vb.y() && va.z() < vb.z())));
+    };
+    std::sort(order.begin(), order.end(), less);
+
+    // Map each vertex to the lowest index of the run of equal vertices.
+    std::vector<int> vertex_map(its.vertices.size(), -1);
+    for (size_t i = 0; i < order.size();) {
+        size_t j = i + 1;
+        int    first = order[i];
+        for (; j < order.size() && its.vertices[order[j]] == its.vertices[order[i]]; ++ j)
+            first = std::min(first, order[j]);
+        for (size_t k = i; k < j; ++ k)
+            vertex_map[order[k]] = first;
+        i = j;
+    }
+
+    // Compact the vertices referenced by the faces, keeping their order, so that the indices of a mesh without duplicate
+    // vertices do not change.
+    std::vector<int> new_index(its.vertices.size(), -1);
+    for (const stl_triangle_vertex_indices &face : its.indices)
+        for (int j = 0; j < 3; ++ j)
+            new_index[vertex_map[face(j)]] = 0;
+    std::vector<stl_vertex> vertices;
+    for (size_t i = 0; i < its.vertices.size(); ++ i)
+        if (new_index[i] == 0) {
+            new_index[i] = int(vertices.size());
+            vertices.emplace_back(its.vertices[i]);
+        }
+    for (int &idx : vertex_map)
+        idx = new_index[idx];
+
+    // Remap the faces and remove the degenerate ones.
+    size_t num_faces = 0;
+    for (const stl_triangle_vertex_indices &face : its.indices) {
+        stl_triangle_vertex_indices new_face(vertex_map[face(0)], vertex_map[face(1)], vertex_map[face(2)]);
+        if (new_face(0) != new_face(1) && new_face(0) != new_face(2) && new_face(1) != new_face(2))
+            its.indices[num_faces ++] = new_face;
+    }
+    int removed = int(its.indices.size() - num_faces);
+    its.indices.resize(num_faces);
+    its.vertices = std::move(vertices);
+    return removed;
+}
+
 void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callback_type throw_on_cancel)
 {
     mesh = _mesh;
@@ -766,14 +968,116 @@ void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callbac
         if ((i & 0x0ffff) == 0)
             throw_on_cancel();
     }
+
+    throw_on_cancel();
+    // The Z index of facets is built lazily by facets_in_z_range().
+    m_facets_z_sorted.clear();
+    m_facets_min_z.clear();
+    m_facets_max_z.clear();
+    m_facets_block_max_z.clear();
+    m_facets_z_index_valid = false;
 }
 
+void TriangleMeshSlicer::build_facets_z_index() const
+{
+    std::lock_guard<std::mutex> lock(m_facets_z_index_mutex);
+    if (m_facets_z_index_valid)
+        // Built by another thread in the meantime.
+        return;
 
+    const size_t num_facets = this->mesh->stl.stats.number_of_facets;
+    std::vector<std::pair<float, float>> facet_z_span(num_facets);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, num_facets),
+        [&facet_z_span, this](const tbb::blocked_range<size_t>& range) {
+            for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+                const std::array<stl_vertex, 3> facet = this->facet_vertices(facet_idx);
+                facet_z_span[facet_idx] = std::make_pair(
+                    fminf(facet[0](2), fminf(facet[1](2), facet[2](2))),
+                    fmaxf(facet[0](2), fmaxf(facet[1](2), facet[2](2))));
+            }
+        });
+
+    m_facets_z_sorted.assign(num_facets, 0);
+    for (uint32_t facet_idx = 0; facet_idx < uint32_t(num_facets); ++ facet_idx)
+        m_facets_z_sorted[facet_idx] = facet_idx;
+    tbb::parallel_sort(m_facets_z_sorted.begin(), m_facets_z_sorted.end(),
+        [&facet_z_span](uint32_t a, uint32_t b) { return facet_z_span[a].first < facet_z_span[b].first; });
+
+    m_facets_min_z.assign(num_facets, 0.f);
+    m_facets_max_z.assign(num_facets, 0.f);
+    m_facets_block_max_z.assign((num_facets + FACETS_Z_BLOCK - 1) / FACETS_Z_BLOCK, -std::numeric_limits<float>::max());
+    for (size_t i = 0; i < num_facets; ++ i) {
+        const std::pair<float, float> &span = facet_z_span[m_facets_z_sorted[i]];
+        m_facets_min_z[i] = span.first;
+        m_facets_max_z[i] = span.second;
+        float &block_max_z = m_facets_block_max_z[i / FACETS_Z_BLOCK];
+        block_max_z = std::max(block_max_z, span.second);
+    }
+    m_facets_z_index_valid = true;
+}
+
+std::array<stl_vertex, 3> TriangleMeshSlicer::facet_vertices(size_t facet_idx) const
+{
+    const stl_triangle_vertex_indices &face = this->mesh->its.indices[facet_idx];
+    std::array<stl_vertex, 3> out;
+    for (int i = 0; i < 3; ++ i)
+        out[i] = m_use_quaternion ? stl_vertex(m_quaternion * this->mesh->its.vertices[face(i)]) : this->mesh->its.vertices[face(i)];
+    return out;
+}
+
+bool TriangleMeshSlicer::facets_in_z_range(float min_z, float max_z, std::vector<uint32_t> &facets) const
+{
+    facets.clear();
+    if (m_use_quaternion || this->mesh == nullptr ||
+        // Slicing a Z range spanning most of the mesh height visits most of the facets anyway,
+        // don't pay for sorting the facets then. This is the case of slicing the whole object.
+        max_z - min_z >= 0.5f * (this->mesh->stl.stats.max.z() - this->mesh->stl.stats.min.z()))
+        // Rotated slicing plane or (almost) all facets are inside the interval.
+        return false;
+    if (! m_facets_z_index_valid)
+        this->build_facets_z_index();
+    if (m_facets_min_z.empty() || (min_z <= m_facets_min_z.front() && max_z >= *std::max_element(m_facets_block_max_z.begin(), m_facets_block_max_z.end())))
+        // All facets are inside the interval.
+        return false;
+    // Only the facets starting below max_z may span the interval, they are a prefix of m_facets_z_sorted.
+    const size_t end = std::upper_bound(m_facets_min_z.begin(), m_facets_min_z.end(), max_z) - m_facets_min_z.begin();
+    for (size_t block_begin = 0; block_begin < end; block_begin += FACETS_Z_BLOCK) {
+        if (m_facets_block_max_z[block_begin / FACETS_Z_BLOCK] < min_z)
+            // The whole block of facets ends below the interval.
+            continue;
+        for (size_t i = block_begin; i < std::min(end, block_begin + FACETS_Z_BLOCK); ++ i)
+            if (m_facets_max_z[i] >= min_z)
+                facets.emplace_back(m_facets_z_sorted[i]);
+    }
+    // Visit the facets in the same order as when slicing the whole mesh, so that the slices are the same.
+    std::sort(facets.begin(), facets.end());
+    return true;
+}
+
+size_t TriangleMeshSlicer::memsize() const
+{
+    size_t out = sizeof(*this) + 
+        this->facets_edges.capacity() * sizeof(int) +
+        this->v_scaled_shared.capacity() * sizeof(stl_vertex);
+    if (m_facets_z_index_valid)
+        out += m_facets_z_sorted.capacity() * sizeof(uint32_t) +
+            (m_facets_min_z.capacity() + m_facets_max_z.capacity() + m_facets_block_max_z.capacity()) * sizeof(float);
+    return out;
+}
 
 void TriangleMeshSlicer::set_up_direction(const Vec3f& up)
 {
     m_quaternion.setFromTwoVectors(up, Vec3f::UnitZ());
     m_use_quaternion = true;
+    // The Z extents of the facets changed with the rotation. The direction is usually changed interactively
+    // before slicing a single plane, where sorting the facets would not pay off, therefore drop the index
+    // and slice through all the facets.
+    m_facets_z_index_valid = false;
+    m_facets_z_sorted.clear();
+    m_facets_min_z.clear();
+    m_facets_max_z.clear();
+    m_facets_block_max_z.clear();
 }
 
 void TriangleMeshSlicer::slice(
@@ -813,14 +1117,47 @@ void TriangleMeshSlicer::slice(
     BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_slice_do";
     std::vector<IntersectionLines> lines(z.size());
     {
-        boost::mutex lines_mutex;
+        // The facets are split into a fixed number of consecutive chunks, each chunk collects its intersection lines
+        // into its own per layer vectors, therefore no locking is needed. The chunks are then merged per layer
+        // in the chunk order, so the lines of a layer are ordered by their facet index independently
+        // of the number of threads and of the scheduling.
+        // If only a Z range of the mesh is sliced, visit just the facets spanning that range.
+        std::vector<uint32_t> facets_selected;
+        const bool   all_facets = z.empty() || ! this->facets_in_z_range(z.front(), z.back(), facets_selected);
+        const size_t num_facets = all_facets ? size_t(this->mesh->stl.stats.number_of_facets) : facets_selected.size();
+        const size_t chunk_size = std::max<size_t>(16384, (num_facets + 127) / 128);
+        const size_t num_chunks = (num_facets + chunk_size - 1) / chunk_size;
+        std::vector<std::vector<IntersectionLines>> chunk_lines(num_chunks);
         tbb::parallel_for(
-            tbb::blocked_range<int>(0,this->mesh->stl.stats.number_of_facets),
-            [&lines, &lines_mutex, &z, throw_on_cancel, this](const tbb::blocked_range<int>& range) {
-                for (int facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
-                    if ((facet_idx & 0x0ffff) == 0)
-                        throw_on_cancel();
-                    this->_slice_do(facet_idx, &lines, &lines_mutex, z);
+            tbb::blocked_range<size_t>(0, num_chunks, 1),
+            [&chunk_lines, &z, &facets_selected, all_facets, num_facets, chunk_size, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+                for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+                    std::vector<IntersectionLines> &out = chunk_lines[chunk_idx];
+                    out.assign(z.size(), IntersectionLines());
+                    const size_t end = std::min(num_facets, (chunk_idx + 1) * chunk_size);
+                    for (size_t i = chunk_idx * chunk_size; i < end; ++ i) {
+                        if ((i & 0x0ffff) == 0)
+                            throw_on_cancel();
+                        this->_slice_do(all_facets ? i : facets_selected[i], &out, z);
+                    }
+                }
+            }
+        );
+        throw_on_cancel();
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, z.size()),
+            [&chunk_lines, &lines](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    size_t num_lines = 0;
+                    for (const std::vector<IntersectionLines> &chunk : chunk_lines)
+                        num_lines += chunk[layer_idx].size();
+                    IntersectionLines &dst = lines[layer_idx];
+                    dst.reserve(num_lines);
+                    for (std::vector<IntersectionLines> &chunk : chunk_lines) {
+                        dst.insert(dst.end(), chunk[layer_idx].begin(), chunk[layer_idx].end());
+                        // Release the memory early.
+                        chunk[layer_idx] = IntersectionLines();
+                    }
                 }
             }
         );
@@ -906,20 +1243,21 @@ void TriangleMeshSlicer::slice(
 #endif
 }
 
-void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, 
-    const std::vector<float> &z) const
+// Slice a single facet by all the planes of z it spans and append the intersection lines to the layers of lines.
+// Called from multiple threads, each thread with its own lines.
+void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, const std::vector<float> &z) const
 {
-    const stl_facet &facet = m_use_quaternion ? (this->mesh->stl.facet_start.data() + facet_idx)->rotated(m_quaternion) : *(this->mesh->stl.facet_start.data() + facet_idx);
+    const std::array<stl_vertex, 3> facet = this->facet_vertices(facet_idx);
     
     // find facet extents
-    const float min_z = fminf(facet.vertex[0](2), fminf(facet.vertex[1](2), facet.vertex[2](2)));
-    const float max_z = fmaxf(facet.vertex[0](2), fmaxf(facet.vertex[1](2), facet.vertex[2](2)));
+    const float min_z = fminf(facet[0](2), fminf(facet[1](2), facet[2](2)));
+    const float max_z = fmaxf(facet[0](2), fmaxf(facet[1](2), facet[2](2)));
     
     #ifdef SLIC3R_TRIANGLEMESH_DEBUG
     printf("\n==> FACET %d (%f,%f,%f - %f,%f,%f - %f,%f,%f):\n", facet_idx,
-        facet.vertex[0](0), facet.vertex[0](1), facet.vertex[0](2),
-        facet.vertex[1](0), facet.vertex[1](1), facet.vertex[1](2),
-        facet.vertex[2](0), facet.vertex[2](1), facet.vertex[2](2));
+        facet[0](0), facet[0](1), facet[0](2),
+        facet[1](0), facet[1](1), facet[1](2),
+        facet[2](0), facet[2](1), facet[2](2));
     printf("z: min = %.2f, max = %.2f\n", min_z, max_z);
     #endif /* SLIC3R_TRIANGLEMESH_DEBUG */
     
@@ -935,7 +1273,6 @@ void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLin
         std::vector<float>::size_type layer_idx = it - z.begin();
         IntersectionLine il;
         if (this->slice_facet(*it / SCALING_FACTOR, facet, facet_idx, min_z, max_z, &il) == TriangleMeshSlicer::Slicing) {
-            boost::lock_guard<boost::mutex> l(*lines_mutex);
             if (il.edge_type == feHorizontal) {
                 // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
             } else
@@ -978,7 +1315,7 @@ void TriangleMeshSlicer::slice(
 
 // Return true, if the facet has been sliced and line_out has been filled.
 TriangleMeshSlicer::FacetSliceType TriangleMeshSlicer::slice_facet(
-    float slice_z, const stl_facet &facet, const int facet_idx,
+    float slice_z, const std::array<stl_vertex, 3> &facet, const int facet_idx,
     const float min_z, const float max_z, 
     IntersectionLine *line_out) const
 {
@@ -990,7 +1327,7 @@ TriangleMeshSlicer::FacetSliceType TriangleMeshSlicer::slice_facet(
     // This is needed to get all intersection lines in a consistent order
     // (external on the right of the line)
     const stl_triangle_vertex_indices &vertices = this->mesh->its.indices[facet_idx];
-    int i = (facet.vertex[1].z() == min_z) ? 1 : ((facet.vertex[2].z() == min_z) ? 2 : 0);
+    int i = (facet[1].z() == min_z) ? 1 : ((facet[2].z() == min_z) ? 2 : 0);
 
     // These are used only if the cut plane is tilted:
     stl_vertex rotated_a;
@@ -1021,14 +1358,13 @@ TriangleMeshSlicer::FacetSliceType TriangleMeshSlicer::slice_facet(
             const stl_vertex &v0 = m_use_quaternion ? stl_vertex(m_quaternion * this->v_scaled_shared[vertices[0]]) : this->v_scaled_shared[vertices[0]];
             const stl_vertex &v1 = m_use_quaternion ? stl_vertex(m_quaternion * this->v_scaled_shared[vertices[1]]) : this->v_scaled_shared[vertices[1]];
             const stl_vertex &v2 = m_use_quaternion ? stl_vertex(m_quaternion * this->v_scaled_shared[vertices[2]]) : this->v_scaled_shared[vertices[2]];
-            const stl_normal &normal = facet.normal;
             // We may ignore this edge for slicing purposes, but we may still use it for object cutting.
             FacetSliceType    result = Slicing;
             if (min_z == max_z) {
                 // All three vertices are aligned with slice_z.
                 line_out->edge_type = feHorizontal;
                 result = Cutting;
-                if (normal.z() < 0) {
+                if ((v1 - v0).cross(v2 - v0).z() < 0) {
                     // If normal points downwards this is a bottom horizontal facet so we reverse its point order.
                     std::swap(a, b);
                     std::swap(a_id, b_id);
@@ -1824,7 +2160,15 @@ void TriangleMeshSlicer::cut(float z, TriangleMesh* upper, TriangleMesh* lower)
     BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::cut - slicing object";
     float scaled_z = scale_(z);
     for (uint32_t facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; ++ facet_idx) {
-        const stl_facet* facet = &this->mesh->stl.facet_start[facet_idx];
+        // The facets of the upper and lower meshes are collected as admesh facets to be repaired.
+        stl_facet facet_data;
+        const stl_triangle_vertex_indices &face = this->mesh->its.indices[facet_idx];
+        for (int j = 0; j < 3; ++ j)
+            facet_data.vertex[j] = this->mesh->its.vertices[face(j)];
+        facet_data.normal = this->mesh->facet_normal(facet_idx);
+        facet_data.extra[0] = 0;
+        facet_data.extra[1] = 0;
+        const stl_facet* facet = &facet_data;
         
         // find facet extents
         float min_z = std::min(facet->vertex[0](2), std::min(facet->vertex[1](2), facet->vertex[2](2)));
@@ -1832,7 +2176,7 @@ void TriangleMeshSlicer::cut(float z, TriangleMesh* upper, TriangleMesh* lower)
         
         // intersect facet with cutting plane
         IntersectionLine line;
-        if (this->slice_facet(scaled_z, *facet, facet_idx, min_z, max_z, &line) != TriangleMeshSlicer::NoSlice) {
+        if (this->slice_facet(scaled_z, { facet->vertex[0], facet->vertex[1], facet->vertex[2] }, facet_idx, min_z, max_z, &line) != TriangleMeshSlicer::NoSlice) {
             // Save intersection lines for generating correct triangulations.
             if (line.edge_type == feTop) {
                 lower_lines.emplace_back(line);
@@ -1952,8 +2296,7 @@ Pointf3s TriangleMesh::vertices()
 {
     Pointf3s tmp{};
     if (this->repaired) {
-        if (this->its.vertices.empty())
-            stl_generate_shared_vertices(&this->stl, this->its); // build the list of vertices
+        this->require_shared_vertices(); // build the list of vertices
         for (auto i = 0; i < this->its.vertices.size(); i++) {
             const auto& v = this->its.vertices[i];
             tmp.emplace_back(Vec3d(v.x(), v.y(), v.z()));
@@ -3,7 +3,10 @@
 
 #include "libslic3r.h"
 #include <admesh/stl.h>
+#include <array>
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <vector>
 #include <boost/thread.hpp>
 #include "BoundingBox.hpp"
@@ -24,10 +27,11 @@ public:
     TriangleMesh() : repaired(false) {}
     TriangleMesh(const Pointf3s &points, const std::vector<Vec3i32> &facets);
     explicit TriangleMesh(const indexed_triangle_set &M);
+    explicit TriangleMesh(indexed_triangle_set &&M);
 	void clear() { this->stl.clear(); this->its.clear(); this->repaired = false; }
     bool ReadSTLFile(const char* input_file) { return stl_open(&stl, input_file); }
-    bool write_ascii(const char* output_file) { return stl_write_ascii(&this->stl, output_file, ""); }
-    bool write_binary(const char* output_file) { return stl_write_binary(&this->stl, output_file, ""); }
+    bool write_ascii(const char* output_file);
+    bool write_binary(const char* output_file);
     void repair(bool update_shared_vertices = true);
     float volume();
     void check_topology();
@@ -53,7 +57,6 @@ public:
     TriangleMeshPtrs split() const;
     void merge(const TriangleMesh &mesh);
     ExPolygons horizontal_projection() const;
-    const float* first_vertex() const { return this->stl.facet_start.empty() ? nullptr : &this->stl.facet_start.front().vertex[0](0); }
     // 2D convex hull of a 3D mesh projected into the Z=0 plane.
     Polygon convex_hull();
     BoundingBoxf3 bounding_box() const;
@@ -71,6 +74,10 @@ public:
     bool needed_repair() const;
     void require_shared_vertices();
     bool   has_shared_vertices() const { return ! this->its.vertices.empty(); }
+    // Unit normal of a facet, calculated from the shared vertices. The normals of a mesh repaired without generating
+    // the shared vertices are those stored with its admesh facets, which the repair fixed.
+    stl_normal facet_normal(size_t facet_idx) const
+        { return this->has_shared_vertices() ? its_face_normal(this->its, facet_idx) : this->stl.facet_start[facet_idx].normal; }
     size_t facets_count() const { return this->stl.stats.number_of_facets; }
     bool   empty() const { return this->facets_count() == 0; }
     bool is_splittable() const;
@@ -81,6 +88,9 @@ public:
 	// Restore optional data possibly released by release_optional().
 	void restore_optional();
 
+    // Once repaired and indexed, the mesh is stored as the indexed triangle set only, stl.facet_start and stl.neighbors_start
+    // are released and stl keeps just the statistics. The admesh facets are only populated between loading a mesh
+    // and repairing it, or temporarily for the admesh functions working over them.
     stl_file stl;
     indexed_triangle_set its;
     bool repaired;
@@ -89,9 +99,20 @@ public:
     Pointf3s vertices();
     
 private:
-    std::deque<uint32_t> find_unvisited_neighbors(std::vector<unsigned char> &facet_visited) const;
+    std::deque<uint32_t> find_unvisited_neighbors(const std::vector<Vec3i32> &face_neighbors, std::vector<unsigned char> &facet_visited) const;
+    // Expand the indexed triangle set into the admesh facets, if they were released.
+    void require_facets();
+    // Release the admesh facets and neighbors of an indexed mesh.
+    void release_facets();
 };
 
+// For each face and each of its edges (the edge i starting at the vertex i), index of the face sharing the edge, -1 if none.
+// Only the edges sharing both vertex indices are connected, the neighbors are not stored with the mesh.
+std::vector<Vec3i32> its_face_neighbors(const indexed_triangle_set &its);
+// Merge the vertices with equal coordinates, remove the faces degenerated by the merge and the unreferenced vertices.
+// Returns the number of faces removed.
+int its_merge_vertices(indexed_triangle_set &its);
+
 enum FacetEdgeType { 
     // A general case, the cutting plane intersect a face at two different edges.
     feGeneral,
@@ -201,23 +222,46 @@ public:
         Slicing = 1,
         Cutting = 2
     };
-    FacetSliceType slice_facet(float slice_z, const stl_facet &facet, const int facet_idx,
+    FacetSliceType slice_facet(float slice_z, const std::array<stl_vertex, 3> &facet, const int facet_idx,
         const float min_z, const float max_z, IntersectionLine *line_out) const;
     void cut(float z, TriangleMesh* upper, TriangleMesh* lower) const;
     void set_up_direction(const Vec3f& up);
+    // Collect indices of the facets spanning the closed Z interval <min_z, max_z>, sorted by the facet index.
+    // Returns false without filling facets if all the facets of the mesh span the interval
+    // or if the interval spans most of the mesh height.
+    bool facets_in_z_range(float min_z, float max_z, std::vector<uint32_t> &facets) const;
+    // Estimate of the memory occupied by the slicer, not counting the mesh.
+    size_t memsize() const;
     
 private:
     const TriangleMesh      *mesh;
     // Map from a facet to an edge index.
     std::vector<int>         facets_edges;
-    // Scaled copy of this->mesh->stl.v_shared
+    // Scaled copy of this->mesh->its.vertices
     std::vector<stl_vertex>  v_scaled_shared;
     // Quaternion that will be used to rotate every facet before the slicing
     Eigen::Quaternion<float, Eigen::DontAlign> m_quaternion;
     // Whether or not the above quaterion should be used
     bool                     m_use_quaternion = false;
+    // Z index of the facets, so that slicing a Z range visits only the facets spanning that range.
+    // Built on the first query of a partial Z range, slicing the whole height of the mesh does not need it.
+    // Facet indices sorted by the minimum Z of the facet.
+    mutable std::vector<uint32_t> m_facets_z_sorted;
+    // Minimum and maximum Z of the facets in the order of m_facets_z_sorted.
+    mutable std::vector<float>    m_facets_min_z;
+    mutable std::vector<float>    m_facets_max_z;
+    // Maximum of m_facets_max_z over blocks of FACETS_Z_BLOCK consecutive facets of m_facets_z_sorted.
+    mutable std::vector<float>    m_facets_block_max_z;
+    mutable std::atomic<bool>     m_facets_z_index_valid { false };
+    mutable std::mutex            m_facets_z_index_mutex;
+    static constexpr size_t       FACETS_Z_BLOCK = 64;
+
+    // Thread safe, builds the index once.
+    void build_facets_z_index() const;
+    // Unscaled vertices of a facet, rotated by m_quaternion if set.
+    std::array<stl_vertex, 3> facet_vertices(size_t facet_idx) const;
 
-    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, const std::vector<float> &z) const;
+    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, const std::vector<float> &z) const;
     void make_loops(std::vector<IntersectionLine> &lines, Polygons* loops) const;
     void make_expolygons(const Polygons &loops, ExPolygons* slices) const;
     void make_expolygons_simple(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
@@ -263,17 +307,41 @@ namespace cereal {
 	template <class Archive> struct specialize<Archive, Slic3r::TriangleMesh, cereal::specialization::non_member_load_save> {};
 	template<class Archive> void load(Archive &archive, Slic3r::TriangleMesh &mesh) {
         stl_file &stl = mesh.stl;
-        stl.stats.type = inmemory;
-		archive(stl.stats.number_of_facets, stl.stats.original_num_facets);
-        stl_allocate(&stl);
-		archive.loadBinary((char*)stl.facet_start.data(), stl.facet_start.size() * 50);
-        stl_get_size(&stl);
-        mesh.repair();
+        bool indexed;
+		archive(indexed, mesh.repaired);
+		if (indexed) {
+			// Indexed mesh is stored with its statistics, it does not need to be repaired again.
+			uint32_t num_vertices;
+			archive(num_vertices);
+			archive.loadBinary((char*)&stl.stats, sizeof(stl_stats));
+			mesh.its.vertices.assign(num_vertices, stl_vertex());
+			mesh.its.indices.assign(stl.stats.number_of_facets, stl_triangle_vertex_indices());
+			archive.loadBinary((char*)mesh.its.vertices.data(), mesh.its.vertices.size() * sizeof(stl_vertex));
+			archive.loadBinary((char*)mesh.its.indices.data(), mesh.its.indices.size() * sizeof(stl_triangle_vertex_indices));
+		} else {
+	        stl.stats.type = inmemory;
+			archive(stl.stats.number_of_facets, stl.stats.original_num_facets);
+	        stl_allocate(&stl);
+			archive.loadBinary((char*)stl.facet_start.data(), stl.facet_start.size() * 50);
+	        stl_get_size(&stl);
+	        mesh.repaired = false;
+		}
+		if (! mesh.repaired)
+	        mesh.repair();
 	}
 	template<class Archive> void save(Archive &archive, const Slic3r::TriangleMesh &mesh) {
 		const stl_file& stl = mesh.stl;
-		archive(stl.stats.number_of_facets, stl.stats.original_num_facets);
-		archive.saveBinary((char*)stl.facet_start.data(), stl.facet_start.size() * 50);
+		bool indexed = mesh.has_shared_vertices();
+		archive(indexed, mesh.repaired);
+		if (indexed) {
+			archive(uint32_t(mesh.its.vertices.size()));
+			archive.saveBinary((const char*)&stl.stats, sizeof(stl_stats));
+			archive.saveBinary((const char*)mesh.its.vertices.data(), mesh.its.vertices.size() * sizeof(stl_vertex));
+			archive.saveBinary((const char*)mesh.its.indices.data(), mesh.its.indices.size() * sizeof(stl_triangle_vertex_indices));
+		} else {
+			archive(stl.stats.number_of_facets, stl.stats.original_num_facets);
+			archive.saveBinary((char*)stl.facet_start.data(), stl.facet_start.size() * 50);
+		}
 	}
 }
 
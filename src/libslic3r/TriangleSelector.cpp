@@ -52,6 +52,10 @@ void TriangleSelector::select_patch(const Vec3f& hit, int facet_start,
         m_old_cursor_radius_sqr = m_cursor.radius_sqr;
     }
 
+    // The neighbors are only needed to paint, they are not calculated for the selectors of the unpainted volumes.
+    if (m_neighbors.empty())
+        m_neighbors = its_face_neighbors(m_mesh->its);
+
     // Now start with the facet the pointer points to and check all adjacent facets.
     std::vector<int> facets_to_check{facet_start};
     std::vector<bool> visited(m_orig_size_indices, false); // keep track of facets we already processed
@@ -62,7 +66,7 @@ void TriangleSelector::select_patch(const Vec3f& hit, int facet_start,
             if (select_triangle(facet, new_state)) {
                 // add neighboring facets to list to be proccessed later
                 for (int n=0; n<3; ++n) {
-                    int neighbor_idx = m_mesh->stl.neighbors_start[facet].neighbor[n];
+                    int neighbor_idx = m_neighbors[facet](n);
                     if (neighbor_idx >=0 && (m_cursor.type == SPHERE || faces_camera(neighbor_idx)))
                         facets_to_check.push_back(neighbor_idx);
                 }
@@ -235,8 +239,7 @@ bool TriangleSelector::is_pointer_in_triangle(int facet_idx) const
 bool TriangleSelector::faces_camera(int facet) const
 {
     assert(facet < m_orig_size_indices);
-    // The normal is cached in mesh->stl, use it.
-    Vec3f normal = m_mesh->stl.facet_start[facet].normal;
+    Vec3f normal = m_mesh->facet_normal(facet);
 
     if (! m_cursor.uniform_scaling) {
         // Transform the normal into world coords.
@@ -56,6 +56,9 @@ public:
     // Load serialized data. Assumes that correct mesh is loaded.
     void deserialize(const std::map<int, std::vector<bool>> data);
 
+    // Were the neighbors of the mesh triangles calculated by select_patch()?
+    bool has_neighbors() const { return ! m_neighbors.empty(); }
+
 
 protected:
     // Triangle and info about how it's split.
@@ -116,6 +119,8 @@ protected:
     std::vector<Vertex> m_vertices;
     std::vector<Triangle> m_triangles;
     const TriangleMesh* m_mesh;
+    // Neighbors of the triangles of m_mesh, see its_face_neighbors(). Calculated by the first select_patch().
+    std::vector<Vec3i32> m_neighbors;
 
     // Number of invalid triangles (to trigger garbage collection).
     int m_invalid_triangles;
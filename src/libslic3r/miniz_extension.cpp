@@ -1,3 +1,4 @@
+#include <cassert>
 #include <exception>
 
 #include "miniz_extension.hpp"
@@ -156,4 +157,70 @@ std::string MZ_Archive::get_errorstr(mz_zip_error mz_err)
     return "unknown error";
 }
 
+// Size of the chunks of content passed to the compressor.
+static constexpr size_t DEFLATE_CHUNK_SIZE = 1 << 16;
+
+MZ_DeflatedEntry::MZ_DeflatedEntry(std::string name, mz_uint level) : 
+    m_name(std::move(name)), m_compressor(std::make_unique<tdefl_compressor>())
+{
+    m_buffer.reserve(DEFLATE_CHUNK_SIZE);
+    // Raw deflate stream (negative window bits), as stored by mz_zip_writer_add_mem().
+    if (tdefl_init(m_compressor.get(), put_buf_callback, this, tdefl_create_comp_flags_from_zip_params(int(level), -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
+        m_failed = true;
+}
+
+MZ_DeflatedEntry::~MZ_DeflatedEntry() = default;
+
+mz_bool MZ_DeflatedEntry::put_buf_callback(const void *buf, int len, void *user)
+{
+    auto *self = static_cast<MZ_DeflatedEntry*>(user);
+    self->m_compressed.insert(self->m_compressed.end(), static_cast<const unsigned char*>(buf), static_cast<const unsigned char*>(buf) + len);
+    return MZ_TRUE;
+}
+
+void MZ_DeflatedEntry::append(const char *data, size_t len)
+{
+    assert(! m_finished);
+    if (m_buffer.size() + len > DEFLATE_CHUNK_SIZE && ! m_buffer.empty())
+        this->deflate_buffer(false);
+    m_buffer.append(data, len);
+}
+
+bool MZ_DeflatedEntry::deflate_buffer(bool last)
+{
+    if (m_failed)
+        return false;
+    m_crc32 = mz_uint32(mz_crc32(m_crc32, reinterpret_cast<const mz_uint8*>(m_buffer.data()), m_buffer.size()));
+    m_size += m_buffer.size();
+    tdefl_status status = tdefl_compress_buffer(m_compressor.get(), m_buffer.data(), m_buffer.size(), last ? TDEFL_FINISH : TDEFL_NO_FLUSH);
+    m_buffer.clear();
+    m_failed = last ? status != TDEFL_STATUS_DONE : status != TDEFL_STATUS_OKAY;
+    return ! m_failed;
+}
+
+bool MZ_DeflatedEntry::finish()
+{
+    if (! m_finished) {
+        m_finished = true;
+        this->deflate_buffer(true);
+        m_compressor.reset();
+        m_buffer.shrink_to_fit();
+    }
+    return ! m_failed;
+}
+
+bool MZ_DeflatedEntry::add_to_archive(mz_zip_archive &zip)
+{
+    if (! this->finish())
+        return false;
+    bool res = m_size == 0 ?
+        // An empty entry is stored, as by mz_zip_writer_add_mem().
+        mz_zip_writer_add_mem(&zip, m_name.c_str(), nullptr, 0, MZ_DEFAULT_COMPRESSION) != MZ_FALSE :
+        mz_zip_writer_add_mem_ex(&zip, m_name.c_str(), m_compressed.data(), m_compressed.size(), nullptr, 0, 
+            MZ_DEFAULT_LEVEL | MZ_ZIP_FLAG_COMPRESSED_DATA, m_size, m_crc32) != MZ_FALSE;
+    m_compressed.clear();
+    m_compressed.shrink_to_fit();
+    return res;
+}
+
 } // namespace Slic3r
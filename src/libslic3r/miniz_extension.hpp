@@ -1,7 +1,9 @@
 #ifndef MINIZ_EXTENSION_HPP
 #define MINIZ_EXTENSION_HPP
 
+#include <memory>
 #include <string>
+#include <vector>
 #include <miniz.h>
 
 namespace Slic3r {
@@ -30,6 +32,37 @@ public:
     }
 };
 
+// Archive entry deflated while its content is being appended, so that only the compressed data is held in memory.
+// The content is buffered and deflated in chunks, the finished entry is stored into an archive with add_to_archive().
+// An entry may be filled and finished on a worker thread, it does not touch the archive until add_to_archive().
+class MZ_DeflatedEntry {
+public:
+    explicit MZ_DeflatedEntry(std::string name, mz_uint level = MZ_DEFAULT_LEVEL);
+    ~MZ_DeflatedEntry();
+
+    const std::string& name() const { return m_name; }
+
+    void append(const char *data, size_t len);
+    void append(const std::string &data) { this->append(data.data(), data.size()); }
+    // Deflate the rest of the buffered content and close the deflate stream.
+    bool finish();
+    // Store the finished entry into the archive, the compressed data is released.
+    bool add_to_archive(mz_zip_archive &zip);
+
+private:
+    bool deflate_buffer(bool last);
+    static mz_bool put_buf_callback(const void *buf, int len, void *user);
+
+    std::string                       m_name;
+    std::unique_ptr<tdefl_compressor> m_compressor;
+    std::string                       m_buffer;
+    std::vector<unsigned char>        m_compressed;
+    mz_uint32                         m_crc32 { MZ_CRC32_INIT };
+    mz_uint64                         m_size { 0 };
+    bool                              m_finished { false };
+    bool                              m_failed { false };
+};
+
 } // namespace Slic3r
 
 #endif // MINIZ_EXTENSION_HPP
@@ -8,6 +8,7 @@
 
 #include "Platform.hpp"
 #include "Time.hpp"
+#include "SlicingMeshCache.hpp"
 
 #ifdef WIN32
 	#include <windows.h>
@@ -977,6 +978,9 @@ std::string log_memory_info(bool ignore_loglevel)
         else
             out += "N/A";
 #endif
+        // Memory held by the meshes prepared for slicing and kept for re-slicing.
+        if (size_t slicing_mesh_cache = SlicingMeshCache::total_memsize(); slicing_mesh_cache > 0)
+            out += "; Slicing mesh cache: " + format_memsize_MB(slicing_mesh_cache);
     }
     return out;
 }
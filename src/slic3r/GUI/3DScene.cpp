@@ -77,9 +77,9 @@ static void smooth_normals_corner(TriangleMesh& mesh, std::vector<stl_normal>& n
     using MapMatrixXfUnaligned = Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor | Eigen::DontAlign>>;
     using MapMatrixXiUnaligned = Eigen::Map<const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor | Eigen::DontAlign>>;
 
-    std::vector<stl_normal> face_normals(mesh.stl.stats.number_of_facets);
-    for (uint32_t i = 0; i < mesh.stl.stats.number_of_facets; ++i) {
-        face_normals[i] = mesh.stl.facet_start[i].normal;
+    std::vector<stl_normal> face_normals(mesh.its.indices.size());
+    for (size_t i = 0; i < mesh.its.indices.size(); ++i) {
+        face_normals[i] = mesh.facet_normal(i);
     }
 
     Eigen::MatrixXd vertices = MapMatrixXfUnaligned(mesh.its.vertices.front().data(),
@@ -159,10 +159,13 @@ void GLIndexedVertexArray::load_mesh_full_shading(const TriangleMesh& mesh)
     this->vertices_and_normals_interleaved.reserve(this->vertices_and_normals_interleaved.size() + 3 * 3 * 2 * mesh.facets_count());
 
     unsigned int vertices_count = 0;
-    for (int i = 0; i < (int)mesh.stl.stats.number_of_facets; ++i) {
-            const stl_facet& facet = mesh.stl.facet_start[i];
-        for (int j = 0; j < 3; ++j)
-            this->push_geometry(facet.vertex[j](0), facet.vertex[j](1), facet.vertex[j](2), facet.normal(0), facet.normal(1), facet.normal(2));
+    for (int i = 0; i < (int)mesh.its.indices.size(); ++i) {
+        const stl_triangle_vertex_indices& face = mesh.its.indices[i];
+        const stl_normal normal = mesh.facet_normal(i);
+        for (int j = 0; j < 3; ++j) {
+            const stl_vertex& v = mesh.its.vertices[face(j)];
+            this->push_geometry(v(0), v(1), v(2), normal(0), normal(1), normal(2));
+        }
 
         this->push_triangle(vertices_count, vertices_count + 1, vertices_count + 2);
         vertices_count += 3;
@@ -137,10 +137,8 @@ ModelObject* CalibrationAbstractDialog::add_part(ModelObject* model_object, std:
             //move to bed
             /* const TriangleMesh& hull = new_volume->get_convex_hull();
             float min_z = std::numeric_limits<float>::max();
-            for (const stl_facet& facet : hull.stl.facet_start) {
-                for (int i = 0; i < 3; ++i)
-                    min_z = std::min(min_z, Vec3f::UnitZ().dot(facet.vertex[i]));
-            }
+            for (const stl_vertex& vertex : hull.its.vertices)
+                min_z = std::min(min_z, Vec3f::UnitZ().dot(vertex));
             volume->translate(Vec3d(0,0,-min_z));*/
         }
     }
@@ -578,12 +578,13 @@ void GCodeViewer::refresh(const GCodeProcessor::Result& gcode_result, const std:
 
     // update ranges for coloring / legend
     m_extrusions.reset_ranges();
-    for (size_t i = 0; i < m_moves_count; ++i) {
+    GCodeProcessor::MoveVertices::const_iterator move_it = gcode_result.moves.begin();
+    for (size_t i = 0; i < m_moves_count; ++i, ++move_it) {
         // skip first vertex
         if (i == 0)
             continue;
 
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+        const GCodeProcessor::MoveVertex& curr = *move_it;
 
         switch (curr.type)
         {
@@ -1563,7 +1564,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessor::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memsize();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
@@ -1599,15 +1600,15 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     std::vector<float> options_zs;
 
     // toolpaths data -> extract vertices from result
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+    GCodeProcessor::MoveVertices::const_iterator move_it = gcode_result.moves.begin();
+    GCodeProcessor::MoveVertex prev;
+    for (size_t i = 0; i < m_moves_count; ++i, prev = *move_it, ++move_it) {
+        const GCodeProcessor::MoveVertex& curr = *move_it;
 
         // skip first vertex
         if (i == 0)
             continue;
 
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
-
         // update progress dialog
         ++progress_count;
         if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
@@ -1736,11 +1737,17 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             size_t next_sub_path_id = 0;
             size_t path_vertices_count = path.vertices_count();
             float half_width = 0.5f * path.width;
+            if (path_vertices_count < 3)
+                continue;
+            GCodeProcessor::MoveVertices::const_iterator move_it = gcode_result.moves.iterator_at(path.sub_paths.front().first.s_id);
+            Vec3f prev = Vec3f::Zero();
+            Vec3f curr = move_it->position;
+            Vec3f next = (++move_it)->position;
             for (size_t j = 1; j < path_vertices_count - 1; ++j) {
                 size_t curr_s_id = path.sub_paths.front().first.s_id + j;
-                const Vec3f& prev = gcode_result.moves[curr_s_id - 1].position;
-                const Vec3f& curr = gcode_result.moves[curr_s_id].position;
-                const Vec3f& next = gcode_result.moves[curr_s_id + 1].position;
+                prev = curr;
+                curr = next;
+                next = (++move_it)->position;
 
                 // select the subpaths which contains the previous/next segments
                 if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
@@ -1872,18 +1879,25 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     using VboIndexList = std::vector<unsigned int>;
     std::vector<VboIndexList> vbo_indices(m_buffers.size());
 
+    // the iterator points to the move following the current one
+    GCodeProcessor::MoveVertices::const_iterator next_move_it = gcode_result.moves.begin();
+    GCodeProcessor::MoveVertex prev_move;
+    GCodeProcessor::MoveVertex curr_move;
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+        prev_move = curr_move;
+        curr_move = *next_move_it;
+        ++next_move_it;
 
         // skip first vertex
         if (i == 0)
             continue;
 
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
+        const GCodeProcessor::MoveVertex& curr = curr_move;
+        const GCodeProcessor::MoveVertex& prev = prev_move;
 #if ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
         const GCodeProcessor::MoveVertex* next = nullptr;
         if (i < m_moves_count - 1)
-            next = &gcode_result.moves[i + 1];
+            next = &*next_move_it;
 #endif // ENABLE_REDUCED_TOOLPATHS_SEGMENT_CAPS
 
         ++progress_count;
@@ -2038,8 +2052,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
     // layers zs / roles / extruder ids -> extract from result
     size_t last_travel_s_id = 0;
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& move = gcode_result.moves[i];
+    GCodeProcessor::MoveVertices::const_iterator layer_move_it = gcode_result.moves.begin();
+    for (size_t i = 0; i < m_moves_count; ++i, ++layer_move_it) {
+        const GCodeProcessor::MoveVertex& move = *layer_move_it;
         if (move.type == EMoveType::Extrude) {
             // layers zs
             const double* const last_z = m_layers.empty() ? nullptr : &m_layers.get_zs().back();
@@ -2098,7 +2113,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 {
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessor::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memsize();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
@@ -2115,8 +2130,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
     m_extruders_count = gcode_result.extruders_count;
 
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& move = gcode_result.moves[i];
+    for (const GCodeProcessor::MoveVertex& move : gcode_result.moves) {
         if (wxGetApp().is_gcode_viewer())
             // for the gcode viewer we need all moves to correctly size the printbed
             m_paths_bounding_box.merge(move.position.cast<double>());
@@ -2486,7 +2500,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     std::vector<float> options_zs;
 
     // toolpaths data -> extract vertices from result
-    for (size_t i = 0; i < m_moves_count; ++i) {
+    GCodeProcessor::MoveVertices::const_iterator move_it = gcode_result.moves.begin();
+    GCodeProcessor::MoveVertex prev;
+    for (size_t i = 0; i < m_moves_count; ++i, prev = *move_it, ++move_it) {
         // skip first vertex
         if (i == 0)
             continue;
@@ -2499,8 +2515,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             progress_count = 0;
         }
 
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+        const GCodeProcessor::MoveVertex& curr = *move_it;
 
         unsigned char id = buffer_id(curr.type);
         TBuffer& buffer = m_buffers[id];
@@ -2574,7 +2589,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
     // variable used to keep track of the current size (in vertices) of the vertex buffer
     std::vector<size_t> curr_buffer_vertices_size(m_buffers.size(), 0);
-    for (size_t i = 0; i < m_moves_count; ++i) {
+    GCodeProcessor::MoveVertices::const_iterator index_move_it = gcode_result.moves.begin();
+    GCodeProcessor::MoveVertex prev_move;
+    for (size_t i = 0; i < m_moves_count; ++i, prev_move = *index_move_it, ++index_move_it) {
         // skip first vertex
         if (i == 0)
             continue;
@@ -2587,8 +2604,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             progress_count = 0;
         }
 
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+        const GCodeProcessor::MoveVertex& prev = prev_move;
+        const GCodeProcessor::MoveVertex& curr = *index_move_it;
 
         unsigned char id = buffer_id(curr.type);
         TBuffer& buffer = m_buffers[id];
@@ -2696,8 +2713,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
     // layers zs / roles / extruder ids / cp color ids -> extract from result
     size_t last_travel_s_id = 0;
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& move = gcode_result.moves[i];
+    GCodeProcessor::MoveVertices::const_iterator layer_move_it = gcode_result.moves.begin();
+    for (size_t i = 0; i < m_moves_count; ++i, ++layer_move_it) {
+        const GCodeProcessor::MoveVertex& move = *layer_move_it;
         if (move.type == EMoveType::Extrude) {
             // layers zs
             const double* const last_z = m_layers.empty() ? nullptr : &m_layers.get_zs().back();
@@ -56,11 +56,12 @@ void GLModel::init_from(const TriangleMesh& mesh)
 
     unsigned int vertices_count = 0;
     for (uint32_t i = 0; i < mesh.stl.stats.number_of_facets; ++i) {
-        const stl_facet& facet = mesh.stl.facet_start[i];
+        const stl_triangle_vertex_indices& face = mesh.its.indices[i];
+        const stl_normal normal = mesh.facet_normal(i);
         for (uint32_t j = 0; j < 3; ++j) {
             uint32_t offset = i * 18 + j * 6;
-            ::memcpy(static_cast<void*>(&vertices[offset]), static_cast<const void*>(facet.vertex[j].data()), 3 * sizeof(float));
-            ::memcpy(static_cast<void*>(&vertices[3 + offset]), static_cast<const void*>(facet.normal.data()), 3 * sizeof(float));
+            ::memcpy(static_cast<void*>(&vertices[offset]), static_cast<const void*>(mesh.its.vertices[face(j)].data()), 3 * sizeof(float));
+            ::memcpy(static_cast<void*>(&vertices[3 + offset]), static_cast<const void*>(normal.data()), 3 * sizeof(float));
         }
         for (uint32_t j = 0; j < 3; ++j) {
             indices[i * 3 + j] = vertices_count + j;
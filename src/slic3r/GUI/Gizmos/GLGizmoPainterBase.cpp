@@ -25,7 +25,7 @@ GLGizmoPainterBase::GLGizmoPainterBase(GLCanvas3D& parent, const std::string& ic
     const TriangleMesh sphere_mesh = make_sphere(1., (2*M_PI)/24.);
     for (size_t i=0; i<sphere_mesh.its.vertices.size(); ++i)
         m_vbo_sphere.push_geometry(sphere_mesh.its.vertices[i].cast<double>(),
-                                    sphere_mesh.stl.facet_start[i].normal.cast<double>());
+                                    sphere_mesh.its.vertices[i].normalized().cast<double>());
     for (const stl_triangle_vertex_indices& indices : sphere_mesh.its.indices)
         m_vbo_sphere.push_triangle(indices(0), indices(1), indices(2));
     m_vbo_sphere.finalize_geometry(true);
@@ -109,9 +109,9 @@ public:
     MeshRaycaster(const TriangleMesh& mesh)
         : m_emesh(mesh)
     {
-        m_normals.reserve(mesh.stl.facet_start.size());
-        for (const stl_facet& facet : mesh.stl.facet_start)
-            m_normals.push_back(facet.normal);
+        m_normals.reserve(mesh.its.indices.size());
+        for (size_t facet_idx = 0; facet_idx < mesh.its.indices.size(); ++ facet_idx)
+            m_normals.push_back(mesh.facet_normal(facet_idx));
     }
 
     void line_from_mouse_pos(const Vec2d& mouse_pos, const Transform3d& trafo, const Camera& camera,
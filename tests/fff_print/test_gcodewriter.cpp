@@ -157,3 +157,61 @@ SCENARIO("set_fan saves state.", "[GCode][GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("Numbers are written without trailing zeros, at the configured precision.", "[GCodeWriter]") {
+    GIVEN("Numbers with a fractional part") {
+        THEN("Trailing zeros and the dot are removed") {
+            REQUIRE_THAT(to_string_nozero(12.5, 3), Catch::Equals("12.5"));
+            REQUIRE_THAT(to_string_nozero(12.0004, 3), Catch::Equals("12"));
+            REQUIRE_THAT(to_string_nozero(-0.0004, 3), Catch::Equals("-0"));
+            REQUIRE_THAT(to_string_nozero(0.12345, 3), Catch::Equals("0.123"));
+            REQUIRE_THAT(to_string_nozero(0.1235, 5), Catch::Equals("0.1235"));
+        }
+        THEN("The precision is reduced to the 15 significant digits of a double") {
+            REQUIRE_THAT(to_string_nozero(123456789.123456789, 15), Catch::Equals("123456789.1234568"));
+        }
+    }
+    GIVEN("Integral numbers") {
+        THEN("They are written without a dot") {
+            REQUIRE_THAT(to_string_nozero(203., 3), Catch::Equals("203"));
+            REQUIRE_THAT(to_string_nozero(-5., 3), Catch::Equals("-5"));
+            REQUIRE_THAT(to_string_nozero(500003., 0), Catch::Equals("500003"));
+        }
+    }
+    GIVEN("A speed") {
+        THEN("It is written with 8 significant digits") {
+            std::string out;
+            append_float(out, 12345.200522, 8);
+            append_float(out, 1., 8);
+            REQUIRE_THAT(out, Catch::Equals("12345.2011"));
+        }
+    }
+}
+
+SCENARIO("Appending moves to a buffer gives the same G-code as the returned strings.", "[GCodeWriter]") {
+    GIVEN("Two GCodeWriter with a single extruder") {
+        GCodeWriter writer, writer_append;
+        for (GCodeWriter *w : { &writer, &writer_append }) {
+            w->config.gcode_comments.value = true;
+            w->set_extruders({ 0 });
+            w->set_tool(0);
+        }
+        WHEN("The same moves are written") {
+            std::string gcode, gcode_append;
+            gcode += writer.set_speed(1800., "", ";_EXTRUDE_SET_SPEED");
+            writer_append.set_speed(gcode_append, 1800., "", ";_EXTRUDE_SET_SPEED");
+            gcode += writer.travel_to_xy(Vec2d(10.25, 20.), 3000., "travel");
+            writer_append.travel_to_xy(gcode_append, Vec2d(10.25, 20.), 3000., "travel");
+            gcode += writer.extrude_to_xy(Vec2d(11.123456, 20.5), 0.0512345, "perimeter");
+            writer_append.extrude_to_xy(gcode_append, Vec2d(11.123456, 20.5), 0.0512345, "perimeter");
+            gcode += writer.travel_to_xyz(Vec3d(1., 2., 0.3));
+            writer_append.travel_to_xyz(gcode_append, Vec3d(1., 2., 0.3));
+            gcode += writer.extrude_to_xyz(Vec3d(3., 4., 0.), 0.1);
+            writer_append.extrude_to_xyz(gcode_append, Vec3d(3., 4., 0.), 0.1);
+            THEN("The G-code is identical") {
+                REQUIRE_THAT(gcode_append, Catch::Equals(gcode));
+                REQUIRE(gcode.find("G1 X10.25 Y20 F3000 ; travel\n") != std::string::npos);
+            }
+        }
+    }
+}
@@ -102,6 +102,57 @@ SCENARIO("Print: Changing number of solid surfaces does not cause all surfaces t
     }
 }
 
+SCENARIO("Print: Changing the config of a layer range only regenerates the layers of this range.", "[Print]") {
+    GIVEN("sliced 20mm cube with 2 perimeters and a layer range from 5mm to 10mm with 3 perimeters") {
+        Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "perimeters",         2 },
+            { "layer_height",       0.2 },
+            { "first_layer_height", 0.2 }
+            });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        ModelConfig &range_config = model.objects.front()->layer_config_ranges[{ 5., 10. }];
+        range_config.set("layer_height", 0.2);
+        range_config.set("perimeters", 3);
+        print.apply(model, config);
+        print.process();
+        auto perimeters_count = [&print](size_t layer_id) {
+            size_t count = 0;
+            for (const LayerRegion *layerm : print.objects().front()->get_layer(int(layer_id))->regions())
+                count += layerm->perimeters.items_count();
+            return count;
+        };
+        auto first_perimeter = [&print](size_t layer_id) -> const ExtrusionEntity* {
+            for (const LayerRegion *layerm : print.objects().front()->get_layer(int(layer_id))->regions())
+                if (! layerm->perimeters.entities().empty())
+                    return layerm->perimeters.entities().front();
+            return nullptr;
+        };
+        const Layer           *layer_below      = print.objects().front()->get_layer(10);
+        const ExtrusionEntity *perimeter_below  = first_perimeter(10);
+        const ExtrusionEntity *perimeter_above  = first_perimeter(70);
+        const size_t           perimeters_range = perimeters_count(35);
+        WHEN("the layer range is changed to 4 perimeters") {
+            range_config.set("perimeters", 4);
+            print.apply(model, config);
+            print.process();
+            THEN("the object is not sliced again") {
+                REQUIRE(print.objects().front()->get_layer(10) == layer_below);
+            }
+            THEN("the perimeters outside of the layer range are kept") {
+                REQUIRE(perimeter_below != nullptr);
+                REQUIRE(first_perimeter(10) == perimeter_below);
+                REQUIRE(first_perimeter(70) == perimeter_above);
+            }
+            THEN("the layers inside the layer range have more perimeters") {
+                REQUIRE(perimeters_count(35) > perimeters_range);
+            }
+        }
+    }
+}
+
 SCENARIO("Print: Brim generation", "[Print]") {
     GIVEN("20mm cube and default config, 1mm first layer width") {
         WHEN("Brim is set to 3mm")  {
@@ -2,10 +2,15 @@
 
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/GCode/SpiralVase.hpp"
 
 #include "test_data.hpp"
 
 #include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <boost/regex.hpp>
 
 using namespace Slic3r;
@@ -268,3 +273,239 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
         }
     }
 }
+
+SCENARIO("PrintGCode pipelined export", "[PrintGCode]") {
+    // Drop the "generated by ... on <timestamp>" line.
+    auto strip_header = [](const std::string &gcode) { return gcode.substr(gcode.find('\n')); };
+    auto export_both = [&strip_header](std::initializer_list<Slic3r::ConfigBase::SetDeserializeItem> config_items) {
+        std::string gcode[2];
+        for (int serial = 0; serial < 2; ++ serial) {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({ TestMesh::cube_20x20x20, TestMesh::pyramid }, print, model, config_items);
+            print.set_serial_gcode_export(serial == 1);
+            gcode[serial] = strip_header(Slic3r::Test::gcode(print));
+        }
+        return std::make_pair(gcode[0], gcode[1]);
+    };
+    GIVEN("Cooling with a minimum layer time and the fan mover") {
+        WHEN("the G-code is exported with and without the pipeline") {
+            auto gcode = export_both({
+                { "cooling",                    true },
+                { "slowdown_below_layer_time",  30 },
+                { "fan_below_layer_time",       60 },
+                { "fan_speedup_time",           0.5 },
+                { "fan_kickstart",              0.2 },
+                { "gcode_comments",             true }
+                });
+            THEN("the output is the same") {
+                REQUIRE(! gcode.first.empty());
+                REQUIRE(gcode.first == gcode.second);
+            }
+        }
+    }
+    GIVEN("Objects printed one after the other") {
+        WHEN("the G-code is exported with and without the pipeline") {
+            auto gcode = export_both({
+                { "complete_objects",           true },
+                { "cooling",                    true },
+                { "slowdown_below_layer_time",  30 }
+                });
+            THEN("the output is the same") {
+                REQUIRE(gcode.first == gcode.second);
+            }
+        }
+    }
+}
+
+SCENARIO("PrintGCode time estimates processed while exporting", "[PrintGCode]") {
+    for (bool remaining_times : { false, true }) {
+        GIVEN(std::string(remaining_times ? "Remaining times exported" : "No remaining times")) {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print, model, {
+                { "gcode_flavor",       "marlin" },
+                { "remaining_times",    remaining_times }
+                });
+            std::string gcode = Slic3r::Test::gcode(print);
+            THEN("the placeholders are filled in") {
+                REQUIRE(gcode.find("; _GP_") == std::string::npos);
+                REQUIRE(gcode.find("; estimated printing time (normal mode) = " + print.print_statistics().estimated_normal_print_time + "\n") != std::string::npos);
+                REQUIRE((gcode.find("\nM73 P") != std::string::npos) == remaining_times);
+            }
+            THEN("the estimate is the same as when processing the exported file") {
+                boost::filesystem::path temp = boost::filesystem::unique_path();
+                {
+                    boost::nowide::ofstream out(temp.string(), std::ios::binary);
+                    out << gcode;
+                }
+                GCodeProcessor processor;
+                processor.apply_config(print.config());
+                processor.process_file(temp.string(), false);
+                boost::nowide::remove(temp.string().c_str());
+                REQUIRE(get_time_dhms(processor.get_time(PrintEstimatedTimeStatistics::ETimeMode::Normal)) == print.print_statistics().estimated_normal_print_time);
+            }
+        }
+    }
+}
+
+SCENARIO("PrintGCode spiral vase", "[PrintGCode]") {
+    GIVEN("A cube printed in spiral vase mode") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print, model, {
+            { "spiral_vase",            true },
+            { "perimeters",             1 },
+            { "top_solid_layers",       0 },
+            { "bottom_solid_layers",    1 },
+            { "fill_density",           0 },
+            { "skirts",                 0 },
+            { "layer_height",           0.4 },
+            { "first_layer_height",     0.4 },
+            { "use_relative_e_distances", true }
+            });
+        std::string gcode = Slic3r::Test::gcode(print);
+        THEN("Z rises continuously along the extrusions of the spiral layers") {
+            GCodeReader reader;
+            reader.apply_config(print.config());
+            size_t num_z_increments = 0;
+            bool   z_decreases      = false;
+            reader.parse_buffer(gcode, [&num_z_increments, &z_decreases] (GCodeReader& self, const GCodeReader::GCodeLine& line) {
+                if (line.extruding(self) && line.dist_XY(self) > 0 && line.has(Z) && self.z() > 1.) {
+                    if (line.z() > self.z())
+                        ++ num_z_increments;
+                    else if (line.z() < self.z() - EPSILON)
+                        z_decreases = true;
+                }
+            });
+            // Many more Z steps than layers.
+            REQUIRE(num_z_increments > 20 / 0.4 * 4);
+            REQUIRE(! z_decreases);
+        }
+    }
+}
+
+SCENARIO("SpiralVase layers with Z lifts", "[PrintGCode]") {
+    GIVEN("A spiral vase layer lifting Z for a travel and at its end") {
+        PrintConfig config;
+        config.set_deserialize_strict({ { "use_relative_e_distances", "1" } });
+        SpiralVase spiral_vase(config);
+        spiral_vase.enable(false);
+        spiral_vase.process_layer("G1 Z0.2 F7800\nG1 X10 Y0 F7800\nG1 X20 Y0 E1 F1800\nG1 X20 Y10 E1\n");
+        spiral_vase.enable(true);
+        std::string transition_layer = spiral_vase.process_layer(
+            "G1 Z0.4 F7800\nG1 X20 Y0 E1\nG1 Z1 F7800\nG1 X10 Y0\nG1 Z0.4\nG1 X10 Y10 E1\nG1 X20 Y10 E1\nG1 Z1 F7800\n");
+        WHEN("The next layer is processed") {
+            std::string layer = spiral_vase.process_layer("G1 Z0.6 F7800\nG1 X20 Y0 E1\nG1 X10 Y0 E1\nG1 X10 Y10 E1\nG1 X20 Y10 E1\n");
+            THEN("The output is the same as before the layer was parsed just once") {
+                // Reference output of the implementation parsing each layer twice: the reader keeps the Z of the last lift
+                // as parsed, not as rewritten.
+                REQUIRE(transition_layer ==
+                    "; Began spiral\nG1 Z-0.400 F7800\nG1 Z-0.133 X20 Y0 E0.333\nG1 Z-0.400 F7800\nG1 Z-0.400\n"
+                    "G1 Z0.133 X10 Y10 E0.667\nG1 Z0.400 X20 Y10 E1.000\nG1 Z-0.400 F7800\n");
+                REQUIRE(layer ==
+                    "G1 Z1.000 F7800\nG1 Z0.900 X20 Y0 E1\nG1 Z0.800 X10 Y0 E1\nG1 Z0.700 X10 Y10 E1\nG1 Z0.600 X20 Y10 E1\n");
+            }
+        }
+    }
+}
+
+static bool operator==(const GCodeProcessor::MoveVertex &lhs, const GCodeProcessor::MoveVertex &rhs)
+{
+    return lhs.type == rhs.type && lhs.extrusion_role == rhs.extrusion_role && lhs.extruder_id == rhs.extruder_id && lhs.cp_color_id == rhs.cp_color_id &&
+        lhs.position == rhs.position && lhs.delta_extruder == rhs.delta_extruder && lhs.feedrate == rhs.feedrate && lhs.width == rhs.width &&
+        lhs.height == rhs.height && lhs.mm3_per_mm == rhs.mm3_per_mm && lhs.fan_speed == rhs.fan_speed && lhs.layer_duration == rhs.layer_duration &&
+        lhs.time == rhs.time && lhs.temperature == rhs.temperature;
+}
+
+SCENARIO("GCodeProcessor moves stored by columns", "[PrintGCode]") {
+    GIVEN("Moves with positions in micrometers, with more decimals, far apart and runs of equal attributes") {
+        std::vector<GCodeProcessor::MoveVertex> moves(1000);
+        for (size_t i = 1; i < moves.size(); ++ i) {
+            GCodeProcessor::MoveVertex &move = moves[i];
+            move.type           = i % 10 == 0 ? EMoveType::Travel : EMoveType::Extrude;
+            move.extrusion_role = i < 500 ? erPerimeter : erInternalInfill;
+            move.extruder_id    = (unsigned char)(i / 300);
+            move.position       = Vec3f(float(i % 100) * 0.125f + 0.001f, i % 7 == 0 ? 100.f / float(i) : float(i) * 0.01f, i % 250 == 0 ? 1000.f : 0.2f * float(i / 100 + 1));
+            move.delta_extruder = float(i) * 0.001f;
+            move.feedrate       = i % 10 == 0 ? 150.f : 40.f;
+            move.width          = 0.45f;
+            move.height         = 0.2f;
+            move.mm3_per_mm     = 0.08f;
+            move.fan_speed      = i < 100 ? 0.f : 100.f;
+            move.layer_duration = float(i / 100 + 1);
+            move.time           = float(i) * 0.5f;
+            move.temperature    = 210.f;
+        }
+        GCodeProcessor::MoveVertices columns;
+        for (const GCodeProcessor::MoveVertex &move : moves)
+            columns.push_back(move);
+        THEN("iterating the columns returns the moves") {
+            REQUIRE(columns.size() == moves.size());
+            size_t i = 0;
+            bool   equal = true;
+            for (const GCodeProcessor::MoveVertex &move : columns)
+                equal &= move == moves[i ++];
+            REQUIRE(i == moves.size());
+            REQUIRE(equal);
+        }
+        THEN("random access returns the moves") {
+            bool equal = true;
+            for (size_t i : { size_t(0), size_t(1), size_t(63), size_t(64), size_t(250), size_t(499), size_t(500), size_t(777), moves.size() - 1 }) {
+                equal &= columns[i] == moves[i];
+                auto it = columns.iterator_at(i);
+                equal &= *it == moves[i];
+                if (++ it != columns.end())
+                    equal &= *it == moves[i + 1];
+            }
+            REQUIRE(equal);
+        }
+        THEN("the layer durations are transformed") {
+            columns.transform_layer_durations([](float layer_duration) { return layer_duration * 2.f; });
+            REQUIRE(columns[150].layer_duration == 4.f);
+        }
+        THEN("the columns are smaller than the moves") {
+            columns.shrink_to_fit();
+            REQUIRE(columns.memsize() < moves.size() * sizeof(GCodeProcessor::MoveVertex) / 2);
+        }
+    }
+}
+
+SCENARIO("PrintGCode manual start G-code flushed by the fan mover", "[PrintGCode]") {
+    for (bool remaining_times : { false, true }) {
+        GIVEN(std::string("Manual start G-code with fan speedup, ") + (remaining_times ? "remaining times exported" : "no remaining times")) {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            // The moves of the start G-code (about 27 s) are shorter than the fan speedup time, they are held by the fan mover
+            // until its buffer is flushed after the start G-code.
+            Slic3r::Test::init_print({ TestMesh::cube_20x20x20 }, print, model, {
+                { "gcode_flavor",       "marlin" },
+                { "remaining_times",    remaining_times },
+                { "start_gcode_manual", true },
+                { "start_gcode",        "G28\nG1 Z5 F600\nG1 X100 Y100\nG1 X10 Y10\n" },
+                { "fan_speedup_time",   60. }
+                });
+            std::string gcode = Slic3r::Test::gcode(print);
+            THEN("the start G-code is exported") {
+                REQUIRE(gcode.find("\nG1 X100 Y100\n") != std::string::npos);
+                REQUIRE(gcode.find("\nG1 X10 Y10\n") != std::string::npos);
+            }
+            THEN("the placeholders are filled in") {
+                REQUIRE(gcode.find("; _GP_") == std::string::npos);
+                REQUIRE(gcode.find("; estimated printing time (normal mode) = " + print.print_statistics().estimated_normal_print_time + "\n") != std::string::npos);
+            }
+            THEN("the estimate is the same as when processing the exported file") {
+                boost::filesystem::path temp = boost::filesystem::unique_path();
+                {
+                    boost::nowide::ofstream out(temp.string(), std::ios::binary);
+                    out << gcode;
+                }
+                GCodeProcessor processor;
+                processor.apply_config(print.config());
+                processor.process_file(temp.string(), false);
+                boost::nowide::remove(temp.string().c_str());
+                REQUIRE(get_time_dhms(processor.get_time(PrintEstimatedTimeStatistics::ETimeMode::Normal)) == print.print_statistics().estimated_normal_print_time);
+            }
+        }
+    }
+}
@@ -3,6 +3,7 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Fill/FillAdaptive.hpp"
 
 #include "test_data.hpp"
 
@@ -94,7 +95,7 @@ SCENARIO("PrintObject: minimum horizontal shells", "[PrintObject]") {
         TestMesh m { TestMesh::cube_20x20x20 };
         Slic3r::Model model;
 
-        config.set_deserialize({
+        config.set_deserialize_strict({
                                {"nozzle_diameter", 3},
                                {"bottom_solid_layers", 0},
                                {"top_solid_layers", 0},
@@ -299,3 +300,25 @@ SCENARIO("PrintObject: minimum horizontal shells", "[PrintObject]") {
 
     }
 }
+
+SCENARIO("PrintObject: adaptive infill octree", "[PrintObject]") {
+    GIVEN("A sphere rotated to the coordinate system of the octree, as by PrintObject::prepare_adaptive_infill_data()") {
+        TriangleMesh sphere = make_sphere(20., PI / 60.);
+        sphere.require_shared_vertices();
+        indexed_triangle_set mesh = sphere.its;
+        Eigen::Matrix3f to_octree = FillAdaptive::transform_to_octree().toRotationMatrix().cast<float>();
+        for (stl_vertex &v : mesh.vertices)
+            v = (to_octree * v).eval();
+        WHEN("The octree is built in parallel and by inserting the triangles one by one") {
+            THEN("The leaf cubes are the same") {
+                for (bool support_overhangs_only : { false, true }) {
+                    FillAdaptive::OctreePtr parallel   = FillAdaptive::build_octree(mesh, {}, 0.5, support_overhangs_only);
+                    FillAdaptive::OctreePtr sequential = FillAdaptive::build_octree_sequential(mesh, {}, 0.5, support_overhangs_only);
+                    std::vector<Vec3d> leaves = FillAdaptive::octree_leaf_centers(*parallel);
+                    REQUIRE(leaves.size() > 100);
+                    REQUIRE(leaves == FillAdaptive::octree_leaf_centers(*sequential));
+                }
+            }
+        }
+    }
+}
@@ -4,12 +4,18 @@
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Model.hpp"
+#include "libslic3r/SlicingMeshCache.hpp"
+#include "libslic3r/TriangleSelector.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include <algorithm>
 #include <future>
 #include <chrono>
 
+#include <tbb/task_arena.h>
+
+#include <boost/filesystem.hpp>
+
 //#include "test_options.hpp"
 #include "test_data.hpp"
 
@@ -228,6 +234,185 @@ SCENARIO( "TriangleMesh: slice behavior.") {
     }
 }
 
+SCENARIO( "TriangleMeshSlicer: slicing is independent of the number of threads.") {
+    GIVEN( "A sphere split into multiple chunks of facets") {
+        TriangleMesh sphere = make_sphere(10., 2. * PI / 360.);
+        sphere.repair();
+        sphere.require_shared_vertices();
+        REQUIRE(sphere.facets_count() > 100000);
+        std::vector<float> z;
+        for (float slice_z = -9.95f; slice_z < 10.f; slice_z += 0.1f)
+            z.emplace_back(slice_z);
+        TriangleMeshSlicer slicer(&sphere);
+        WHEN("The sphere is sliced by a single thread and by the whole thread pool") {
+            std::vector<Polygons> serial;
+            tbb::task_arena arena(1);
+            arena.execute([&slicer, &z, &serial]() { slicer.slice(z, SlicingMode::Regular, &serial, []() {}); });
+            std::vector<Polygons> parallel;
+            slicer.slice(z, SlicingMode::Regular, &parallel, []() {});
+            THEN( "The same polygons are produced") {
+                REQUIRE(serial.size() == parallel.size());
+                for (size_t i = 0; i < serial.size(); ++ i) {
+                    REQUIRE(serial[i].size() == parallel[i].size());
+                    for (size_t j = 0; j < serial[i].size(); ++ j)
+                        REQUIRE(serial[i][j].points == parallel[i][j].points);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO( "TriangleMeshSlicer: slicing a Z range visits the facets spanning the range only.") {
+    GIVEN( "A tall cylinder") {
+        TriangleMesh cylinder = make_cylinder(10., 100.);
+        cylinder.repair();
+        cylinder.require_shared_vertices();
+        TriangleMeshSlicer slicer(&cylinder);
+        std::vector<float> z;
+        for (float slice_z = 0.1f; slice_z < 100.f; slice_z += 0.2f)
+            z.emplace_back(slice_z);
+        const size_t memsize_initialized = slicer.memsize();
+        std::vector<Polygons> all_layers;
+        slicer.slice(z, SlicingMode::Regular, &all_layers, []() {});
+        WHEN("All the layers were sliced") {
+            THEN( "The Z index of facets was not built") {
+                REQUIRE(slicer.memsize() == memsize_initialized);
+            }
+        }
+        WHEN("The facets spanning a Z range in the middle are queried") {
+            std::vector<uint32_t> facets;
+            bool partial = slicer.facets_in_z_range(40.f, 45.f, facets);
+            THEN( "Only the side facets are returned, sorted by their index") {
+                REQUIRE(partial);
+                REQUIRE(! facets.empty());
+                REQUIRE(facets.size() < cylinder.facets_count());
+                REQUIRE(std::is_sorted(facets.begin(), facets.end()));
+            }
+        }
+        WHEN("The whole Z span of the cylinder is queried") {
+            std::vector<uint32_t> facets;
+            THEN( "All facets are reported") {
+                REQUIRE(! slicer.facets_in_z_range(-1.f, 101.f, facets));
+            }
+        }
+        WHEN("Only the layers of a Z range are sliced") {
+            auto first = std::lower_bound(z.begin(), z.end(), 40.f);
+            auto last  = std::lower_bound(z.begin(), z.end(), 45.f);
+            std::vector<Polygons> range_layers;
+            slicer.slice(std::vector<float>(first, last), SlicingMode::Regular, &range_layers, []() {});
+            THEN( "The slices are the same as when slicing all the layers") {
+                REQUIRE(range_layers.size() == size_t(last - first));
+                for (size_t i = 0; i < range_layers.size(); ++ i) {
+                    const Polygons &expected = all_layers[first - z.begin() + i];
+                    REQUIRE(range_layers[i].size() == expected.size());
+                    for (size_t j = 0; j < expected.size(); ++ j)
+                        REQUIRE(range_layers[i][j].points == expected[j].points);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO( "SlicingMeshCache: prepared meshes are reused until the geometry changes.") {
+    GIVEN( "A model volume") {
+        Model model;
+        ModelObject *object = model.add_object();
+        ModelVolume *volume = object->add_volume(make_cube(20., 20., 20.));
+        std::vector<const ModelVolume*> volumes { volume };
+        SlicingMeshCache cache;
+        int num_prepared = 0;
+        auto prepare = [&num_prepared, volume](TriangleMesh &mesh) {
+            ++ num_prepared;
+            mesh = volume->mesh();
+            mesh.transform(volume->get_matrix(), true);
+            mesh.require_shared_vertices();
+            return true;
+        };
+        SlicingMeshCache::EntryPtr first = cache.get(volumes, Transform3d::Identity(), 0.f, 0.f, prepare, []() {});
+        WHEN("The same volume is prepared again") {
+            SlicingMeshCache::EntryPtr second = cache.get(volumes, Transform3d::Identity(), 0.f, 0.f, prepare, []() {});
+            THEN( "The cached mesh is returned") {
+                REQUIRE(first == second);
+                REQUIRE(num_prepared == 1);
+                REQUIRE(cache.memsize() > 0);
+                REQUIRE(SlicingMeshCache::total_memsize() >= cache.memsize());
+            }
+        }
+        WHEN("The volume is moved") {
+            volume->set_offset(Vec3d(0., 0., 5.));
+            SlicingMeshCache::EntryPtr second = cache.get(volumes, Transform3d::Identity(), 0.f, 0.f, prepare, []() {});
+            THEN( "The mesh is prepared again") {
+                REQUIRE(first != second);
+                REQUIRE(num_prepared == 2);
+                REQUIRE(second->mesh.bounding_box().min.z() == Approx(5.));
+            }
+        }
+        WHEN("The mesh of the volume is replaced") {
+            volume->set_mesh(make_cube(10., 10., 10.));
+            cache.remove_unused(*object);
+            THEN( "The stale mesh is released") {
+                REQUIRE(cache.memsize() == 0);
+            }
+        }
+    }
+}
+
+SCENARIO( "ModelVolume: transformed bounding boxes are calculated from the convex hull.") {
+    GIVEN( "A model volume with a non-convex mesh") {
+        TriangleMesh mesh = make_cube(20., 20., 20.);
+        TriangleMesh sphere = make_sphere(8., PI / 36.);
+        sphere.translate(10.f, 10.f, 25.f);
+        mesh.merge(sphere);
+        mesh.repair();
+        Model model;
+        ModelObject *object = model.add_object();
+        ModelVolume *volume = object->add_volume(mesh);
+        object->add_instance();
+        THEN( "The vertices of the convex hull are used") {
+            size_t num_vertices = 0;
+            volume->visit_convex_hull_vertices([&num_vertices](const stl_vertex &) { ++ num_vertices; });
+            REQUIRE(num_vertices == volume->get_convex_hull().its.vertices.size());
+            REQUIRE(num_vertices < volume->mesh().its.vertices.size());
+        }
+        THEN( "The transformed bounding boxes are the same as those of the mesh") {
+            for (double angle : { 0., 0.3, 1., 2.5 }) {
+                Transform3d trafo = Geometry::assemble_transform(Vec3d(1., -2., 3.), Vec3d(angle, 0.5 * angle, -angle), Vec3d(1., 2., 0.5));
+                BoundingBoxf3 bbox = volume->transformed_mesh_bounding_box(trafo);
+                REQUIRE(bbox.min == volume->mesh().transformed_bounding_box(trafo).min);
+                REQUIRE(bbox.max == volume->mesh().transformed_bounding_box(trafo).max);
+            }
+        }
+        WHEN( "The geometry of the volume is scaled") {
+            volume->scale_geometry_after_creation(Vec3d(2., 1., 0.5));
+            THEN( "The bounding box follows the scaled convex hull") {
+                BoundingBoxf3 bbox = volume->transformed_mesh_bounding_box(Transform3d::Identity());
+                REQUIRE(bbox.min.isApprox(volume->mesh().bounding_box().min));
+                REQUIRE(bbox.max.isApprox(volume->mesh().bounding_box().max));
+            }
+        }
+    }
+    GIVEN( "A model volume with a planar mesh, repaired without indexing its vertices") {
+        TriangleMesh mesh({ Vec3d(0., 0., 0.), Vec3d(10., 0., 0.), Vec3d(10., 10., 5.), Vec3d(0., 10., 5.) }, { Vec3i32(0, 1, 2), Vec3i32(0, 2, 3) });
+        mesh.repair(false);
+        Model model;
+        ModelObject *object = model.add_object();
+        ModelVolume *volume = object->add_volume(mesh, false);
+        THEN( "The normals are those of the repaired facets") {
+            REQUIRE(! mesh.has_shared_vertices());
+            REQUIRE(mesh.facet_normal(1).isApprox(stl_normal(0.f, -1.f, 2.f).normalized()));
+        }
+        THEN( "There is no convex hull and the vertices of the facets are used") {
+            REQUIRE(! volume->mesh().has_shared_vertices());
+            REQUIRE(volume->get_convex_hull().empty());
+            Transform3d trafo = Geometry::assemble_transform(Vec3d(1., -2., 3.), Vec3d(0.3, 0.15, -0.3), Vec3d(1., 2., 0.5));
+            BoundingBoxf3 bbox = volume->transformed_mesh_bounding_box(trafo);
+            REQUIRE(bbox.defined);
+            REQUIRE(bbox.min == mesh.transformed_bounding_box(trafo).min);
+            REQUIRE(bbox.max == mesh.transformed_bounding_box(trafo).max);
+        }
+    }
+}
+
 SCENARIO( "make_xxx functions produce meshes.") {
     GIVEN("make_cube() function") {
         WHEN("make_cube() is called with arguments 20,20,20") {
@@ -347,6 +532,56 @@ SCENARIO( "TriangleMesh: Mesh merge functions") {
     }
 }
 
+SCENARIO( "TriangleMesh: Repaired meshes are stored as an indexed triangle set only.") {
+    GIVEN( "A sphere") {
+        TriangleMesh sphere = make_sphere(10., PI / 36.);
+        THEN( "The admesh facets and neighbors are released after repair") {
+            REQUIRE(sphere.has_shared_vertices());
+            REQUIRE(sphere.stl.facet_start.empty());
+            REQUIRE(sphere.stl.neighbors_start.empty());
+            REQUIRE(sphere.facets_count() == sphere.its.indices.size());
+        }
+        THEN( "The normals calculated on demand point outwards") {
+            for (size_t i = 0; i < sphere.its.indices.size(); ++ i) {
+                const stl_triangle_vertex_indices &face = sphere.its.indices[i];
+                Vec3f center = (sphere.its.vertices[face(0)] + sphere.its.vertices[face(1)] + sphere.its.vertices[face(2)]) / 3.f;
+                REQUIRE(sphere.facet_normal(i).dot(center) > 0.f);
+                REQUIRE(sphere.facet_normal(i).norm() == Approx(1.f));
+            }
+        }
+        THEN( "Each facet of the closed mesh has three neighbors sharing an edge with it") {
+            std::vector<Vec3i32> neighbors = its_face_neighbors(sphere.its);
+            REQUIRE(neighbors.size() == sphere.its.indices.size());
+            for (size_t i = 0; i < neighbors.size(); ++ i)
+                for (int j = 0; j < 3; ++ j) {
+                    int neighbor = neighbors[i](j);
+                    REQUIRE(neighbor >= 0);
+                    const stl_triangle_vertex_indices &face  = sphere.its.indices[i];
+                    const stl_triangle_vertex_indices &other = sphere.its.indices[neighbor];
+                    int num_shared = 0;
+                    for (int k = 0; k < 3; ++ k)
+                        num_shared += int(other(0) == face(k) || other(1) == face(k) || other(2) == face(k));
+                    REQUIRE(num_shared == 2);
+                }
+        }
+        WHEN( "The mesh is written to a binary STL and read back") {
+            std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.stl")).string();
+            REQUIRE(sphere.write_binary(path.c_str()));
+            TriangleMesh loaded;
+            REQUIRE(loaded.ReadSTLFile(path.c_str()));
+            boost::filesystem::remove(path);
+            THEN( "The facets of the written mesh are released again") {
+                REQUIRE(sphere.stl.facet_start.empty());
+            }
+            THEN( "The loaded mesh has the same volume once repaired") {
+                loaded.repair();
+                REQUIRE(loaded.facets_count() == sphere.facets_count());
+                REQUIRE(loaded.volume() == Approx(sphere.volume()));
+            }
+        }
+    }
+}
+
 SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
     GIVEN( "A 20mm cube with one corner on the origin") {
         const std::vector<Vec3d> vertices { {20,20,0}, {20,0,0}, {0,0,0}, {0,20,0}, {20,20,20}, {0,20,20}, {0,0,20}, {20,0,20} };
@@ -432,3 +667,31 @@ TEST_CASE("Profile test for issue #4486 - files take forever to slice") {
 
 }
 #endif //BUILD_PROFILE
+
+SCENARIO( "TriangleSelector: The neighbors are only calculated for painting.") {
+    GIVEN( "A model volume of a cube, not painted") {
+        Model model;
+        ModelObject *object = model.add_object();
+        ModelVolume *volume = object->add_volume(make_cube(20., 20., 20.));
+        THEN( "The unpainted volume has no custom facets") {
+            REQUIRE(volume->supported_facets.empty());
+            REQUIRE(volume->supported_facets.get_facets(*volume, EnforcerBlockerType::ENFORCER).indices.empty());
+            REQUIRE(volume->seam_facets.get_facets(*volume, EnforcerBlockerType::BLOCKER).indices.empty());
+        }
+        WHEN( "A selector is built on the mesh of the volume") {
+            TriangleSelector selector(volume->mesh());
+            THEN( "The neighbors are not calculated") {
+                REQUIRE(! selector.has_neighbors());
+                REQUIRE(selector.get_facets(EnforcerBlockerType::ENFORCER).indices.empty());
+                REQUIRE(! selector.has_neighbors());
+            }
+            THEN( "The neighbors are calculated by painting") {
+                const stl_triangle_vertex_indices &face = volume->mesh().its.indices.front();
+                Vec3f hit = (volume->mesh().its.vertices[face(0)] + volume->mesh().its.vertices[face(1)] + volume->mesh().its.vertices[face(2)]) / 3.f;
+                selector.select_patch(hit, 0, hit + Vec3f(0.f, 0.f, 100.f), 5.f, TriangleSelector::SPHERE, EnforcerBlockerType::ENFORCER, Transform3d::Identity());
+                REQUIRE(selector.has_neighbors());
+                REQUIRE(! selector.get_facets(EnforcerBlockerType::ENFORCER).indices.empty());
+            }
+        }
+    }
+}
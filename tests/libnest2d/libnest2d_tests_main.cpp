@@ -688,6 +688,91 @@ TEST_CASE("Items can be preloaded", "[Nesting]") {
     }
 }
 
+TEST_CASE("Copies of parts are nested with cached no-fit polygons", "[Nesting]") {
+    auto bin = Box(250000000, 210000000);
+
+    auto copies = [] {
+        std::vector<Item> items;
+        for (size_t i = 0; i < 30; ++i) items.emplace_back(prusaParts()[i % 3]);
+        return items;
+    };
+
+    auto nest_copies = [&bin, &copies](const NestConfig<> &cfg) {
+        std::vector<Item> items = copies();
+        REQUIRE(libnest2d::nest(items, bin, 1000000, cfg) > 0u);
+        return items;
+    };
+
+    auto same_placement = [](const std::vector<Item> &items1,
+                             const std::vector<Item> &items2) {
+        for (size_t i = 0; i < items1.size(); ++i) {
+            REQUIRE(items1[i].binId() == items2[i].binId());
+            REQUIRE(items1[i].translation() == items2[i].translation());
+            REQUIRE(double(items1[i].rotation()) == double(items2[i].rotation()));
+        }
+    };
+
+    auto cache = std::make_shared<placers::NfpCache<ClipperLib::Polygon>>();
+
+    NestConfig<> cfg;
+    cfg.placer_config.nfp_cache = cache;
+
+    SECTION("Cached no-fit polygons should not lead to overlaps") {
+        std::vector<Item> items = nest_copies(cfg);
+
+        for (Item &itm1 : items) {
+            REQUIRE(itm1.binId() != BIN_ID_UNSET);
+            for (Item &itm2 : items)
+                if (&itm1 != &itm2 && itm1.binId() == itm2.binId())
+                    REQUIRE((!Item::intersects(itm1, itm2) || Item::touches(itm1, itm2)));
+        }
+
+        // Three parts in four rotations against each other.
+        REQUIRE(cache->size() > 0u);
+        REQUIRE(cache->size() <= 3u * 3u * 4u);
+    }
+
+    SECTION("The cache should be reused by the next nesting") {
+        std::vector<Item> items = nest_copies(cfg);
+        size_t cached = cache->size();
+
+        same_placement(items, nest_copies(cfg));
+        REQUIRE(cache->size() == cached);
+    }
+
+    SECTION("Without rotations the placement should not change") {
+        cfg.placer_config.rotations = {0.};
+        NestConfig<> uncached_cfg = cfg;
+        uncached_cfg.placer_config.nfp_cache.reset();
+
+        same_placement(nest_copies(cfg), nest_copies(uncached_cfg));
+    }
+}
+
+TEST_CASE("Cached no-fit polygons are only reused for the same geometry", "[Nesting]") {
+    using Cache = placers::NfpCache<ClipperLib::Polygon>;
+
+    Item square = { {0, 0}, {0, 10}, {10, 10}, {10, 0}, {0, 0} };
+    Item square_copy = square;
+    square_copy.translate({100, 100});
+    Item rect = { {0, 0}, {0, 10}, {20, 10}, {20, 0}, {0, 0} };
+
+    Cache cache;
+    Cache::Key key = Cache::key(square, square);
+    // Pretend the hashes of the different shapes collide.
+    Cache::Key colliding = Cache::key(rect, square);
+    colliding.fixed_shape = key.fixed_shape;
+
+    std::vector<ClipperLib::Polygon> nfps = { square.rawShape() };
+    cache.insert({key}, nfps, {false});
+    REQUIRE(cache.size() == 1u);
+
+    std::vector<ClipperLib::Polygon> found_nfps;
+    REQUIRE(cache.find({Cache::key(square_copy, square)}, found_nfps) == std::vector<bool>{true});
+    REQUIRE(found_nfps.front().Contour == square.rawShape().Contour);
+    REQUIRE(cache.find({colliding}, found_nfps) == std::vector<bool>{false});
+}
+
 namespace {
 
 struct ItemPair {
@@ -89,3 +89,44 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
         }
     }
 }
+
+SCENARIO("Export+Import painted facets to/from 3mf file cycle", "[3mf]") {
+    GIVEN("a model of two volumes with some facets painted") {
+        Model src_model;
+        std::string src_file = std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl";
+        load_stl(src_file.c_str(), &src_model);
+        src_model.add_default_instances();
+
+        ModelObject* src_object = src_model.objects[0];
+        src_object->add_volume(src_object->volumes[0]->mesh());
+        src_object->volumes[0]->supported_facets.set_triangle_from_string(0, "4");
+        src_object->volumes[0]->supported_facets.set_triangle_from_string(17, "1C");
+        src_object->volumes[0]->seam_facets.set_triangle_from_string(17, "8");
+        src_object->volumes[1]->supported_facets.set_triangle_from_string(0, "8");
+        src_object->volumes[1]->seam_facets.set_triangle_from_string(5, "4");
+
+        WHEN("model is saved+loaded to/from 3mf file") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/painted.3mf";
+            store_3mf(test_file.c_str(), &src_model, nullptr, false);
+
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("the painted facets of each volume are loaded back") {
+                REQUIRE(dst_model.objects.size() == 1);
+                REQUIRE(dst_model.objects[0]->volumes.size() == 2);
+                for (size_t i = 0; i < 2; ++ i) {
+                    const ModelVolume* src_volume = src_object->volumes[i];
+                    const ModelVolume* dst_volume = dst_model.objects[0]->volumes[i];
+                    REQUIRE(dst_volume->supported_facets.get_data() == src_volume->supported_facets.get_data());
+                    REQUIRE(dst_volume->seam_facets.get_data() == src_volume->seam_facets.get_data());
+                }
+            }
+        }
+    }
+}
@@ -275,6 +275,37 @@ size_t count_polys(const ExPolygons& expolys)
     return c;
 }
 
+SCENARIO("Clipper operations reading Slic3r polygons in place", "[ClipperUtils]") {
+    GIVEN("two overlapping squares with a hole") {
+        ExPolygon  expoly({ { 0, 0 }, { 40, 0 }, { 40, 40 }, { 0, 40 } }, { { 15, 15 }, { 15, 25 }, { 25, 25 }, { 25, 15 } });
+        Polygon    square { { 30, 10 }, { 60, 10 }, { 60, 30 }, { 30, 30 } };
+        // Reference: the same operation over ClipperLib::Paths copies of the input.
+        auto clipper_paths = [](ClipperLib::ClipType clip_type, const Polygons &subject, const Polygons &clip) {
+            ClipperLib::Clipper clipper;
+            clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(subject), ClipperLib::ptSubject, true);
+            clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(clip), ClipperLib::ptClip, true);
+            ClipperLib::Paths out;
+            clipper.Execute(clip_type, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+            return ClipperPaths_to_Slic3rPolygons(out);
+        };
+        THEN("diff matches the Clipper Paths result") {
+            REQUIRE(diff(to_polygons(expoly), { square }) == clipper_paths(ClipperLib::ctDifference, to_polygons(expoly), { square }));
+        }
+        THEN("intersection of ExPolygons matches the Clipper Paths result") {
+            REQUIRE(intersection(ExPolygons{ expoly }, ExPolygons{ ExPolygon(square) }) == clipper_paths(ClipperLib::ctIntersection, to_polygons(expoly), { square }));
+        }
+        THEN("union_ex of Surfaces matches union_ex of their polygons") {
+            Surfaces surfaces { Surface(stPosInternal | stDensSparse, expoly), Surface(stPosInternal | stDensSparse, ExPolygon(square)) };
+            REQUIRE(union_ex(surfaces) == union_ex(Polygons{ expoly.contour, expoly.holes.front(), square }));
+        }
+        THEN("simplify_polygons matches ClipperLib::SimplifyPolygons") {
+            ClipperLib::Paths out;
+            ClipperLib::SimplifyPolygons(Slic3rMultiPoints_to_ClipperPaths(Polygons{ expoly.contour, square }), out, ClipperLib::pftNonZero);
+            REQUIRE(simplify_polygons({ expoly.contour, square }) == ClipperPaths_to_Slic3rPolygons(out));
+        }
+    }
+}
+
 TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
     // Create a polygon representing unit box
     Polygon unitbox;
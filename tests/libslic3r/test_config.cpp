@@ -206,6 +206,62 @@ SCENARIO("Config ini load/save interface", "[Config]") {
     }
 }
 
+SCENARIO("DynamicConfig shares the values marked as shared with its copies.", "[Config]") {
+    GIVEN("A config generated from default options with its values shared") {
+        Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+        config.share_options();
+        Slic3r::DynamicPrintConfig copy = config;
+        THEN("The copy refers to the same values.") {
+            REQUIRE(static_cast<const DynamicPrintConfig&>(copy).option("layer_height") == static_cast<const DynamicPrintConfig&>(config).option("layer_height"));
+            REQUIRE(copy == config);
+        }
+        WHEN("A value of the copy is modified") {
+            copy.opt_float("layer_height") = 0.1;
+            copy.set_deserialize_strict("perimeters", "7");
+            THEN("The value of the original config is unchanged.") {
+                REQUIRE(copy.opt_float("layer_height") == 0.1);
+                REQUIRE(copy.opt_int("perimeters") == 7);
+                REQUIRE(config.opt_float("layer_height") == 0.2);
+                REQUIRE(config.opt_int("perimeters") == 3);
+            }
+        }
+        WHEN("A value is set to a value shared with another config") {
+            Slic3r::DynamicPrintConfig other;
+            other.set_key_value("perimeters", new ConfigOptionInt(5));
+            copy.set_key_value("perimeters", other.share_option("perimeters"));
+            other.opt_int("perimeters") = 6;
+            THEN("Modifying the other config does not change the value.") {
+                REQUIRE(copy.opt_int("perimeters") == 5);
+                REQUIRE(other.opt_int("perimeters") == 6);
+            }
+        }
+    }
+    GIVEN("A config generated from default options") {
+        Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+        WHEN("A value is modified through a pointer obtained before copying the config") {
+            ConfigOptionFloat *layer_height = config.opt<ConfigOptionFloat>("layer_height");
+            Slic3r::DynamicPrintConfig copy = config;
+            layer_height->value = 0.1;
+            THEN("The value of the copy is unchanged.") {
+                REQUIRE(config.opt_float("layer_height") == 0.1);
+                REQUIRE(copy.opt_float("layer_height") == 0.2);
+            }
+        }
+        WHEN("A config with shared values is added to it") {
+            ConfigOptionFloat *layer_height = config.opt<ConfigOptionFloat>("layer_height");
+            Slic3r::DynamicPrintConfig other;
+            other.set_key_value("layer_height", new ConfigOptionFloat(0.3));
+            other.share_options();
+            config += other;
+            THEN("The owned value is assigned in place.") {
+                REQUIRE(config.opt<ConfigOptionFloat>("layer_height") == layer_height);
+                REQUIRE(layer_height->value == 0.3);
+                REQUIRE(other.opt_float("layer_height") == 0.3);
+            }
+        }
+    }
+}
+
 SCENARIO("Config parameter conversion from old/related configurations.", "[Config][parameters]") {
     GIVEN("A Slic3r Config") {
         Slic3r::Model model;
@@ -71,6 +71,33 @@ SCENARIO("Placeholder parser scripting", "[PlaceholderParser]") {
     // The PlaceholderParser has no way to know which extrusion type the caller has in mind, therefore it throws.
     SECTION("first_layer_speed") { REQUIRE_THROWS(parser.process("{first_layer_speed}")); }
 
+    // The templates are split once into text, legacy variables and macros, then processed part by part.
+    SECTION("leading whitespaces are skipped") { REQUIRE(parser.process("  \n G1 [bar]") == "G1 2"); }
+    SECTION("escaped brackets and braces") { REQUIRE(parser.process("\\[foo\\] \\{bar} \\ [foo]") == "[foo\\] {bar} \\ 0"); }
+    SECTION("if block with nested legacy variables") { REQUIRE(parser.process("A{if bar > 1}[bar]{if foo == 0}x{endif}{else}[foo]{endif}B") == "A2xB"); }
+    SECTION("string literal with a brace") { REQUIRE(parser.process("{\"a}\" + \"b\"} [foo]") == "a}b 0"); }
+    SECTION("same template processed twice, after a variable change") {
+        const std::string templ = ";LAYER:[bar]\n{if bar > 2}big{else}small{endif}\n";
+        REQUIRE(parser.process(templ) == ";LAYER:2\nsmall\n");
+        parser.set("bar", 3);
+        REQUIRE(parser.process(templ) == ";LAYER:3\nbig\n");
+    }
+    SECTION("compiled template processed twice, after a variable change") {
+        PlaceholderParser::CompiledTemplatePtr templ = PlaceholderParser::compile_template(
+            "{if bar > 2}{bar * 100 + temperature[foo]}{elsif foo == 0}{min(bar, 1.5) * 2}{else}x{endif} [temperature_[foo]] {(bar > 2 ? \"hot\" : \"cold\") + \"!\"}");
+        REQUIRE(parser.process(*templ) == "3 357 cold!");
+        parser.set("bar", 3);
+        REQUIRE(parser.process(*templ) == "657 357 hot!");
+    }
+    SECTION("compiled template with a regex match") {
+        parser.set("name", std::string("PLA blue"));
+        REQUIRE(parser.process(*PlaceholderParser::compile_template("{((name =~ /PLA.*/) and not (name !~ /.*blue/))}")) == "true");
+    }
+    SECTION("compiled template reports errors at their position") {
+        REQUIRE_THROWS_WITH(parser.process(*PlaceholderParser::compile_template("G1 [foo]\n{if foo == 0}{nonexistent}{endif}")), Catch::Contains("line 2"));
+    }
+    SECTION("errors are reported at their position in the whole template") { REQUIRE_THROWS_WITH(parser.process("G1 [foo]\nG1 [nonexistent]"), Catch::Contains("line 2")); }
+
     // Test the boolean expression parser.
     auto boolean_expression = [&parser](const std::string& templ) { return parser.evaluate_boolean_expression(templ, parser.config()); };
 
@@ -2,6 +2,11 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
 
 using namespace Slic3r;
 
@@ -35,8 +40,7 @@ SCENARIO("Reading an STL file", "[stl]") {
 				REQUIRE(is_approx(model.objects.front()->volumes.front()->mesh().size(), Vec3d(20, 20, 20)));
 			}
 		}
-#if 0
-		// ASCII STLs ending with just carriage returns are not supported. These were used by the old Macs, while the Unix based MacOS uses LFs as any other Unix.
+		// ASCII STLs ending with just carriage returns were used by the old Macs, while the Unix based MacOS uses LFs as any other Unix.
 		WHEN("line endings CR") {
 			Slic3r::Model model;
 			THEN("load should succeed") {
@@ -44,8 +48,6 @@ SCENARIO("Reading an STL file", "[stl]") {
 				REQUIRE(is_approx(model.objects.front()->volumes.front()->mesh().size(), Vec3d(20, 20, 20)));
 			}
 		}
-
-#endif
 		WHEN("nonstandard STL file (text after ending tags, invalid normals, for example infinities)") {
 			Slic3r::Model model;
 			THEN("load should succeed") {
@@ -55,3 +57,32 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+SCENARIO("Connecting the facets by sorting their edges", "[stl]") {
+	GIVEN("a non-manifold mesh: a sphere, its copy with flipped facets and a cube sharing edges with each other, shuffled") {
+		TriangleMesh mesh = make_sphere(10., PI / 60.);
+		TriangleMesh flipped = mesh;
+		flipped.mirror_z();
+		mesh.merge(flipped);
+		mesh.merge(make_cube(10., 10., 10.));
+		stl_file stl;
+		stl.stats = mesh.stl.stats;
+		stl_facets_from_its(&stl, mesh.its);
+		std::shuffle(stl.facet_start.begin(), stl.facet_start.end(), std::mt19937(0));
+		WHEN("the facets are connected by hashing their edges and by sorting them in parallel") {
+			stl_file hashed = stl;
+			stl_check_facets_exact(&hashed);
+			stl_file sorted = stl;
+			stl_check_facets_exact_parallel(&sorted);
+			THEN("the neighbors and the statistics are the same") {
+				REQUIRE(hashed.neighbors_start.size() == sorted.neighbors_start.size());
+				REQUIRE(std::memcmp(hashed.neighbors_start.data(), sorted.neighbors_start.data(), sizeof(stl_neighbors) * hashed.neighbors_start.size()) == 0);
+				REQUIRE(hashed.stats.connected_edges == sorted.stats.connected_edges);
+				REQUIRE(hashed.stats.connected_facets_1_edge == sorted.stats.connected_facets_1_edge);
+				REQUIRE(hashed.stats.connected_facets_2_edge == sorted.stats.connected_facets_2_edge);
+				REQUIRE(hashed.stats.connected_facets_3_edge == sorted.stats.connected_facets_3_edge);
+				REQUIRE(hashed.stats.shortest_edge == sorted.stats.shortest_edge);
+			}
+		}
+	}
+}
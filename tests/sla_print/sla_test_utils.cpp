@@ -288,7 +288,10 @@ void check_validity(const TriangleMesh &input_mesh, int flags)
     } else if (mesh.empty())
         return; // If it can be empty and it is, there is nothing left to do.
     
-    REQUIRE(stl_validate(&mesh.stl));
+    if (mesh.has_shared_vertices())
+        REQUIRE(mesh.its.indices.size() == mesh.facets_count());
+    else
+        REQUIRE(stl_validate(&mesh.stl));
     
     bool do_update_shared_vertices = false;
     mesh.repair(do_update_shared_vertices);